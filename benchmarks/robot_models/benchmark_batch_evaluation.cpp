@@ -0,0 +1,100 @@
+#include <boost/filesystem.hpp>
+#include <thread>
+#include "../benchmarks_common.hpp"
+#include "robot_models/kdl/RobotModelKDL.hpp"
+#include "robot_models/rbdl/RobotModelRBDL.hpp"
+#include "robot_models/pinocchio/RobotModelPinocchio.hpp"
+
+using namespace wbc;
+using namespace std;
+
+/**
+ * Throughput of RobotModel::evaluateBatch() in configurations per second, depending on the number of threads. Each configuration computes the pose
+ * and the space Jacobian of all given chains, the CoM Jacobian and the joint space inertia matrix. Robot models that do not support workspaces
+ * evaluate the batch sequentially, independent of the number of threads.
+ */
+base::VectorXd evalBatch(RobotModelPtr robot_model, const BatchRequest& request, uint n_threads, uint n_configs, int n_runs){
+    const vector<string>& order = robot_model->jointOrder();
+    base::MatrixXd Q(order.size(), n_configs);
+    for(uint k = 0; k < n_configs; k++){
+        base::samples::Joints joint_state = randomJointState(robot_model->jointLimits());
+        for(size_t i = 0; i < order.size(); i++)
+            Q(i,k) = joint_state[order[i]].position;
+    }
+
+    robot_model->setBatchThreads(n_threads);
+    BatchResult result;
+    robot_model->evaluateBatch(Q, request, result); // Warm up: creates the workspaces and allocates the result buffers
+
+    base::VectorXd results(n_runs);
+    for(int i = 0; i < n_runs; i++){
+        base::Time start = base::Time::now();
+        robot_model->evaluateBatch(Q, request, result);
+        results[i] = n_configs / (base::Time::now()-start).toSeconds();
+    }
+    robot_model->setBatchThreads(1);
+    return results;
+}
+
+map<string,base::VectorXd> evaluateBatch(RobotModelPtr robot_model, const string &root, const vector<string> &tips, const vector<uint> &n_threads, uint n_configs, int n_runs){
+    BatchRequest request;
+    request.quantities = batch_pose | batch_space_jacobian | batch_com_jacobian | batch_inertia;
+    for(const string& tip : tips)
+        request.chains.push_back(robot_model->chainId(root, tip));
+
+    map<string,base::VectorXd> results;
+    for(uint n : n_threads)
+        results["n_threads_" + to_string(n)] = evalBatch(robot_model, request, n, n_configs, n_runs);
+    return results;
+}
+
+void printResults(const vector<uint> &n_threads, map<string,base::VectorXd> results){
+    for(uint n : n_threads){
+        const string key = "n_threads_" + to_string(n);
+        cout << "No of threads: " << n << ",  " << results[key].mean() << " configs/s +/- " << stdDev(results[key]) << endl;
+    }
+}
+
+void runRH5Benchmarks(uint n_configs, int n_runs){
+    cout << " ----------- Evaluating RH5 model: Batch evaluation throughput -----------" << endl;
+    RobotModelConfig cfg;
+    cfg.file_or_string = "../../../models/rh5/urdf/rh5.urdf";
+    cfg.floating_base = true;
+
+    RobotModelPtr robot_model_kdl =  std::make_shared<RobotModelKDL>();
+    RobotModelPtr robot_model_rbdl =  std::make_shared<RobotModelRBDL>();
+    RobotModelPtr robot_model_pinocchio =  std::make_shared<RobotModelPinocchio>();
+
+    if(!robot_model_kdl->configure(cfg)) abort();
+    if(!robot_model_pinocchio->configure(cfg))abort();
+    if(!robot_model_rbdl->configure(cfg))abort();
+
+    vector<uint> n_threads;
+    for(uint n = 1; n <= max(1u, thread::hardware_concurrency()); n *= 2)
+        n_threads.push_back(n);
+
+    const string root = "world";
+    const vector<string> tips = {"LLAnkle_FT", "LRAnkle_FT", "ALWrist_FT", "ARWrist_FT"};
+    map<string,base::VectorXd> results_kdl = evaluateBatch(robot_model_kdl, root, tips, {1}, n_configs, n_runs);
+    map<string,base::VectorXd> results_pinocchio = evaluateBatch(robot_model_pinocchio, root, tips, n_threads, n_configs, n_runs);
+    map<string,base::VectorXd> results_rbdl = evaluateBatch(robot_model_rbdl, root, tips, n_threads, n_configs, n_runs);
+
+    toCSV(results_kdl, "results/rh5_batch_kdl.csv");
+    toCSV(results_pinocchio, "results/rh5_batch_pinocchio.csv");
+    toCSV(results_rbdl, "results/rh5_batch_rbdl.csv");
+
+    cout << " ----------- Results RobotModelKDL (sequential) -----------" << endl;
+    printResults({1}, results_kdl);
+    cout << " ----------- Results RobotModelPinocchio -----------" << endl;
+    printResults(n_threads, results_pinocchio);
+    cout << " ----------- Results RobotModelRBDL -----------" << endl;
+    printResults(n_threads, results_rbdl);
+}
+
+int main(){
+    srand(time(NULL));
+    uint n_configs = 10000;
+    int n_runs = 20;
+    boost::filesystem::create_directory("results");
+    runRH5Benchmarks(n_configs, n_runs);
+}
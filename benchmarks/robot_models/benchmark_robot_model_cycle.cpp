@@ -0,0 +1,99 @@
+#include <boost/filesystem.hpp>
+#include "../benchmarks_common.hpp"
+#include "core/RobotModelFactory.hpp"
+#include "robot_models/hyrodyn/RobotModelHyrodyn.hpp"
+#include "robot_models/kdl/RobotModelKDL.hpp"
+#include "robot_models/rbdl/RobotModelRBDL.hpp"
+#include "robot_models/pinocchio/RobotModelPinocchio.hpp"
+
+using namespace wbc;
+using namespace std;
+
+/**
+ * Per-cycle cost of the robot model in an acceleration based WBC scene with n_tasks Cartesian tasks: One update() followed by
+ * the queries the scene performs for each task (pose/twist, space Jacobian, acceleration bias), the dynamics queries, and
+ * another rigidBodyState() per task as in updateTasksStatus(). In contrast to benchmark_robot_models, the time of update() is included,
+ * since robot models may move computations from the queries to update().
+ */
+base::VectorXd evalControlCycle(RobotModelPtr robot_model, const string &root, const vector<string> &tips, int n_tasks, int n_samples){
+    base::VectorXd results(n_samples);
+    for(int i = 0; i < n_samples; i++){
+        base::samples::Joints joint_state = randomJointState(robot_model->jointLimits());
+        base::samples::RigidBodyStateSE3 floating_base_state = randomFloatingBaseState(robot_model->floatingBaseState());
+        base::Time start = base::Time::now();
+        robot_model->update(joint_state, floating_base_state);
+        for(int j = 0; j < n_tasks; j++){
+            robot_model->rigidBodyState(root, tips[j]);
+            robot_model->spaceJacobian(root, tips[j]);
+            robot_model->spatialAccelerationBias(root, tips[j]);
+        }
+        robot_model->jointSpaceInertiaMatrix();
+        robot_model->biasForces();
+        for(int j = 0; j < n_tasks; j++)
+            robot_model->rigidBodyState(root, tips[j]);
+        results[i] = (double)(base::Time::now()-start).toMicroseconds()/1000;
+        usleep(0.001*1e6);
+    }
+    return results;
+}
+
+map<string,base::VectorXd> evaluateControlCycle(RobotModelPtr robot_model, const string &root, const vector<string> &tips, int n_samples){
+    map<string,base::VectorXd> results;
+    for(uint n = 1; n <= tips.size(); n++)
+        results["n_tasks_" + to_string(n)] = evalControlCycle(robot_model, root, tips, n, n_samples);
+    return results;
+}
+
+void printResults(const vector<string> &tips, map<string,base::VectorXd> results){
+    for(uint n = 1; n <= tips.size(); n++){
+        const string key = "n_tasks_" + to_string(n);
+        cout << "No of tasks: " << n << ",  " << results[key].mean() << " ms +/- " << stdDev(results[key]) << endl;
+    }
+}
+
+void runRH5Benchmarks(int n_samples){
+    cout << " ----------- Evaluating RH5 model: Cost per control cycle -----------" << endl;
+    RobotModelConfig cfg;
+    cfg.file_or_string = "../../../models/rh5/urdf/rh5.urdf";
+    cfg.submechanism_file = "../../../models/rh5/hyrodyn/rh5.yml";
+    cfg.floating_base = true;
+
+    RobotModelPtr robot_model_kdl =  std::make_shared<RobotModelKDL>();
+    RobotModelPtr robot_model_hyrodyn =  std::make_shared<RobotModelHyrodyn>();
+    RobotModelPtr robot_model_rbdl =  std::make_shared<RobotModelRBDL>();
+    RobotModelPtr robot_model_pinocchio =  std::make_shared<RobotModelPinocchio>();
+
+    if(!robot_model_kdl->configure(cfg)) abort();
+    if(!robot_model_hyrodyn->configure(cfg))abort();
+    if(!robot_model_pinocchio->configure(cfg))abort();
+    if(!robot_model_rbdl->configure(cfg))abort();
+
+    const string root = "world";
+    const vector<string> tips = {"LLAnkle_FT", "LRAnkle_FT", "ALWrist_FT", "ARWrist_FT", "FL_SupportCenter",
+                                 "FR_SupportCenter", "ALElbow_Link", "ARElbow_Link", "HeadPitch_Link", "IMU_Link"};
+    map<string,base::VectorXd> results_kdl = evaluateControlCycle(robot_model_kdl, root, tips, n_samples);
+    map<string,base::VectorXd> results_hyrodyn = evaluateControlCycle(robot_model_hyrodyn, root, tips, n_samples);
+    map<string,base::VectorXd> results_pinocchio = evaluateControlCycle(robot_model_pinocchio, root, tips, n_samples);
+    map<string,base::VectorXd> results_rbdl = evaluateControlCycle(robot_model_rbdl, root, tips, n_samples);
+
+    toCSV(results_kdl, "results/rh5_control_cycle_kdl.csv");
+    toCSV(results_hyrodyn, "results/rh5_control_cycle_hyrodyn.csv");
+    toCSV(results_pinocchio, "results/rh5_control_cycle_pinocchio.csv");
+    toCSV(results_rbdl, "results/rh5_control_cycle_rbdl.csv");
+
+    cout << " ----------- Results RobotModelKDL -----------" << endl;
+    printResults(tips, results_kdl);
+    cout << " ----------- Results RobotModelHyrodyn -----------" << endl;
+    printResults(tips, results_hyrodyn);
+    cout << " ----------- Results RobotModelPinocchio -----------" << endl;
+    printResults(tips, results_pinocchio);
+    cout << " ----------- Results RobotModelRBDL -----------" << endl;
+    printResults(tips, results_rbdl);
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 1000;
+    boost::filesystem::create_directory("results");
+    runRH5Benchmarks(n_samples);
+}
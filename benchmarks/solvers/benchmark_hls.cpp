@@ -0,0 +1,56 @@
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <core/QuadraticProgram.hpp>
+#include <solvers/hls/HierarchicalLSSolver.hpp>
+#include "../benchmarks_common.hpp"
+
+using namespace std;
+using namespace wbc;
+
+/**
+ * Latency of the HierarchicalLSSolver depending on the number of priorities and joints, with and without warm started SVD. The task matrices
+ * are random and perturbed slightly in each cycle, similar to the Jacobians of a robot moving in a control loop.
+ */
+base::VectorXd evalHLS(int n_prios, int n_joints, bool warm_start_svd, int n_cycles){
+    HierarchicalQP hqp;
+    hqp.resize(n_prios);
+    for(int prio = 0; prio < n_prios; prio++){
+        hqp[prio].resize(n_joints, 6, 0, false);
+        hqp[prio].A.setRandom();
+        hqp[prio].b.setRandom();
+    }
+    hqp.Wq.setOnes(n_joints);
+
+    HierarchicalLSSolver solver;
+    solver.setWarmStartSVD(warm_start_svd);
+    base::VectorXd solver_output, results(n_cycles);
+    for(int i = 0; i < n_cycles; i++){
+        for(int prio = 0; prio < n_prios; prio++){
+            for(int j = 0; j < hqp[prio].A.size(); j++)
+                hqp[prio].A.data()[j] += whiteNoise(1e-4);
+        }
+        base::Time start = base::Time::now();
+        solver.solve(hqp, solver_output);
+        results[i] = (double)(base::Time::now()-start).toMicroseconds()/1000;
+    }
+    return results;
+}
+
+int main(){
+    int n_cycles = 1000;
+    boost::filesystem::create_directory("results");
+
+    map<string,base::VectorXd> results;
+    for(int n_joints : {7, 14, 28, 56}){
+        for(int n_prios = 1; n_prios <= 5; n_prios++){
+            const string suffix = "_nj_" + to_string(n_joints) + "_np_" + to_string(n_prios);
+            results["cold" + suffix] = evalHLS(n_prios, n_joints, false, n_cycles);
+            results["warm" + suffix] = evalHLS(n_prios, n_joints, true, n_cycles);
+            cout << "Joints: " << n_joints << ", Priorities: " << n_prios
+                 << ", SVD from scratch: " << results["cold" + suffix].mean() << " ms +/- " << stdDev(results["cold" + suffix])
+                 << ", Warm started SVD: " << results["warm" + suffix].mean() << " ms +/- " << stdDev(results["warm" + suffix]) << endl;
+        }
+    }
+    toCSV(results, "results/hls_solver.csv");
+    return 0;
+}
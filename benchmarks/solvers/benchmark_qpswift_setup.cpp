@@ -0,0 +1,82 @@
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <core/RobotModelConfig.hpp>
+#include <core/QuadraticProgram.hpp>
+#include <robot_models/rbdl/RobotModelRBDL.hpp>
+#include <scenes/acceleration_tsid/AccelerationSceneTSID.hpp>
+#include <solvers/qpswift/QPSwiftSolver.hpp>
+#include "../benchmarks_common.hpp"
+
+using namespace std;
+using namespace wbc;
+
+/**
+ * Setup + solve latency of the QPSwift solver for a sequence of quadratic programs with constant dimensions, as it occurs in a control loop.
+ * The QP is generated once by an AccelerationSceneTSID and the gradient, the non-zeros of the equality constraint matrix and the constraint vectors
+ * are perturbed in each cycle. Compares the in-place update of the problem data against a setup of the solver in each cycle.
+ */
+base::VectorXd evalSetupAndSolve(const HierarchicalQP& hqp_in, bool reuse_kkt_ordering, bool in_place_update, int n_cycles){
+    shared_ptr<QPSwiftSolver> solver = make_shared<QPSwiftSolver>();
+    solver->setReuseKKTOrdering(reuse_kkt_ordering);
+    solver->setInPlaceUpdate(in_place_update);
+
+    HierarchicalQP hqp = hqp_in;
+    const QuadraticProgram& qp_in = hqp_in[0];
+    QuadraticProgram& qp = hqp[0];
+    base::VectorXd solver_output, results(n_cycles);
+    for(int i = 0; i < n_cycles; i++){
+        for(int j = 0; j < qp.g.size(); j++)
+            qp.g[j] = qp_in.g[j] + whiteNoise(1e-3);
+        for(int j = 0; j < qp.b.size(); j++)
+            qp.b[j] = qp_in.b[j] + whiteNoise(1e-3);
+        for(int j = 0; j < qp.A.size(); j++){
+            if(qp_in.A.data()[j] != 0)
+                qp.A.data()[j] = qp_in.A.data()[j] + whiteNoise(1e-3);
+        }
+        base::Time start = base::Time::now();
+        solver->solve(hqp, solver_output);
+        results[i] = (double)(base::Time::now()-start).toMicroseconds()/1000;
+    }
+    return results;
+}
+
+void runRH5LegsBenchmarks(int n_cycles){
+    cout << " ----------- Evaluating RH5 Legs model -----------" << endl;
+    RobotModelConfig cfg;
+    cfg.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    cfg.floating_base = true;
+    cfg.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    cfg.contact_points.elements = {contact, contact};
+    RobotModelPtr robot_model = make_shared<RobotModelRBDL>();
+    if(!robot_model->configure(cfg))
+        abort();
+    robot_model->update(randomJointState(robot_model->jointLimits()), randomFloatingBaseState());
+
+    TaskConfig cart_task("cart_pos_ctrl",0,"world","RH5_Root_Link","world",1);
+    AccelerationSceneTSID scene(robot_model, make_shared<QPSwiftSolver>(), 1e-3);
+    if(!scene.configure({cart_task}))
+        throw runtime_error("Failed to configure AccelerationSceneTSID");
+    scene.update();
+    HierarchicalQP hqp;
+    scene.getHierarchicalQP(hqp);
+
+    map<string,base::VectorXd> results;
+    results["setup_solve_no_reuse"] = evalSetupAndSolve(hqp, false, false, n_cycles);
+    results["setup_solve_reuse"] = evalSetupAndSolve(hqp, true, false, n_cycles);
+    results["in_place_update_solve"] = evalSetupAndSolve(hqp, true, true, n_cycles);
+    toCSV(results, "results/rh5_legs_qpswift_setup.csv");
+
+    cout << "Setup + Solve (ordering computed per cycle)  " << results["setup_solve_no_reuse"].mean() << " ms +/- " << stdDev(results["setup_solve_no_reuse"]) << endl;
+    cout << "Setup + Solve (ordering reused)              " << results["setup_solve_reuse"].mean() << " ms +/- " << stdDev(results["setup_solve_reuse"]) << endl;
+    cout << "In-place update + Solve                      " << results["in_place_update_solve"].mean() << " ms +/- " << stdDev(results["in_place_update_solve"]) << endl;
+}
+
+int main(){
+    int n_cycles = 10000;
+    boost::filesystem::create_directory("results");
+    runRH5LegsBenchmarks(n_cycles);
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include "core/TaskConfig.hpp"
 #include "core/TaskStatus.hpp"
 #include "core/QuadraticProgram.hpp"
+#include "core/QPSolver.hpp"
 #include <base/JointLimits.hpp>
 #include <boost/python/enum.hpp>
 
@@ -230,6 +231,22 @@ BOOST_PYTHON_MODULE(core){
                      py::make_getter(&wbc::TaskStatus::y, py::return_value_policy<py::copy_non_const_reference>()),
                      py::make_setter(&wbc::TaskStatus::y));
 
+   py::enum_<wbc::QPSolver::Status>("QPSolverStatus")
+       .value("solved", wbc::QPSolver::solved)
+       .value("max_iter_reached", wbc::QPSolver::max_iter_reached)
+       .value("time_budget_exceeded", wbc::QPSolver::time_budget_exceeded)
+       .value("not_solved", wbc::QPSolver::not_solved);
+
+   py::class_<wbc::SolverStats>("SolverStats")
+       .def_readonly("status",          &wbc::SolverStats::status)
+       .def_readonly("n_iter",          &wbc::SolverStats::n_iter)
+       .def_readonly("n_active",        &wbc::SolverStats::n_active)
+       .def_readonly("primal_residual", &wbc::SolverStats::primal_residual)
+       .def_readonly("dual_residual",   &wbc::SolverStats::dual_residual)
+       .def_readonly("setup_time",      &wbc::SolverStats::setup_time)
+       .def_readonly("solve_time",      &wbc::SolverStats::solve_time)
+       .def_readonly("warm_start",      &wbc::SolverStats::warm_start);
+
    py::class_<base::NamedVector<wbc::TaskStatus>>("TasksStatus")
            .add_property("names",
                py::make_getter(&wbc::TasksStatus::names, py::return_value_policy<py::copy_non_const_reference>()),
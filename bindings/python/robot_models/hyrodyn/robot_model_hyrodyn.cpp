@@ -33,6 +33,14 @@ wbc_py::RobotModelConfig RobotModelHyrodyn::getRobotModelConfig(){
 
 }
 
+// rigidBodyState(), spaceJacobian(), ... are overloaded for frame names and chain ids, so the member function pointers have to be disambiguated
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelHyrodyn::*RigidBodyStateFn)(const std::string&, const std::string&);
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelHyrodyn::*RigidBodyStateIdFn)(const wbc::ChainId);
+typedef const base::MatrixXd& (wbc::RobotModelHyrodyn::*JacobianFn)(const std::string&, const std::string&);
+typedef const base::MatrixXd& (wbc::RobotModelHyrodyn::*JacobianIdFn)(const wbc::ChainId);
+typedef const base::Acceleration& (wbc::RobotModelHyrodyn::*AccelerationBiasFn)(const std::string&, const std::string&);
+typedef const base::Acceleration& (wbc::RobotModelHyrodyn::*AccelerationBiasIdFn)(const wbc::ChainId);
+
 BOOST_PYTHON_MODULE(robot_model_hyrodyn){
 
     np::initialize();
@@ -42,10 +50,15 @@ BOOST_PYTHON_MODULE(robot_model_hyrodyn){
             .def("update",                  &wbc_py::RobotModelHyrodyn::update)
             .def("update",                  &wbc_py::RobotModelHyrodyn::update2)
             .def("jointState",              &wbc_py::RobotModelHyrodyn::jointState2)
-            .def("rigidBodyState",          &wbc_py::RobotModelHyrodyn::rigidBodyState, py::return_value_policy<py::copy_const_reference>())
-            .def("spaceJacobian",           &wbc_py::RobotModelHyrodyn::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("bodyJacobian",            &wbc_py::RobotModelHyrodyn::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("spatialAccelerationBias", &wbc_py::RobotModelHyrodyn::spatialAccelerationBias, py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateFn(&wbc_py::RobotModelHyrodyn::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateIdFn(&wbc_py::RobotModelHyrodyn::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianFn(&wbc_py::RobotModelHyrodyn::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianIdFn(&wbc_py::RobotModelHyrodyn::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianFn(&wbc_py::RobotModelHyrodyn::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianIdFn(&wbc_py::RobotModelHyrodyn::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasFn(&wbc_py::RobotModelHyrodyn::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasIdFn(&wbc_py::RobotModelHyrodyn::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("chainId",                 &wbc_py::RobotModelHyrodyn::chainId)
             .def("jacobianDot",             &wbc_py::RobotModelHyrodyn::jacobianDot, py::return_value_policy<py::copy_const_reference>())
             .def("jointSpaceInertiaMatrix", &wbc_py::RobotModelHyrodyn::jointSpaceInertiaMatrix, py::return_value_policy<py::copy_const_reference>())
             .def("biasForces",              &wbc_py::RobotModelHyrodyn::biasForces, py::return_value_policy<py::copy_const_reference>())
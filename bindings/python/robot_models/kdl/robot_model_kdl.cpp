@@ -33,6 +33,14 @@ wbc_py::RobotModelConfig RobotModelKDL::getRobotModelConfig(){
 
 }
 
+// rigidBodyState(), spaceJacobian(), ... are overloaded for frame names and chain ids, so the member function pointers have to be disambiguated
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelKDL::*RigidBodyStateFn)(const std::string&, const std::string&);
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelKDL::*RigidBodyStateIdFn)(const wbc::ChainId);
+typedef const base::MatrixXd& (wbc::RobotModelKDL::*JacobianFn)(const std::string&, const std::string&);
+typedef const base::MatrixXd& (wbc::RobotModelKDL::*JacobianIdFn)(const wbc::ChainId);
+typedef const base::Acceleration& (wbc::RobotModelKDL::*AccelerationBiasFn)(const std::string&, const std::string&);
+typedef const base::Acceleration& (wbc::RobotModelKDL::*AccelerationBiasIdFn)(const wbc::ChainId);
+
 BOOST_PYTHON_MODULE(robot_model_kdl){
 
     np::initialize();
@@ -42,10 +50,15 @@ BOOST_PYTHON_MODULE(robot_model_kdl){
             .def("update",                  &wbc_py::RobotModelKDL::update)
             .def("update",                  &wbc_py::RobotModelKDL::update2)
             .def("jointState",              &wbc_py::RobotModelKDL::jointState2)
-            .def("rigidBodyState",          &wbc_py::RobotModelKDL::rigidBodyState, py::return_value_policy<py::copy_const_reference>())
-            .def("spaceJacobian",           &wbc_py::RobotModelKDL::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("bodyJacobian",            &wbc_py::RobotModelKDL::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("spatialAccelerationBias", &wbc_py::RobotModelKDL::spatialAccelerationBias, py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateFn(&wbc_py::RobotModelKDL::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateIdFn(&wbc_py::RobotModelKDL::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianFn(&wbc_py::RobotModelKDL::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianIdFn(&wbc_py::RobotModelKDL::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianFn(&wbc_py::RobotModelKDL::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianIdFn(&wbc_py::RobotModelKDL::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasFn(&wbc_py::RobotModelKDL::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasIdFn(&wbc_py::RobotModelKDL::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("chainId",                 &wbc_py::RobotModelKDL::chainId)
             .def("jacobianDot",             &wbc_py::RobotModelKDL::jacobianDot, py::return_value_policy<py::copy_const_reference>())
             .def("jointSpaceInertiaMatrix", &wbc_py::RobotModelKDL::jointSpaceInertiaMatrix, py::return_value_policy<py::copy_const_reference>())
             .def("biasForces",              &wbc_py::RobotModelKDL::biasForces, py::return_value_policy<py::copy_const_reference>())
@@ -33,6 +33,14 @@ wbc_py::RobotModelConfig RobotModelPinocchio::getRobotModelConfig(){
 
 }
 
+// rigidBodyState(), spaceJacobian(), ... are overloaded for frame names and chain ids, so the member function pointers have to be disambiguated
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelPinocchio::*RigidBodyStateFn)(const std::string&, const std::string&);
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelPinocchio::*RigidBodyStateIdFn)(const wbc::ChainId);
+typedef const base::MatrixXd& (wbc::RobotModelPinocchio::*JacobianFn)(const std::string&, const std::string&);
+typedef const base::MatrixXd& (wbc::RobotModelPinocchio::*JacobianIdFn)(const wbc::ChainId);
+typedef const base::Acceleration& (wbc::RobotModelPinocchio::*AccelerationBiasFn)(const std::string&, const std::string&);
+typedef const base::Acceleration& (wbc::RobotModelPinocchio::*AccelerationBiasIdFn)(const wbc::ChainId);
+
 BOOST_PYTHON_MODULE(robot_model_pinocchio){
 
     np::initialize();
@@ -42,10 +50,15 @@ BOOST_PYTHON_MODULE(robot_model_pinocchio){
             .def("update",                  &wbc_py::RobotModelPinocchio::update)
             .def("update",                  &wbc_py::RobotModelPinocchio::update2)
             .def("jointState",              &wbc_py::RobotModelPinocchio::jointState2)
-            .def("rigidBodyState",          &wbc_py::RobotModelPinocchio::rigidBodyState, py::return_value_policy<py::copy_const_reference>())
-            .def("spaceJacobian",           &wbc_py::RobotModelPinocchio::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("bodyJacobian",            &wbc_py::RobotModelPinocchio::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("spatialAccelerationBias", &wbc_py::RobotModelPinocchio::spatialAccelerationBias, py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateFn(&wbc_py::RobotModelPinocchio::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateIdFn(&wbc_py::RobotModelPinocchio::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianFn(&wbc_py::RobotModelPinocchio::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianIdFn(&wbc_py::RobotModelPinocchio::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianFn(&wbc_py::RobotModelPinocchio::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianIdFn(&wbc_py::RobotModelPinocchio::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasFn(&wbc_py::RobotModelPinocchio::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasIdFn(&wbc_py::RobotModelPinocchio::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("chainId",                 &wbc_py::RobotModelPinocchio::chainId)
             .def("jacobianDot",             &wbc_py::RobotModelPinocchio::jacobianDot, py::return_value_policy<py::copy_const_reference>())
             .def("jointSpaceInertiaMatrix", &wbc_py::RobotModelPinocchio::jointSpaceInertiaMatrix, py::return_value_policy<py::copy_const_reference>())
             .def("biasForces",              &wbc_py::RobotModelPinocchio::biasForces, py::return_value_policy<py::copy_const_reference>())
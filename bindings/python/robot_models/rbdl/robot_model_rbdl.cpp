@@ -33,6 +33,14 @@ wbc_py::RobotModelConfig RobotModelRBDL::getRobotModelConfig(){
 
 }
 
+// rigidBodyState(), spaceJacobian(), ... are overloaded for frame names and chain ids, so the member function pointers have to be disambiguated
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelRBDL::*RigidBodyStateFn)(const std::string&, const std::string&);
+typedef const base::samples::RigidBodyStateSE3& (wbc::RobotModelRBDL::*RigidBodyStateIdFn)(const wbc::ChainId);
+typedef const base::MatrixXd& (wbc::RobotModelRBDL::*JacobianFn)(const std::string&, const std::string&);
+typedef const base::MatrixXd& (wbc::RobotModelRBDL::*JacobianIdFn)(const wbc::ChainId);
+typedef const base::Acceleration& (wbc::RobotModelRBDL::*AccelerationBiasFn)(const std::string&, const std::string&);
+typedef const base::Acceleration& (wbc::RobotModelRBDL::*AccelerationBiasIdFn)(const wbc::ChainId);
+
 BOOST_PYTHON_MODULE(robot_model_rbdl){
 
     np::initialize();
@@ -42,10 +50,15 @@ BOOST_PYTHON_MODULE(robot_model_rbdl){
             .def("update",                  &wbc_py::RobotModelRBDL::update)
             .def("update",                  &wbc_py::RobotModelRBDL::update2)
             .def("jointState",              &wbc_py::RobotModelRBDL::jointState2)
-            .def("rigidBodyState",          &wbc_py::RobotModelRBDL::rigidBodyState, py::return_value_policy<py::copy_const_reference>())
-            .def("spaceJacobian",           &wbc_py::RobotModelRBDL::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("bodyJacobian",            &wbc_py::RobotModelRBDL::spaceJacobian, py::return_value_policy<py::copy_const_reference>())
-            .def("spatialAccelerationBias", &wbc_py::RobotModelRBDL::spatialAccelerationBias, py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateFn(&wbc_py::RobotModelRBDL::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("rigidBodyState",          RigidBodyStateIdFn(&wbc_py::RobotModelRBDL::rigidBodyState), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianFn(&wbc_py::RobotModelRBDL::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spaceJacobian",           JacobianIdFn(&wbc_py::RobotModelRBDL::spaceJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianFn(&wbc_py::RobotModelRBDL::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("bodyJacobian",            JacobianIdFn(&wbc_py::RobotModelRBDL::bodyJacobian), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasFn(&wbc_py::RobotModelRBDL::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("spatialAccelerationBias", AccelerationBiasIdFn(&wbc_py::RobotModelRBDL::spatialAccelerationBias), py::return_value_policy<py::copy_const_reference>())
+            .def("chainId",                 &wbc_py::RobotModelRBDL::chainId)
             .def("jacobianDot",             &wbc_py::RobotModelRBDL::jacobianDot, py::return_value_policy<py::copy_const_reference>())
             .def("jointSpaceInertiaMatrix", &wbc_py::RobotModelRBDL::jointSpaceInertiaMatrix, py::return_value_policy<py::copy_const_reference>())
             .def("biasForces",              &wbc_py::RobotModelRBDL::biasForces, py::return_value_policy<py::copy_const_reference>())
@@ -78,6 +78,7 @@ BOOST_PYTHON_MODULE(acceleration_scene){
             .def("updateTasksStatus",   &wbc_py::AccelerationScene::updateTasksStatus2)
             .def("getHierarchicalQP",   &wbc_py::AccelerationScene::getHierarchicalQP,  py::return_value_policy<py::copy_const_reference>())
             .def("getSolverOutput",   &wbc_py::AccelerationScene::getSolverOutput,  py::return_value_policy<py::copy_const_reference>())
+            .def("getSolverStats",   &wbc_py::AccelerationScene::getSolverStats,  py::return_value_policy<py::copy_const_reference>())
             .def("setJointWeights",   &wbc_py::AccelerationScene::setJointWeights)
             .def("getJointWeights",   &wbc_py::AccelerationScene::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::AccelerationScene::getActuatedJointWeights2);
@@ -78,6 +78,7 @@ BOOST_PYTHON_MODULE(acceleration_scene_reduced_tsid){
             .def("updateTasksStatus",   &wbc_py::AccelerationSceneReducedTSID::updateTasksStatus2)
             .def("getHierarchicalQP",   &wbc_py::AccelerationSceneReducedTSID::getHierarchicalQP,  py::return_value_policy<py::copy_const_reference>())
             .def("getSolverOutput",   &wbc_py::AccelerationSceneReducedTSID::getSolverOutput,  py::return_value_policy<py::copy_const_reference>())
+            .def("getSolverStats",   &wbc_py::AccelerationSceneReducedTSID::getSolverStats,  py::return_value_policy<py::copy_const_reference>())
             .def("setJointWeights",   &wbc_py::AccelerationSceneReducedTSID::setJointWeights)
             .def("getJointWeights",   &wbc_py::AccelerationSceneReducedTSID::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::AccelerationSceneReducedTSID::getActuatedJointWeights2);
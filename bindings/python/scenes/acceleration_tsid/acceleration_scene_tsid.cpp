@@ -78,6 +78,7 @@ BOOST_PYTHON_MODULE(acceleration_scene_tsid){
             .def("updateTasksStatus",   &wbc_py::AccelerationSceneTSID::updateTasksStatus2)
             .def("getHierarchicalQP",   &wbc_py::AccelerationSceneTSID::getHierarchicalQP,  py::return_value_policy<py::copy_const_reference>())
             .def("getSolverOutput",   &wbc_py::AccelerationSceneTSID::getSolverOutput,  py::return_value_policy<py::copy_const_reference>())
+            .def("getSolverStats",   &wbc_py::AccelerationSceneTSID::getSolverStats,  py::return_value_policy<py::copy_const_reference>())
             .def("setJointWeights",   &wbc_py::AccelerationSceneTSID::setJointWeights)
             .def("getJointWeights",   &wbc_py::AccelerationSceneTSID::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::AccelerationSceneTSID::getActuatedJointWeights2);
@@ -78,6 +78,7 @@ BOOST_PYTHON_MODULE(velocity_scene){
             .def("updateTasksStatus",   &wbc_py::VelocityScene::updateTasksStatus2)
             .def("getHierarchicalQP",   &wbc_py::VelocityScene::getHierarchicalQP,  py::return_value_policy<py::copy_const_reference>())
             .def("getSolverOutput",   &wbc_py::VelocityScene::getSolverOutput,  py::return_value_policy<py::copy_const_reference>())
+            .def("getSolverStats",   &wbc_py::VelocityScene::getSolverStats,  py::return_value_policy<py::copy_const_reference>())
             .def("setJointWeights",   &wbc_py::VelocityScene::setJointWeights)
             .def("getJointWeights",   &wbc_py::VelocityScene::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::VelocityScene::getActuatedJointWeights2);
@@ -78,6 +78,7 @@ BOOST_PYTHON_MODULE(velocity_scene_qp){
             .def("updateTasksStatus",   &wbc_py::VelocitySceneQP::updateTasksStatus2)
             .def("getHierarchicalQP",   &wbc_py::VelocitySceneQP::getHierarchicalQP,  py::return_value_policy<py::copy_const_reference>())
             .def("getSolverOutput",   &wbc_py::VelocitySceneQP::getSolverOutput,  py::return_value_policy<py::copy_const_reference>())
+            .def("getSolverStats",   &wbc_py::VelocitySceneQP::getSolverStats,  py::return_value_policy<py::copy_const_reference>())
             .def("setJointWeights",   &wbc_py::VelocitySceneQP::setJointWeights)
             .def("getJointWeights",   &wbc_py::VelocitySceneQP::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::VelocitySceneQP::getActuatedJointWeights2);
@@ -19,6 +19,7 @@ BOOST_PYTHON_MODULE(hls_solver){
 
     py::class_<wbc_py::HierarchicalLSSolver>("HierarchicalLSSolver")
             .def("solve", &wbc_py::HierarchicalLSSolver::solve)
+            .def("getStats", &wbc_py::HierarchicalLSSolver::getStats, py::return_value_policy<py::copy_const_reference>())
             .def("setMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::setMaxSolverOutputNorm)
             .def("getMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::getMaxSolverOutputNorm)
             .def("setMinEigenvalue", &wbc_py::HierarchicalLSSolver::setMinEigenvalue)
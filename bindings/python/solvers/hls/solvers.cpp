@@ -28,12 +28,14 @@ BOOST_PYTHON_MODULE(solvers){
 
     py::class_<wbc_py::HierarchicalLSSolver>("HierarchicalLSSolver")
             .def("solve", &wbc_py::HierarchicalLSSolver::solve)
+            .def("getStats", &wbc_py::HierarchicalLSSolver::getStats, py::return_value_policy<py::copy_const_reference>())
             .def("setMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::setMaxSolverOutputNorm)
             .def("getMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::getMaxSolverOutputNorm)
             .def("setMinEigenvalue", &wbc_py::HierarchicalLSSolver::setMinEigenvalue)
             .def("getMinEigenvalue", &wbc_py::HierarchicalLSSolver::getMinEigenvalue);
     py::class_<wbc_py::QPOASESSolver>("QPOASESSolver")
             .def("solve", &wbc_py::QPOASESSolver::solve)
+            .def("getStats", &wbc_py::QPOASESSolver::getStats, py::return_value_policy<py::copy_const_reference>())
             .def("setMaxNoWSR", &wbc_py::QPOASESSolver::setMaxNoWSR)
             .def("getMaxNoWSR", &wbc_py::QPOASESSolver::getMaxNoWSR)
             .def("getReturnValue", &wbc_py::QPOASESSolver::getReturnValueAsInt)
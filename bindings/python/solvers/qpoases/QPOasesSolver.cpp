@@ -21,6 +21,7 @@ BOOST_PYTHON_MODULE(qpoases_solver){
     np::initialize();
     py::class_<wbc_py::QPOASESSolver>("QPOASESSolver")
             .def("solve", &wbc_py::QPOASESSolver::solve)
+            .def("getStats", &wbc_py::QPOASESSolver::getStats, py::return_value_policy<py::copy_const_reference>())
             .def("setMaxNoWSR", &wbc_py::QPOASESSolver::setMaxNoWSR)
             .def("getMaxNoWSR", &wbc_py::QPOASESSolver::getMaxNoWSR)
             .def("getReturnValue", &wbc_py::QPOASESSolver::getReturnValueAsInt)
@@ -3,6 +3,12 @@ from wbc.robot_models.robot_model_rbdl import *
 import numpy as np
 import nose
 
+def rotationMatrix(q):
+    x,y,z,w = q
+    return np.array([[1-2*(y*y+z*z), 2*(x*y-z*w),   2*(x*z+y*w)],
+                     [2*(x*y+z*w),   1-2*(x*x+z*z), 2*(y*z-x*w)],
+                     [2*(x*z-y*w),   2*(y*z+x*w),   1-2*(x*x+y*y)]])
+
 def run(robot_model):
     joint_names = ["LLHip1", "LLHip2", "LLHip3", "LLKnee", "LLAnkleRoll", "LLAnklePitch"]
     root_link = "RH5_Root_Link"
@@ -33,10 +39,20 @@ def run(robot_model):
     space_jacobian = robot_model.spaceJacobian(root_link, tip_link)
     body_jacobian  = robot_model.bodyJacobian(root_link, tip_link)
 
-    twist = np.array(body_jacobian).dot(np.array([js.speed]*nj))
+    twist = np.array(space_jacobian).dot(np.array([js.speed]*nj))
     assert np.all(np.isclose(twist[0:3] - rbs.twist.linear, np.array([0]*3)))
     assert np.all(np.isclose(twist[3:6] - rbs.twist.angular, np.array([0]*3)))
 
+    # Body Jacobian: Space Jacobian expressed in tip coordinates
+    R = rotationMatrix(rbs.pose.orientation)
+    assert np.all(np.isclose(body_jacobian[0:3,:], R.T.dot(space_jacobian[0:3,:])))
+    assert np.all(np.isclose(body_jacobian[3:6,:], R.T.dot(space_jacobian[3:6,:])))
+
+    # Chain id overloads have to give the same results as the frame name overloads
+    chain = robot_model.chainId(root_link, tip_link)
+    assert np.all(robot_model.spaceJacobian(chain) == space_jacobian)
+    assert np.all(robot_model.bodyJacobian(chain) == body_jacobian)
+
     bias_acc = robot_model.spatialAccelerationBias(root_link, tip_link)
     accel = np.append(bias_acc.linear,bias_acc.angular) + space_jacobian.dot(np.array([js.acceleration]*nj))
     assert np.all(np.isclose(accel[0:3] - rbs.acceleration.linear, np.array([0]*3)))
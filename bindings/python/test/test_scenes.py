@@ -198,6 +198,57 @@ def test_solver_output():
     # Fix me: reduced TSID does not find a solution for this problem!
     #run_acceleration_wbc(AccelerationSceneReducedTSID(robot_model, qp_solver, 0.001), robot_model)
 
+def test_solver_stats():
+    robot_model=RobotModelRBDL()
+    r=RobotModelConfig()
+    r.file_or_string="../../../models/kuka/urdf/kuka_iiwa.urdf"
+    r.actuated_joint_names = ["kuka_lbr_l_joint_1", "kuka_lbr_l_joint_2", "kuka_lbr_l_joint_3", "kuka_lbr_l_joint_4", "kuka_lbr_l_joint_5", "kuka_lbr_l_joint_6", "kuka_lbr_l_joint_7"]
+    r.joint_names = r.actuated_joint_names
+    assert robot_model.configure(r) == True
+
+    joint_state = Joints()
+    js = JointState()
+    js.position = 1.0
+    js.speed = js.acceleration = 0.0
+    joint_state.names = r.joint_names
+    joint_state.elements = [js]*len(r.actuated_joint_names)
+    robot_model.update(joint_state)
+
+    ref = RigidBodyStateSE3()
+    ref.twist.linear  = [0.0,0.0,0.1]
+    ref.twist.angular = [0.0,0.0,0.0]
+
+    # qpOASES: The first call initializes the solver, all subsequent calls are hotstarts
+    qp_solver = QPOASESSolver()
+    qp_solver.setMaxNoWSR(100)
+    scene = VelocitySceneQP(robot_model, qp_solver, 0.001)
+    configure_wbc(scene)
+    scene.setReference("tcp_pose",ref)
+    for i in range(2):
+        scene.solve(scene.update())
+        stats = scene.getSolverStats()
+        assert stats.status == QPSolverStatus.solved
+        assert stats.n_iter <= 100
+        assert stats.n_iter == qp_solver.getNoWSR()
+        assert stats.setup_time >= 0
+        assert stats.solve_time >= 0
+        assert stats.warm_start == (i > 0)
+        assert qp_solver.getStats().n_iter == stats.n_iter
+        assert qp_solver.getStats().warm_start == stats.warm_start
+
+    # HLS: The SVD is warm started by default and needs at least one sweep per priority
+    hls_solver = HierarchicalLSSolver()
+    scene = VelocityScene(robot_model, hls_solver, 0.001)
+    configure_wbc(scene)
+    scene.setReference("tcp_pose",ref)
+    scene.solve(scene.update())
+    stats = scene.getSolverStats()
+    assert stats.status == QPSolverStatus.solved
+    assert stats.n_iter > 0
+    assert stats.setup_time >= 0
+    assert stats.solve_time >= 0
+    assert stats.warm_start == True
+    assert hls_solver.getStats().n_iter == stats.n_iter
 
 if __name__ == '__main__':
     nose.run()
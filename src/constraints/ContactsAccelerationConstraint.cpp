@@ -2,30 +2,45 @@
 
 namespace wbc{
 
-    void ContactsAccelerationConstraint::update(RobotModelPtr robot_model) {
-        
-        const ActiveContacts& contacts = robot_model->getActiveContacts();
+    void ContactsAccelerationConstraint::createStructure(RobotModelPtr robot_model) {
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
-        uint nc = contacts.size();
+        uint nc = robot_model->getActiveContacts().size();
 
         uint nv = reduced ? (nj + nc*6) : (nj + na + nc*6);
 
-        A_mtx.resize(nc*6, nv);
-        b_vec.resize(nc*6);
+        // Only the acceleration columns are non-zero, they are overwritten in every update
+        if(sparse){
+            std::vector<int> first_row(nv, 0), n_rows(nv, 0);
+            std::fill(n_rows.begin(), n_rows.begin() + nj, nc*6);
+            setSparsePattern(nc*6, nv, first_row, n_rows);
+        }
+        else
+            A_mtx.setZero(nc*6, nv);
+        b_vec.setZero(nc*6);
+    }
 
-        A_mtx.setZero();
-        b_vec.setZero();
+    void ContactsAccelerationConstraint::updateValues(RobotModelPtr robot_model) {
 
-        for(int i = 0; i < contacts.size(); i++){
-            const base::Acceleration& a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contacts.names[i]);
-            base::Vector6d acc;
-            acc.segment(0,3) = a.linear;
-            acc.segment(3,3) = a.angular;
+        const std::vector<ChainId>& contact_chains = robot_model->contactChainIds();
+        const ActiveContacts& contacts = robot_model->getActiveContacts();
+        uint nj = robot_model->noOfJoints();
 
-            b_vec.segment(i*6, 6) = -acc;
-            A_mtx.block(i*6,  0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contacts.names[i]);
+        // Inactive contacts are allowed to move, their rows are zero. This way, switching contacts does not change the structure of the constraint. Solvers
+        // that cannot handle empty equality rows drop them, see ConstraintRowSelection::updateEqualities()
+        for(uint i = 0; i < contact_chains.size(); i++){
+            const double active = contacts[i].active;
+            const base::Acceleration& a = robot_model->spatialAccelerationBias(contact_chains[i]);
+            b_map.segment<3>(i*6)   = -active * a.linear;
+            b_map.segment<3>(i*6+3) = -active * a.angular;
+            const base::MatrixXd& jac = robot_model->spaceJacobian(contact_chains[i]);
+            if(sparse){
+                for(uint j = 0; j < nj; j++)
+                    sparseCol(j).segment<6>(i*6) = active * jac.col(j);
+            }
+            else
+                A_map.block(i*6, 0, 6, nj) = active * jac;
         }
     }
 
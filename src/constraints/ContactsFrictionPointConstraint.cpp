@@ -2,9 +2,33 @@
 
 namespace wbc {
 
-void ContactsFrictionPointConstraint::update(RobotModelPtr robot_model){
+// We assume that contact surface normal is always world_z, TODO: Make this dynamically (re-)configurable
+static const uint row_skip = 4;
+static const uint col_skip = 3;
 
-    const bool use_torques = false;
+/** Linearized friction cone of a point contact, applied to the contact force*/
+static Eigen::Matrix<double,row_skip,col_skip> frictionCone(const ActiveContact& contact){
+    double mu=contact.mu;
+
+    Eigen::Matrix<double,row_skip,col_skip> a;
+    a << 1,0,-mu,
+         0,1,-mu,
+         1,0, mu,
+         0,1, mu;
+    return a;
+}
+
+/** Constant bounds of the friction cone constraint*/
+static void frictionConeBounds(uint nc, base::VectorXd& lb, base::VectorXd& ub){
+    lb.resize(nc*row_skip);
+    ub.resize(nc*row_skip);
+    for(uint i = 0; i < nc; i++){
+        lb.segment<row_skip>(i*row_skip) << -QP_INFINITE_BOUND,-QP_INFINITE_BOUND,0,0;
+        ub.segment<row_skip>(i*row_skip) << 0,0,QP_INFINITE_BOUND,QP_INFINITE_BOUND;
+    }
+}
+
+void ContactsFrictionPointConstraint::createStructure(RobotModelPtr robot_model){
 
     const auto& contacts = robot_model->getActiveContacts();
 
@@ -13,38 +37,34 @@ void ContactsFrictionPointConstraint::update(RobotModelPtr robot_model){
     uint nc = contacts.size();
 
     uint nv = reduced ? nj + 6*nc : nj + na + 6*nc;
-
-    const uint row_skip = use_torques ? 8 : 4;
-    const uint col_skip = use_torques ? 6 : 3;
-
-    A_mtx.resize(nc*row_skip, nv);
-    lb_vec.resize(nc*row_skip);
-    ub_vec.resize(nc*row_skip);
-
-    A_mtx.setZero();
-    ub_vec.setZero();
-    lb_vec.setZero();
-
     uint start_idx = reduced ? nj : nj + na;
 
-    for(uint i = 0; i < contacts.size(); i++){
-
-        double mu=contacts[i].mu;
-
-        // We assume that contact surface normal is always world_z, TODO: Make this dynamically (re-)configurable
-        Eigen::MatrixXd a(row_skip,col_skip);
-        a << 1,0,-mu,
-             0,1,-mu,
-             1,0, mu,
-             0,1, mu;
-        Eigen::VectorXd lb(row_skip), ub(row_skip);
-        lb << -1e10,-1e10,0,0;
-        ub << 0,0,1e10,1e10;
-
-        lb_vec.segment(i*row_skip,row_skip) = lb;
-        ub_vec.segment(i*row_skip,row_skip) = ub;
-        A_mtx.block<row_skip,col_skip>(i*row_skip,start_idx+i*6) = a;
+    // The friction cones only depend on the contact parameters, so the complete constraint is constant. Only the 4x3 block of each contact force is non-zero
+    if(sparse){
+        std::vector<int> first_row(nv, 0), n_rows(nv, 0);
+        for(uint i = 0; i < nc; i++){
+            for(uint j = 0; j < col_skip; j++){
+                first_row[start_idx+i*6+j] = i*row_skip;
+                n_rows[start_idx+i*6+j] = row_skip;
+            }
+        }
+        setSparsePattern(nc*row_skip, nv, first_row, n_rows);
+        for(uint i = 0; i < nc; i++){
+            const Eigen::Matrix<double,row_skip,col_skip> a = frictionCone(contacts[i]);
+            for(uint j = 0; j < col_skip; j++)
+                sparseCol(start_idx+i*6+j) = a.col(j);
+        }
+    }
+    else{
+        A_mtx.setZero(nc*row_skip, nv);
+        for(uint i = 0; i < nc; i++)
+            A_mtx.block<row_skip,col_skip>(i*row_skip,start_idx+i*6) = frictionCone(contacts[i]);
     }
+    frictionConeBounds(nc, lb_vec, ub_vec);
+}
+
+void ContactsFrictionPointConstraint::updateValues(RobotModelPtr robot_model){
+    // Constant constraint, see createStructure()
 }
 
 }
@@ -12,7 +12,10 @@ public:
 
     virtual ~ContactsFrictionPointConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
+protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
 
 private:
     bool reduced; // if torques are removed from the qp formulation or not
@@ -2,7 +2,34 @@
 
 namespace wbc {
 
-void ContactsFrictionSurfaceConstraint::update(RobotModelPtr robot_model){
+static const uint row_skip = 16, col_skip = 6;
+
+/** Linearized friction cone of a surface contact, applied to the contact wrench (force, torque)*/
+static Eigen::Matrix<double,row_skip,col_skip> frictionCone(const ActiveContact& contact){
+    double mu=contact.mu;
+    double wx = contact.wx, wy = contact.wy;
+
+    Eigen::Matrix<double,row_skip,col_skip> a;
+    a << -1,  0, -mu,  0,  0, 0,
+          1,  0, -mu,  0,  0, 0,
+          0, -1, -mu,  0,  0, 0,
+          0,  1, -mu,  0,  0, 0,
+          0,  0, -wy, -1,  0, 0,
+          0,  0, -wy,  1,  0, 0,
+          0,  0, -wx,  0, -1, 0,
+          0,  0, -wx,  0,  1, 0,
+          -wy, -wx, -(wx+wy)*mu,  mu,  mu, -1,
+          -wy,  wx, -(wx+wy)*mu,  mu, -mu, -1,
+           wy, -wx, -(wx+wy)*mu, -mu,  mu, -1,
+           wy,  wx, -(wx+wy)*mu, -mu, -mu, -1,
+           wy,  wx, -(wx+wy)*mu,  mu,  mu,  1,
+           wy, -wx, -(wx+wy)*mu,  mu, -mu,  1,
+          -wy,  wx, -(wx+wy)*mu, -mu,  mu,  1,
+          -wy, -wx, -(wx+wy)*mu, -mu, -mu,  1;
+    return a;
+}
+
+void ContactsFrictionSurfaceConstraint::createStructure(RobotModelPtr robot_model){
 
     const auto& contacts = robot_model->getActiveContacts();
 
@@ -11,49 +38,35 @@ void ContactsFrictionSurfaceConstraint::update(RobotModelPtr robot_model){
     uint nc = contacts.size();
 
     uint nv = reduced ? nj + 6*nc : nj + na + 6*nc;
-
-    const uint row_skip = 16, col_skip = 6;
-
-    A_mtx.resize(nc*row_skip, nv);
-    lb_vec.resize(nc*row_skip);
-    ub_vec.resize(nc*row_skip);
-
-    A_mtx.setZero();
-    ub_vec.setZero();
-    lb_vec.setZero();
-
     uint start_idx = reduced ? nj : nj + na;
 
-    for(uint i = 0; i < nc; i++){
-        double mu=contacts[i].mu;
-        double wx = contacts[i].wx, wy = contacts[i].wy;
-
-        Eigen::MatrixXd a(row_skip,col_skip);
-        a << -1,  0, -mu,  0,  0, 0,
-              1,  0, -mu,  0,  0, 0,
-              0, -1, -mu,  0,  0, 0,
-              0,  1, -mu,  0,  0, 0,
-              0,  0, -wy, -1,  0, 0,
-              0,  0, -wy,  1,  0, 0,
-              0,  0, -wx,  0, -1, 0,
-              0,  0, -wx,  0,  1, 0,
-              -wy, -wx, -(wx+wy)*mu,  mu,  mu, -1,
-              -wy,  wx, -(wx+wy)*mu,  mu, -mu, -1,
-               wy, -wx, -(wx+wy)*mu, -mu,  mu, -1,
-               wy,  wx, -(wx+wy)*mu, -mu, -mu, -1,
-               wy,  wx, -(wx+wy)*mu,  mu,  mu,  1,
-               wy, -wx, -(wx+wy)*mu,  mu, -mu,  1,
-              -wy,  wx, -(wx+wy)*mu, -mu,  mu,  1,
-              -wy, -wx, -(wx+wy)*mu, -mu, -mu,  1;
-
-        Eigen::VectorXd lb(row_skip), ub(row_skip);
-        lb.setConstant(-1e10);
-        ub.setZero();
-
-        lb_vec.segment(i*row_skip,row_skip) = lb;
-        ub_vec.segment(i*row_skip,row_skip) = ub;
-        A_mtx.block<row_skip,col_skip>(i*row_skip,start_idx+i*6) = a;
+    // The friction cones only depend on the contact parameters, so the complete constraint is constant. Only the 16x6 block of each contact wrench is non-zero
+    if(sparse){
+        std::vector<int> first_row(nv, 0), n_rows(nv, 0);
+        for(uint i = 0; i < nc; i++){
+            for(uint j = 0; j < col_skip; j++){
+                first_row[start_idx+i*6+j] = i*row_skip;
+                n_rows[start_idx+i*6+j] = row_skip;
+            }
+        }
+        setSparsePattern(nc*row_skip, nv, first_row, n_rows);
+        for(uint i = 0; i < nc; i++){
+            const Eigen::Matrix<double,row_skip,col_skip> a = frictionCone(contacts[i]);
+            for(uint j = 0; j < col_skip; j++)
+                sparseCol(start_idx+i*6+j) = a.col(j);
+        }
+    }
+    else{
+        A_mtx.setZero(nc*row_skip, nv);
+        for(uint i = 0; i < nc; i++)
+            A_mtx.block<row_skip,col_skip>(i*row_skip,start_idx+i*6) = frictionCone(contacts[i]);
     }
+    lb_vec.setConstant(nc*row_skip, -QP_INFINITE_BOUND);
+    ub_vec.setZero(nc*row_skip);
+}
+
+void ContactsFrictionSurfaceConstraint::updateValues(RobotModelPtr robot_model){
+    // Constant constraint, see createStructure()
 }
 
 }
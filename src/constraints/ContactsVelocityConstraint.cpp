@@ -2,19 +2,26 @@
 
 namespace wbc{
 
-    void ContactsVelocityConstraint::update(RobotModelPtr robot_model) {
-        
+    void ContactsVelocityConstraint::createStructure(RobotModelPtr robot_model) {
+
+        uint nj = robot_model->noOfJoints();
+        uint nc = robot_model->getActiveContacts().size();
+
+        // The contact Jacobians fill the complete matrix and are overwritten in every update
+        A_mtx.setZero(nc*6, nj);
+        b_vec.setZero(nc*6);
+    }
+
+    void ContactsVelocityConstraint::updateValues(RobotModelPtr robot_model) {
+
         const ActiveContacts& contacts = robot_model->getActiveContacts();
+        const std::vector<ChainId>& contact_chains = robot_model->contactChainIds();
 
         uint nj = robot_model->noOfJoints();
         uint nc = contacts.size();
 
-        A_mtx.resize(nc*6, nj);
-        b_vec.resize(nc*6);
-        b_vec.setZero();
-
-        for(int i = 0; i < nc; ++i)
-            A_mtx.block(i*6, 0, 6, nj) = contacts[i].active * robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]);
+        for(uint i = 0; i < nc; ++i)
+            A_map.block(i*6, 0, 6, nj) = contacts[i].active * robot_model->bodyJacobian(contact_chains[i]);
     }
 
 
@@ -21,7 +21,13 @@ public:
 
     virtual ~ContactsVelocityConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
+    /** @brief Only uses the chain id based queries of the robot model, see Constraint::concurrentUpdate()*/
+    virtual bool concurrentUpdate() const override {return true;}
+
+protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
 
 };
 typedef std::shared_ptr<ContactsVelocityConstraint> ContactsVelocityConstraintPtr;
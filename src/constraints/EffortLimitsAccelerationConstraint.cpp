@@ -2,36 +2,39 @@
 
 namespace wbc{
 
-    void EffortLimitsAccelerationConstraint::update(RobotModelPtr robot_model) {
-        
-        const auto& contacts = robot_model->getActiveContacts();
+    void EffortLimitsAccelerationConstraint::createStructure(RobotModelPtr robot_model) {
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
-        uint nc = contacts.size();
+        uint nc = robot_model->getActiveContacts().size();
 
-        lb_vec.resize(na);
-        ub_vec.resize(na);
+        // All non-zero entries are overwritten in every update
+        A_mtx.setZero(na, nj+6*nc);
+        lb_vec.setZero(na);
+        ub_vec.setZero(na);
+    }
+
+    void EffortLimitsAccelerationConstraint::updateValues(RobotModelPtr robot_model) {
+
+        const std::vector<ChainId>& contact_chains = robot_model->contactChainIds();
 
-        lb_vec.setConstant(-10000);
-        ub_vec.setConstant(+10000);
-        
-        A_mtx.resize(na, nj+6*nc);
-        A_mtx.setZero();
+        uint nj = robot_model->noOfJoints();
+        uint na = robot_model->noOfActuatedJoints();
+        uint nc = contact_chains.size();
 
         //! NOTE! -> not considering selection matrix
 
-        A_mtx.block(0,0,na,nj) = robot_model->jointSpaceInertiaMatrix().bottomRows(na);
+        A_map.block(0,0,na,nj) = robot_model->jointSpaceInertiaMatrix().bottomRows(na);
         for(uint i=0; i < nc; ++i)
-            A_mtx.block(0,nj+i*6,na,6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose().bottomRows(na);
+            A_map.block(0,nj+i*6,na,6) = -robot_model->bodyJacobian(contact_chains[i]).transpose().bottomRows(na);
 
         // enforce joint effort limits (only if torques are part of the optimization problem)
-        Eigen::VectorXd b = robot_model->biasForces().tail(na);
+        const base::VectorXd& h = robot_model->biasForces();
 
         for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
             const std::string& name = robot_model->actuatedJointNames()[i];
-            lb_vec(i) = robot_model->jointLimits()[name].min.effort - b(i);
-            ub_vec(i) = robot_model->jointLimits()[name].max.effort - b(i);
+            lb_map(i) = robot_model->jointLimits()[name].min.effort - h(nj-na+i);
+            ub_map(i) = robot_model->jointLimits()[name].max.effort - h(nj-na+i);
         }
     }
 
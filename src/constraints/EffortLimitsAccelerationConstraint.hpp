@@ -25,7 +25,10 @@ public:
 
     virtual ~EffortLimitsAccelerationConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
+protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
 
 };
 typedef std::shared_ptr<EffortLimitsAccelerationConstraint> EffortLimitsAccelerationConstraintPtr;
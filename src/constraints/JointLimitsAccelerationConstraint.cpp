@@ -1,4 +1,5 @@
 #include "JointLimitsAccelerationConstraint.hpp"
+#include <algorithm>
 
 namespace wbc{
 
@@ -10,68 +11,91 @@ namespace wbc{
 
     }
 
-    void JointLimitsAccelerationConstraint::update(RobotModelPtr robot_model) {
-        
+    void JointLimitsAccelerationConstraint::createStructure(RobotModelPtr robot_model) {
+
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
         uint nc = robot_model->getActiveContacts().size();
         uint nv = reduced ? nj+6*nc : nj+na+6*nc;
 
-        lb_vec.resize(nv);
-        ub_vec.resize(nv);
-        lb_vec.setConstant(-10000);
-        ub_vec.setConstant(+10000);
+        // Entries of the floating base joints are constant, the entries of the actuated joints and contact wrenches are overwritten in every update
+        lb_vec.setConstant(nv, -QP_INFINITE_BOUND);
+        ub_vec.setConstant(nv, +QP_INFINITE_BOUND);
+
+        // Resolve the joint indices and limits once, so that no name lookups are required in updateValues()
+        const std::vector<std::string>& state_names = robot_model->jointState().names;
+        joint_idx.resize(na);
+        state_idx.resize(na);
+        limits.resize(na);
+        for(uint i = 0; i < na; i++){
+            const std::string& name = robot_model->actuatedJointNames()[i];
+            joint_idx[i] = robot_model->jointIndex(name);
+            state_idx[i] = std::find(state_names.begin(), state_names.end(), name) - state_names.begin();
+            if(state_idx[i] >= state_names.size())
+                throw std::runtime_error("JointLimitsAccelerationConstraint: Joint " + name + " is not in the joint state of the robot model");
+            limits[i] = robot_model->jointLimits()[name];
+
+            // Acceleration limits might not be defined in URDFs
+            if(std::isnan(limits[i].min.acceleration))
+                limits[i].min.acceleration = -QP_INFINITE_BOUND;
+            if(std::isnan(limits[i].max.acceleration))
+                limits[i].max.acceleration = +QP_INFINITE_BOUND;
+        }
+
+        // enforce joint effort limits (only if torques are part of the optimization problem)
+        // otherwise use EffortLimitsAccelerationConstraint
+        if(reduced)
+            return;
+
+        for(uint i = 0; i < na; i++){
+            lb_vec(i+nj) = limits[i].min.effort;
+            ub_vec(i+nj) = limits[i].max.effort;
+        }
+    }
+
+    void JointLimitsAccelerationConstraint::updateValues(RobotModelPtr robot_model) {
 
         bool check_accelerations = true;
         bool check_velocities = true;
         bool check_positions = true;
         
-        auto state = robot_model->jointState(robot_model->actuatedJointNames());
-
-        // check if a value is not nan otherwise return a substiture value
-        // used for acceleration limits since they might not be define in URDFs
-        auto check_number = [](double val, double sub){
-            if(std::isnan(val))
-                return sub;
-            return val;
-        };
+        const base::samples::Joints& state = robot_model->jointState();
+        if(state.time.isNull())
+            throw std::runtime_error("JointLimitsAccelerationConstraint: You have to call RobotModel::update() before updating the constraint");
 
         // joint acceleration, velocity and position limits
-        for(auto n : robot_model->actuatedJointNames()){
-            size_t idx = robot_model->jointIndex(n);
-            const base::JointLimitRange &range = robot_model->jointLimits().getElementByName(n);
+        for(uint i = 0; i < joint_idx.size(); i++){
+            const uint idx = joint_idx[i];
+            const base::JointLimitRange &range = limits[i];
 
-            double pos = state[n].position;
-            double vel = state[n].speed;
+            double pos = state.elements[state_idx[i]].position;
+            double vel = state.elements[state_idx[i]].speed;
 
             // enforce joint acceleration and velocity limit
             if(check_accelerations)
             {
-                lb_vec(idx) = check_number(range.min.acceleration, -10000);
-                ub_vec(idx) = check_number(range.max.acceleration, +10000);
+                lb_map(idx) = range.min.acceleration;
+                ub_map(idx) = range.max.acceleration;
             }
             if(check_velocities)
             {
-                lb_vec(idx) = std::max(lb_vec(idx), (range.min.speed - vel) / dt);
-                ub_vec(idx) = std::min(ub_vec(idx), (range.max.speed - vel) / dt);
+                lb_map(idx) = std::max(lb_map(idx), (range.min.speed - vel) / dt);
+                ub_map(idx) = std::min(ub_map(idx), (range.max.speed - vel) / dt);
             }
             // enforce joint position limit
             if(check_positions)
             {
-                lb_vec(idx) = std::max(lb_vec(idx), 2*(range.min.position - pos - dt*vel) / (dt*dt));
-                ub_vec(idx) = std::min(ub_vec(idx), 2*(range.max.position - pos - dt*vel) / (dt*dt));
+                lb_map(idx) = std::max(lb_map(idx), 2*(range.min.position - pos - dt*vel) / (dt*dt));
+                ub_map(idx) = std::min(ub_map(idx), 2*(range.max.position - pos - dt*vel) / (dt*dt));
             }
         }
 
-        // enforce joint effort limits (only if torques are part of the optimization problem)
-        // otherwise use EffortLimitsAccelerationConstraint
-        if(reduced)
-            return;
-
-        for(int i = 0; i < robot_model->noOfActuatedJoints(); i++){
-            const std::string& name = robot_model->actuatedJointNames()[i];
-            lb_vec(i+nj) = robot_model->jointLimits()[name].min.effort;
-            ub_vec(i+nj) = robot_model->jointLimits()[name].max.effort;
+        // Pin the wrenches of inactive contacts to zero. This way, switching contacts does not change the structure of the QP
+        const ActiveContacts& contacts = robot_model->getActiveContacts();
+        uint start_idx = reduced ? robot_model->noOfJoints() : robot_model->noOfJoints() + robot_model->noOfActuatedJoints();
+        for(uint i = 0; i < contacts.size(); i++){
+            lb_map.segment<6>(start_idx+i*6).setConstant(contacts[i].active ? -QP_INFINITE_BOUND : 0);
+            ub_map.segment<6>(start_idx+i*6).setConstant(contacts[i].active ? +QP_INFINITE_BOUND : 0);
         }
     }
 
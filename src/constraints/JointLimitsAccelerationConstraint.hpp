@@ -24,15 +24,22 @@ public:
 
     virtual ~JointLimitsAccelerationConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
-
 protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
+
 
     /** Control timestep: used to integrate and differentiate velocities */
     double dt;
 
     bool reduced;
 
+    /** Joint data resolved in createStructure(), in the order of RobotModel::actuatedJointNames()*/
+    std::vector<uint> joint_idx;                    /** Index in RobotModel::jointNames()*/
+    std::vector<uint> state_idx;                    /** Index in RobotModel::jointState()*/
+    std::vector<base::JointLimitRange> limits;      /** Joint limits. Undefined acceleration limits are replaced by infinite bounds*/
+
 };
 typedef std::shared_ptr<JointLimitsAccelerationConstraint> JointLimitsAccelerationConstraintPtr;
 
@@ -9,28 +9,26 @@ namespace wbc{
 
     }
 
-    void JointLimitsVelocityConstraint::update(RobotModelPtr robot_model) {
+    void JointLimitsVelocityConstraint::createStructure(RobotModelPtr robot_model) {
 
-        uint nj = robot_model->noOfJoints();
+        // vars are velocities. Entries of the floating base joints are constant, the entries of the actuated joints are overwritten in every update
+        lb_vec.setConstant(robot_model->noOfJoints(), -QP_INFINITE_BOUND);
+        ub_vec.setConstant(robot_model->noOfJoints(), +QP_INFINITE_BOUND);
+    }
 
-        // vars are velocities
-        lb_vec.resize(nj);
-        ub_vec.resize(nj);
+    void JointLimitsVelocityConstraint::updateValues(RobotModelPtr robot_model) {
 
-        lb_vec.setConstant(-999999);
-        ub_vec.setConstant(+999999);
-        
-        auto state = robot_model->jointState(robot_model->actuatedJointNames());
+        const base::samples::Joints& state = robot_model->jointState(robot_model->actuatedJointNames());
 
-        for(auto n : robot_model->actuatedJointNames()){
+        for(const std::string& n : robot_model->actuatedJointNames()){
             size_t idx = robot_model->jointIndex(n);
             const base::JointLimitRange &range = robot_model->jointLimits().getElementByName(n);
 
             // enforce joint velocity and position limits
-            lb_vec(idx) = std::max(static_cast<double>(range.min.speed), (range.min.position - state[n].position) / dt);
-            ub_vec(idx) = std::min(static_cast<double>(range.max.speed), (range.max.position - state[n].position) / dt);
-            lb_vec(idx) = std::min(lb_vec(idx), 0.0); // Why is this required?
-            ub_vec(idx) = std::max(ub_vec(idx), 0.0);
+            lb_map(idx) = std::max(static_cast<double>(range.min.speed), (range.min.position - state[n].position) / dt);
+            ub_map(idx) = std::min(static_cast<double>(range.max.speed), (range.max.position - state[n].position) / dt);
+            lb_map(idx) = std::min(lb_map(idx), 0.0); // Why is this required?
+            ub_map(idx) = std::max(ub_map(idx), 0.0);
         }
     }
 
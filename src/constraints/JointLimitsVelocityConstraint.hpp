@@ -23,9 +23,11 @@ public:
 
     virtual ~JointLimitsVelocityConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
-
 protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
+
 
     /** Control timestep: used to integrate and differentiate velocities */
     double dt;
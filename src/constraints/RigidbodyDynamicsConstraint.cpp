@@ -2,42 +2,76 @@
 
 namespace wbc{
 
-    void RigidbodyDynamicsConstraint::update(RobotModelPtr robot_model) {
-        
-        const ActiveContacts& contacts = robot_model->getActiveContacts();
+    void RigidbodyDynamicsConstraint::createStructure(RobotModelPtr robot_model) {
 
         uint nj = robot_model->noOfJoints();
         uint na = robot_model->noOfActuatedJoints();
-        uint nc = contacts.size();
+        uint nc = robot_model->getActiveContacts().size();
 
         uint nv = reduced ? (nj + nc*6) : (nj + na + nc*6);
+        uint nr = reduced ? 6 : nj; // no torques in reduced qp, consider only floating base dynamics
 
-        if(reduced) // no torques in qp, consider only floating base dynamics
-        {
-            A_mtx.resize(6, nv);
-            A_mtx.setZero();
+        // The selection matrix is constant, so the torque columns (-S^T) are only written here. Inertia matrix and contact Jacobians are overwritten in every update
+        const base::MatrixXd& S = robot_model->selectionMatrix();
+        if(sparse){
+            // The columns of the inertia matrix and the contact Jacobians are dense, the columns of the (transposed) selection matrix
+            // only contain the entries between the first and last non-zero
+            std::vector<int> first_row(nv, 0), n_rows(nv, nr);
+            if(!reduced){
+                for(uint i = 0; i < na; i++){
+                    int first = 0, last = -1;
+                    for(uint j = 0; j < nj; j++){
+                        if(S(i,j) != 0){
+                            if(last < 0)
+                                first = j;
+                            last = j;
+                        }
+                    }
+                    first_row[nj+i] = first;
+                    n_rows[nj+i] = last - first + 1;
+                }
+            }
+            setSparsePattern(nr, nv, first_row, n_rows);
+            if(!reduced){
+                for(uint i = 0; i < na; i++)
+                    sparseCol(nj+i) = -S.row(i).segment(first_row[nj+i], n_rows[nj+i]).transpose();
+            }
+        }
+        else{
+            A_mtx.setZero(nr, nv);
+            if(!reduced)
+                A_mtx.block(0, nj, nj, na) = -S.transpose();
+        }
+        b_vec.setZero(nr);
+    }
 
-            b_vec.resize(6);
+    void RigidbodyDynamicsConstraint::updateValues(RobotModelPtr robot_model) {
 
-            A_mtx.block(0,  0, 6, nj) =  robot_model->jointSpaceInertiaMatrix().topRows<6>();
-            for(int i = 0; i < contacts.size(); i++)
-                A_mtx.block(0, nj+i*6, 6, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose().topRows<6>();
-            b_vec = -robot_model->biasForces().topRows<6>();
+        const std::vector<ChainId>& contact_chains = robot_model->contactChainIds();
+
+        uint nj = robot_model->noOfJoints();
+        uint na = robot_model->noOfActuatedJoints();
+        uint nr = reduced ? 6 : nj;
+        uint start_idx = reduced ? nj : nj + na;
+
+        const base::MatrixXd& M = robot_model->jointSpaceInertiaMatrix();
+        if(sparse){
+            for(uint j = 0; j < nj; j++)
+                sparseCol(j) = M.col(j).head(nr);
         }
         else
-        {
-            A_mtx.resize(nj, nv);
-            A_mtx.setZero();
-            
-            b_vec.resize(nj);
-
-            A_mtx.block(0,  0, nj, nj) =  robot_model->jointSpaceInertiaMatrix();
-            A_mtx.block(0, nj, nj, na) = -robot_model->selectionMatrix().transpose();
-            for(int i = 0; i < contacts.size(); i++)
-                A_mtx.block(0, nj+na+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[i]).transpose();
-            b_vec = -robot_model->biasForces();
-        }
+            A_map.leftCols(nj) = M.topRows(nr);
 
+        for(uint i = 0; i < contact_chains.size(); i++){
+            const base::MatrixXd& jac = robot_model->bodyJacobian(contact_chains[i]);
+            if(sparse){
+                for(uint j = 0; j < 6; j++)
+                    sparseCol(start_idx+i*6+j) = -jac.row(j).head(nr).transpose();
+            }
+            else
+                A_map.block(0, start_idx+i*6, nr, 6) = -jac.leftCols(nr).transpose();
+        }
+        b_map = -robot_model->biasForces().head(nr);
     }
 
 
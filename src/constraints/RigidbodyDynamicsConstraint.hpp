@@ -22,9 +22,11 @@ public:
 
     virtual ~RigidbodyDynamicsConstraint() = default;
 
-    virtual void update(RobotModelPtr robot_model) override;
-
 protected:
+    virtual void createStructure(RobotModelPtr robot_model) override;
+
+    virtual void updateValues(RobotModelPtr robot_model) override;
+
 
     bool reduced;
 };
@@ -1,27 +1,43 @@
 #include "Constraint.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/Float.hpp>
+#include <algorithm>
 
 namespace wbc{
 
-Constraint::Constraint(){
+Constraint::Constraint() :
+    Constraint(Constraint::equality){
 
 }
 
 Constraint::Constraint(Type type)
-    : c_type(type)
+    : c_type(type),
+      sparse(false),
+      A_map(nullptr, 0, 0, Eigen::OuterStride<>(0)),
+      b_map(nullptr, 0),
+      lb_map(nullptr, 0),
+      ub_map(nullptr, 0),
+      bound_qp(nullptr),
+      sparse_values(nullptr),
+      dense_fallback(false),
+      structure_stamp(0),
+      has_structure(false)
 {
- 
+
 }
 
 Constraint::Type Constraint::type() {
     return c_type;
-} 
+}
 
 const base::MatrixXd& Constraint::A() {
     return A_mtx;
 }
 
+const SparseMatrixXd& Constraint::As() {
+    return A_sparse;
+}
+
 const base::VectorXd& Constraint::b() {
     return b_vec;
 }
@@ -35,14 +51,147 @@ const base::VectorXd& Constraint::ub() {
 }
 
 uint Constraint::size() {
+    // Use the vectors here, since the constraint matrix is either given in dense or in sparse format
     switch(c_type) {
         case Constraint::equality:
+            return b_vec.rows();
         case Constraint::inequality:
-            return A_mtx.rows();
         case Constraint::bounds:
             return lb_vec.rows();
     }
     return 0;
 }
 
+bool Constraint::structureChanged(RobotModelPtr robot_model, bool _sparse) const{
+    return !has_structure || structure_stamp != robot_model->structureCounter() || sparse != _sparse;
+}
+
+void Constraint::updateStructure(RobotModelPtr robot_model, bool _sparse){
+    sparse = _sparse;
+
+    // setSparsePattern() resets the fallback, so it is only active if the derived class did not create a sparse pattern
+    dense_fallback = sparse && c_type != Constraint::bounds;
+    A_sparse.resize(0,0);
+    createStructure(robot_model);
+
+    // Store all entries of the dense matrix, so that the sparsity pattern does not depend on the values
+    if(dense_fallback){
+        std::vector<int> first_row(A_mtx.cols(), 0), n_rows(A_mtx.cols(), A_mtx.rows());
+        setSparsePattern(A_mtx.rows(), A_mtx.cols(), first_row, n_rows);
+        dense_fallback = true;
+        Eigen::Map<base::MatrixXd>(A_sparse.valuePtr(), A_mtx.rows(), A_mtx.cols()) = A_mtx;
+    }
+
+    unbind();
+    structure_stamp = robot_model->structureCounter();
+    has_structure = true;
+}
+
+void Constraint::update(RobotModelPtr robot_model){
+    if(!has_structure){
+        LOG_ERROR("Constraint::update: Structure of the constraint has not been created. Call updateStructure() first");
+        throw std::runtime_error("Constraint::update: Missing structure");
+    }
+
+    updateValues(robot_model);
+
+    if(dense_fallback){
+        for(int j = 0; j < A_mtx.cols(); j++)
+            sparseCol(j) = A_mtx.col(j);
+    }
+}
+
+void Constraint::unbind(){
+    bound_qp = nullptr;
+    new (&A_map) MatrixMap(A_mtx.data(), A_mtx.rows(), A_mtx.cols(), Eigen::OuterStride<>(A_mtx.rows()));
+    new (&b_map) VectorMap(b_vec.data(), b_vec.size());
+    new (&lb_map) VectorMap(lb_vec.data(), lb_vec.size());
+    new (&ub_map) VectorMap(ub_vec.data(), ub_vec.size());
+    sparse_values = A_sparse.valuePtr();
+    sparse_outer.assign(A_sparse.outerIndexPtr(), A_sparse.outerIndexPtr() + A_sparse.cols());
+}
+
+void Constraint::bind(QuadraticProgram& qp, uint row_offset){
+
+    const uint n = size();
+
+    if(c_type == Constraint::bounds){
+        if(!qp.bounded || qp.lower_x.size() != n || qp.upper_x.size() != n){
+            LOG_ERROR("Constraint::bind: Bounds constraint has size %i, but QP has %i variables (bounded: %i)", n, qp.nq, qp.bounded);
+            throw std::invalid_argument("Constraint::bind: Invalid QP size");
+        }
+        qp.lower_x = lb_vec;
+        qp.upper_x = ub_vec;
+        new (&lb_map) VectorMap(qp.lower_x.data(), n);
+        new (&ub_map) VectorMap(qp.upper_x.data(), n);
+        bound_qp = &qp;
+        return;
+    }
+
+    const bool eq = c_type == Constraint::equality;
+    const int n_rows = eq ? qp.neq : qp.nin;
+    const int n_cols = sparse ? A_sparse.cols() : A_mtx.cols();
+    if(row_offset + n > (uint)n_rows || n_cols != qp.nq || sparse != qp.sparse){
+        LOG_ERROR("Constraint::bind: Constraint with %i rows at row %i does not fit into the QP. QP has %i constraint rows and %i variables",
+                  n, row_offset, n_rows, qp.nq);
+        throw std::invalid_argument("Constraint::bind: Invalid QP size");
+    }
+
+    if(sparse){
+        // The entries of each column of the constraint are contiguous within the corresponding column of the stacked matrix
+        SparseMatrixXd& mat = eq ? qp.A_sparse : qp.C_sparse;
+        const int* outer = mat.outerIndexPtr();
+        const int* inner = mat.innerIndexPtr();
+        const int* local_outer = A_sparse.outerIndexPtr();
+        const int* local_inner = A_sparse.innerIndexPtr();
+        for(int j = 0; j < n_cols; j++){
+            const int start = std::lower_bound(inner + outer[j], inner + outer[j+1], (int)row_offset) - inner;
+            const int nnz = local_outer[j+1] - local_outer[j];
+            bool valid = start + nnz <= outer[j+1];
+            for(int k = 0; k < nnz && valid; k++)
+                valid = inner[start+k] == local_inner[local_outer[j]+k] + (int)row_offset;
+            if(!valid){
+                LOG_ERROR("Constraint::bind: Sparsity pattern of the QP does not match the sparsity pattern of the constraint in column %i", j);
+                throw std::invalid_argument("Constraint::bind: Invalid sparsity pattern");
+            }
+            sparse_outer[j] = start;
+        }
+        sparse_values = mat.valuePtr();
+        for(int j = 0; j < n_cols; j++)
+            sparseCol(j) = VectorMap(A_sparse.valuePtr() + local_outer[j], local_outer[j+1] - local_outer[j]);
+    }
+    else{
+        base::MatrixXd& mat = eq ? qp.A : qp.C;
+        mat.middleRows(row_offset, n) = A_mtx;
+        new (&A_map) MatrixMap(mat.data() + row_offset, n, n_cols, Eigen::OuterStride<>(mat.rows()));
+    }
+
+    if(eq){
+        qp.b.segment(row_offset, n) = b_vec;
+        new (&b_map) VectorMap(qp.b.data() + row_offset, n);
+    }
+    else{
+        qp.lower_y.segment(row_offset, n) = lb_vec;
+        qp.upper_y.segment(row_offset, n) = ub_vec;
+        new (&lb_map) VectorMap(qp.lower_y.data() + row_offset, n);
+        new (&ub_map) VectorMap(qp.upper_y.data() + row_offset, n);
+    }
+    bound_qp = &qp;
+}
+
+void Constraint::setSparsePattern(uint rows, uint cols, const std::vector<int>& first_row, const std::vector<int>& n_rows){
+    A_sparse.resize(rows, cols);
+    A_sparse.reserve(n_rows);
+    for(uint j = 0; j < cols; j++){
+        for(int i = 0; i < n_rows[j]; i++)
+            A_sparse.insert(first_row[j] + i, j) = 0;
+    }
+    A_sparse.makeCompressed();
+    dense_fallback = false;
+
+    // Write to the own storage, so that sparseCol() can be used to fill in the constant entries
+    sparse_values = A_sparse.valuePtr();
+    sparse_outer.assign(A_sparse.outerIndexPtr(), A_sparse.outerIndexPtr() + cols);
+}
+
 }// namespace wbc
@@ -2,6 +2,7 @@
 #define CONSTRAINT_HPP
 
 #include "RobotModel.hpp"
+#include "QuadraticProgram.hpp"
 #include <base/Eigen.hpp>
 #include <base/Time.hpp>
 #include <base/NamedVector.hpp>
@@ -15,6 +16,14 @@ namespace wbc{
  * equality Ax = b
  * inequality lb <= Ax <= ub
  * bounds lb <= x <= ub
+ *
+ * The update of a constraint is split into two phases:
+ *  - Structural phase (updateStructure()): Size, sparsity pattern and all constant entries. Only executed on configuration and if the structure changed, e.g.,
+ *    if the contact points change, see structureChanged().
+ *  - Numeric phase (update()): Only refresh the entries that depend on the robot state. If the constraint is bound to a QP (see bind()), these entries are
+ *    written directly to the QP storage, so that the scenes do not have to copy the constraint in every cycle.
+ *
+ * Equality and inequality constraints can also provide their constraint matrix in sparse format, see updateStructure().
  */
 class Constraint{
 public:
@@ -27,15 +36,42 @@ public:
 
     virtual ~Constraint() = default;
 
-    /** @brief Update constraint matrix and vectors, depending on the type. Abstract method. */
-    virtual void update(RobotModelPtr robot_model) = 0;
+    /** @brief True if updateStructure() has to be called, i.e., if it has never been called before, if the robot model has been reconfigured
+     *  or its contacts changed (see RobotModel::structureCounter()), or if the storage format changed*/
+    bool structureChanged(RobotModelPtr robot_model, bool sparse = false) const;
+
+    /** @brief Structural phase: Resize the constraint, create the sparsity pattern of As() (only if sparse is true) and write all constant entries.
+     *  Unbinds the constraint from any QP, see bind(). Constraints that do not create a sparse pattern store all entries in sparse format.*/
+    void updateStructure(RobotModelPtr robot_model, bool sparse = false);
+
+    /** @brief Numeric phase: Refresh all state dependent entries. Call updateStructure() first. If the constraint is bound to a QP, the entries are written to the QP,
+     *  otherwise to A()/As(), b(), lb() and ub()*/
+    void update(RobotModelPtr robot_model);
+
+    /**
+     * @brief Write the current constraint to the given QP and redirect all subsequent calls of update() to the QP storage. Depending on the type of the constraint,
+     * this will be A/b, C/lower_y/upper_y or lower_x/upper_x. The QP has to have the correct size and, in sparse format, the stacked sparsity pattern
+     * of all constraints (see Scene::stackSparseConstraints()). The binding is invalid once the QP is resized or updateStructure() is called.
+     * @param row_offset First row of the constraint in the QP. Ignored for bounds.
+     */
+    void bind(QuadraticProgram& qp, uint row_offset);
+
+    /** @brief True if updateValues() only uses robot model queries that may be called concurrently (see RobotModel::prepareConcurrentQueries()) and no other shared
+     *  data, so that the numeric phase of this constraint can run in parallel to other constraints and tasks. Default is false*/
+    virtual bool concurrentUpdate() const {return false;}
+
+    /** @brief Return the QP this constraint is bound to, nullptr if it is not bound*/
+    const QuadraticProgram* boundQP() const {return bound_qp;}
 
     /** @brief Return the type of this constraint */
-    Type type(); 
+    Type type();
 
-    /** @brief return constraint matrix A */
+    /** @brief return constraint matrix A. If the constraint is bound to a QP, this only contains the constant entries */
     const base::MatrixXd& A();
 
+    /** @brief return constraint matrix A in sparse format. Only valid if updateStructure() was called with sparse=true. If the constraint is bound to a QP, this only contains the constant entries */
+    const SparseMatrixXd& As();
+
     /** @brief return constraint vector b */
     const base::VectorXd& b();
 
@@ -49,6 +85,8 @@ public:
     uint size();
 
 protected:
+    typedef Eigen::Map<base::MatrixXd, 0, Eigen::OuterStride<> > MatrixMap;
+    typedef Eigen::Map<base::VectorXd> VectorMap;
 
     /** @brief Default constructor */
     Constraint();
@@ -56,11 +94,24 @@ protected:
     /** @brief Constructor. Initialiye the type of this constraint */
     Constraint(Type type);
 
+    /** @brief Structural phase, see updateStructure(). Resize A_mtx (or create the pattern of A_sparse if sparse is true) and the constraint vectors,
+     *  and write all constant entries. Entries that are written in updateValues() need not be initialized.*/
+    virtual void createStructure(RobotModelPtr robot_model) = 0;
+
+    /** @brief Numeric phase, see update(). Write the state dependent entries to A_map (or sparseCol() if sparse is true), b_map, lb_map and ub_map.*/
+    virtual void updateValues(RobotModelPtr robot_model) = 0;
+
     Type c_type;
 
+    /** Storage format of the constraint matrix, see updateStructure()*/
+    bool sparse;
+
     /** Constraint matrix */
     base::MatrixXd A_mtx;
 
+    /** Sparse constraint matrix, see updateStructure()*/
+    SparseMatrixXd A_sparse;
+
     /** Constraint vector */
     base::VectorXd b_vec;
 
@@ -70,6 +121,29 @@ protected:
     /** Constraint upper bound */
     base::VectorXd ub_vec;
 
+    /** Write targets of the numeric phase. Point to the own storage or to the QP storage, see bind()*/
+    MatrixMap A_map;
+    VectorMap b_map, lb_map, ub_map;
+
+    /** @brief Resize A_sparse and create its sparsity pattern: Column j stores the rows first_row[j] ... first_row[j]+n_rows[j]-1. All entries are set to zero */
+    void setSparsePattern(uint rows, uint cols, const std::vector<int>& first_row, const std::vector<int>& n_rows);
+
+    /** @brief Return the stored entries of column j of the sparse constraint matrix, see setSparsePattern(). Points to the QP storage, if the constraint is bound to a QP*/
+    VectorMap sparseCol(uint j){
+        const int* outer = A_sparse.outerIndexPtr();
+        return VectorMap(sparse_values + sparse_outer[j], outer[j+1] - outer[j]);
+    }
+
+private:
+    /** Redirect the write targets to the own storage*/
+    void unbind();
+
+    const QuadraticProgram* bound_qp;
+    double* sparse_values;           /** Value array of the sparse write target*/
+    std::vector<int> sparse_outer;   /** Start of each column of the constraint in sparse_values*/
+    bool dense_fallback;             /** Sparse format, but no pattern was created. Entries are written to A_mtx and copied to the sparse target in update()*/
+    uint structure_stamp;            /** RobotModel::structureCounter() at the last call of updateStructure()*/
+    bool has_structure;
 };
 typedef std::shared_ptr<Constraint> ConstraintPtr;
 
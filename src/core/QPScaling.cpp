@@ -0,0 +1,199 @@
+#include "QPScaling.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace wbc{
+
+/// Scaling factors are limited to [MIN_SCALING, MAX_SCALING], norms below MIN_SCALING (e.g. zero rows or columns) are not scaled at all, see OSQP
+static const double MIN_SCALING = 1e-4;
+static const double MAX_SCALING = 1e4;
+/// Stop the Ruiz equilibration if all row and column norms are within this tolerance of one
+static const double RUIZ_TOL = 1e-3;
+
+static double limitNorm(double norm){
+    if(norm < MIN_SCALING)
+        return 1.0;
+    return std::min(norm, MAX_SCALING);
+}
+
+/// Largest finite bound. Scaled bounds must stay below QP_INFINITE_BOUND, otherwise solvers would drop them as infinite
+static const double MAX_FINITE_BOUND = std::nextafter(QP_INFINITE_BOUND, 0.0);
+
+/// out = scale * bound for finite bounds, saturated at MAX_FINITE_BOUND. Infinite bounds (see QP_INFINITE_BOUND) are copied, so that they remain infinite
+template<typename Scale>
+static void scaleBounds(const Scale& scale, const base::VectorXd& bound, base::VectorXd& out){
+    out.resize(bound.size());
+    for(int i = 0; i < bound.size(); i++){
+        if(std::abs(bound[i]) >= QP_INFINITE_BOUND)
+            out[i] = bound[i];
+        else
+            out[i] = std::max(-MAX_FINITE_BOUND, std::min(scale[i] * bound[i], MAX_FINITE_BOUND));
+    }
+}
+
+/// Update the column and row infinity norms of E*M*D. M can be dense or sparse
+static void updateNorms(const base::MatrixXd& M, const base::VectorXd& E, int row_offset, const base::VectorXd& D, base::VectorXd& col_norm, base::VectorXd& row_norm){
+    for(int j = 0; j < M.cols(); j++){
+        for(int i = 0; i < M.rows(); i++){
+            const double v = std::abs(E[row_offset+i] * M(i,j) * D[j]);
+            col_norm[j] = std::max(col_norm[j], v);
+            row_norm[row_offset+i] = std::max(row_norm[row_offset+i], v);
+        }
+    }
+}
+
+static void updateNorms(const SparseMatrixXd& M, const base::VectorXd& E, int row_offset, const base::VectorXd& D, base::VectorXd& col_norm, base::VectorXd& row_norm){
+    for(int j = 0; j < M.outerSize(); j++){
+        for(SparseMatrixXd::InnerIterator it(M, j); it; ++it){
+            const double v = std::abs(E[row_offset+it.row()] * it.value() * D[j]);
+            col_norm[j] = std::max(col_norm[j], v);
+            row_norm[row_offset+it.row()] = std::max(row_norm[row_offset+it.row()], v);
+        }
+    }
+}
+
+/// Squared 2-norms of the rows of M*D
+static void rowNormsSquared(const base::MatrixXd& M, int row_offset, const base::VectorXd& D, base::VectorXd& row_norm){
+    for(int i = 0; i < M.rows(); i++)
+        row_norm[row_offset+i] = M.row(i).cwiseProduct(D.transpose()).squaredNorm();
+}
+
+static void rowNormsSquared(const SparseMatrixXd& M, int row_offset, const base::VectorXd& D, base::VectorXd& row_norm){
+    for(int j = 0; j < M.outerSize(); j++)
+        for(SparseMatrixXd::InnerIterator it(M, j); it; ++it)
+            row_norm[row_offset+it.row()] += std::pow(it.value() * D[j], 2);
+}
+
+/// M *= diag(E) from the left and diag(D) from the right, in place
+static void scaleMatrix(SparseMatrixXd& M, const base::VectorXd& E, int row_offset, const base::VectorXd& D){
+    for(int j = 0; j < M.outerSize(); j++)
+        for(SparseMatrixXd::InnerIterator it(M, j); it; ++it)
+            it.valueRef() *= E[row_offset+it.row()] * D[j];
+}
+
+QPScaling::QPScaling() :
+    method(ruiz),
+    update_interval(100),
+    ruiz_iterations(10),
+    n_calls(0),
+    c(1.0){
+}
+
+void QPScaling::computeNorms(const QuadraticProgram& qp){
+    col_norm.setZero(qp.nq);
+    row_norm.setZero(qp.neq + qp.nin);
+    for(int j = 0; j < qp.nq; j++)
+        for(int i = 0; i < qp.nq; i++)
+            col_norm[j] = std::max(col_norm[j], std::abs(D[i] * qp.H(i,j) * D[j]));
+    if(qp.sparse){
+        updateNorms(qp.A_sparse, E, 0, D, col_norm, row_norm);
+        updateNorms(qp.C_sparse, E, qp.neq, D, col_norm, row_norm);
+    }
+    else{
+        updateNorms(qp.A, E, 0, D, col_norm, row_norm);
+        updateNorms(qp.C, E, qp.neq, D, col_norm, row_norm);
+    }
+}
+
+void QPScaling::computeFactors(const QuadraticProgram& qp){
+
+    D.setOnes(qp.nq);
+    E.setOnes(qp.neq + qp.nin);
+    c = 1.0;
+    if(method == none)
+        return;
+
+    if(method == jacobi){
+        for(int j = 0; j < qp.nq; j++)
+            D[j] = 1.0 / std::sqrt(limitNorm(std::abs(qp.H(j,j))));
+        row_norm.setZero(qp.neq + qp.nin);
+        if(qp.sparse){
+            rowNormsSquared(qp.A_sparse, 0, D, row_norm);
+            rowNormsSquared(qp.C_sparse, qp.neq, D, row_norm);
+        }
+        else{
+            rowNormsSquared(qp.A, 0, D, row_norm);
+            rowNormsSquared(qp.C, qp.neq, D, row_norm);
+        }
+        for(int i = 0; i < E.size(); i++)
+            E[i] = 1.0 / limitNorm(std::sqrt(row_norm[i]));
+    }
+    else{
+        for(uint k = 0; k < ruiz_iterations; k++){
+            computeNorms(qp);
+            double max_dev = 0;
+            for(int j = 0; j < col_norm.size(); j++){
+                if(col_norm[j] >= MIN_SCALING)
+                    max_dev = std::max(max_dev, std::abs(1.0 - col_norm[j]));
+            }
+            for(int i = 0; i < row_norm.size(); i++){
+                if(row_norm[i] >= MIN_SCALING)
+                    max_dev = std::max(max_dev, std::abs(1.0 - row_norm[i]));
+            }
+            if(max_dev < RUIZ_TOL)
+                break;
+            for(int j = 0; j < D.size(); j++)
+                D[j] /= std::sqrt(limitNorm(col_norm[j]));
+            for(int i = 0; i < E.size(); i++)
+                E[i] /= std::sqrt(limitNorm(row_norm[i]));
+        }
+        D = D.cwiseMax(MIN_SCALING).cwiseMin(MAX_SCALING);
+        E = E.cwiseMax(MIN_SCALING).cwiseMin(MAX_SCALING);
+    }
+
+    // Cost scaling: Normalize the mean column norm of the scaled Hessian, or the scaled gradient, if it is larger
+    double mean_col_norm = 0;
+    for(int j = 0; j < qp.nq; j++)
+        mean_col_norm += (D.asDiagonal() * qp.H.col(j)).cwiseAbs().maxCoeff() * D[j];
+    mean_col_norm /= std::max(qp.nq, 1);
+    const double g_norm = qp.nq > 0 ? D.cwiseProduct(qp.g).cwiseAbs().maxCoeff() : 0;
+    c = 1.0 / limitNorm(std::max(mean_col_norm, g_norm));
+}
+
+void QPScaling::scale(const QuadraticProgram& qp, QuadraticProgram& qp_scaled){
+
+    if(D.size() != qp.nq || E.size() != qp.neq + qp.nin || (update_interval > 0 && n_calls % update_interval == 0))
+        computeFactors(qp);
+    n_calls++;
+
+    qp_scaled.nq = qp.nq;
+    qp_scaled.neq = qp.neq;
+    qp_scaled.nin = qp.nin;
+    qp_scaled.bounded = qp.bounded;
+    qp_scaled.sparse = qp.sparse;
+    if(qp_scaled.variable_blocks != qp.variable_blocks)
+        qp_scaled.variable_blocks = qp.variable_blocks;
+    qp_scaled.Wy = qp.Wy;
+
+    qp_scaled.H.noalias() = D.asDiagonal() * qp.H * D.asDiagonal();
+    qp_scaled.H *= c;
+    qp_scaled.g = c * D.cwiseProduct(qp.g);
+
+    const auto E_A = E.head(qp.neq);
+    const auto E_C = E.segment(qp.neq, qp.nin);
+    if(qp.sparse){
+        qp_scaled.A.resize(0, qp.nq);
+        qp_scaled.C.resize(0, qp.nq);
+        qp_scaled.A_sparse = qp.A_sparse;
+        qp_scaled.C_sparse = qp.C_sparse;
+        scaleMatrix(qp_scaled.A_sparse, E, 0, D);
+        scaleMatrix(qp_scaled.C_sparse, E, qp.neq, D);
+    }
+    else{
+        qp_scaled.A.noalias() = E_A.asDiagonal() * qp.A * D.asDiagonal();
+        qp_scaled.C.noalias() = E_C.asDiagonal() * qp.C * D.asDiagonal();
+        qp_scaled.A_sparse.resize(0, qp.nq);
+        qp_scaled.C_sparse.resize(0, qp.nq);
+    }
+    qp_scaled.b = E_A.cwiseProduct(qp.b);
+    scaleBounds(E_C, qp.lower_y, qp_scaled.lower_y);
+    scaleBounds(E_C, qp.upper_y, qp_scaled.upper_y);
+    scaleBounds(D.cwiseInverse(), qp.lower_x, qp_scaled.lower_x);
+    scaleBounds(D.cwiseInverse(), qp.upper_x, qp_scaled.upper_x);
+}
+
+void QPScaling::unscale(base::VectorXd& x) const{
+    x.array() *= D.array();
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef WBC_CORE_QP_SCALING_HPP
+#define WBC_CORE_QP_SCALING_HPP
+
+#include "QuadraticProgram.hpp"
+
+namespace wbc{
+
+/**
+ * @brief Equilibration of a quadratic program. The variables are substituted by \f$\mathbf{x} = \mathbf{D}\bar{\mathbf{x}}\f$ and the constraint rows are scaled by \f$\mathbf{E}\f$,
+ *  which gives the equivalent problem
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\bar{\mathbf{x}}) & \frac{c}{2} \bar{\mathbf{x}}^T\mathbf{DHD}\bar{\mathbf{x}}+c\bar{\mathbf{x}}^T\mathbf{Dg}& \\
+ *             & & \\
+ *        s.t. & \mathbf{E}_A\mathbf{AD}\bar{\mathbf{x}} = \mathbf{E}_A\mathbf{b}& \\
+ *             & \mathbf{E}_C\mathbf{l} \leq \mathbf{E}_C\mathbf{CD}\bar{\mathbf{x}} \leq \mathbf{E}_C\mathbf{u}& \\
+ *             & \mathbf{D}^{-1}\mathbf{lb} \leq \bar{\mathbf{x}} \leq \mathbf{D}^{-1}\mathbf{ub}& \\
+ *        \end{array}
+ *  \f]
+ * with diagonal, positive D and E and cost scaling c. Well scaled problems, e.g., if torques, accelerations and contact forces are of similar magnitude, require less iterations in
+ * most solvers. The scaling factors are only recomputed every n calls (see setUpdateInterval()) or if the problem dimensions change, since computing them costs about as much as
+ * a few matrix products. Infinite bounds (see QP_INFINITE_BOUND) remain infinite, finite bounds remain finite, i.e., scaled finite bounds are saturated below QP_INFINITE_BOUND.
+ */
+class QPScaling{
+public:
+    enum Method{
+        none,       /** No scaling, all factors are one*/
+        jacobi,     /** Diagonal Jacobi equilibration: D = diag(H)^-1/2, E normalizes the 2-norm of the rows of the variable-scaled constraint matrix*/
+        ruiz        /** Ruiz equilibration: Iteratively normalizes the infinity norm of the rows and columns of the KKT matrix, see OSQP*/
+    };
+
+    QPScaling();
+
+    /** Scaling method. Default is ruiz*/
+    void setMethod(Method m){method = m; reset();}
+    Method getMethod() const {return method;}
+
+    /** Recompute the scaling factors every n calls of scale(). If n is 0, they are only computed if the problem dimensions change. Default is 100*/
+    void setUpdateInterval(uint n){update_interval = n;}
+    uint getUpdateInterval() const {return update_interval;}
+
+    /** Maximum number of iterations of the Ruiz equilibration. Default is 10*/
+    void setRuizIterations(uint n){ruiz_iterations = n;}
+
+    /** Enforce recomputation of the scaling factors at the next call of scale()*/
+    void reset(){n_calls = 0; D.resize(0);}
+
+    /**
+     * @brief Write the scaled version of qp to qp_scaled. Dense and sparse quadratic programs are supported. No memory is allocated
+     *  if the problem dimensions and, in the sparse case, the non-zeros of the constraint matrices do not change.
+     */
+    void scale(const QuadraticProgram& qp, QuadraticProgram& qp_scaled);
+
+    /** Transform the solution of the scaled problem back to the original variables*/
+    void unscale(base::VectorXd& x) const;
+
+    /** Variable scaling D (nq x 1)*/
+    const base::VectorXd& variableScaling() const {return D;}
+    /** Constraint scaling E of the equalities followed by the inequalities (neq + nin x 1)*/
+    const base::VectorXd& constraintScaling() const {return E;}
+    /** Cost scaling c*/
+    double costScaling() const {return c;}
+
+protected:
+    /** Compute D, E and c for the given problem*/
+    void computeFactors(const QuadraticProgram& qp);
+    /** Infinity norms of the columns of D*H*D and E*[A;C]*D and of the rows of E*[A;C]*D with the current factors*/
+    void computeNorms(const QuadraticProgram& qp);
+
+    Method method;
+    uint update_interval;
+    uint ruiz_iterations;
+    uint n_calls;
+
+    base::VectorXd D, E;
+    double c;
+    base::VectorXd col_norm, row_norm;
+};
+
+}
+
+#endif
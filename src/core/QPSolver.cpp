@@ -1,12 +1,122 @@
 #include "QPSolver.hpp"
+#include "QuadraticProgram.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace wbc{
 
-QPSolver::QPSolver() : configured(false){
+static void setRow(std::vector<int>& rows, size_t& n, int row, bool& changed){
+    if(n < rows.size()){
+        if(rows[n] != row){
+            rows[n] = row;
+            changed = true;
+        }
+    }
+    else{
+        rows.push_back(row);
+        changed = true;
+    }
+    n++;
+}
+
+bool ConstraintRowSelection::update(const base::VectorXd& lb, const base::VectorXd& ub){
+    bool changed = false;
+    size_t n_lower = 0, n_upper = 0, n_equal = 0;
+    for(int i = 0; i < lb.size(); i++){
+        const bool has_lower = lb[i] > -QP_INFINITE_BOUND;
+        const bool has_upper = ub[i] < QP_INFINITE_BOUND;
+        if(has_lower && has_upper && lb[i] == ub[i])
+            setRow(equal, n_equal, i, changed);
+        else{
+            if(has_lower)
+                setRow(lower, n_lower, i, changed);
+            if(has_upper)
+                setRow(upper, n_upper, i, changed);
+        }
+    }
+    changed |= n_lower != lower.size() || n_upper != upper.size() || n_equal != equal.size();
+    lower.resize(n_lower);
+    upper.resize(n_upper);
+    equal.resize(n_equal);
+    return changed;
+}
+
+bool ConstraintRowSelection::updateEqualities(const base::MatrixXd& A, const base::VectorXd& b){
+    bool changed = !lower.empty() || !upper.empty();
+    lower.clear();
+    upper.clear();
+    size_t n_equal = 0;
+    for(int i = 0; i < A.rows(); i++){
+        if(b[i] != 0 || !A.row(i).isZero(0))
+            setRow(equal, n_equal, i, changed);
+    }
+    changed |= n_equal != equal.size();
+    equal.resize(n_equal);
+    return changed;
+}
+
+QPSolver::QPSolver() :
+    configured(false),
+    time_budget(0),
+    time_per_iter(0){
+}
+
+uint QPSolver::iterationBudget(uint max_iter) const{
+    if(time_budget <= 0 || time_per_iter <= 0)
+        return max_iter;
+    return std::max(1u, std::min(max_iter, (uint)(time_budget / time_per_iter)));
+}
+
+void QPSolver::updateTimePerIteration(const base::Time& duration, uint n_iter){
+    const double t = (double)duration.toMicroseconds() / std::max(1u, n_iter);
+    time_per_iter = time_per_iter > 0 ? 0.8 * time_per_iter + 0.2 * t : t;
 }
 
 QPSolver::~QPSolver(){
 }
 
+void QPSolver::mapVariables(const std::vector<VariableBlock>& blocks_prev, const base::VectorXd& x_prev,
+                            const std::vector<VariableBlock>& blocks, uint n, base::VectorXd& x){
+    x.setZero(n);
+    if(blocks.empty() || blocks_prev.empty()){
+        if(x_prev.size() == (int)n)
+            x = x_prev;
+        return;
+    }
+    for(const VariableBlock& b : blocks){
+        for(const VariableBlock& b_prev : blocks_prev){
+            if(b.name == b_prev.name && b.size == b_prev.size && b_prev.start + b_prev.size <= x_prev.size() && b.start + b.size <= (int)n){
+                x.segment(b.start, b.size) = x_prev.segment(b_prev.start, b_prev.size);
+                break;
+            }
+        }
+    }
+}
+
+static double violation(double val, double lb, double ub){
+    return std::max({0.0, lb - val, val - ub});
+}
+
+double QPSolver::constraintViolation(const QuadraticProgram& qp, const base::VectorXd& x){
+    // Row-wise evaluation, so that no memory is allocated for dense problems
+    double viol = 0;
+    if(qp.sparse){
+        const base::VectorXd Ax = qp.A_sparse * x, Cx = qp.C_sparse * x;
+        for(uint i = 0; i < qp.neq; i++)
+            viol = std::max(viol, std::abs(Ax[i] - qp.b[i]));
+        for(uint i = 0; i < qp.nin; i++)
+            viol = std::max(viol, violation(Cx[i], qp.lower_y[i], qp.upper_y[i]));
+    }
+    else{
+        for(uint i = 0; i < qp.neq; i++)
+            viol = std::max(viol, std::abs(qp.A.row(i).dot(x) - qp.b[i]));
+        for(uint i = 0; i < qp.nin; i++)
+            viol = std::max(viol, violation(qp.C.row(i).dot(x), qp.lower_y[i], qp.upper_y[i]));
+    }
+    for(int i = 0; i < qp.lower_x.size(); i++)
+        viol = std::max(viol, violation(x[i], qp.lower_x[i], qp.upper_x[i]));
+    return viol;
+}
+
 QPSolverFactory::QPSolverMap* QPSolverFactory::qp_solver_map = 0;
 }
@@ -5,15 +5,92 @@
 #include <base/Eigen.hpp>
 #include <memory>
 #include <map>
+#include <limits>
 #include "QPSolverConfig.hpp"
+#include <base/Time.hpp>
 
 namespace wbc{
 
 class HierarchicalQP;
+struct QuadraticProgram;
+struct VariableBlock;
+
+/**
+ * @brief Classifies the rows of a two-sided constraint lb <= y <= ub. Solvers that only support one-sided inequalities use this to drop the sides with infinite
+ *  bounds (see QP_INFINITE_BOUND), which can never become active, instead of expanding each row into two inequalities. Rows with equal lower and upper bound are treated as equalities.
+ */
+struct ConstraintRowSelection{
+    std::vector<int> lower;  /** Rows with finite lower bound (excluding the equalities)*/
+    std::vector<int> upper;  /** Rows with finite upper bound (excluding the equalities)*/
+    std::vector<int> equal;  /** Rows with equal, finite lower and upper bound*/
+
+    /** Classify the rows of the given bounds. Return true if the selection differs from the previous call. No memory is allocated if the selection does not grow*/
+    bool update(const base::VectorXd& lb, const base::VectorXd& ub);
+    /** Select the rows of the equality constraints Ax = b that are not structurally empty, i.e., that have a non-zero entry in A or b, and store them in equal.
+     *  Empty rows (e.g. of inactive contacts with fixed contact set, see Scene::setFixedContactSet()) are always satisfied, but make the equality constraints rank deficient,
+     *  which active set and interior point solvers cannot handle. Return true if the selection differs from the previous call*/
+    bool updateEqualities(const base::MatrixXd& A, const base::VectorXd& b);
+    /** Number of one-sided inequalities*/
+    uint nInequalities() const {return lower.size() + upper.size();}
+};
 
 class QPSolver{
+public:
+    /** Outcome of the last call to solve(). Errors like an infeasible problem are reported by exceptions*/
+    enum Status{
+        solved,                 /** The solver found a solution*/
+        max_iter_reached,       /** Iteration limit of the solver reached. Only reported if a time budget is set, otherwise an exception is thrown*/
+        time_budget_exceeded,   /** Time budget exceeded (see setTimeBudget()). The solver output is not optimal and may violate the constraints, see setTimeBudget()*/
+        not_solved              /** solve() has not been called yet*/
+    };
+
+    /** Statistics of the last call to solve(). Entries that are not provided by a solver are NaN (residuals) or -1 (active set size)*/
+    struct SolverStats{
+        SolverStats() : status(not_solved), n_iter(0), n_active(-1),
+            primal_residual(std::numeric_limits<double>::quiet_NaN()), dual_residual(std::numeric_limits<double>::quiet_NaN()),
+            setup_time(0), solve_time(0), warm_start(false){}
+
+        Status status;              /** Outcome of the last call to solve()*/
+        uint n_iter;                /** Number of solver iterations. For active set solvers this is the number of working set changes*/
+        int n_active;               /** Number of active inequality constraints and bounds at the solution*/
+        double primal_residual;     /** Infinity norm of the primal residual. Solvers without own residuals report the constraint violation of the solver output, see constraintViolation()*/
+        double dual_residual;       /** Infinity norm of the dual residual*/
+        double setup_time;          /** Wall time to prepare the solver data (copy, factorization, solver setup) in microseconds*/
+        double solve_time;          /** Wall time of the actual solver call in microseconds*/
+        bool warm_start;            /** True if the solver started from a previous solution*/
+    };
+
 protected:
     bool configured;
+    double time_budget;         /** Time budget per call of solve() in microseconds, <= 0 means no budget*/
+    SolverStats stats;          /** Statistics of the last call to solve(). Has to be filled by all solvers in each call of solve()*/
+    double time_per_iter;       /** Estimated computation time per solver iteration in microseconds, see updateTimePerIteration()*/
+
+    /**
+     * @brief Translate the time budget into an iteration limit for solvers that do not support a time limit natively, based on the measured computation time per iteration
+     *  of the previous calls (see updateTimePerIteration()). Returns max_iter if no time budget is set or no measurement is available yet.
+     */
+    uint iterationBudget(uint max_iter) const;
+
+    /** Update the estimate of the computation time per iteration with the time and number of iterations of the last call*/
+    void updateTimePerIteration(const base::Time& duration, uint n_iter);
+
+    /**
+     * @brief Map a vector over the variables of a previous quadratic program (e.g. its solution) to the variables of a quadratic program with a different structure,
+     *  e.g., after the contact points changed. Blocks are matched by name and size (see QuadraticProgram::variable_blocks), all variables without a matching block are set to zero.
+     *  If no blocks are given, the vector is only copied if the number of variables did not change.
+     * @param blocks_prev Variable blocks of the previous quadratic program
+     * @param x_prev Vector over the variables of the previous quadratic program
+     * @param blocks Variable blocks of the new quadratic program
+     * @param n Number of variables of the new quadratic program
+     * @param x Output vector over the variables of the new quadratic program. Will be resized to n.
+     */
+    static void mapVariables(const std::vector<VariableBlock>& blocks_prev, const base::VectorXd& x_prev,
+                             const std::vector<VariableBlock>& blocks, uint n, base::VectorXd& x);
+
+    /** Infinity norm of the violation of the equality constraints, inequality constraints and bounds of the given quadratic program by x. Infinite bounds are never violated.
+     *  Does not allocate memory for dense problems*/
+    static double constraintViolation(const QuadraticProgram& qp, const base::VectorXd& x);
 public:
     QPSolver();
     virtual ~QPSolver();
@@ -24,11 +101,32 @@ public:
      */
     virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output) = 0;
 
+    /** @brief Return true if the solver expects the constraint matrices in sparse format, see QuadraticProgram::sparse. Scenes that support
+     *  sparse quadratic programs will generate them in this case. Default is false*/
+    virtual bool sparseInput() const {return false;}
+
     /** @brief reset Enforces reconfiguration at next call to solve() */
     void reset(){configured=false;}
+
+    /**
+     * @brief Set a time budget for each call of solve() in microseconds. All solvers stop when the budget is exceeded, either by a native time limit of the backend
+     *  or by an iteration limit estimated from the previous calls (the first call runs without limit in this case). If the budget is exceeded, solve() does not throw but returns an
+     *  iterate that is not optimal and getStatus() returns time_budget_exceeded, so that the caller can decide to use it or to fall back to the previous command. Which iterate is
+     *  returned depends on the solver: ADMMSolver returns the best iterate found so far, preferring primal feasible ones. Dual active set (eiquadprog) and interior point (qpSWIFT)
+     *  methods return their last iterate, which is primal infeasible in general. Check getStats().primal_residual before using the output. A value <= 0 disables the budget. Default is 0.
+     */
+    void setTimeBudget(double microseconds){time_budget = microseconds;}
+    double getTimeBudget() const {return time_budget;}
+
+    /** @brief Status of the last call to solve()*/
+    Status getStatus() const {return stats.status;}
+
+    /** @brief Statistics of the last call to solve(), e.g. for monitoring the solver cost per control cycle*/
+    const SolverStats& getStats() const {return stats;}
 };
 
 typedef std::shared_ptr<QPSolver> QPSolverPtr;
+typedef QPSolver::SolverStats SolverStats;
 
 template<typename T> QPSolver* createT(){return new T;}
 
@@ -3,12 +3,27 @@
 
 namespace wbc {
 
-void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin, bool _bounds){
+bool QuadraticProgram::hasSize(const uint _nq, const uint _neq, const uint _nin, bool _bounds, bool _sparse) const{
+    if(nq != (int)_nq || neq != (int)_neq || nin != (int)_nin || bounded != _bounds || sparse != _sparse ||
+       H.rows() != nq || Wy.size() != neq+nin)
+        return false;
+    if(sparse)
+        return A_sparse.rows() == neq && A_sparse.cols() == nq && C_sparse.rows() == nin && C_sparse.cols() == nq;
+    return A.rows() == neq && C.rows() == nin;
+}
+
+void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin, bool _bounds, bool _sparse){
+
+    // Structure did not change, keep the memory and the current values
+    if(hasSize(_nq, _neq, _nin, _bounds, _sparse))
+        return;
+
     neq = _neq;
     nin = _nin;
     nq = _nq;
 
     bounded = _bounds;
+    sparse = _sparse;
 
     // cost function
     H.resize(nq, nq);
@@ -17,14 +32,16 @@ void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin,
     g.setConstant(std::numeric_limits<double>::quiet_NaN());
 
     // equalities
-    A.resize(neq, nq);
+    A.resize(sparse ? 0 : neq, nq);
     A.setConstant(std::numeric_limits<double>::quiet_NaN());
+    A_sparse.resize(sparse ? neq : 0, nq);
     b.resize(neq);
     b.setConstant(std::numeric_limits<double>::quiet_NaN());
 
     // inequalities
-    C.resize(nin, nq);
+    C.resize(sparse ? 0 : nin, nq);
     C.setConstant(std::numeric_limits<double>::quiet_NaN());
+    C_sparse.resize(sparse ? nin : 0, nq);
     lower_y.resize(nin);
     lower_y.setConstant(std::numeric_limits<double>::quiet_NaN());
     upper_y.resize(nin);
@@ -37,6 +54,7 @@ void QuadraticProgram::resize(const uint _nq, const uint _neq, const uint _nin,
     upper_x.setConstant(std::numeric_limits<double>::quiet_NaN());
 
     Wy.setOnes(neq+nin);
+    variable_blocks.clear();
 }
 
 void QuadraticProgram::check() const {
@@ -56,18 +74,22 @@ void QuadraticProgram::check() const {
             std::cout<<"Quadratic program has not bounds "
                 "but upper bound has size " + std::to_string(lower_x.size()) + " (nq:" + std::to_string(nq) + ")"<<std::endl;
     }
-    if(C.rows() != nin || C.cols() != nq)
+    const int C_rows = sparse ? C_sparse.rows() : C.rows();
+    const int C_cols = sparse ? C_sparse.cols() : C.cols();
+    if(C_rows != nin || C_cols != nq)
         std::cout<<"Inequality constraint matrix C should have size " + std::to_string(nin) + "x" + std::to_string(nq) +
-            "but has size " +  std::to_string(C.rows()) + "x" + std::to_string(C.cols())<<std::endl;
+            "but has size " +  std::to_string(C_rows) + "x" + std::to_string(C_cols)<<std::endl;
     if(lower_y.size() != nin)
         std::cout<<"Number of inequality constraints in quadratic program is " + std::to_string(nin)
             + ", but lower bound has size " + std::to_string(lower_y.size())<<std::endl;
     if(upper_y.size() != nin)
         std::cout<<"Number of inequality constraints in quadratic program is " + std::to_string(nin)
             + ", but lower bound has size " + std::to_string(lower_y.size())<<std::endl;
-    if(A.rows() != neq || A.cols() != nq)
+    const int A_rows = sparse ? A_sparse.rows() : A.rows();
+    const int A_cols = sparse ? A_sparse.cols() : A.cols();
+    if(A_rows != neq || A_cols != nq)
         std::cout<<"Equality constraint matrix A should have size " + std::to_string(neq) + "x" + std::to_string(nq) +
-            "but has size " +  std::to_string(A.rows()) + "x" + std::to_string(A.cols())<<std::endl;
+            "but has size " +  std::to_string(A_rows) + "x" + std::to_string(A_cols)<<std::endl;
     if(b.size() != neq)
             std::cout<<"Equality constraint vector b should have size " + std::to_string(neq) + "but has size " + std::to_string(b.size())<<std::endl;
     if(H.rows() != nq || H.cols() != nq)
@@ -81,16 +103,23 @@ void QuadraticProgram::print() const {
     std::cout << "-- Quadratic Program --" << std::endl;
     std::cout << "Size nq: " << nq << "  neq: " << neq << "  nin:" << nin << std::endl;
     std::cout << "bounded: " << (bounded ? "true" : "false") << std::endl;
+    std::cout << "sparse: " << (sparse ? "true" : "false") << std::endl;
     std::cout << "H" << std::endl;
     std::cout << H << std::endl;
     std::cout << "g" << std::endl;
     std::cout << g.transpose() << std::endl;
     std::cout << "A" << std::endl;
-    std::cout << A << std::endl;
+    if(sparse)
+        std::cout << base::MatrixXd(A_sparse) << std::endl;
+    else
+        std::cout << A << std::endl;
     std::cout << "b" << std::endl;
     std::cout << b.transpose() << std::endl;
     std::cout << "C" << std::endl;
-    std::cout << C << std::endl;
+    if(sparse)
+        std::cout << base::MatrixXd(C_sparse) << std::endl;
+    else
+        std::cout << C << std::endl;
     std::cout << "lower_y" << std::endl;
     std::cout << lower_y.transpose() << std::endl;
     std::cout << "upper_y" << std::endl;
@@ -4,12 +4,35 @@
 #include <base/Eigen.hpp>
 #include <base/Time.hpp>
 #include <base/samples/Joints.hpp>
+#include <Eigen/SparseCore>
 
 namespace wbc{
 
+/** Sparse matrix type used for the constraint matrices of sparse quadratic programs (compressed column storage)*/
+typedef Eigen::SparseMatrix<double, Eigen::ColMajor, int> SparseMatrixXd;
+
+/** Constraint bounds with an absolute value of at least QP_INFINITE_BOUND are considered infinite, i.e., the corresponding one-sided constraint can never become active.
+ *  Use this value instead of arbitrary large numbers if a constraint row or variable is not bounded on one side. Solvers may drop such constraints, see ConstraintRowSelection*/
+const double QP_INFINITE_BOUND = 1e10;
+
 class JointWeights : public base::NamedVector<double>{
 };
 
+/**
+ * @brief Semantic block of variables of a quadratic program, e.g., the joint accelerations or the wrench of a particular contact point. Solvers use the
+ *  blocks to map the previous solution to a quadratic program with different structure, see QuadraticProgram::variable_blocks
+ */
+struct VariableBlock{
+    VariableBlock() : start(0), size(0){}
+    VariableBlock(const std::string& name, int start, int size) : name(name), start(start), size(size){}
+
+    std::string name;   /** Unique name of the block*/
+    int start;          /** Index of the first variable of the block*/
+    int size;           /** Number of variables in the block*/
+
+    bool operator==(const VariableBlock& other) const {return name == other.name && start == other.start && size == other.size;}
+};
+
 /**
  * @brief Describes a quadratic program of the form
  *  \f[
@@ -20,6 +43,9 @@ class JointWeights : public base::NamedVector<double>{
  *             & lb(\mathbf{x}) \leq \mathbf{x} \leq ub(\mathbf{x})& \\
  *        \end{array}
  *  \f]
+ * If sparse is true, the constraint matrices are stored in A_sparse and C_sparse instead of A and C. This is useful for problems with many
+ * structural zeros in the constraint matrices, e.g., the friction cones and the selection matrix in the TSID formulation. The dense
+ * matrices A and C have zero rows in this case.
  */
 struct QuadraticProgram{
 
@@ -28,6 +54,7 @@ struct QuadraticProgram{
     int nin;                /** Number of inequalities constraints for this prio*/
 
     bool bounded;            /** Contains simple boiunds for the variables */
+    bool sparse;             /** Constraint matrices are given in A_sparse and C_sparse instead of A and C*/
 
     base::MatrixXd H;       /** Hessian Matrix (nq x nq) */
     base::VectorXd g;       /** Gradient vector (nq x 1) */
@@ -39,9 +66,20 @@ struct QuadraticProgram{
     base::VectorXd lower_x; /** Lower bound of the solution vector (nq x 1) */
     base::VectorXd upper_x; /** Upper bound of the solution vector (nq x 1) */
     base::VectorXd Wy;      /** Constraint weights (nc x 1). Default entry is 1. */
+    SparseMatrixXd A_sparse; /** Sparse equalities constraint matrix (neq x nq). Only used if sparse is true*/
+    SparseMatrixXd C_sparse; /** Sparse inequalities constraint matrix (nin x nq). Only used if sparse is true*/
+    std::vector<VariableBlock> variable_blocks; /** Optional description of the variables. If the problem size changes between two calls, solvers match the blocks
+                                                    by name and size to warm start from the previous solution. Cleared on resize()*/
+
+    QuadraticProgram() : nq(0), neq(0), nin(0), bounded(false), sparse(false){}
+
+    /** Resize all variables and initialize them with NaN. If the problem dimensions did not change since the last call, nothing will be done,
+     *  i.e., no memory is (re-)allocated and all entries keep their current values. If sparse is true, the sparse constraint matrices are resized
+     *  (without any non-zeros) instead of the dense ones*/
+    void resize(uint nq, uint neq, uint nin, bool bounds, bool sparse = false);
 
-    /** Initialize all variables with NaN */
-    void resize(uint nq, uint neq, uint nin, bool bounds);
+    /** Return true if the problem has the given dimensions*/
+    bool hasSize(uint nq, uint neq, uint nin, bool bounds, bool sparse = false) const;
 
     /** Check if matrix and vectors dims match with nq, neq, nin. Throw exception if not **/
     void check() const;
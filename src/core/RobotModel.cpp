@@ -1,8 +1,10 @@
 #include "RobotModel.hpp"
+#include "../tools/WorkerPool.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/samples/RigidBodyStateSE3.hpp>
 #include <base/samples/Joints.hpp>
 #include <fstream>
+#include <algorithm>
 #include <urdf_parser/urdf_parser.h>
 
 namespace wbc{
@@ -13,7 +15,10 @@ std::vector<std::string> operator+(std::vector<std::string> a, std::vector<std::
 }
 
 RobotModel::RobotModel() :
-    gravity(base::Vector3d(0,0,-9.81)){
+    gravity(base::Vector3d(0,0,-9.81)),
+    structure_counter(0),
+    fixed_contact_set(false),
+    concurrent_stamp(0){
 }
 
 void RobotModel::clear(){
@@ -33,6 +38,15 @@ void RobotModel::clear(){
     space_jac_map.clear();
     body_jac_map.clear();
     jac_dot_map.clear();
+    frame_names.clear();
+    chains.clear();
+    contact_chain_ids.clear();
+    contact_chain_names.clear();
+    joint_order.clear();
+    joint_order_idx.clear();
+    batch_workspaces.clear();
+    concurrent_workspaces.clear();
+    structure_counter++;
 }
 
 void RobotModel::setActiveContacts(const ActiveContacts &contacts){
@@ -42,9 +56,355 @@ void RobotModel::setActiveContacts(const ActiveContacts &contacts){
         if(contacts[name].mu <= 0)
             throw std::runtime_error("RobotModel::setActiveContacts: Friction coefficient has to be > 0");
     }
-    active_contacts = contacts;
+
+    // Extend the contacts before comparing them, so that switching contacts does not change the structure with fixed contact set
+    const ActiveContacts* new_contacts = &contacts;
+    if(fixed_contact_set){
+        const ActiveContacts& config_contacts = robot_model_config.contact_points;
+        for(const std::string& name : contacts.names){
+            if(std::find(config_contacts.names.begin(), config_contacts.names.end(), name) == config_contacts.names.end()){
+                LOG_ERROR("Contact point %s is not in the robot model configuration. This is not allowed with a fixed contact set", name.c_str());
+                throw std::invalid_argument("Invalid contact points");
+            }
+        }
+        all_contacts = config_contacts;
+        for(uint i = 0; i < all_contacts.size(); i++){
+            auto it = std::find(contacts.names.begin(), contacts.names.end(), all_contacts.names[i]);
+            if(it != contacts.names.end())
+                all_contacts.elements[i] = contacts.elements[it - contacts.names.begin()];
+            else
+                all_contacts.elements[i].active = 0;
+        }
+        new_contacts = &all_contacts;
+    }
+
+    bool structure_changed = new_contacts->names != active_contacts.names;
+    for(size_t i = 0; i < new_contacts->size() && !structure_changed; i++){
+        const ActiveContact& a = (*new_contacts)[i], &b = active_contacts[i];
+        structure_changed = a.mu != b.mu || a.wx != b.wx || a.wy != b.wy;
+    }
+    if(structure_changed)
+        structure_counter++;
+    active_contacts = *new_contacts;
+}
+
+void RobotModel::setFixedContactSet(bool fixed){
+    fixed_contact_set = fixed;
+    if(fixed_contact_set)
+        setActiveContacts(active_contacts);
+}
+
+
+FrameId RobotModel::frameId(const std::string& frame_name){
+    for(size_t i = 0; i < frame_names.size(); i++){
+        if(frame_names[i] == frame_name)
+            return i;
+    }
+    frame_names.push_back(frame_name);
+    return frame_names.size()-1;
+}
+
+const std::string& RobotModel::frameName(const FrameId frame) const{
+    if(frame < 0 || frame >= (int)frame_names.size())
+        throw std::invalid_argument("Invalid frame id " + std::to_string(frame));
+    return frame_names[frame];
+}
+
+ChainId RobotModel::chainId(const std::string& root_frame, const std::string& tip_frame){
+    const FrameId root = frameId(root_frame);
+    const FrameId tip = frameId(tip_frame);
+    for(size_t i = 0; i < chains.size(); i++){
+        if(chains[i].first == root && chains[i].second == tip)
+            return i;
+    }
+    chains.push_back(std::make_pair(root, tip));
+    addChain(chains.size()-1);
+    return chains.size()-1;
+}
+
+void RobotModel::checkChainId(const ChainId chain) const{
+    if(chain < 0 || chain >= (int)chains.size()){
+        LOG_ERROR("Invalid chain id %i. Number of chains is %i. Note that chain ids have to be resolved again after reconfiguring the robot model", chain, chains.size());
+        throw std::invalid_argument("Invalid chain id");
+    }
 }
 
+const std::string& RobotModel::chainRoot(const ChainId chain) const{
+    checkChainId(chain);
+    return frame_names[chains[chain].first];
+}
+
+const std::string& RobotModel::chainTip(const ChainId chain) const{
+    checkChainId(chain);
+    return frame_names[chains[chain].second];
+}
+
+const std::vector<ChainId>& RobotModel::contactChainIds(){
+    // Only resolve again if the contact names changed, e.g. after setActiveContacts()
+    if(contact_chain_names != active_contacts.names){
+        contact_chain_ids.resize(active_contacts.size());
+        for(size_t i = 0; i < active_contacts.size(); i++)
+            contact_chain_ids[i] = chainId(world_frame, active_contacts.names[i]);
+        contact_chain_names = active_contacts.names;
+    }
+    return contact_chain_ids;
+}
+
+/** Robot model and thread index the queries of the calling thread are routed to, see RobotModel::beginConcurrentQueries()*/
+struct ConcurrentQueryThread{
+    const RobotModel* robot_model;
+    uint thread;
+};
+static thread_local ConcurrentQueryThread concurrent_query_thread = {nullptr, 0};
+
+/** Assign b to a and return true if the value changed*/
+static bool assignChanged(double& a, const double b){
+    const bool changed = a != b;
+    a = b;
+    return changed;
+}
+
+static bool sameFloatingBaseState(const base::samples::RigidBodyStateSE3& a, const base::samples::RigidBodyStateSE3& b){
+    return a.pose.position == b.pose.position && a.pose.orientation.coeffs() == b.pose.orientation.coeffs() &&
+           a.twist.linear == b.twist.linear && a.twist.angular == b.twist.angular &&
+           a.acceleration.linear == b.acceleration.linear && a.acceleration.angular == b.acceleration.angular;
+}
+
+void RobotModel::prepareConcurrentQueries(uint n_threads){
+    if(n_threads == 0)
+        throw std::invalid_argument("RobotModel::prepareConcurrentQueries: Number of threads has to be > 0");
+    if(!supportsWorkspaces())
+        throw std::runtime_error("RobotModel::prepareConcurrentQueries: This robot model does not support workspaces");
+    if(joint_state.time.isNull()){
+        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error("Invalid call to prepareConcurrentQueries()");
+    }
+
+    // Contact chains are interned lazily, so resolve them here, before the workspaces are created
+    contactChainIds();
+
+    // Workspaces know the chains that exist at creation time, so recreate them if chains have been added since
+    bool changed = false;
+    if(concurrent_workspaces.size() != n_threads-1 || (n_threads > 1 && concurrent_workspaces[0]->noOfChains() != chains.size())){
+        concurrent_workspaces.clear();
+        for(uint i = 1; i < n_threads; i++)
+            concurrent_workspaces.push_back(createWorkspace());
+        concurrent_workspace_stamps.assign(n_threads-1, concurrent_stamp);
+        changed = true;
+    }
+
+    // Copy the robot state, so that the workspaces never read the robot model state. Only trigger an update of the workspaces if the state actually
+    // changed, e.g., if this is called once for the constraints and once for the tasks in the same control cycle
+    const size_t n = joint_order_idx.size();
+    if(concurrent_q.size() != (int)n){
+        concurrent_q.setZero(n);
+        concurrent_qd.setZero(n);
+        concurrent_qdd.setZero(n);
+        changed = true;
+    }
+    for(size_t i = 0; i < n; i++){
+        const base::JointState& state = joint_state.elements[joint_order_idx[i]];
+        changed |= assignChanged(concurrent_q[i], state.position);
+        changed |= assignChanged(concurrent_qd[i], state.speed);
+        changed |= assignChanged(concurrent_qdd[i], state.acceleration);
+    }
+    if(has_floating_base && !sameFloatingBaseState(concurrent_fb_state, floating_base_state)){
+        concurrent_fb_state = floating_base_state;
+        changed = true;
+    }
+    if(changed)
+        concurrent_stamp++;
+}
+
+void RobotModel::beginConcurrentQueries(uint thread){
+    if(thread > concurrent_workspaces.size()){
+        LOG_ERROR("Concurrent queries from thread %i were requested, but the robot model has been prepared for %i threads", thread, concurrent_workspaces.size()+1);
+        throw std::invalid_argument("Invalid thread index");
+    }
+    concurrent_query_thread.robot_model = this;
+    concurrent_query_thread.thread = thread;
+}
+
+void RobotModel::endConcurrentQueries(){
+    concurrent_query_thread.robot_model = nullptr;
+    concurrent_query_thread.thread = 0;
+}
+
+RobotModelWorkspace* RobotModel::concurrentWorkspace(){
+    if(concurrent_query_thread.robot_model != this || concurrent_query_thread.thread == 0)
+        return nullptr;
+    const uint i = concurrent_query_thread.thread-1;
+    if(concurrent_workspace_stamps[i] != concurrent_stamp){
+        concurrent_workspaces[i]->update(concurrent_q, concurrent_qd, concurrent_qdd, concurrent_fb_state);
+        concurrent_workspace_stamps[i] = concurrent_stamp;
+    }
+    return concurrent_workspaces[i].get();
+}
+
+RobotModelWorkspacePtr RobotModel::createWorkspace(){
+    throw std::runtime_error("RobotModel::createWorkspace: This robot model does not support workspaces");
+}
+
+/** Copy the requested quantities of the current state of model, which is either a RobotModel or a RobotModelWorkspace, to the k-th configuration in result*/
+template<typename Model> static void storeBatchResult(Model& model, const BatchRequest& request, const uint k, const uint nj, BatchResult& result){
+    for(size_t c = 0; c < request.chains.size(); c++){
+        const ChainId chain = request.chains[c];
+        if(request.has(batch_pose)){
+            const base::samples::RigidBodyStateSE3& rbs = model.rigidBodyState(chain);
+            result.positions[c].col(k) = rbs.pose.position;
+            result.orientations[c].col(k) = rbs.pose.orientation.coeffs();
+        }
+        if(request.has(batch_space_jacobian))
+            result.space_jacobians[c].middleCols(k*nj,nj) = model.spaceJacobian(chain);
+        if(request.has(batch_body_jacobian))
+            result.body_jacobians[c].middleCols(k*nj,nj) = model.bodyJacobian(chain);
+    }
+    if(request.has(batch_com))
+        result.com.col(k) = model.centerOfMass().pose.position;
+    if(request.has(batch_com_jacobian))
+        result.com_jacobians.middleCols(k*nj,nj) = model.comJacobian();
+    if(request.has(batch_inertia))
+        result.inertia_matrices.middleCols(k*nj,nj) = model.jointSpaceInertiaMatrix();
+    if(request.has(batch_bias_forces))
+        result.bias_forces.col(k) = model.biasForces();
+}
+
+void RobotModel::evaluateBatch(const Eigen::Ref<const base::MatrixXd>& Q, const BatchRequest& request, BatchResult& result){
+    if(Q.rows() != (int)joint_order.size()){
+        LOG_ERROR("Configuration matrix has %i rows, but joint order has %i entries", Q.rows(), joint_order.size());
+        throw std::invalid_argument("Invalid configuration matrix");
+    }
+    for(const ChainId chain : request.chains){
+        checkChainId(chain);
+        if(chainRoot(chain) != world_frame){
+            LOG_ERROR("Chain %s -> %s was requested in evaluateBatch(), but batch evaluation requires the root to be the world frame %s",
+                      chainRoot(chain).c_str(), chainTip(chain).c_str(), world_frame.c_str());
+            throw std::invalid_argument("Invalid chain id");
+        }
+    }
+
+    const uint n_configs = Q.cols();
+    const uint nj = noOfJoints();
+    result.resize(request, n_configs, nj);
+    if(n_configs == 0)
+        return;
+
+    base::samples::RigidBodyStateSE3 fb_state = request.floating_base_state;
+    fb_state.twist.linear.setZero();
+    fb_state.twist.angular.setZero();
+    fb_state.acceleration.linear.setZero();
+    fb_state.acceleration.angular.setZero();
+    fb_state.time = base::Time::now();
+    const base::VectorXd zero = base::VectorXd::Zero(joint_order.size());
+
+    if(!supportsWorkspaces()){
+        // Evaluate the robot model itself and restore its state afterwards, so that a batch never changes the state seen by e.g. a running controller
+        const base::samples::Joints saved_joint_state = joint_state;
+        const base::samples::RigidBodyStateSE3 saved_fb_state = floating_base_state;
+        for(uint k = 0; k < n_configs; k++){
+            update(Q.col(k), zero, zero, fb_state.time, fb_state);
+            storeBatchResult(*this, request, k, nj, result);
+        }
+        if(!saved_joint_state.time.isNull())
+            update(saved_joint_state, saved_fb_state);
+        return;
+    }
+
+    // Workspaces know the chains that exist at creation time, so recreate them if chains have been added since
+    const uint n_threads = getBatchThreads();
+    if(batch_workspaces.size() != n_threads || batch_workspaces[0]->noOfChains() != chains.size()){
+        batch_workspaces.clear();
+        for(uint i = 0; i < n_threads; i++)
+            batch_workspaces.push_back(createWorkspace());
+    }
+
+    auto evaluate = [&](uint k, uint thread){
+        RobotModelWorkspace& ws = *batch_workspaces[thread];
+        ws.update(Q.col(k), zero, zero, fb_state);
+        storeBatchResult(ws, request, k, nj, result);
+    };
+    if(batch_pool)
+        batch_pool->parallelFor(n_configs, evaluate);
+    else{
+        for(uint k = 0; k < n_configs; k++)
+            evaluate(k, 0);
+    }
+}
+
+void RobotModel::setBatchThreads(uint n_threads, const std::vector<int>& cores){
+    if(n_threads == 0)
+        throw std::invalid_argument("RobotModel::setBatchThreads: Number of threads has to be > 0");
+    batch_pool.reset();
+    batch_workspaces.clear();
+    if(n_threads == 1)
+        return;
+    if(!supportsWorkspaces()){
+        LOG_WARN("RobotModel: This robot model does not support workspaces, batches will be evaluated sequentially");
+        return;
+    }
+    batch_pool = std::make_shared<WorkerPool>(n_threads, cores);
+}
+
+uint RobotModel::getBatchThreads() const{
+    return batch_pool ? batch_pool->nThreads() : 1;
+}
+
+const base::samples::RigidBodyStateSE3& RobotModel::rigidBodyState(const ChainId chain){
+    return rigidBodyState(chainRoot(chain), chainTip(chain));
+}
+
+const base::MatrixXd& RobotModel::spaceJacobian(const ChainId chain){
+    return spaceJacobian(chainRoot(chain), chainTip(chain));
+}
+
+const base::MatrixXd& RobotModel::bodyJacobian(const ChainId chain){
+    return bodyJacobian(chainRoot(chain), chainTip(chain));
+}
+
+const base::Acceleration& RobotModel::spatialAccelerationBias(const ChainId chain){
+    return spatialAccelerationBias(chainRoot(chain), chainTip(chain));
+}
+
+void RobotModel::setJointOrder(const std::vector<std::string>& names){
+    if(names.size() != actuated_joint_names.size()){
+        LOG_ERROR("Joint order has %i entries, but robot model has %i actuated joints", names.size(), actuated_joint_names.size());
+        throw std::invalid_argument("Invalid joint order");
+    }
+    std::vector<int> idx(names.size());
+    for(size_t i = 0; i < names.size(); i++){
+        if(!hasActuatedJoint(names[i]) || std::count(names.begin(), names.end(), names[i]) != 1){
+            LOG_ERROR("Joint %s in joint order is either not an actuated joint of the robot model or given more than once", names[i].c_str());
+            throw std::invalid_argument("Invalid joint order");
+        }
+        idx[i] = std::find(joint_state.names.begin(), joint_state.names.end(), names[i]) - joint_state.names.begin();
+    }
+    joint_order = names;
+    joint_order_idx = idx;
+    batch_workspaces.clear();
+    concurrent_workspaces.clear();
+}
+
+void RobotModel::setJointStateRaw(const Eigen::Ref<const base::VectorXd>& q,
+                                  const Eigen::Ref<const base::VectorXd>& qd,
+                                  const Eigen::Ref<const base::VectorXd>& qdd,
+                                  const base::Time& time){
+    const size_t n = joint_order_idx.size();
+    if(q.size() != n || qd.size() != n || qdd.size() != n){
+        LOG_ERROR("Size of raw joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q.size(), qd.size(), qdd.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+    if(time.isNull()){
+        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
+        throw std::runtime_error("Invalid joint state");
+    }
+    for(size_t i = 0; i < n; i++){
+        base::JointState& state = joint_state.elements[joint_order_idx[i]];
+        state.position = q[i];
+        state.speed = qd[i];
+        state.acceleration = qdd[i];
+    }
+    joint_state.time = time;
+}
 
 uint RobotModel::jointIndex(const std::string &joint_name){
     uint idx = std::find(joint_names.begin(), joint_names.end(), joint_name) - joint_names.begin();
@@ -65,6 +425,33 @@ bool RobotModel::hasJoint(const std::string &joint_name){
     return std::find(joint_names.begin(), joint_names.end(), joint_name) != joint_names.end();
 }
 
+std::vector<int> RobotModel::chainJointIndices(const std::string& root_frame, const std::string& tip_frame){
+    urdf::LinkConstSharedPtr root = robot_urdf->getLink(root_frame);
+    urdf::LinkConstSharedPtr tip = robot_urdf->getLink(tip_frame);
+    if(!root || !tip){
+        LOG_ERROR("RobotModel: Requested joints of chain %s -> %s, but one of these links is not in the robot model", root_frame.c_str(), tip_frame.c_str());
+        throw std::invalid_argument("Invalid chain");
+    }
+
+    // The path between root and tip goes through their closest common ancestor. Collect the (non-fixed) joints on both branches
+    std::vector<std::string> root_ancestors;
+    for(urdf::LinkConstSharedPtr l = root; l; l = l->getParent())
+        root_ancestors.push_back(l->name);
+
+    std::vector<int> idx;
+    urdf::LinkConstSharedPtr l = tip;
+    for(; l && std::find(root_ancestors.begin(), root_ancestors.end(), l->name) == root_ancestors.end(); l = l->getParent()){
+        if(hasJoint(l->parent_joint->name))
+            idx.push_back(jointIndex(l->parent_joint->name));
+    }
+    for(urdf::LinkConstSharedPtr r = root; r && l && r->name != l->name; r = r->getParent()){
+        if(hasJoint(r->parent_joint->name))
+            idx.push_back(jointIndex(r->parent_joint->name));
+    }
+    std::sort(idx.begin(), idx.end());
+    return idx;
+}
+
 bool RobotModel::hasActuatedJoint(const std::string &joint_name){
     return std::find(actuated_joint_names.begin(), actuated_joint_names.end(), joint_name) != actuated_joint_names.end();
 }
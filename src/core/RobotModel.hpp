@@ -10,12 +10,19 @@
 #include <base/samples/Wrenches.hpp>
 #include <base/commands/Joints.hpp>
 #include "RobotModelConfig.hpp"
+#include "RobotModelWorkspace.hpp"
+#include "RobotModelBatch.hpp"
 #include <urdf_world/world.h>
 
 namespace wbc{
 
+class WorkerPool;
+
 std::vector<std::string> operator+(std::vector<std::string> a, std::vector<std::string> b);
 
+/** Integer id of an interned frame name, see RobotModel::frameId()*/
+typedef int FrameId;
+
 /**
  * @brief Interface for all robot models. This has to provide all kinematics and dynamics information that is required for WBC
  */
@@ -57,6 +64,44 @@ protected:
     // Helper
     base::samples::Joints joint_state_out;
 
+    std::vector<std::string> frame_names;                /** Interned frame names, indexed by FrameId*/
+    std::vector< std::pair<FrameId,FrameId> > chains;    /** Interned kinematic chains (root, tip), indexed by ChainId*/
+    std::vector<ChainId> contact_chain_ids;              /** Chains world frame -> contact link for all active contacts*/
+    std::vector<std::string> contact_chain_names;        /** Contact names for which contact_chain_ids have been resolved*/
+
+    /** Called once for each new chain, see chainId(). Robot models can overload this to allocate per-chain data. The frame names
+     *  are not validated at this point, this is left to the first query with the given chain id*/
+    virtual void addChain(const ChainId chain){}
+
+    /** Throw if the given chain id is invalid*/
+    void checkChainId(const ChainId chain) const;
+
+    std::vector<std::string> joint_order;     /** Order of the joints in the raw state vectors passed to update(q,qd,qdd,...), see setJointOrder()*/
+    std::vector<int> joint_order_idx;         /** Index of each entry of the raw state vectors in joint_state*/
+
+    uint structure_counter;                   /** Incremented whenever the model is (re-)configured or the contact configuration changes, see structureCounter()*/
+    bool fixed_contact_set;                   /** See setFixedContactSet()*/
+    ActiveContacts all_contacts;              /** Helper for the fixed contact set, see setActiveContacts()*/
+
+    std::shared_ptr<WorkerPool> batch_pool;                 /** Threads for evaluateBatch(), see setBatchThreads(). Null if disabled*/
+    std::vector<RobotModelWorkspacePtr> batch_workspaces;   /** One workspace per batch thread, created on demand in evaluateBatch()*/
+
+    std::vector<RobotModelWorkspacePtr> concurrent_workspaces;  /** Workspaces of the threads 1..n-1 in concurrent queries, see prepareConcurrentQueries()*/
+    std::vector<uint64_t> concurrent_workspace_stamps;          /** Value of concurrent_stamp at the last update of each concurrent workspace*/
+    uint64_t concurrent_stamp;                                  /** Incremented in prepareConcurrentQueries() whenever the robot state changed*/
+    base::VectorXd concurrent_q, concurrent_qd, concurrent_qdd; /** Robot state for the concurrent workspaces, in joint order*/
+    base::samples::RigidBodyStateSE3 concurrent_fb_state;       /** Floating base state for the concurrent workspaces*/
+
+    /** Return the workspace the calling thread has to use for the chain id queries and comJacobian(), see beginConcurrentQueries(). Updates the workspace if the robot
+     *  state changed since its last use. Returns null if the calling thread queries the robot model itself*/
+    RobotModelWorkspace* concurrentWorkspace();
+
+    /** Check the raw state vectors and copy them to joint_state using joint_order_idx. Does not perform any name lookups*/
+    void setJointStateRaw(const Eigen::Ref<const base::VectorXd>& q,
+                          const Eigen::Ref<const base::VectorXd>& qd,
+                          const Eigen::Ref<const base::VectorXd>& qdd,
+                          const base::Time& time);
+
 public:
     RobotModel();
     virtual ~RobotModel(){}
@@ -76,9 +121,38 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3()) = 0;
 
+    /**
+     * @brief Update the robot configuration from raw state vectors. Same as update(joint_state, floating_base_state), but the joint states
+     *  are given as contiguous vectors in the order defined by setJointOrder(). The mapping to the internal state is precomputed, so no name lookups
+     *  are performed. The result is identical to the one of the named version.
+     * @param q Joint positions. Size has to be jointOrder().size()
+     * @param qd Joint velocities. Size has to be jointOrder().size()
+     * @param qdd Joint accelerations. Size has to be jointOrder().size()
+     * @param time Time stamp of the joint state
+     * @param floating_base_state Optional, only for floating base robots: update the floating base state of the robot model.
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3()) = 0;
+
+    /**
+     * @brief Set the order of the joints in the raw state vectors passed to update(q,qd,qdd,...). Has to contain each actuated joint exactly once. After configure(), the
+     *  order is the same as actuatedJointNames(). Throws if the given names are invalid.
+     */
+    virtual void setJointOrder(const std::vector<std::string>& names);
+
+    /** @brief Return the order of the joints in the raw state vectors passed to update(q,qd,qdd,...), see setJointOrder()*/
+    const std::vector<std::string>& jointOrder() const {return joint_order;}
+
     /** Returns the current status of the given joint names */
     const base::samples::Joints& jointState(const std::vector<std::string> &joint_names);
 
+    /** Returns the current status of all joints without name lookups. The joint order is backend specific and does not change until the next call of configure(), so that
+     *  callers can resolve the index of each joint once from the names of the returned state*/
+    const base::samples::Joints& jointState() const {return joint_state;}
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd) = 0;
 
@@ -124,6 +198,87 @@ public:
       */
     virtual const base::MatrixXd &jacobianDot(const std::string &root_frame, const std::string &tip_frame) = 0;
 
+    /** @brief Return the id of the given frame name. Interns the name if called for the first time with this name. Ids are valid until the next call to configure()*/
+    FrameId frameId(const std::string& frame_name);
+
+    /** @brief Return the name of the frame with the given id*/
+    const std::string& frameName(const FrameId frame) const;
+
+    /** @brief Return the id of the kinematic chain between root and tip frame. Interns the chain if called for the first time with these frames. Resolve
+     *  the chain ids once, e.g., on task creation, and use the chain id overloads of rigidBodyState(), spaceJacobian(), bodyJacobian() and
+     *  spatialAccelerationBias() in the control loop, which avoid any string operations. Ids are valid until the next call to configure()*/
+    ChainId chainId(const std::string& root_frame, const std::string& tip_frame);
+
+    /** @brief Return the root frame of the given chain*/
+    const std::string& chainRoot(const ChainId chain) const;
+
+    /** @brief Return the tip frame of the given chain*/
+    const std::string& chainTip(const ChainId chain) const;
+
+    /** @brief Return the chain ids world frame -> contact link for all active contacts, in the same order as getActiveContacts()*/
+    const std::vector<ChainId>& contactChainIds();
+
+    /** @brief Same as rigidBodyState(root_frame, tip_frame), with the chain given by its id. The default implementation forwards to the frame name version*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+
+    /** @brief Same as spaceJacobian(root_frame, tip_frame), with the chain given by its id. The default implementation forwards to the frame name version*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+
+    /** @brief Same as bodyJacobian(root_frame, tip_frame), with the chain given by its id. The default implementation forwards to the frame name version*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+
+    /** @brief Same as spatialAccelerationBias(root_frame, tip_frame), with the chain given by its id. The default implementation forwards to the frame name version*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+
+    /** @brief Prepare the model for concurrent queries from n_threads threads, including the calling thread. Has to be called from a single thread after update() and after all
+     *  chains have been interned (see chainId()). Requires supportsWorkspaces() to be true. Copies the current robot state and (re-)creates one workspace for each of the
+     *  threads 1..n_threads-1, if required (see createWorkspace()). Afterwards and until the next call of update(), the chain id overloads of rigidBodyState(), spaceJacobian(),
+     *  bodyJacobian() and spatialAccelerationBias(), as well as comJacobian(), contactChainIds() and jointIndex() may be called from all threads at the same time, as long as
+     *  each thread t > 0 has called beginConcurrentQueries(t) before. The calling thread (t = 0) queries the robot model itself, all other threads are routed to their own
+     *  workspace, which is updated on the first query after the robot state changed. No locks are taken and the sequential queries are not affected.
+     *  All other queries, in particular the frame name overloads and the dynamics, must not be called concurrently*/
+    void prepareConcurrentQueries(uint n_threads);
+
+    /** @brief Route the concurrent queries of the calling thread to the workspace of the given thread, see prepareConcurrentQueries(). Thread 0 queries the robot model itself.
+     *  Has to be reverted with endConcurrentQueries() in the same thread*/
+    void beginConcurrentQueries(uint thread);
+
+    /** @brief Stop routing the queries of the calling thread to a workspace, see beginConcurrentQueries()*/
+    void endConcurrentQueries();
+
+    /** @brief Return true if the robot model can create workspaces for the evaluation from other threads, see createWorkspace(). Workspaces are the only mechanism for
+     *  evaluating a robot model from several threads, i.e., they are required for the parallel batch evaluation (see evaluateBatch()) and for concurrent queries
+     *  (see prepareConcurrentQueries()). Default is false*/
+    virtual bool supportsWorkspaces() const {return false;}
+
+    /** @brief Create a workspace that evaluates this robot model independently of the robot model state and of all other workspaces, see RobotModelWorkspace. Use one workspace
+     *  per thread to evaluate the same robot for many states in parallel, without locks and without loading the model again. Has to be called after configure(). The workspace
+     *  can query all chains that have been interned at this point (see chainId()) and uses the current joint order (see setJointOrder()). It stays valid after reconfiguring
+     *  the robot model, but keeps evaluating the model it was created with. Throws if supportsWorkspaces() is false*/
+    virtual RobotModelWorkspacePtr createWorkspace();
+
+    /**
+     * @brief Evaluate the requested quantities for many joint configurations, e.g., for workspace analysis or sampling based planning. If supportsWorkspaces() is true,
+     *  the configurations are distributed over the threads given in setBatchThreads(), each thread evaluating its own workspace (see createWorkspace()), and the state of the
+     *  robot model is not changed. Otherwise, the configurations are evaluated sequentially by calling update() on the robot model itself, and the previous state of the
+     *  robot model is restored afterwards. All joint velocities and accelerations are zero.
+     * @param Q Joint positions, one column per configuration. Number of rows has to be jointOrder().size()
+     * @param request Quantities to compute. All chains have to be interned (see chainId()) and start at the world frame
+     * @param result Output buffers, see BatchResult. Only reallocated if the number of configurations or the request changes
+     */
+    void evaluateBatch(const Eigen::Ref<const base::MatrixXd>& Q, const BatchRequest& request, BatchResult& result);
+
+    /**
+     * @brief Set the number of threads used by evaluateBatch(), including the calling thread. The worker threads are created here and kept until the next call.
+     *  Default is 1, i.e., sequential evaluation. Falls back to sequential evaluation with a warning if supportsWorkspaces() is false.
+     * @param n_threads Number of threads. Has to be > 0
+     * @param cores Optional: CPU cores to pin the worker threads to, one entry per worker thread, see WorkerPool
+     */
+    void setBatchThreads(uint n_threads, const std::vector<int>& cores = std::vector<int>());
+
+    /** @brief Return the number of threads used by evaluateBatch(), see setBatchThreads()*/
+    uint getBatchThreads() const;
+
     /** @brief Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix() = 0;
 
@@ -157,6 +312,11 @@ public:
     /** @brief Return True if given joint name is available in robot model, false otherwise*/
     bool hasJoint(const std::string& joint_name);
 
+    /** @brief Return the indices (see jointIndex()) of all joints that can have an influence on the kinematics of the given chain, in ascending order. All other
+     *  columns of the Jacobians of the chain are always zero. The default implementation returns the joints on the path between root and tip frame in the URDF tree.
+     *  Throws if one of the frames does not exist*/
+    virtual std::vector<int> chainJointIndices(const std::string& root_frame, const std::string& tip_frame);
+
     /** @brief Return True if given joint name is an actuated joint in robot model, false otherwise*/
     bool hasActuatedJoint(const std::string& joint_name);
 
@@ -168,12 +328,27 @@ public:
     /** @brief Compute and return center of mass expressed in base frame*/
     virtual const base::samples::RigidBodyStateSE3& centerOfMass() = 0;
 
-    /** @brief Provide information about which link is currently in contact with the environment*/
+    /** @brief Provide information about which link is currently in contact with the environment. If the fixed contact set is enabled (see setFixedContactSet()),
+     *  the contacts are extended to all contact points of the robot model configuration, where the contact points that are not given are inactive*/
     void setActiveContacts(const ActiveContacts &contacts);
 
+    /**
+     * @brief If true, the active contacts always contain all contact points of the robot model configuration (see RobotModelConfig::contact_points), so that the contact
+     *  structure (see structureCounter()) does not change if the contacts are switched at runtime. Contact points that are not given in setActiveContacts() are added as
+     *  inactive contacts, i.e., scenes pin their wrenches to zero. Throws if the current active contacts contain a contact point that is not in the configuration. Default is false.
+     */
+    void setFixedContactSet(bool fixed);
+
+    /** @brief Return true if the fixed contact set is enabled, see setFixedContactSet()*/
+    bool hasFixedContactSet() const {return fixed_contact_set;}
+
     /** @brief Provide links names that are possibly in contact with the environment (typically the end effector links)*/
     const ActiveContacts& getActiveContacts(){return active_contacts;}
 
+    /** @brief Return a counter that is incremented whenever the model is (re-)configured or the contact names or contact parameters (friction coefficient, surface size)
+     *  change. Switching the activation of a contact does not change the counter. Constraints use this to decide if their structure has to be rebuilt.*/
+    uint structureCounter() const {return structure_counter;}
+
     /** @brief Return number of joints*/
     uint noOfJoints(){return jointNames().size();}
 
@@ -204,6 +379,19 @@ public:
 };
 typedef std::shared_ptr<RobotModel> RobotModelPtr;
 
+/**
+ * @brief Route the concurrent queries of the calling thread to the workspace of the given thread for the lifetime of this object, see RobotModel::beginConcurrentQueries()
+ */
+class ConcurrentQueryScope{
+public:
+    ConcurrentQueryScope(RobotModel& robot_model, uint thread) : robot_model(robot_model){robot_model.beginConcurrentQueries(thread);}
+    ~ConcurrentQueryScope(){robot_model.endConcurrentQueries();}
+    ConcurrentQueryScope(const ConcurrentQueryScope&) = delete;
+    ConcurrentQueryScope& operator=(const ConcurrentQueryScope&) = delete;
+protected:
+    RobotModel& robot_model;
+};
+
 template<typename T> RobotModel* createT(){return new T;}
 
 struct RobotModelFactory{
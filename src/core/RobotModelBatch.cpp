@@ -0,0 +1,44 @@
+#include "RobotModelBatch.hpp"
+
+namespace wbc{
+
+BatchRequest::BatchRequest() :
+    quantities(0){
+    floating_base_state.pose.position.setZero();
+    floating_base_state.pose.orientation.setIdentity();
+    floating_base_state.twist.linear.setZero();
+    floating_base_state.twist.angular.setZero();
+    floating_base_state.acceleration.linear.setZero();
+    floating_base_state.acceleration.angular.setZero();
+}
+
+static void resizeChainBuffers(std::vector<base::MatrixXd>& buffers, const bool requested, const size_t n_chains, const unsigned int rows, const unsigned int cols){
+    if(!requested){
+        buffers.clear();
+        return;
+    }
+    buffers.resize(n_chains);
+    for(auto& b : buffers)
+        b.resize(rows, cols);
+}
+
+static void resizeBuffer(base::MatrixXd& buffer, const bool requested, const unsigned int rows, const unsigned int cols){
+    if(requested)
+        buffer.resize(rows, cols);
+    else
+        buffer.resize(0,0);
+}
+
+void BatchResult::resize(const BatchRequest& request, const unsigned int n_configs, const unsigned int nj){
+    const size_t n_chains = request.chains.size();
+    resizeChainBuffers(positions, request.has(batch_pose), n_chains, 3, n_configs);
+    resizeChainBuffers(orientations, request.has(batch_pose), n_chains, 4, n_configs);
+    resizeChainBuffers(space_jacobians, request.has(batch_space_jacobian), n_chains, 6, nj*n_configs);
+    resizeChainBuffers(body_jacobians, request.has(batch_body_jacobian), n_chains, 6, nj*n_configs);
+    resizeBuffer(com, request.has(batch_com), 3, n_configs);
+    resizeBuffer(com_jacobians, request.has(batch_com_jacobian), 3, nj*n_configs);
+    resizeBuffer(inertia_matrices, request.has(batch_inertia), nj, nj*n_configs);
+    resizeBuffer(bias_forces, request.has(batch_bias_forces), nj, n_configs);
+}
+
+}
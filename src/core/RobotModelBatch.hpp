@@ -0,0 +1,58 @@
+#ifndef ROBOT_MODEL_BATCH_HPP
+#define ROBOT_MODEL_BATCH_HPP
+
+#include <vector>
+#include <base/Eigen.hpp>
+#include <base/samples/RigidBodyStateSE3.hpp>
+#include "RobotModelWorkspace.hpp"
+
+namespace wbc{
+
+/** Quantities that can be requested in RobotModel::evaluateBatch(). Can be combined with bitwise or*/
+enum BatchQuantity{batch_pose = 1,              /** Position and orientation of each requested chain*/
+                   batch_space_jacobian = 2,    /** Space Jacobian of each requested chain*/
+                   batch_body_jacobian = 4,     /** Body Jacobian of each requested chain*/
+                   batch_com = 8,               /** Center of mass position*/
+                   batch_com_jacobian = 16,     /** CoM Jacobian*/
+                   batch_inertia = 32,          /** Joint space inertia matrix*/
+                   batch_bias_forces = 64};     /** Bias forces. Since all joint velocities are zero, these are the gravity forces*/
+
+/**
+ * @brief Quantities to compute in RobotModel::evaluateBatch()
+ */
+struct BatchRequest{
+    BatchRequest();
+
+    /** Bitwise or of the requested quantities, see BatchQuantity*/
+    unsigned int quantities;
+    /** Chains for the chain dependent quantities (pose, Jacobians), see RobotModel::chainId()*/
+    std::vector<ChainId> chains;
+    /** Only for floating base robots: Pose of the floating base, same for all configurations. Twist and acceleration are ignored. Default is the identity*/
+    base::samples::RigidBodyStateSE3 floating_base_state;
+
+    bool has(const BatchQuantity q) const {return (quantities & q) != 0;}
+};
+
+/**
+ * @brief Results of RobotModel::evaluateBatch() in structure-of-arrays layout. Each quantity is stored for all configurations in one contiguous, column major matrix. The result
+ *  of configuration k is the k-th column (vectors) or the k-th block of n columns (matrices with n columns), e.g., the space Jacobian of chain c for configuration k is
+ *  space_jacobians[c].middleCols(k*nj,nj), where nj is the number of robot joints. Column order of all Jacobians and matrices is the same as in RobotModel.
+ *  Only the requested quantities are allocated, all others are empty. Passing the same result to several calls with the same request does not allocate memory.
+ */
+struct BatchResult{
+    std::vector<base::MatrixXd> positions;          /** Per chain: 3 x n_configs, position of the tip frame in world coordinates*/
+    std::vector<base::MatrixXd> orientations;       /** Per chain: 4 x n_configs, orientation of the tip frame as quaternion coefficients (x,y,z,w)*/
+    std::vector<base::MatrixXd> space_jacobians;    /** Per chain: 6 x (nj*n_configs)*/
+    std::vector<base::MatrixXd> body_jacobians;     /** Per chain: 6 x (nj*n_configs)*/
+    base::MatrixXd com;                             /** 3 x n_configs, center of mass in world coordinates*/
+    base::MatrixXd com_jacobians;                   /** 3 x (nj*n_configs)*/
+    base::MatrixXd inertia_matrices;                /** nj x (nj*n_configs)*/
+    base::MatrixXd bias_forces;                     /** nj x n_configs*/
+
+    /** Allocate the buffers of the requested quantities for n_configs configurations of a robot with nj joints and free all others*/
+    void resize(const BatchRequest& request, const unsigned int n_configs, const unsigned int nj);
+};
+
+} // namespace wbc
+
+#endif
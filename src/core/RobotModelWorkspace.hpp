@@ -0,0 +1,70 @@
+#ifndef ROBOT_MODEL_WORKSPACE_HPP
+#define ROBOT_MODEL_WORKSPACE_HPP
+
+#include <memory>
+#include <base/Eigen.hpp>
+#include <base/samples/RigidBodyStateSE3.hpp>
+#include <base/Acceleration.hpp>
+
+namespace wbc{
+
+/** Integer id of an interned kinematic chain, i.e., a pair of root and tip frame, see RobotModel::chainId()*/
+typedef int ChainId;
+
+/**
+ * @brief Per-thread evaluation state of a robot model, see RobotModel::createWorkspace(). A workspace shares the immutable model description (kinematic tree, inertias, joint
+ *  order, chains) with the robot model it was created from and only owns the state dependent data, e.g., one pinocchio::Data per workspace. Creating a workspace neither
+ *  parses the URDF nor rebuilds the model. All query results are stored in the workspace, so that different workspaces of the same robot model can be updated and queried
+ *  from different threads at the same time without any locking. A single workspace must not be used by several threads at the same time.
+ *
+ *  All queries refer to the state given in the last call to update() and are computed at most once per update(). The returned references stay valid until the workspace is
+ *  destroyed, their content changes with the next call to update(). The time stamps of the returned states are not set.
+ */
+class RobotModelWorkspace{
+public:
+    virtual ~RobotModelWorkspace(){}
+
+    /**
+     * @brief Set the robot state and compute the forward kinematics
+     * @param q Joint positions in the order of RobotModel::jointOrder() at the time the workspace was created
+     * @param qd Joint velocities, same order as q
+     * @param qdd Joint accelerations, same order as q
+     * @param floating_base_state Only for floating base robots: Pose, twist and acceleration of the floating base
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3()) = 0;
+
+    /** @brief Same as RobotModel::rigidBodyState(). The chain has to be known to the robot model when the workspace is created*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain) = 0;
+
+    /** @brief Same as RobotModel::spaceJacobian(). The chain has to be known to the robot model when the workspace is created*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain) = 0;
+
+    /** @brief Same as RobotModel::bodyJacobian(). The chain has to be known to the robot model when the workspace is created*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain) = 0;
+
+    /** @brief Same as RobotModel::spatialAccelerationBias(). The chain has to be known to the robot model when the workspace is created*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain) = 0;
+
+    /** @brief Same as RobotModel::comJacobian()*/
+    virtual const base::MatrixXd &comJacobian() = 0;
+
+    /** @brief Same as RobotModel::centerOfMass()*/
+    virtual const base::samples::RigidBodyStateSE3 &centerOfMass() = 0;
+
+    /** @brief Same as RobotModel::jointSpaceInertiaMatrix()*/
+    virtual const base::MatrixXd &jointSpaceInertiaMatrix() = 0;
+
+    /** @brief Same as RobotModel::biasForces()*/
+    virtual const base::VectorXd &biasForces() = 0;
+
+    /** @brief Return the number of chains that can be queried in this workspace, i.e., the number of chains of the robot model at creation time*/
+    virtual uint noOfChains() const = 0;
+};
+typedef std::shared_ptr<RobotModelWorkspace> RobotModelWorkspacePtr;
+
+} // namespace wbc
+
+#endif
@@ -0,0 +1,70 @@
+#include "ScaledQPSolver.hpp"
+#include <stdexcept>
+
+namespace wbc{
+
+QPSolverRegistry<ScaledQPSolver> ScaledQPSolver::reg("scaled_qp");
+
+ScaledQPSolver::ScaledQPSolver(const std::string& solver_type, QPScaling::Method method, uint update_interval) :
+    solver_type(solver_type){
+    scaling.setMethod(method);
+    scaling.setUpdateInterval(update_interval);
+    hqp_scaled.resize(1);
+}
+
+ScaledQPSolver::ScaledQPSolver(QPSolverPtr solver, QPScaling::Method method, uint update_interval) :
+    solver(solver){
+    if(!solver)
+        throw std::invalid_argument("ScaledQPSolver: Invalid solver pointer");
+    scaling.setMethod(method);
+    scaling.setUpdateInterval(update_interval);
+    hqp_scaled.resize(1);
+}
+
+ScaledQPSolver::~ScaledQPSolver(){
+}
+
+QPSolverPtr ScaledQPSolver::getSolver(){
+    if(!solver)
+        solver.reset(QPSolverFactory::createInstance(solver_type));
+    return solver;
+}
+
+bool ScaledQPSolver::sparseInput() const{
+    if(!solver)
+        solver.reset(QPSolverFactory::createInstance(solver_type));
+    return solver->sparseInput();
+}
+
+void ScaledQPSolver::solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output){
+
+    if(hierarchical_qp.size() != 1)
+        throw std::runtime_error("ScaledQPSolver::solve: Number of task hierarchies must be 1 for the current implementation");
+
+    // reset() of the wrapper resets the wrapped solver and enforces new scaling factors
+    if(!configured){
+        getSolver()->reset();
+        scaling.reset();
+        configured = true;
+    }
+
+    const base::Time start = base::Time::now();
+    scaling.scale(hierarchical_qp[0], hqp_scaled[0]);
+    hqp_scaled.time = hierarchical_qp.time;
+    hqp_scaled.Wq = hierarchical_qp.Wq;
+    const base::Time scaling_time = base::Time::now() - start;
+
+    solver->setTimeBudget(time_budget > 0 ? std::max(time_budget - scaling_time.toMicroseconds(), 1.0) : time_budget);
+    solver->solve(hqp_scaled, solver_output);
+    scaling.unscale(solver_output);
+
+    // The residuals of the wrapped solver refer to the scaled problem
+    stats = solver->getStats();
+    stats.setup_time += scaling_time.toMicroseconds();
+    stats.primal_residual = constraintViolation(hierarchical_qp[0], solver_output);
+    const base::VectorXd& D = scaling.variableScaling();
+    if(D.size() > 0)
+        stats.dual_residual /= scaling.costScaling() * D.minCoeff();
+}
+
+}
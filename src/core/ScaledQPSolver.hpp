@@ -0,0 +1,68 @@
+#ifndef WBC_CORE_SCALED_QP_SOLVER_HPP
+#define WBC_CORE_SCALED_QP_SOLVER_HPP
+
+#include "QPSolver.hpp"
+#include "QPScaling.hpp"
+
+namespace wbc{
+
+/**
+ * @brief Wraps an arbitrary QP solver and solves an equilibrated version of the quadratic program (see QPScaling). The solution is transformed back to the original variables,
+ *  so the wrapper can be passed to any scene instead of the solver itself, e.g.
+ *  \code
+ *  QPSolverPtr solver = std::make_shared<ScaledQPSolver>(std::make_shared<QPOASESSolver>());
+ *  \endcode
+ *  The wrapper is also registered as solver plugin "scaled_qp", which wraps the plugin given by setSolverType(), and can be enabled for the solver of a scene with
+ *  Scene::setQPScaling(). The time budget is forwarded to the wrapped solver. The statistics (see getStats()) are the ones of the wrapped solver, with the residuals
+ *  transformed to the original problem: The primal residual is the constraint violation of the unscaled solution. The dual residual is an upper bound, since the scaled
+ *  dual residual \f$c\mathbf{D}\mathbf{r}\f$ is only available as norm, i.e., \f$||\mathbf{r}||_\infty \leq ||c\mathbf{D}\mathbf{r}||_\infty / (c \cdot min(\mathbf{D}))\f$.
+ *  The time for the scaling is included in the setup time. Only quadratic programs with a single priority level are supported.
+ */
+class ScaledQPSolver : public QPSolver{
+private:
+    static QPSolverRegistry<ScaledQPSolver> reg;
+
+public:
+    /**
+     * @param solver_type Name of the QP solver plugin for the scaled quadratic program, see QPSolverFactory. The plugin has to be registered, i.e., its library has to be linked.
+     * @param method Scaling method, see QPScaling::setMethod()
+     * @param update_interval Recompute the scaling factors every n calls, see QPScaling::setUpdateInterval()
+     */
+    ScaledQPSolver(const std::string& solver_type = "qpoases", QPScaling::Method method = QPScaling::ruiz, uint update_interval = 100);
+    /**
+     * @param solver Solver for the scaled quadratic program
+     * @param method Scaling method, see QPScaling::setMethod()
+     * @param update_interval Recompute the scaling factors every n calls, see QPScaling::setUpdateInterval()
+     */
+    ScaledQPSolver(QPSolverPtr solver, QPScaling::Method method = QPScaling::ruiz, uint update_interval = 100);
+    virtual ~ScaledQPSolver();
+
+    /**
+     * @brief solve Scale the given quadratic program, solve it with the wrapped solver and unscale the solution
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. Only one priority level is supported.
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output);
+
+    virtual bool sparseInput() const;
+
+    /** Set the QP solver plugin for the scaled quadratic program. The current wrapped solver is discarded*/
+    void setSolverType(const std::string& name){solver_type = name; solver.reset(); configured = false;}
+    const std::string& getSolverType() const {return solver_type;}
+
+    /** Wrapped solver, e.g. for setting solver specific options. The instance is created if it does not exist yet*/
+    QPSolverPtr getSolver();
+
+    /** Scaling stage, e.g. for changing the method or reading the scaling factors*/
+    QPScaling& getScaling(){return scaling;}
+
+protected:
+    std::string solver_type;
+    mutable QPSolverPtr solver;   /** Created on first use if only the plugin name is given*/
+    QPScaling scaling;
+    HierarchicalQP hqp_scaled;
+};
+
+}
+
+#endif
@@ -1,14 +1,36 @@
 #include "Scene.hpp"
+#include "ScaledQPSolver.hpp"
 #include <base-logging/Logging.hpp>
 #include "../tasks/JointTask.hpp"
 #include "../tasks/CartesianTask.hpp"
+#include "../tools/WorkerPool.hpp"
+#include "../tools/TripleBuffer.hpp"
+#include <algorithm>
+#include <set>
 
 namespace wbc{
 
+struct Scene::TaskMailbox{
+    struct Reference{
+        base::Time time;
+        base::VectorXd y_ref;
+    };
+
+    TaskMailbox(const TaskConfig& config) :
+        reference(Reference{base::Time(), base::VectorXd::Zero(config.nVariables())}),
+        weights(base::VectorXd::Zero(config.nVariables())),
+        activation(0){
+    }
+    TripleBuffer<Reference> reference;
+    TripleBuffer<base::VectorXd> weights;
+    TripleBuffer<double> activation;
+};
+
 Scene::Scene(RobotModelPtr robot_model, QPSolverPtr solver, const double dt) :
     robot_model(robot_model),
     solver(solver),
-    configured(false){
+    configured(false),
+    variable_blocks_stamp(0){
 }
 
 Scene::~Scene(){
@@ -22,6 +44,8 @@ void Scene::clearTasks(){
         tasks[i].clear();
     }
     tasks.clear();
+    task_handles.clear();
+    task_mailboxes.clear();
     tasks_status.clear();
     configured = false;
 }
@@ -35,6 +59,15 @@ bool Scene::configure(const std::vector<TaskConfig> &config){
         return false;
     }
 
+    // Tasks are identified by name, e.g., in setReference() or getTaskHandle(). Duplicate names would make them indistinguishable
+    std::set<std::string> task_names;
+    for(const TaskConfig& c : config){
+        if(!task_names.insert(c.name).second){
+            LOG_ERROR("Task name %s is used for more than one task. Task names have to be unique", c.name.c_str());
+            return false;
+        }
+    }
+
     for(auto c : config)
         c.validate();
     std::vector< std::vector<TaskConfig> > sorted_config;
@@ -51,6 +84,17 @@ bool Scene::configure(const std::vector<TaskConfig> &config){
     }
     n_task_variables_per_prio = getNTaskVariablesPerPrio(config);
 
+    // Task handles are given by the order of the task configuration
+    task_handles.resize(config.size());
+    for(size_t k = 0; k < config.size(); k++){
+        for(size_t i = 0; i < tasks.size(); i++){
+            for(size_t j = 0; j < tasks[i].size(); j++){
+                if(tasks[i][j]->config.name == config[k].name)
+                    task_handles[k] = tasks[i][j];
+            }
+        }
+    }
+
     for(size_t i = 0; i < tasks.size(); i++){
         for(size_t j = 0; j < tasks[i].size(); j++){
             TaskPtr task = tasks[i][j];
@@ -71,6 +115,16 @@ bool Scene::configure(const std::vector<TaskConfig> &config){
     actuated_joint_weights.names = robot_model->actuatedJointNames();
     std::fill(actuated_joint_weights.elements.begin(), actuated_joint_weights.elements.end(), 1);
 
+    // Joint names of the solver output do not change after configuration, so they don't have to be copied in every call to solve()
+    solver_output_joints.resize(robot_model->noOfActuatedJoints());
+    solver_output_joints.names = robot_model->actuatedJointNames();
+
+    task_mailboxes.resize(task_handles.size());
+    for(size_t k = 0; k < task_handles.size(); k++)
+        task_mailboxes[k] = std::make_shared<TaskMailbox>(task_handles[k]->config);
+    solver_output_snapshot = std::make_shared< TripleBuffer<base::commands::Joints> >(solver_output_joints);
+    tasks_status_snapshot = std::make_shared< TripleBuffer<TasksStatus> >(tasks_status);
+
     wbc_config = config;
 
     // Check WBC config
@@ -101,6 +155,56 @@ bool Scene::configure(const std::vector<TaskConfig> &config){
     return true;
 }
 
+void Scene::updateVariableBlocks(QuadraticProgram& qp, bool torques){
+
+    if(!qp.variable_blocks.empty() && variable_blocks_stamp == robot_model->structureCounter())
+        return;
+
+    const uint nj = robot_model->noOfJoints();
+    const uint na = robot_model->noOfActuatedJoints();
+    const ActiveContacts& contacts = robot_model->getActiveContacts();
+
+    qp.variable_blocks.clear();
+    qp.variable_blocks.push_back(VariableBlock("acceleration", 0, nj));
+    uint start_idx = nj;
+    if(torques){
+        qp.variable_blocks.push_back(VariableBlock("torque", nj, na));
+        start_idx += na;
+    }
+    for(uint i = 0; i < contacts.size(); i++)
+        qp.variable_blocks.push_back(VariableBlock("wrench_" + contacts.names[i], start_idx + i*6, 6));
+    variable_blocks_stamp = robot_model->structureCounter();
+}
+
+void Scene::addTaskToCost(const TaskPtr& task, QuadraticProgram& qp){
+
+    // Weights will be zero if the activation for this task is zero or if the task is in timeout
+    const double scale = task->activation * (!task->timeout);
+    if(scale == 0)
+        return;
+
+    const std::vector<int>& cols = task->active_cols;
+    for(uint c = 0; c < cols.size(); c++)
+        task->Aw_active.col(c) = (scale * joint_weights[cols[c]]) * task->weights_root.cwiseProduct(task->A.col(cols[c]));
+
+    task->H_active.setZero();
+    task->H_active.selfadjointView<Eigen::Upper>().rankUpdate(task->Aw_active.transpose());
+    task->g_active.noalias() = task->Aw_active.transpose() * task->y_ref_root;
+
+    // Scatter to the QP. Since the active columns are sorted, the upper triangle of H_active maps to the upper triangle of H
+    for(uint j = 0; j < cols.size(); j++){
+        for(uint i = 0; i <= j; i++)
+            qp.H(cols[i], cols[j]) += task->H_active(i,j);
+        qp.g(cols[j]) -= task->g_active(j);
+    }
+}
+
+void Scene::symmetrizeCost(QuadraticProgram& qp){
+    const int n = qp.H.cols();
+    for(int j = 0; j < n-1; j++)
+        qp.H.col(j).tail(n-j-1) = qp.H.row(j).tail(n-j-1).transpose();
+}
+
 void Scene::setReference(const std::string& constraint_name, const base::samples::Joints& ref){
     TaskPtr c = getTask(constraint_name);
     if(c->config.type == cart)
@@ -123,6 +227,289 @@ void Scene::setTaskActivation(const std::string& constraint_name, const double a
     getTask(constraint_name)->setActivation(activation);
 }
 
+const TaskPtr& Scene::taskFromHandle(const TaskHandle handle) const{
+    if(handle < 0 || handle >= (int)task_handles.size()){
+        LOG_ERROR("Invalid task handle %i. Number of configured tasks is %i", handle, task_handles.size());
+        throw std::invalid_argument("Invalid task handle");
+    }
+    return task_handles[handle];
+}
+
+void Scene::stackSparseConstraints(uint prio, Constraint::Type type, SparseMatrixXd& mat){
+
+    int nnz = 0;
+    for(const ConstraintPtr& c : constraints[prio]){
+        if(c->type() == type)
+            nnz += c->As().nonZeros();
+    }
+
+    // Fill the compressed storage directly, column by column
+    mat.resizeNonZeros(nnz);
+    int* outer = mat.outerIndexPtr();
+    int* inner = mat.innerIndexPtr();
+    double* values = mat.valuePtr();
+    int k = 0;
+    for(int j = 0; j < mat.cols(); j++){
+        outer[j] = k;
+        int row_offset = 0;
+        for(const ConstraintPtr& c : constraints[prio]){
+            if(c->type() != type)
+                continue;
+            const SparseMatrixXd& As = c->As();
+            for(SparseMatrixXd::InnerIterator it(As, j); it; ++it){
+                inner[k] = it.row() + row_offset;
+                values[k] = it.value();
+                k++;
+            }
+            row_offset += As.rows();
+        }
+    }
+    outer[mat.cols()] = k;
+}
+
+void Scene::updateConstraints(uint prio, uint nq, bool sparse){
+
+    // Structural phase, only if something changed, e.g., the contact points
+    bool rebuild = false, has_bounds = false;
+    uint total_eqs = 0, total_ineqs = 0;
+    for(const ConstraintPtr& c : constraints[prio]){
+        if(c->structureChanged(robot_model, sparse)){
+            c->updateStructure(robot_model, sparse);
+            rebuild = true;
+        }
+        if(c->type() == Constraint::equality)
+            total_eqs += c->size();
+        else if(c->type() == Constraint::inequality)
+            total_ineqs += c->size();
+        else if(c->type() == Constraint::bounds)
+            has_bounds = true;
+    }
+
+    QuadraticProgram& qp = hqp[prio];
+    if(!qp.hasSize(nq, total_eqs, total_ineqs, has_bounds, sparse)){
+        qp.resize(nq, total_eqs, total_ineqs, has_bounds, sparse);
+        rebuild = true;
+    }
+    for(const ConstraintPtr& c : constraints[prio])
+        rebuild |= c->boundQP() != &qp;
+
+    // Write the complete constraints to the QP. From here on, the constraints write directly to the QP storage
+    if(rebuild){
+        if(sparse){
+            stackSparseConstraints(prio, Constraint::equality, qp.A_sparse);
+            stackSparseConstraints(prio, Constraint::inequality, qp.C_sparse);
+        }
+        total_eqs = total_ineqs = 0;
+        for(const ConstraintPtr& c : constraints[prio]){
+            if(c->type() == Constraint::equality){
+                c->bind(qp, total_eqs);
+                total_eqs += c->size();
+            }
+            else if(c->type() == Constraint::inequality){
+                c->bind(qp, total_ineqs);
+                total_ineqs += c->size();
+            }
+            else
+                c->bind(qp, 0);
+        }
+    }
+
+    // Numeric phase
+    if(!parallelUpdate()){
+        for(const ConstraintPtr& c : constraints[prio])
+            c->update(robot_model);
+        return;
+    }
+
+    robot_model->prepareConcurrentQueries(worker_pool->nThreads());
+    concurrent_constraints.clear();
+    for(const ConstraintPtr& c : constraints[prio]){
+        if(c->concurrentUpdate())
+            concurrent_constraints.push_back(c.get());
+        else
+            c->update(robot_model);
+    }
+    auto update_constraint = [this](uint i, uint thread){
+        ConcurrentQueryScope scope(*robot_model, thread);
+        concurrent_constraints[i]->update(robot_model);
+    };
+    worker_pool->parallelFor(concurrent_constraints.size(), update_constraint);
+}
+
+void Scene::updateTasks(){
+
+    auto update_task = [this](uint i, uint){
+        const TaskPtr& task = task_handles[i];
+
+        // Apply the most recent inputs posted from other threads
+        TaskMailbox& mailbox = *task_mailboxes[i];
+        if(mailbox.reference.fetch()){
+            task->time = mailbox.reference.read().time;
+            task->y_ref = mailbox.reference.read().y_ref;
+        }
+        if(mailbox.weights.fetch())
+            task->weights = mailbox.weights.read();
+        if(mailbox.activation.fetch())
+            task->activation = mailbox.activation.read();
+
+        task->checkTimeout();
+        task->update(robot_model);
+
+        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
+        // task phases and we don't want to store the "old" reference value, in case we switch on the task again
+        if(task->activation == 0){
+           task->y_ref.setZero();
+           task->y_ref_root.setZero();
+        }
+    };
+
+    if(parallelUpdate()){
+        robot_model->prepareConcurrentQueries(worker_pool->nThreads());
+        auto update_task_concurrent = [&](uint i, uint thread){
+            ConcurrentQueryScope scope(*robot_model, thread);
+            update_task(i, thread);
+        };
+        worker_pool->parallelFor(task_handles.size(), update_task_concurrent);
+    }
+    else{
+        for(uint i = 0; i < task_handles.size(); i++)
+            update_task(i, 0);
+    }
+}
+
+bool Scene::parallelUpdate() const{
+    return worker_pool && robot_model->supportsWorkspaces();
+}
+
+void Scene::setParallelUpdate(uint n_threads, const std::vector<int>& cores){
+    if(n_threads == 0)
+        throw std::invalid_argument("Scene::setParallelUpdate: Number of threads has to be > 0");
+    worker_pool.reset();
+    if(n_threads == 1)
+        return;
+    if(!robot_model->supportsWorkspaces()){
+        LOG_WARN("Scene: The robot model does not support workspaces, tasks and constraints will be updated sequentially");
+        return;
+    }
+    worker_pool = std::make_shared<WorkerPool>(n_threads, cores);
+}
+
+uint Scene::getParallelUpdate() const{
+    return parallelUpdate() ? worker_pool->nThreads() : 1;
+}
+
+void Scene::setQPScaling(QPScaling::Method method, uint update_interval){
+    if(std::shared_ptr<ScaledQPSolver> scaled = std::dynamic_pointer_cast<ScaledQPSolver>(solver))
+        solver = scaled->getSolver();
+    solver->reset();
+    if(method != QPScaling::none)
+        solver = std::make_shared<ScaledQPSolver>(solver, method, update_interval);
+}
+
+QPScaling::Method Scene::getQPScaling() const{
+    std::shared_ptr<ScaledQPSolver> scaled = std::dynamic_pointer_cast<ScaledQPSolver>(solver);
+    return scaled ? scaled->getScaling().getMethod() : QPScaling::none;
+}
+
+TaskHandle Scene::getTaskHandle(const std::string& name) const{
+    for(size_t i = 0; i < task_handles.size(); i++){
+        if(task_handles[i]->config.name == name)
+            return i;
+    }
+    throw std::invalid_argument("Invalid task name: " + name);
+}
+
+void Scene::setReference(const TaskHandle handle, const base::samples::Joints& ref){
+    const TaskPtr& c = taskFromHandle(handle);
+    if(c->config.type == cart)
+        throw std::runtime_error("Task '" + c->config.name + "' has type cart, but you are trying to set a joint space reference");
+    static_cast<JointTask*>(c.get())->setReference(ref);
+}
+
+void Scene::setReference(const TaskHandle handle, const base::samples::RigidBodyStateSE3& ref){
+    const TaskPtr& c = taskFromHandle(handle);
+    if(c->config.type == jnt)
+        throw std::runtime_error("Task '" + c->config.name + "' has type jnt, but you are trying to set a cartesian reference");
+    static_cast<CartesianTask*>(c.get())->setReference(ref);
+}
+
+void Scene::setReference(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& ref){
+    taskFromHandle(handle)->setReferenceRaw(ref);
+}
+
+void Scene::setTaskWeights(const TaskHandle handle, const base::VectorXd &weights){
+    taskFromHandle(handle)->setWeights(weights);
+}
+
+void Scene::setTaskActivation(const TaskHandle handle, const double activation){
+    taskFromHandle(handle)->setActivation(activation);
+}
+
+void Scene::postReference(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& ref, const base::Time& time){
+    const TaskPtr& task = taskFromHandle(handle);
+    if(task->config.nVariables() != ref.size()){
+        LOG_ERROR("Task %s: Size of reference vector should be %i but is %i", task->config.name.c_str(), task->config.nVariables(), ref.size());
+        throw std::invalid_argument("Invalid task reference input");
+    }
+    TripleBuffer<TaskMailbox::Reference>& mailbox = task_mailboxes[handle]->reference;
+    TaskMailbox::Reference& msg = mailbox.write();
+    msg.time = time.isNull() ? base::Time::now() : time;
+    msg.y_ref = ref;
+    mailbox.publish();
+}
+
+void Scene::postTaskWeights(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& weights){
+    const TaskPtr& task = taskFromHandle(handle);
+    if(task->config.nVariables() != weights.size()){
+        LOG_ERROR("Task %s: Size of weight vector should be %i but is %i", task->config.name.c_str(), task->config.nVariables(), weights.size());
+        throw std::invalid_argument("Invalid task weights");
+    }
+    for(uint i = 0; i < weights.size(); i++){
+        if(weights(i) < 0){
+            LOG_ERROR("Task %s: Weight values should be > 0, but weight %i is %f", task->config.name.c_str(), i, weights(i));
+            throw std::invalid_argument("Invalid task weights");
+        }
+    }
+    TripleBuffer<base::VectorXd>& mailbox = task_mailboxes[handle]->weights;
+    mailbox.write() = weights;
+    mailbox.publish();
+}
+
+void Scene::postTaskActivation(const TaskHandle handle, const double activation){
+    const TaskPtr& task = taskFromHandle(handle);
+    if(activation < 0 || activation > 1){
+        LOG_ERROR("Task %s: Activation has to be between 0 and 1 but is %f", task->config.name.c_str(), activation);
+        throw std::invalid_argument("Invalid task activation");
+    }
+    TripleBuffer<double>& mailbox = task_mailboxes[handle]->activation;
+    mailbox.write() = activation;
+    mailbox.publish();
+}
+
+void Scene::publishSolverOutput(){
+    solver_output_snapshot->write() = solver_output_joints;
+    solver_output_snapshot->publish();
+}
+
+void Scene::publishTasksStatus(){
+    tasks_status_snapshot->write() = tasks_status;
+    tasks_status_snapshot->publish();
+}
+
+bool Scene::readSolverOutput(base::commands::Joints& out){
+    if(!solver_output_snapshot || !solver_output_snapshot->fetch())
+        return false;
+    out = solver_output_snapshot->read();
+    return true;
+}
+
+bool Scene::readTasksStatus(TasksStatus& out){
+    if(!tasks_status_snapshot || !tasks_status_snapshot->fetch())
+        return false;
+    out = tasks_status_snapshot->read();
+    return true;
+}
+
 TaskPtr Scene::getTask(const std::string& name){
 
     for(size_t i = 0; i < tasks.size(); i++){
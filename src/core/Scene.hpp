@@ -6,10 +6,17 @@
 #include "QuadraticProgram.hpp"
 #include "RobotModel.hpp"
 #include "QPSolver.hpp"
+#include "QPScaling.hpp"
 #include "SceneConfig.hpp"
 
 namespace wbc{
 
+class WorkerPool;
+template<typename T> class TripleBuffer;
+
+/** Integer handle of a task within a scene. The handle of a task is its index in the task configuration given to Scene::configure() */
+typedef int TaskHandle;
+
 /**
  * @brief Base class for all wbc scenes.
  */
@@ -18,6 +25,7 @@ protected:
     RobotModelPtr robot_model;
     QPSolverPtr solver;
     std::vector< std::vector<TaskPtr> > tasks;
+    std::vector<TaskPtr> task_handles;          /** Tasks in the order of the task configuration, indexed by TaskHandle*/
     std::vector< std::vector<ConstraintPtr> > constraints;
     TasksStatus tasks_status;
     HierarchicalQP hqp;
@@ -27,6 +35,25 @@ protected:
     JointWeights joint_weights, actuated_joint_weights;
     std::vector<TaskConfig> wbc_config;
     base::VectorXd solver_output;
+    uint variable_blocks_stamp;                 /** RobotModel::structureCounter() at the last call of updateVariableBlocks()*/
+    std::shared_ptr<WorkerPool> worker_pool;    /** Threads for the parallel update of tasks and constraints, see setParallelUpdate(). Null if disabled*/
+    std::vector<Constraint*> concurrent_constraints;  /** Helper for the parallel numeric phase of the constraints in updateConstraints()*/
+
+    /** Task inputs posted from other threads, see postReference(), postTaskWeights() and postTaskActivation()*/
+    struct TaskMailbox;
+    std::vector< std::shared_ptr<TaskMailbox> > task_mailboxes;                   /** Indexed by TaskHandle*/
+    std::shared_ptr< TripleBuffer<base::commands::Joints> > solver_output_snapshot; /** Solver output for other threads, see readSolverOutput()*/
+    std::shared_ptr< TripleBuffer<TasksStatus> > tasks_status_snapshot;             /** Tasks status for other threads, see readTasksStatus()*/
+
+    /**
+     * @brief Publish the current solver output to readSolverOutput(). Has to be called by all scenes at the end of solve()
+     */
+    void publishSolverOutput();
+
+    /**
+     * @brief Publish the current tasks status to readTasksStatus(). Has to be called by all scenes at the end of updateTasksStatus()
+     */
+    void publishTasksStatus();
 
     /**
      * brief Create a task and add it to the WBC scene
@@ -38,13 +65,61 @@ protected:
      */
     void clearTasks();
 
+    /**
+     * @brief Return the task with the given handle. Throw if the handle is invalid
+     */
+    const TaskPtr& taskFromHandle(const TaskHandle handle) const;
+
+    /**
+     * @brief Stack the sparse constraint matrices (see Constraint::As()) of all constraints of the given type and priority vertically into mat.
+     *  mat has to have the correct size already. Memory is only allocated if the number of non-zeros increases.
+     */
+    void stackSparseConstraints(uint prio, Constraint::Type type, SparseMatrixXd& mat);
+
+    /**
+     * @brief Update all constraints of the given priority and write them to the QP of that priority, which is resized to nq variables if required. The structural phase
+     *  of the constraints (see Constraint::updateStructure()) and the copy of the complete constraints to the QP are only executed if the structure of a constraint or the
+     *  size of the QP changed. Otherwise, the constraints only write their state dependent entries directly to the QP storage (see Constraint::bind()).
+     * @param sparse Create the constraint matrices in sparse format, see QuadraticProgram::A_sparse
+     */
+    void updateConstraints(uint prio, uint nq, bool sparse = false);
+
+    /**
+     * @brief Update all tasks from the robot model, i.e., apply the most recent inputs posted from other threads (see postReference()), check their timeout, update task matrix and reference and reset the reference of deactivated tasks. If the parallel
+     *  update is enabled (see setParallelUpdate()), the tasks are distributed over the worker threads.
+     */
+    void updateTasks();
+
+    /**
+     * @brief True if tasks and constraints are updated in parallel, see setParallelUpdate()
+     */
+    bool parallelUpdate() const;
+
+    /**
+     * @brief Describe the variables of the given QP (see QuadraticProgram::variable_blocks) for acceleration based scenes: Joint accelerations, joint torques (only if torques is true)
+     *  and the wrenches of all contacts. Only executed if the structure of the robot model changed since the last call.
+     */
+    void updateVariableBlocks(QuadraticProgram& qp, bool torques);
+
+    /**
+     * @brief Add the weighted task to the cost function of the given QP, i.e., H += Aw^T*Aw and g -= Aw^T*y_ref_root, where Aw is the task matrix weighted
+     *  with the task weights, joint weights, activation and timeout. Only the active columns of the task (see Task::setActiveColumns()) are considered and only
+     *  the upper triangle of H is updated. Call symmetrizeCost() once all tasks have been added.
+     */
+    void addTaskToCost(const TaskPtr& task, QuadraticProgram& qp);
+
+    /**
+     * @brief Copy the upper triangle of the Hessian to the lower triangle
+     */
+    static void symmetrizeCost(QuadraticProgram& qp);
+
 public:
     Scene(RobotModelPtr robot_model, QPSolverPtr solver, const double dt);
     ~Scene();
 
     /**
-     * @brief Configure the WBC scene. Create tasks and sort them by priority
-     * @param config configuration. Size has to be > 0. All tasks have to be valid. See TaskConfig.hpp for more details.
+     * @brief Configure the WBC scene. Create tasks and sort them by priority. The handle of each task is its index in the given config vector, see also getTaskHandle().
+     * @param config configuration. Size has to be > 0. All tasks have to be valid and have unique names. See TaskConfig.hpp for more details.
      */
     virtual bool configure(const std::vector<TaskConfig> &config);
 
@@ -86,6 +161,74 @@ public:
      * @param activation Activation value. Has to be in interval [0.0Scene,1.0]
      */
     void setTaskActivation(const std::string& task_name, double activation);
+
+    /**
+     * @brief Return the handle of the task with the given name. Throw if the task does not exist. The handle can be used to
+     *  set references, weights and activation without any string comparisons.
+     */
+    TaskHandle getTaskHandle(const std::string& name) const;
+
+    /**
+     * @brief Set reference input for a joint space task
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param ref Joint space reference values
+     */
+    void setReference(const TaskHandle handle, const base::samples::Joints& ref);
+
+    /**
+     * @brief Set reference input for a cartesian space task
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param ref Cartesian space reference values
+     */
+    void setReference(const TaskHandle handle, const base::samples::RigidBodyStateSE3& ref);
+
+    /**
+     * @brief Set raw reference input for a task. For joint space tasks, the entries have to be in the same order as TaskConfig::joint_names, for Cartesian tasks
+     *  the reference (linear, angular) has to be given in ref_frame coordinates. Twist or spatial acceleration, depending on the scene.
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param ref Reference vector. Size has to be same as number of task variables
+     */
+    void setReference(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& ref);
+
+    /**
+     * @brief Set Task weights input for a  task
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param weights Weight vector. Size has to be same as number of task variables
+     */
+    void setTaskWeights(const TaskHandle handle, const base::VectorXd &weights);
+
+    /**
+     * @brief Set Task activation for a  task
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param activation Activation value. Has to be in interval [0.0,1.0]
+     */
+    void setTaskActivation(const TaskHandle handle, double activation);
+
+    /**
+     * @brief Post a raw reference for a task from another thread, e.g., a planner, without blocking the control thread. The reference is applied to the task in the next
+     *  call of update(). If several references are posted between two calls of update(), only the most recent one is applied. Each reference is applied completely or not at all.
+     *  Lock-free, does not allocate memory after the first three calls for the same task. Only one thread at a time may post references for the same task, and this must not be
+     *  called concurrently with configure(). References for the same task given with setReference() in the control thread are overwritten by posted references in the next update().
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param ref Reference vector, same as in setReference(handle, ref). Size has to be same as number of task variables
+     * @param time Time stamp of the reference. If null, the current time is used
+     */
+    void postReference(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& ref, const base::Time& time = base::Time());
+
+    /**
+     * @brief Post task weights from another thread, see postReference()
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param weights Weight vector. Size has to be same as number of task variables and all entries have to be >= 0
+     */
+    void postTaskWeights(const TaskHandle handle, const Eigen::Ref<const base::VectorXd>& weights);
+
+    /**
+     * @brief Post the task activation from another thread, see postReference()
+     * @param handle Handle of the task, see getTaskHandle()
+     * @param activation Activation value. Has to be in interval [0.0,1.0]
+     */
+    void postTaskActivation(const TaskHandle handle, double activation);
+
     /**
      * @brief Return a Particular task. Throw if the task does not exist
      */
@@ -131,6 +274,19 @@ public:
      */
     const base::commands::Joints& getSolverOutput() const { return solver_output_joints; }
 
+    /**
+     * @brief Copy the most recent solver output to out, if a new one has been computed since the last call. Can be called from another thread than the one calling
+     *  solve() and never blocks it. Only one thread at a time may read the solver output, and this must not be called concurrently with configure().
+     * @return True if a new solver output has been copied, false otherwise. In the latter case, out is unchanged
+     */
+    bool readSolverOutput(base::commands::Joints& out);
+
+    /**
+     * @brief Copy the most recent tasks status to out, if a new one has been computed since the last call, see readSolverOutput()
+     * @return True if a new tasks status has been copied, false otherwise. In the latter case, out is unchanged
+     */
+    bool readTasksStatus(TasksStatus& out);
+
     /**
      * @brief Get current solver output in raw values
      */
@@ -151,6 +307,47 @@ public:
      */
     const JointWeights& getActuatedJointWeights() const { return actuated_joint_weights; }
 
+    /**
+     * @brief If true, the quadratic program always contains all contact points of the robot model configuration (see RobotModelConfig::contact_points), so that
+     *  its structure does not change if the contacts are switched at runtime. Contact points that are not part of the active contacts
+     *  (see RobotModel::setActiveContacts()) are added as inactive contacts, i.e., their wrenches are pinned to zero. Default is false.
+     *  The setting belongs to the robot model, see RobotModel::setFixedContactSet(), and thus applies to all scenes that share the robot model.
+     */
+    void setFixedContactSet(bool fixed){robot_model->setFixedContactSet(fixed);}
+
+    /**
+     * @brief Return true if the fixed contact set is enabled, see setFixedContactSet()
+     */
+    bool hasFixedContactSet() const {return robot_model->hasFixedContactSet();}
+
+    /**
+     * @brief Update tasks and constraints in parallel on a persistent pool of n_threads threads, including the thread that calls update(). The worker threads are created
+     *  here and never in update(). Requires a robot model that supports workspaces (see RobotModel::supportsWorkspaces()), otherwise tasks and constraints
+     *  are updated sequentially. Each worker thread queries its own robot model workspace, so that no locks are required (see RobotModel::prepareConcurrentQueries()).
+     *  Constraints that do not support a concurrent numeric phase (see Constraint::concurrentUpdate()) are always updated sequentially.
+     *  Default is 1, i.e., sequential update. Only worthwhile for scenes with many tasks and expensive robot model queries.
+     * @param cores Optional: CPU cores to pin the worker threads to, one entry per worker thread, see WorkerPool
+     */
+    void setParallelUpdate(uint n_threads, const std::vector<int>& cores = std::vector<int>());
+
+    /**
+     * @brief Return the number of threads that update tasks and constraints, see setParallelUpdate()
+     */
+    uint getParallelUpdate() const;
+
+    /**
+     * @brief Solve an equilibrated version of the quadratic program, see QPScaling. Wraps the solver of the scene into a ScaledQPSolver, which unscales the solution,
+     *  so that the scene output does not change. If method is QPScaling::none, an existing wrapper is removed. Only for solvers of single priority quadratic programs.
+     *  The wrapped solver is reset, i.e., the next call of solve() is not warm started. Default is QPScaling::none.
+     * @param update_interval Recompute the scaling factors every n calls, see QPScaling::setUpdateInterval()
+     */
+    void setQPScaling(QPScaling::Method method, uint update_interval = 100);
+
+    /**
+     * @brief Return the scaling method of the solver, see setQPScaling()
+     */
+    QPScaling::Method getQPScaling() const;
+
     /**
      * @brief Return the current robot model
      */
@@ -161,6 +358,11 @@ public:
      */
     QPSolverPtr getSolver(){return solver;}
 
+    /**
+     * @brief Return the statistics of the last solver call, e.g. number of iterations, residuals and solve time. See QPSolver::SolverStats
+     */
+    const SolverStats& getSolverStats() const {return solver->getStats();}
+
     /**
      * @brief Return task configuration
      */
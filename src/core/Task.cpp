@@ -1,6 +1,8 @@
 #include "Task.hpp"
 #include <base-logging/Logging.hpp>
 #include <base/Float.hpp>
+#include <algorithm>
+#include <numeric>
 
 namespace wbc{
 
@@ -19,7 +21,9 @@ Task::Task(const TaskConfig& _config, uint n_robot_joints) :
     weights_root.resize(no_variables);
 
     A.resize(no_variables, n_robot_joints);
-    Aw.resize(no_variables, n_robot_joints);
+    std::vector<int> cols(n_robot_joints);
+    std::iota(cols.begin(), cols.end(), 0);
+    setActiveColumns(cols);
     reset();
 }
 
@@ -34,7 +38,6 @@ void Task::reset(){
     y_ref_root.setConstant(no_variables, base::NaN<double>());
     y_ref.setZero(no_variables);
     A.setZero();
-    Aw.setZero();
     activation = config.activation;
     for(uint i = 0; i < no_variables; i++){
         weights(i) = config.weights[i];
@@ -74,4 +77,30 @@ void Task::setActivation(const double activation){
     this->activation = activation;
 }
 
+void Task::setReferenceRaw(const Eigen::Ref<const base::VectorXd>& ref){
+    if(config.nVariables() != ref.size()){
+        LOG_ERROR("Task %s: Size of reference vector should be %i but is %i", config.name.c_str(), config.nVariables(), ref.size())
+        throw std::invalid_argument("Invalid task reference input");
+    }
+    this->time = base::Time::now();
+    this->y_ref = ref;
+}
+
+void Task::setActiveColumns(const std::vector<int>& cols){
+    for(int c : cols){
+        if(c < 0 || c >= A.cols()){
+            LOG_ERROR("Task %s: Active column %i is out of range. Task matrix has %i columns", config.name.c_str(), c, A.cols());
+            throw std::invalid_argument("Invalid active columns");
+        }
+    }
+    active_cols = cols;
+    std::sort(active_cols.begin(), active_cols.end());
+    active_cols.erase(std::unique(active_cols.begin(), active_cols.end()), active_cols.end());
+
+    const uint k = active_cols.size();
+    Aw_active.setZero(config.nVariables(), k);
+    H_active.setZero(k, k);
+    g_active.setZero(k);
+}
+
 }// namespace wbc
@@ -52,6 +52,20 @@ public:
      */
     void setActivation(const double activation);
 
+    /**
+     * @brief Set the raw task reference, i.e., write y_ref directly without any conversion from base types. For joint space tasks the entries have
+     *  to be in the same order as config.joint_names, for Cartesian tasks they have to be given as (linear, angular) in ref_frame coordinates.
+     * @param ref Reference vector. Size has to be same as number of task variables
+     */
+    void setReferenceRaw(const Eigen::Ref<const base::VectorXd>& ref);
+
+    /**
+     * @brief Set the columns of the task matrix that can be non-zero, i.e., the robot joints that influence the task. All other columns of A have to be zero.
+     *  Scenes use this to update only the affected sub-blocks of the QP cost function. By default, all columns are active.
+     * @param cols Column indices. Have to be valid indices in A. Will be sorted in ascending order.
+     */
+    void setActiveColumns(const std::vector<int>& cols);
+
     /** Last time the task reference values was updated.*/
     base::Time time;
 
@@ -85,8 +99,15 @@ public:
     /** Task matrix */
     base::MatrixXd A;
 
-    /** Weighted task matrix */
-    base::MatrixXd Aw;
+    /** Columns of A that can be non-zero in ascending order, see setActiveColumns()*/
+    std::vector<int> active_cols;
+
+    /** Weighted task matrix, restricted to the active columns (see active_cols) */
+    base::MatrixXd Aw_active;
+
+    /** Aw_active^T * Aw_active (upper triangle) and Aw_active^T * y_ref_root. Helper for assembling the QP cost function, see Scene::addTaskToCost()*/
+    base::MatrixXd H_active;
+    base::VectorXd g_active;
 };
 
 
@@ -1,7 +1,9 @@
 #include "RobotModelHyrodyn.hpp"
+#include "RobotModelWorkspaceHyrodyn.hpp"
 #include <base-logging/Logging.hpp>
 #include <urdf_parser/urdf_parser.h>
 #include <tools/URDFTools.hpp>
+#include <numeric>
 
 namespace wbc{
 
@@ -18,6 +20,37 @@ void RobotModelHyrodyn::clear(){
     RobotModel::clear();
 
     hyrodyn = hyrodyn::RobotModel_HyRoDyn();
+    chain_data.clear();
+}
+
+void RobotModelHyrodyn::addChain(const ChainId chain){
+    chain_data.resize(chain+1);
+}
+
+RobotModelHyrodyn::ChainData& RobotModelHyrodyn::chainData(const ChainId chain, const char* caller){
+
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelHyrodyn: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string(" Invalid call to ") + caller + "()");
+    }
+    checkChainId(chain);
+
+    // Validate root and tip frame only once
+    ChainData& cd = chain_data[chain];
+    if(!cd.checked){
+        const std::string &root_frame = chainRoot(chain);
+        const std::string &tip_frame = chainTip(chain);
+        if(!hasLink(root_frame) || !hasLink(tip_frame)){
+            LOG_ERROR_S << "Request " << caller << " for " << root_frame << " -> " << tip_frame << " but at least one of these links does not exist in robot model" << std::endl;
+            throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+        }
+        if(root_frame != world_frame){
+            LOG_ERROR_S<<"Requested " << caller << " for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but hyrodyn robot model always requires the root frame to be the root of the full model"<<std::endl;
+            throw std::runtime_error("Invalid root frame");
+        }
+        cd.checked = true;
+    }
+    return cd;
 }
 
 bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
@@ -46,9 +79,7 @@ bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
     // Read Joint Limits
     URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
 
-    TiXmlDocument *doc = urdf::exportURDF(robot_urdf);
-    std::string robot_urdf_file = "/tmp/floating_base_model.urdf";
-    doc->SaveFile(robot_urdf_file);
+    const std::string robot_urdf_file = writeURDF();
     try{
         hyrodyn.load_robotmodel(robot_urdf_file, cfg.submechanism_file);
     }
@@ -84,6 +115,7 @@ bool RobotModelHyrodyn::configure(const RobotModelConfig& cfg){
     selection_matrix.setZero();
     for(int i = 0; i < hyrodyn.jointnames_active.size(); i++)
         selection_matrix(i, jointIndex(hyrodyn.jointnames_active[i])) = 1.0;
+    setJointOrder(std::vector<std::string>(hyrodyn.jointnames_independent.begin() + (has_floating_base ? 6 : 0), hyrodyn.jointnames_independent.end()));
 
     LOG_DEBUG("------------------- WBC RobotModelHyrodyn -----------------");
     LOG_DEBUG_S << "Robot Name " << robot_urdf->getName() << std::endl;
@@ -119,41 +151,7 @@ void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
     }
 
     if(has_floating_base){
-        if(!_floating_base_state.hasValidPose() ||
-           !_floating_base_state.hasValidTwist() ||
-           !_floating_base_state.hasValidAcceleration()){
-           LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
-           throw std::runtime_error("Invalid floating base status");
-        }
-        if(_floating_base_state.time.isNull()){
-            LOG_ERROR("Floating base state does not have a valid timestamp. Or do we have 1970?");
-            throw std::runtime_error("Invalid call to update()");
-        }
-
-        floating_base_state = _floating_base_state;
-
-        // Transformation from fb body linear acceleration to fb joint linear acceleration
-        // look at RobotModelRBDL for description
-        Eigen::Matrix3d fb_rot = _floating_base_state.pose.orientation.toRotationMatrix();
-        base::Twist fb_twist = _floating_base_state.twist;
-        base::Acceleration fb_acc = _floating_base_state.acceleration;
-
-        Eigen::VectorXd spherical_j_vel(6);
-        spherical_j_vel << fb_twist.angular, Eigen::Vector3d::Zero();
-        Eigen::VectorXd spherical_b_vel(6);
-        spherical_b_vel << fb_twist.angular, fb_rot.transpose() * fb_twist.linear;
-        Eigen::VectorXd fb_spherical_cross = crossm(spherical_b_vel, spherical_j_vel);
-        fb_acc.linear = fb_acc.linear - fb_rot * fb_spherical_cross.tail<3>(); // remove cross contribution from linear acc s(in world coordinates as RBDL want)
-
-        hyrodyn.floating_robot_pose.segment(0,3) = _floating_base_state.pose.position;
-        hyrodyn.floating_robot_pose[3] = _floating_base_state.pose.orientation.x();
-        hyrodyn.floating_robot_pose[4] = _floating_base_state.pose.orientation.y();
-        hyrodyn.floating_robot_pose[5] = _floating_base_state.pose.orientation.z();
-        hyrodyn.floating_robot_pose[6] = _floating_base_state.pose.orientation.w();
-        hyrodyn.floating_robot_twist.segment(0,3) = _floating_base_state.twist.angular;
-        hyrodyn.floating_robot_twist.segment(3,3) = _floating_base_state.twist.linear;
-        hyrodyn.floating_robot_accn.segment(0,3) = fb_acc.angular;
-        hyrodyn.floating_robot_accn.segment(3,3) = fb_acc.linear;
+        updateFloatingBase(_floating_base_state);
 
         for( unsigned int i = 6; i < hyrodyn.jointnames_independent.size(); ++i){
             const std::string& name =  hyrodyn.jointnames_independent[i];
@@ -167,7 +165,6 @@ void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
                 throw e;
             }
         }
-        hyrodyn.update_all_independent_coordinates();
     }
     else{
         for( unsigned int i = 0; i < hyrodyn.jointnames_independent.size(); ++i){
@@ -184,16 +181,125 @@ void RobotModelHyrodyn::update(const base::samples::Joints& joint_state_in,
         }
     }
 
+    updateSystemState(joint_state_in.time);
+}
+
+void RobotModelHyrodyn::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                               const Eigen::Ref<const base::VectorXd>& qd_in,
+                               const Eigen::Ref<const base::VectorXd>& qdd_in,
+                               const base::Time& time,
+                               const base::samples::RigidBodyStateSE3& _floating_base_state){
+
+    const size_t n = joint_order_idx.size();
+    if(q_in.size() != n || qd_in.size() != n || qdd_in.size() != n){
+        LOG_ERROR("Size of raw joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q_in.size(), qd_in.size(), qdd_in.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+    if(time.isNull()){
+        LOG_ERROR_S << "Joint State does not have a valid timestamp. Or do we have 1970?"<<std::endl;
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    // joint_order_idx contains the indices in the independent coordinates of the robot, i.e., y_robot for floating base robots and y otherwise
+    if(has_floating_base){
+        updateFloatingBase(_floating_base_state);
+        for(size_t i = 0; i < n; i++){
+            hyrodyn.y_robot[joint_order_idx[i]]   = q_in[i];
+            hyrodyn.yd_robot[joint_order_idx[i]]  = qd_in[i];
+            hyrodyn.ydd_robot[joint_order_idx[i]] = qdd_in[i];
+        }
+    }
+    else{
+        for(size_t i = 0; i < n; i++){
+            hyrodyn.y[joint_order_idx[i]]   = q_in[i];
+            hyrodyn.yd[joint_order_idx[i]]  = qd_in[i];
+            hyrodyn.ydd[joint_order_idx[i]] = qdd_in[i];
+        }
+    }
+
+    updateSystemState(time);
+}
+
+void RobotModelHyrodyn::updateFloatingBase(const base::samples::RigidBodyStateSE3& _floating_base_state){
+
+    if(_floating_base_state.time.isNull()){
+        LOG_ERROR("Floating base state does not have a valid timestamp. Or do we have 1970?");
+        throw std::runtime_error("Invalid call to update()");
+    }
+    RobotModelWorkspaceHyrodyn::floatingBaseState(_floating_base_state, hyrodyn);
+    floating_base_state = _floating_base_state;
+}
+
+void RobotModelHyrodyn::updateSystemState(const base::Time& time){
+
+    if(has_floating_base)
+        hyrodyn.update_all_independent_coordinates();
+
     // Compute system state
     hyrodyn.calculate_system_state();
 
+    // joint_state has the same order as the spanning tree joints
     for(size_t i = 0; i < hyrodyn.jointnames_spanningtree.size(); i++){
-        const std::string &name = hyrodyn.jointnames_spanningtree[i];
-        joint_state[name].position = hyrodyn.Q[i];
-        joint_state[name].speed = hyrodyn.QDot[i];
-        joint_state[name].acceleration = hyrodyn.QDDot[i];
+        base::JointState &state = joint_state.elements[i];
+        state.position = hyrodyn.Q[i];
+        state.speed = hyrodyn.QDot[i];
+        state.acceleration = hyrodyn.QDDot[i];
     }
-    joint_state.time = joint_state_in.time;
+    joint_state.time = time;
+}
+
+std::string RobotModelHyrodyn::writeURDF(){
+    TiXmlDocument *doc = urdf::exportURDF(robot_urdf);
+    const std::string robot_urdf_file = "/tmp/floating_base_model.urdf";
+    doc->SaveFile(robot_urdf_file);
+    delete doc;
+    return robot_urdf_file;
+}
+
+RobotModelWorkspacePtr RobotModelHyrodyn::createWorkspace(){
+    if(!robot_urdf)
+        throw std::runtime_error("RobotModelHyrodyn::createWorkspace: Robot model has not been configured");
+
+    // Hyrodyn requires all chains to start at the world frame, all other chains are invalid in the workspace
+    std::vector<std::string> chain_tips(chains.size());
+    for(size_t i = 0; i < chains.size(); i++){
+        if(chainRoot(i) == world_frame && hasLink(chainTip(i)))
+            chain_tips[i] = chainTip(i);
+    }
+    return std::make_shared<RobotModelWorkspaceHyrodyn>(writeURDF(), robot_model_config.submechanism_file, has_floating_base, world_frame,
+                                                        noOfJoints(), joint_order_idx, chain_tips);
+}
+
+std::vector<int> RobotModelHyrodyn::chainJointIndices(const std::string& root_frame, const std::string& tip_frame){
+    if(!hasLink(root_frame) || !hasLink(tip_frame)){
+        LOG_ERROR("RobotModelHyrodyn: Requested joints of chain %s -> %s, but one of these links is not in the robot model", root_frame.c_str(), tip_frame.c_str());
+        throw std::invalid_argument("Invalid chain");
+    }
+    std::vector<int> idx(noOfJoints());
+    std::iota(idx.begin(), idx.end(), 0);
+    return idx;
+}
+
+void RobotModelHyrodyn::setJointOrder(const std::vector<std::string>& names){
+
+    // The raw state vectors contain the independent joints of the robot, excluding the floating base
+    const uint offset = has_floating_base ? 6 : 0;
+    const std::vector<std::string>& independent = hyrodyn.jointnames_independent;
+    if(names.size() != independent.size() - offset){
+        LOG_ERROR("Joint order has %i entries, but robot model has %i independent joints", names.size(), independent.size() - offset);
+        throw std::invalid_argument("Invalid joint order");
+    }
+    std::vector<int> idx(names.size());
+    for(size_t i = 0; i < names.size(); i++){
+        auto it = std::find(independent.begin() + offset, independent.end(), names[i]);
+        if(it == independent.end() || std::count(names.begin(), names.end(), names[i]) != 1){
+            LOG_ERROR("Joint %s in joint order is either not an independent joint of the robot model or given more than once", names[i].c_str());
+            throw std::invalid_argument("Invalid joint order");
+        }
+        idx[i] = it - independent.begin() - offset;
+    }
+    joint_order = names;
+    joint_order_idx = idx;
 }
 
 void RobotModelHyrodyn::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
@@ -225,19 +331,23 @@ const base::samples::RigidBodyStateSE3 &RobotModelHyrodyn::rigidBodyState(const
         throw std::runtime_error("Invalid root frame");
     }
 
-    hyrodyn.calculate_forward_kinematics(tip_frame);
-    rbs.pose.position        = hyrodyn.pose.segment(0,3);
-    rbs.pose.orientation     = base::Quaterniond(hyrodyn.pose[6],hyrodyn.pose[3],hyrodyn.pose[4],hyrodyn.pose[5]);
-    rbs.twist.linear         = hyrodyn.twist.segment(3,3);
-    rbs.twist.angular        = hyrodyn.twist.segment(0,3);
-    rbs.acceleration.linear  = hyrodyn.spatial_acceleration.segment(3,3);
-    rbs.acceleration.angular = hyrodyn.spatial_acceleration.segment(0,3);//
-    rbs.time                 = joint_state.time;
-    rbs.frame_id             = tip_frame;
-
+    computeRigidBodyState(tip_frame, rbs);
     return rbs;
 }
 
+const base::samples::RigidBodyStateSE3 &RobotModelHyrodyn::rigidBodyState(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->rigidBodyState(chain);
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    computeRigidBodyState(chainTip(chain), cd.rbs);
+    return cd.rbs;
+}
+
+void RobotModelHyrodyn::computeRigidBodyState(const std::string &tip_frame, base::samples::RigidBodyStateSE3 &rbs_out){
+    RobotModelWorkspaceHyrodyn::computeRigidBodyState(hyrodyn, tip_frame, rbs_out);
+    rbs_out.time = joint_state.time;
+}
+
 const base::MatrixXd &RobotModelHyrodyn::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
 
     if(joint_state.time.isNull()){
@@ -261,22 +371,20 @@ const base::MatrixXd &RobotModelHyrodyn::spaceJacobian(const std::string &root_f
     }
 
     std::string chain_id = chainID(root_frame,tip_frame);
+    computeSpaceJacobian(tip_frame, space_jac_map[chain_id]);
+    return space_jac_map[chain_id];
+}
 
-    space_jac_map[chain_id].resize(6,noOfJoints());
-    space_jac_map[chain_id].setZero();
-    if(hyrodyn.floating_base_robot){
-        hyrodyn.calculate_space_jacobian_actuation_space_including_floatingbase(tip_frame);
-        uint n_cols = hyrodyn.Jsufb.cols();
-        space_jac_map[chain_id].block(0,0,3,n_cols) = hyrodyn.Jsufb.block(3,0,3,n_cols);
-        space_jac_map[chain_id].block(3,0,3,n_cols) = hyrodyn.Jsufb.block(0,0,3,n_cols);
-    }else{
-        hyrodyn.calculate_space_jacobian_actuation_space(tip_frame);
-        uint n_cols = hyrodyn.Jsu.cols();
-        space_jac_map[chain_id].block(0,0,3,n_cols) = hyrodyn.Jsu.block(3,0,3,n_cols);
-        space_jac_map[chain_id].block(3,0,3,n_cols) = hyrodyn.Jsu.block(0,0,3,n_cols);
-    }
+const base::MatrixXd &RobotModelHyrodyn::spaceJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spaceJacobian(chain);
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    computeSpaceJacobian(chainTip(chain), cd.space_jac);
+    return cd.space_jac;
+}
 
-    return space_jac_map[chain_id];
+void RobotModelHyrodyn::computeSpaceJacobian(const std::string &tip_frame, base::MatrixXd &space_jac){
+    RobotModelWorkspaceHyrodyn::computeSpaceJacobian(hyrodyn, noOfJoints(), tip_frame, space_jac);
 }
 
 const base::MatrixXd &RobotModelHyrodyn::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
@@ -303,23 +411,20 @@ const base::MatrixXd &RobotModelHyrodyn::bodyJacobian(const std::string &root_fr
     }
 
     std::string chain_id = chainID(root_frame,tip_frame);
+    computeBodyJacobian(tip_frame, body_jac_map[chain_id]);
+    return body_jac_map[chain_id];
+}
 
-    body_jac_map[chain_id].resize(6,noOfJoints());
-    body_jac_map[chain_id].setZero();
-    if(hyrodyn.floating_base_robot){
-        hyrodyn.calculate_body_jacobian_actuation_space_including_floatingbase(tip_frame);
-        uint n_cols = hyrodyn.Jbufb.cols();
-        body_jac_map[chain_id].block(0,0,3,n_cols) = hyrodyn.Jbufb.block(3,0,3,n_cols);
-        body_jac_map[chain_id].block(3,0,3,n_cols) = hyrodyn.Jbufb.block(0,0,3,n_cols);
-    }
-    else{
-        hyrodyn.calculate_body_jacobian_actuation_space(tip_frame);
-        uint n_cols = hyrodyn.Jbu.cols();
-        body_jac_map[chain_id].block(0,0,3,n_cols) = hyrodyn.Jbu.block(3,0,3,n_cols);
-        body_jac_map[chain_id].block(3,0,3,n_cols) = hyrodyn.Jbu.block(0,0,3,n_cols);
-    }
+const base::MatrixXd &RobotModelHyrodyn::bodyJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->bodyJacobian(chain);
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    computeBodyJacobian(chainTip(chain), cd.body_jac);
+    return cd.body_jac;
+}
 
-    return body_jac_map[chain_id];
+void RobotModelHyrodyn::computeBodyJacobian(const std::string &tip_frame, base::MatrixXd &body_jac){
+    RobotModelWorkspaceHyrodyn::computeBodyJacobian(hyrodyn, noOfJoints(), tip_frame, body_jac);
 }
 
 const base::MatrixXd &RobotModelHyrodyn::comJacobian(){
@@ -327,6 +432,8 @@ const base::MatrixXd &RobotModelHyrodyn::comJacobian(){
         LOG_ERROR("RobotModelHyrodyn: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to comJacobian()");
     }
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->comJacobian();
 
     hyrodyn.calculate_com_jacobian();
     com_jac.resize(3,noOfJoints());
@@ -340,27 +447,25 @@ const base::MatrixXd &RobotModelHyrodyn::jacobianDot(const std::string &root_fra
 }
 
 const base::Acceleration &RobotModelHyrodyn::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
-    hyrodyn.calculate_spatial_acceleration_bias(tip_frame);
-    spatial_acc_bias = base::Acceleration(hyrodyn.spatial_acceleration_bias.segment(3,3), hyrodyn.spatial_acceleration_bias.segment(0,3));
+    RobotModelWorkspaceHyrodyn::computeSpatialAccelerationBias(hyrodyn, tip_frame, spatial_acc_bias);
     return spatial_acc_bias;
 }
 
+const base::Acceleration &RobotModelHyrodyn::spatialAccelerationBias(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spatialAccelerationBias(chain);
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    RobotModelWorkspaceHyrodyn::computeSpatialAccelerationBias(hyrodyn, chainTip(chain), cd.acc_bias);
+    return cd.acc_bias;
+}
+
 const base::MatrixXd &RobotModelHyrodyn::jointSpaceInertiaMatrix(){
     if(joint_state.time.isNull()){
         LOG_ERROR("RobotModelHyrodyn: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to jointSpaceInertiaMatrix()");
     }
 
-    // Compute joint space inertia matrix
-    if(hyrodyn.floating_base_robot){
-        hyrodyn.calculate_mass_interia_matrix_actuation_space_including_floatingbase();
-        joint_space_inertia_mat = hyrodyn.Hufb;
-    }
-    else{
-        hyrodyn.calculate_mass_interia_matrix_actuation_space();
-        joint_space_inertia_mat = hyrodyn.Hu;
-    }
-
+    RobotModelWorkspaceHyrodyn::computeJointSpaceInertiaMatrix(hyrodyn, joint_space_inertia_mat);
     return joint_space_inertia_mat;
 }
 
@@ -370,30 +475,13 @@ const base::VectorXd &RobotModelHyrodyn::biasForces(){
         throw std::runtime_error(" Invalid call to biasForces()");
     }
 
-    // Compute bias forces
-    hyrodyn.ydd.setZero();
-    if(hyrodyn.floating_base_robot){
-        hyrodyn.calculate_inverse_dynamics_including_floatingbase();
-        bias_forces = hyrodyn.Tau_actuated_floatingbase;
-    }
-    else{
-        hyrodyn.calculate_inverse_dynamics();
-        bias_forces = hyrodyn.Tau_actuated;
-    }
-
+    RobotModelWorkspaceHyrodyn::computeBiasForces(hyrodyn, bias_forces);
     return bias_forces;
 }
 
 const base::samples::RigidBodyStateSE3& RobotModelHyrodyn::centerOfMass(){
-    hyrodyn.calculate_com_properties();
-
+    RobotModelWorkspaceHyrodyn::computeCenterOfMass(hyrodyn, com_rbs);
     com_rbs.frame_id = world_frame;
-    com_rbs.pose.position = hyrodyn.com;
-    com_rbs.pose.orientation.setIdentity();
-    com_rbs.twist.linear = hyrodyn.com_vel;
-    com_rbs.twist.angular.setZero();
-    com_rbs.acceleration.linear = hyrodyn.com_acc; // TODO: double check CoM acceleration
-    com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
     return com_rbs;
 }
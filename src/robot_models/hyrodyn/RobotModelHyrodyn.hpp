@@ -15,7 +15,29 @@ private:
 protected:
     hyrodyn::RobotModel_HyRoDyn hyrodyn;
 
+    /** Per-chain data for the chain id based queries*/
+    struct ChainData{
+        bool checked = false;   /** True if root and tip frame have been validated*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+    };
+    std::vector<ChainData> chain_data;  /** Indexed by ChainId*/
+
     void clear();
+    /** Allocate the per-chain data for the given chain*/
+    virtual void addChain(const ChainId chain);
+    /** Return the data of the given chain. Validates root and tip frame on first use. Throws if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+    void computeRigidBodyState(const std::string &tip_frame, base::samples::RigidBodyStateSE3 &rbs_out);
+    void computeSpaceJacobian(const std::string &tip_frame, base::MatrixXd &space_jac);
+    void computeBodyJacobian(const std::string &tip_frame, base::MatrixXd &body_jac);
+    /** Check the given floating base state and write it to the hyrodyn model*/
+    void updateFloatingBase(const base::samples::RigidBodyStateSE3& floating_base_state);
+    /** Compute the system state from the independent coordinates of the hyrodyn model and copy it to joint_state*/
+    void updateSystemState(const base::Time& time);
+    /** Write the robot URDF including the floating base to a file, since hyrodyn can only be loaded from files. Return the file name*/
+    std::string writeURDF();
 public:
     RobotModelHyrodyn();
     virtual ~RobotModelHyrodyn();
@@ -35,6 +57,25 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
 
+    /**
+     * @brief Update the robot configuration from raw state vectors in the order given by setJointOrder(). Does not perform any name lookups. See RobotModel::update() for details
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
+    /**
+     * @brief Set the order of the joints in the raw state vectors passed to update(q,qd,qdd,...). In contrast to the other robot models, the raw state vectors
+     *  contain the independent joints of the hyrodyn model (excluding the floating base), which may differ from the actuated joints for hybrid robots.
+     *  After configure(), the order is the one of the independent joints. Throws if the given names are invalid.
+     */
+    virtual void setJointOrder(const std::vector<std::string>& names);
+
+    /** @brief Return all joints, since the independent joints of a hybrid robot can influence links that are not on their path in the URDF tree*/
+    virtual std::vector<int> chainJointIndices(const std::string& root_frame, const std::string& tip_frame);
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
 
@@ -46,6 +87,9 @@ public:
      */
     virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as rigidBodyState(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -53,6 +97,9 @@ public:
       */
     virtual const base::MatrixXd &spaceJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spaceJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+
     /** @brief Returns the Body Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -60,6 +107,9 @@ public:
       */
     virtual const base::MatrixXd &bodyJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as bodyJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+
     /** @brief Returns the CoM Jacobian for the entire robot, which maps the robot joint velocities to linear spatial velocities in robot base coordinates.
       * Size of the Jacobian will be 3 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot.
@@ -83,6 +133,9 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spatialAccelerationBias(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+
     /** Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix();
 
@@ -97,6 +150,13 @@ public:
 
     /** @brief Compute and return the inverse dynamics solution*/
     virtual void computeInverseDynamics(base::commands::Joints &solver_output);
+
+    /** Workspaces are supported, see createWorkspace()*/
+    virtual bool supportsWorkspaces() const {return true;}
+
+    /** Create a RobotModelWorkspaceHyrodyn, which loads its own hyrodyn model from the model files of this robot model, see RobotModel::createWorkspace().
+     *  This is more expensive than for the other robot models, so create the workspaces once and reuse them*/
+    virtual RobotModelWorkspacePtr createWorkspace();
 };
 
 }
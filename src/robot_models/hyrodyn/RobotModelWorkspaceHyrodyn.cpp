@@ -0,0 +1,276 @@
+#include "RobotModelWorkspaceHyrodyn.hpp"
+#include <base-logging/Logging.hpp>
+
+namespace wbc {
+
+RobotModelWorkspaceHyrodyn::RobotModelWorkspaceHyrodyn(const std::string& urdf_file,
+                                                       const std::string& submechanism_file,
+                                                       const bool has_floating_base,
+                                                       const std::string& world_frame,
+                                                       const uint nj,
+                                                       const std::vector<int>& q_idx,
+                                                       const std::vector<std::string>& chain_tips) :
+    has_floating_base(has_floating_base),
+    nj(nj),
+    q_idx(q_idx),
+    update_counter(0),
+    com_stamp(0),
+    com_jac_stamp(0),
+    inertia_mat_stamp(0),
+    bias_forces_stamp(0){
+
+    try{
+        hyrodyn.load_robotmodel(urdf_file, submechanism_file);
+    }
+    catch(std::exception e){
+        LOG_ERROR_S << "Failed to load hyrodyn model from URDF " << urdf_file << " and submechanism file " << submechanism_file << std::endl;
+        throw std::runtime_error("Unable to create hyrodyn workspace");
+    }
+
+    chain_data.resize(chain_tips.size());
+    for(size_t i = 0; i < chain_tips.size(); i++)
+        chain_data[i].tip_frame = chain_tips[i];
+    com_rbs.frame_id = world_frame;
+}
+
+void RobotModelWorkspaceHyrodyn::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                                        const Eigen::Ref<const base::VectorXd>& qd_in,
+                                        const Eigen::Ref<const base::VectorXd>& qdd_in,
+                                        const base::samples::RigidBodyStateSE3& floating_base_state){
+    const size_t n = q_idx.size();
+    if(q_in.size() != n || qd_in.size() != n || qdd_in.size() != n){
+        LOG_ERROR("Size of joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q_in.size(), qd_in.size(), qdd_in.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    if(has_floating_base){
+        floatingBaseState(floating_base_state, hyrodyn);
+        for(size_t i = 0; i < n; i++){
+            hyrodyn.y_robot[q_idx[i]]   = q_in[i];
+            hyrodyn.yd_robot[q_idx[i]]  = qd_in[i];
+            hyrodyn.ydd_robot[q_idx[i]] = qdd_in[i];
+        }
+        hyrodyn.update_all_independent_coordinates();
+    }
+    else{
+        for(size_t i = 0; i < n; i++){
+            hyrodyn.y[q_idx[i]]   = q_in[i];
+            hyrodyn.yd[q_idx[i]]  = qd_in[i];
+            hyrodyn.ydd[q_idx[i]] = qdd_in[i];
+        }
+    }
+    hyrodyn.calculate_system_state();
+    update_counter++;
+}
+
+void RobotModelWorkspaceHyrodyn::checkUpdated(const char* caller) const{
+    if(update_counter == 0){
+        LOG_ERROR("RobotModelWorkspaceHyrodyn: You have to call update() at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+}
+
+RobotModelWorkspaceHyrodyn::ChainData& RobotModelWorkspaceHyrodyn::chainData(const ChainId chain, const char* caller){
+    if(chain < 0 || chain >= (int)chain_data.size()){
+        LOG_ERROR("Invalid chain id %i in %s(). The workspace knows %i chains. Chains have to be created before the workspace", chain, caller, chain_data.size());
+        throw std::invalid_argument("Invalid chain id");
+    }
+    ChainData& cd = chain_data[chain];
+    if(cd.tip_frame.empty()){
+        LOG_ERROR("Chain %i was requested in %s(), but either its root is not the world frame or its tip frame does not exist in robot model", chain, caller);
+        throw std::invalid_argument("Invalid chain id");
+    }
+    checkUpdated(caller);
+    return cd;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceHyrodyn::rigidBodyState(const ChainId chain){
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        computeRigidBodyState(hyrodyn, cd.tip_frame, cd.rbs);
+        cd.rbs_stamp = update_counter;
+    }
+    return cd.rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceHyrodyn::spaceJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        computeSpaceJacobian(hyrodyn, nj, cd.tip_frame, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
+    }
+    return cd.space_jac;
+}
+
+const base::MatrixXd &RobotModelWorkspaceHyrodyn::bodyJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        computeBodyJacobian(hyrodyn, nj, cd.tip_frame, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
+}
+
+const base::Acceleration &RobotModelWorkspaceHyrodyn::spatialAccelerationBias(const ChainId chain){
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp != update_counter){
+        computeSpatialAccelerationBias(hyrodyn, cd.tip_frame, cd.acc_bias);
+        cd.acc_bias_stamp = update_counter;
+    }
+    return cd.acc_bias;
+}
+
+const base::MatrixXd &RobotModelWorkspaceHyrodyn::comJacobian(){
+    checkUpdated("comJacobian");
+    if(com_jac_stamp != update_counter){
+        hyrodyn.calculate_com_jacobian();
+        com_jac = hyrodyn.Jcom;
+        com_jac_stamp = update_counter;
+    }
+    return com_jac;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceHyrodyn::centerOfMass(){
+    checkUpdated("centerOfMass");
+    if(com_stamp != update_counter){
+        computeCenterOfMass(hyrodyn, com_rbs);
+        com_stamp = update_counter;
+    }
+    return com_rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceHyrodyn::jointSpaceInertiaMatrix(){
+    checkUpdated("jointSpaceInertiaMatrix");
+    if(inertia_mat_stamp != update_counter){
+        computeJointSpaceInertiaMatrix(hyrodyn, joint_space_inertia_mat);
+        inertia_mat_stamp = update_counter;
+    }
+    return joint_space_inertia_mat;
+}
+
+const base::VectorXd &RobotModelWorkspaceHyrodyn::biasForces(){
+    checkUpdated("biasForces");
+    if(bias_forces_stamp != update_counter){
+        computeBiasForces(hyrodyn, bias_forces);
+        bias_forces_stamp = update_counter;
+    }
+    return bias_forces;
+}
+
+void RobotModelWorkspaceHyrodyn::floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state, hyrodyn::RobotModel_HyRoDyn& hyrodyn){
+
+    if(!floating_base_state.hasValidPose() ||
+       !floating_base_state.hasValidTwist() ||
+       !floating_base_state.hasValidAcceleration()){
+       LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
+       throw std::runtime_error("Invalid floating base status");
+    }
+
+    // Transformation from fb body linear acceleration to fb joint linear acceleration
+    // look at RobotModelWorkspaceRBDL for description
+    Eigen::Matrix3d fb_rot = floating_base_state.pose.orientation.toRotationMatrix();
+    base::Twist fb_twist = floating_base_state.twist;
+    base::Acceleration fb_acc = floating_base_state.acceleration;
+
+    Eigen::VectorXd spherical_j_vel(6);
+    spherical_j_vel << fb_twist.angular, Eigen::Vector3d::Zero();
+    Eigen::VectorXd spherical_b_vel(6);
+    spherical_b_vel << fb_twist.angular, fb_rot.transpose() * fb_twist.linear;
+    Eigen::VectorXd fb_spherical_cross = crossm(spherical_b_vel, spherical_j_vel);
+    fb_acc.linear = fb_acc.linear - fb_rot * fb_spherical_cross.tail<3>(); // remove cross contribution from linear acc s(in world coordinates as RBDL want)
+
+    hyrodyn.floating_robot_pose.segment(0,3) = floating_base_state.pose.position;
+    hyrodyn.floating_robot_pose[3] = floating_base_state.pose.orientation.x();
+    hyrodyn.floating_robot_pose[4] = floating_base_state.pose.orientation.y();
+    hyrodyn.floating_robot_pose[5] = floating_base_state.pose.orientation.z();
+    hyrodyn.floating_robot_pose[6] = floating_base_state.pose.orientation.w();
+    hyrodyn.floating_robot_twist.segment(0,3) = floating_base_state.twist.angular;
+    hyrodyn.floating_robot_twist.segment(3,3) = floating_base_state.twist.linear;
+    hyrodyn.floating_robot_accn.segment(0,3) = fb_acc.angular;
+    hyrodyn.floating_robot_accn.segment(3,3) = fb_acc.linear;
+}
+
+void RobotModelWorkspaceHyrodyn::computeRigidBodyState(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const std::string& tip_frame, base::samples::RigidBodyStateSE3& rbs){
+    hyrodyn.calculate_forward_kinematics(tip_frame);
+    rbs.pose.position        = hyrodyn.pose.segment(0,3);
+    rbs.pose.orientation     = base::Quaterniond(hyrodyn.pose[6],hyrodyn.pose[3],hyrodyn.pose[4],hyrodyn.pose[5]);
+    rbs.twist.linear         = hyrodyn.twist.segment(3,3);
+    rbs.twist.angular        = hyrodyn.twist.segment(0,3);
+    rbs.acceleration.linear  = hyrodyn.spatial_acceleration.segment(3,3);
+    rbs.acceleration.angular = hyrodyn.spatial_acceleration.segment(0,3);
+    rbs.frame_id             = tip_frame;
+}
+
+void RobotModelWorkspaceHyrodyn::computeSpaceJacobian(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const uint nj, const std::string& tip_frame, base::MatrixXd& space_jac){
+    space_jac.resize(6,nj);
+    space_jac.setZero();
+    if(hyrodyn.floating_base_robot){
+        hyrodyn.calculate_space_jacobian_actuation_space_including_floatingbase(tip_frame);
+        uint n_cols = hyrodyn.Jsufb.cols();
+        space_jac.block(0,0,3,n_cols) = hyrodyn.Jsufb.block(3,0,3,n_cols);
+        space_jac.block(3,0,3,n_cols) = hyrodyn.Jsufb.block(0,0,3,n_cols);
+    }else{
+        hyrodyn.calculate_space_jacobian_actuation_space(tip_frame);
+        uint n_cols = hyrodyn.Jsu.cols();
+        space_jac.block(0,0,3,n_cols) = hyrodyn.Jsu.block(3,0,3,n_cols);
+        space_jac.block(3,0,3,n_cols) = hyrodyn.Jsu.block(0,0,3,n_cols);
+    }
+}
+
+void RobotModelWorkspaceHyrodyn::computeBodyJacobian(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const uint nj, const std::string& tip_frame, base::MatrixXd& body_jac){
+    body_jac.resize(6,nj);
+    body_jac.setZero();
+    if(hyrodyn.floating_base_robot){
+        hyrodyn.calculate_body_jacobian_actuation_space_including_floatingbase(tip_frame);
+        uint n_cols = hyrodyn.Jbufb.cols();
+        body_jac.block(0,0,3,n_cols) = hyrodyn.Jbufb.block(3,0,3,n_cols);
+        body_jac.block(3,0,3,n_cols) = hyrodyn.Jbufb.block(0,0,3,n_cols);
+    }
+    else{
+        hyrodyn.calculate_body_jacobian_actuation_space(tip_frame);
+        uint n_cols = hyrodyn.Jbu.cols();
+        body_jac.block(0,0,3,n_cols) = hyrodyn.Jbu.block(3,0,3,n_cols);
+        body_jac.block(3,0,3,n_cols) = hyrodyn.Jbu.block(0,0,3,n_cols);
+    }
+}
+
+void RobotModelWorkspaceHyrodyn::computeSpatialAccelerationBias(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const std::string& tip_frame, base::Acceleration& acc_bias){
+    hyrodyn.calculate_spatial_acceleration_bias(tip_frame);
+    acc_bias.linear = hyrodyn.spatial_acceleration_bias.segment(3,3);
+    acc_bias.angular = hyrodyn.spatial_acceleration_bias.segment(0,3);
+}
+
+void RobotModelWorkspaceHyrodyn::computeCenterOfMass(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::samples::RigidBodyStateSE3& com_rbs){
+    hyrodyn.calculate_com_properties();
+    com_rbs.pose.position = hyrodyn.com;
+    com_rbs.pose.orientation.setIdentity();
+    com_rbs.twist.linear = hyrodyn.com_vel;
+    com_rbs.twist.angular.setZero();
+    com_rbs.acceleration.linear = hyrodyn.com_acc; // TODO: double check CoM acceleration
+    com_rbs.acceleration.angular.setZero();
+}
+
+void RobotModelWorkspaceHyrodyn::computeJointSpaceInertiaMatrix(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::MatrixXd& joint_space_inertia_mat){
+    if(hyrodyn.floating_base_robot){
+        hyrodyn.calculate_mass_interia_matrix_actuation_space_including_floatingbase();
+        joint_space_inertia_mat = hyrodyn.Hufb;
+    }
+    else{
+        hyrodyn.calculate_mass_interia_matrix_actuation_space();
+        joint_space_inertia_mat = hyrodyn.Hu;
+    }
+}
+
+void RobotModelWorkspaceHyrodyn::computeBiasForces(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::VectorXd& bias_forces){
+    hyrodyn.ydd.setZero();
+    if(hyrodyn.floating_base_robot){
+        hyrodyn.calculate_inverse_dynamics_including_floatingbase();
+        bias_forces = hyrodyn.Tau_actuated_floatingbase;
+    }
+    else{
+        hyrodyn.calculate_inverse_dynamics();
+        bias_forces = hyrodyn.Tau_actuated;
+    }
+}
+
+} // namespace wbc
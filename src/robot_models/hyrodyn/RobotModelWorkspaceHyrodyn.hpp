@@ -0,0 +1,108 @@
+#ifndef ROBOT_MODEL_WORKSPACE_HYRODYN_HPP
+#define ROBOT_MODEL_WORKSPACE_HYRODYN_HPP
+
+#include "../../core/RobotModelWorkspace.hpp"
+#include <hyrodyn/robot_model_hyrodyn.hpp>
+#include <vector>
+#include <string>
+
+namespace wbc {
+
+/**
+ * @brief Workspace of RobotModelHyrodyn, see RobotModelWorkspace. Hyrodyn stores the complete kinematic and dynamic state in RobotModel_HyRoDyn itself, including the state of
+ *  the submechanisms, and does not guarantee that copies of a loaded model are independent of each other. Thus, in contrast to the other workspaces, each workspace loads its
+ *  own hyrodyn model from the model files of the robot model. The static functions implement the kinematics for both RobotModelHyrodyn and the workspaces, so that both give
+ *  identical results. As for RobotModelHyrodyn, all chains have to start at the world frame.
+ */
+class RobotModelWorkspaceHyrodyn : public RobotModelWorkspace{
+protected:
+    hyrodyn::RobotModel_HyRoDyn hyrodyn;
+    bool has_floating_base;
+    uint nj;                             /** Number of joints of the robot model, including the floating base*/
+    std::vector<int> q_idx;              /** Index in the independent coordinates (y_robot for floating base robots, y otherwise) of each joint in the joint order*/
+
+    /** Per-chain results. A result is up to date if its stamp equals the current update counter*/
+    struct ChainData{
+        std::string tip_frame;           /** Empty if the chain is invalid*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;   /** Indexed by ChainId*/
+
+    base::samples::RigidBodyStateSE3 com_rbs;
+    base::MatrixXd com_jac, joint_space_inertia_mat;
+    base::VectorXd bias_forces;
+
+    uint64_t update_counter;
+    uint64_t com_stamp, com_jac_stamp, inertia_mat_stamp, bias_forces_stamp;
+
+    /** Return the data of the given chain. Throws if the chain is unknown or invalid or if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+
+    /** Throw if update() has not been called yet*/
+    void checkUpdated(const char* caller) const;
+
+public:
+    /**
+     * @brief Create a workspace. Throws if the hyrodyn model cannot be loaded
+     * @param urdf_file URDF file of the robot, including the floating base joints for floating base robots
+     * @param submechanism_file Hyrodyn submechanism file of the robot
+     * @param has_floating_base True for floating base robots
+     * @param world_frame Frame id of the CoM state
+     * @param nj Number of joints of the robot model, including the floating base
+     * @param q_idx Index in the independent coordinates of each joint in the joint order
+     * @param chain_tips Tip frame of each chain, indexed by ChainId. Empty for invalid chains
+     */
+    RobotModelWorkspaceHyrodyn(const std::string& urdf_file,
+                               const std::string& submechanism_file,
+                               const bool has_floating_base,
+                               const std::string& world_frame,
+                               const uint nj,
+                               const std::vector<int>& q_idx,
+                               const std::vector<std::string>& chain_tips);
+    virtual ~RobotModelWorkspaceHyrodyn(){}
+
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+    virtual const base::MatrixXd &comJacobian();
+    virtual const base::samples::RigidBodyStateSE3 &centerOfMass();
+    virtual const base::MatrixXd &jointSpaceInertiaMatrix();
+    virtual const base::VectorXd &biasForces();
+    virtual uint noOfChains() const {return chain_data.size();}
+
+    /** Write the floating base state to the hyrodyn model. Throws if the floating base state is invalid*/
+    static void floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state, hyrodyn::RobotModel_HyRoDyn& hyrodyn);
+
+    /** Compute pose, twist and acceleration of the given frame in world coordinates. Does not set time stamp*/
+    static void computeRigidBodyState(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const std::string& tip_frame, base::samples::RigidBodyStateSE3& rbs);
+
+    /** Compute the space Jacobian of the given frame as 6 x nj matrix*/
+    static void computeSpaceJacobian(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const uint nj, const std::string& tip_frame, base::MatrixXd& space_jac);
+
+    /** Compute the body Jacobian of the given frame as 6 x nj matrix*/
+    static void computeBodyJacobian(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const uint nj, const std::string& tip_frame, base::MatrixXd& body_jac);
+
+    /** Compute the spatial acceleration bias of the given frame*/
+    static void computeSpatialAccelerationBias(hyrodyn::RobotModel_HyRoDyn& hyrodyn, const std::string& tip_frame, base::Acceleration& acc_bias);
+
+    /** Compute the center of mass in world coordinates. Does not set frame id and time stamp*/
+    static void computeCenterOfMass(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::samples::RigidBodyStateSE3& com_rbs);
+
+    /** Compute the joint space inertia matrix in actuation space, including the floating base*/
+    static void computeJointSpaceInertiaMatrix(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::MatrixXd& joint_space_inertia_mat);
+
+    /** Compute the bias forces in actuation space, including the floating base. Sets the independent joint accelerations of the hyrodyn model to zero*/
+    static void computeBiasForces(hyrodyn::RobotModel_HyRoDyn& hyrodyn, base::VectorXd& bias_forces);
+};
+
+} // namespace wbc
+
+#endif
@@ -46,18 +46,26 @@ const base::samples::RigidBodyStateSE3 &KinematicChainKDL::rigidBodyState(){
     return cartesian_state;
 }
 
-void KinematicChainKDL::update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, std::map<std::string,int> joint_idx_map){
+void KinematicChainKDL::update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, const std::map<std::string,int>& joint_idx_map){
+
+    // Resolve the joint indices only once, the joint index map does not change after configuration of the robot model
+    if(joint_idx.size() != joint_names.size()){
+        std::vector<int> idx(joint_names.size());
+        for(size_t i = 0; i < joint_names.size(); i++){
+            auto it = joint_idx_map.find(joint_names[i]);
+            if(it == joint_idx_map.end()){
+                LOG_ERROR("Kinematic Chain %s to %s contains joint %s, but this joint is not in joint state vector",
+                          chain.getSegment(0).getName().c_str(), chain.getSegment(chain.getNrOfSegments()-1).getName().c_str(), joint_names[i].c_str());
+                throw std::invalid_argument("Invalid joint state");
+            }
+            idx[i] = it->second;
+        }
+        joint_idx = idx;
+    }
 
     //// update Joints
     for(size_t i = 0; i < joint_names.size(); i++){
-        const std::string& name = joint_names[i];
-        if(joint_idx_map.count(name) == 0){
-            LOG_ERROR("Kinematic Chain %s to %s contains joint %s, but this joint is not in joint state vector",
-                      chain.getSegment(0).getName().c_str(), chain.getSegment(chain.getNrOfSegments()-1).getName().c_str(), joint_names[i].c_str());
-            throw std::invalid_argument("Invalid joint state");
-        }
-
-        uint idx = joint_idx_map[name];
+        const uint idx = joint_idx[i];
 
         jnt_array_vel.q(i)       = jnt_array_acc.q(i)    = q(idx);
         jnt_array_vel.qdot(i)    = jnt_array_acc.qdot(i) = qd(idx);
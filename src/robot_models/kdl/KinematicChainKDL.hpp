@@ -35,8 +35,9 @@ public:
     /**
      * @brief Update all joints of the kinematic chain
      * @param joint_state Has to contain at least all joints that are included in the kinematic chain. Each entry has to have a valid position, velocity and acceleration
+     * @param joint_idx_map Index of each joint in q, qd and qdd. Only evaluated in the first call, the resulting indices are reused afterwards
      */
-    void update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, std::map<std::string,int> joint_idx_map);
+    void update(const KDL::JntArray& q, const KDL::JntArray& qd, const KDL::JntArray& qdd, const std::map<std::string,int>& joint_idx_map);
     /** Convert and return current Cartesian state*/
     const base::samples::RigidBodyStateSE3& rigidBodyState();
 
@@ -62,6 +63,7 @@ public:
     KDL::Jacobian body_jacobian;                     /** Body Jacobian of the Chain. Reference frame is root & reference point is tip*/
     KDL::Jacobian jacobian_dot;                      /** Derivative of Jacobian of the Chain. Reference frame & reference point is the root frame*/
     std::vector<std::string> joint_names;            /** Names of the joint included in the kinematic chain*/
+    std::vector<int> joint_idx;                      /** Index of each chain joint in the joint arrays passed to update(). Resolved in the first call to update()*/
     std::string root_frame;                          /** UID of the kinematics chain root link*/
     std::string tip_frame;                           /** UID of the kinematics chain tip link*/
     base::Time stamp;
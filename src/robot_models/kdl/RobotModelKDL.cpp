@@ -3,7 +3,6 @@
 #include <kdl_parser/kdl_parser.hpp>
 #include <base-logging/Logging.hpp>
 #include "../../core/RobotModelConfig.hpp"
-#include <kdl/treeidsolver_recursive_newton_euler.hpp>
 #include <algorithm>
 #include <tools/URDFTools.hpp>
 #include <kdl/chaindynparam.hpp>
@@ -12,7 +11,10 @@ namespace wbc{
 
 RobotModelRegistry<RobotModelKDL> RobotModelKDL::reg("kdl");
 
-RobotModelKDL::RobotModelKDL(){
+RobotModelKDL::RobotModelKDL() :
+    tree_description(std::make_shared<TreeDescriptionKDL>()),
+    update_counter(0),
+    com_stamp(0){
 }
 
 RobotModelKDL::~RobotModelKDL(){
@@ -22,8 +24,14 @@ void RobotModelKDL::clear(){
 
     RobotModel::clear();
 
-    full_tree = KDL::Tree();
     kdl_chain_map.clear();
+    chain_data.clear();
+    // The id solver refers to the tree of the old description, so release it first. Workspaces keep their own copy of the old description
+    id_solver.reset();
+    tree_description = std::make_shared<TreeDescriptionKDL>();
+    tree_buffers.resize(0);
+    // Don't reset the update counter, so that a CoM computed before clear() can never be mistaken for up to date
+    com_stamp = 0;
 }
 
 bool RobotModelKDL::configure(const RobotModelConfig& cfg){
@@ -56,7 +64,8 @@ bool RobotModelKDL::configure(const RobotModelConfig& cfg){
     URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
 
     // Parse KDL Tree
-    if(!kdl_parser::treeFromUrdfModel(*robot_urdf, full_tree)){
+    std::shared_ptr<TreeDescriptionKDL> description = std::make_shared<TreeDescriptionKDL>();
+    if(!kdl_parser::treeFromUrdfModel(*robot_urdf, description->tree)){
         LOG_ERROR("Unable to load KDL Tree");
         return false;
     }
@@ -93,11 +102,32 @@ bool RobotModelKDL::configure(const RobotModelConfig& cfg){
     for(int i = 0; i < actuated_joint_names.size(); i++)
         selection_matrix(i, jointIndex(actuated_joint_names[i])) = 1.0;
 
-    for(const auto &it : full_tree.getSegments()){
+    description->joint_names = joint_names;
+    for(const auto &it : description->tree.getSegments()){
         KDL::Joint jnt = it.second.segment.getJoint();
         if(jnt.getType() != KDL::Joint::None)
-            joint_idx_map_kdl[jnt.getName()] = GetTreeElementQNr(it.second);
+            description->joint_idx_map_kdl[jnt.getName()] = GetTreeElementQNr(it.second);
     }
+    description->joint_q_nr.resize(noOfJoints());
+    for(uint i = 0; i < noOfJoints(); i++)
+        description->joint_q_nr[i] = description->joint_idx_map_kdl[joint_names[i]];
+    actuated_q_nr.resize(noOfActuatedJoints());
+    for(uint i = 0; i < noOfActuatedJoints(); i++)
+        actuated_q_nr[i] = description->joint_idx_map_kdl[actuated_joint_names[i]];
+    setJointOrder(actuated_joint_names);
+
+    // 4. Create the data structures for the dynamics computations. Start with the children of the root segment, since the root segment
+    // itself has no joint and no inertia
+    for(const auto& child : GetTreeElementChildren(description->tree.getRootSegment()->second))
+        flattenTree(*description, child, -1);
+    for(const auto& segment : description->segments)
+        description->total_mass += segment.getInertia().getMass();
+    tree_buffers.resize(description->segments.size());
+    com_jac.setZero(3, noOfJoints());
+
+    // The description is never modified after this point, so that it can be shared with the workspaces, see createWorkspace()
+    tree_description = description;
+    updateIdSolver();
 
     // 5. Print some debug info
 
@@ -121,8 +151,93 @@ bool RobotModelKDL::configure(const RobotModelConfig& cfg){
     return true;
 }
 
+void RobotModelKDL::flattenTree(TreeDescriptionKDL& description, const KDL::SegmentMap::const_iterator& segment, const int parent_idx){
+
+    const KDL::Segment& seg = GetTreeElementSegment(segment->second);
+    const int idx = description.segments.size();
+
+    description.segments.push_back(seg);
+    description.parent_idx.push_back(parent_idx);
+    description.children_idx.push_back(std::vector<int>());
+    if(parent_idx >= 0)
+        description.children_idx[parent_idx].push_back(idx);
+
+    if(seg.getJoint().getType() != KDL::Joint::None){
+        description.q_nr.push_back(GetTreeElementQNr(segment->second));
+        description.joint_idx.push_back(jointIndex(seg.getJoint().getName()));
+    }
+    else{
+        description.q_nr.push_back(-1);
+        description.joint_idx.push_back(-1);
+    }
+
+    for(const auto& child : GetTreeElementChildren(segment->second))
+        flattenTree(description, child, idx);
+}
+
+void RobotModelKDL::updateIdSolver(){
+    const KDL::Vector g(gravity(0), gravity(1), gravity(2));
+    if(!id_solver || g != id_solver_gravity){
+        id_solver = std::make_shared<KDL::TreeIdSolver_RNE>(tree_description->tree, g);
+        id_solver_gravity = g;
+    }
+}
+
+void RobotModelKDL::addChain(const ChainId chain){
+    chain_data.resize(chain+1);
+}
+
+RobotModelKDL::ChainData& RobotModelKDL::chainData(const ChainId chain, const char* caller){
+
+    if(joint_state.time.isNull()){
+        LOG_ERROR("RobotModelKDL: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string(" Invalid call to ") + caller + "()");
+    }
+    checkChainId(chain);
+    return resolveChain(chain);
+}
+
+RobotModelKDL::ChainData& RobotModelKDL::resolveChain(const ChainId chain){
+
+    // Resolve KDL chain and joint indices on first use
+    ChainData& cd = chain_data[chain];
+    if(!cd.kdl_chain){
+        const std::string &root_frame = chainRoot(chain);
+        const std::string &tip_frame = chainTip(chain);
+        const std::string chain_id = chainID(root_frame, tip_frame);
+        if(kdl_chain_map.count(chain_id) == 0)
+            createChain(root_frame, tip_frame);
+        cd.kdl_chain = kdl_chain_map[chain_id];
+        cd.joint_idx.resize(cd.kdl_chain->joint_names.size());
+        for(uint j = 0; j < cd.kdl_chain->joint_names.size(); j++)
+            cd.joint_idx[j] = jointIndex(cd.kdl_chain->joint_names[j]);
+        // Columns of joints that are not part of the chain are always zero
+        cd.space_jac.setZero(6,noOfJoints());
+        cd.body_jac.setZero(6,noOfJoints());
+    }
+    return cd;
+}
+
+RobotModelWorkspacePtr RobotModelKDL::createWorkspace(){
+    if(!robot_urdf)
+        throw std::runtime_error("RobotModelKDL::createWorkspace: Robot model has not been configured");
+
+    // Resolve all chains, so that the workspaces can copy them. Chains with unknown frames are invalid and throw on request, same as in the robot model itself
+    const KDL::SegmentMap& segments = tree_description->tree.getSegments();
+    std::vector<const KinematicChainKDL*> kdl_chains(chains.size(), nullptr);
+    for(size_t i = 0; i < chains.size(); i++){
+        if(segments.count(chainRoot(i)) && segments.count(chainTip(i)))
+            kdl_chains[i] = resolveChain(i).kdl_chain.get();
+    }
+
+    std::vector<int> q_nr(joint_order_idx.size());
+    for(size_t i = 0; i < joint_order_idx.size(); i++)
+        q_nr[i] = tree_description->joint_q_nr[joint_order_idx[i]];
+    return std::make_shared<RobotModelWorkspaceKDL>(tree_description, has_floating_base, world_frame, gravity, q_nr, kdl_chains);
+}
+
 void RobotModelKDL::createChain(const std::string &root_frame, const std::string &tip_frame){
-    createChain(full_tree, root_frame, tip_frame);
+    createChain(tree_description->tree, root_frame, tip_frame);
 }
 
 void RobotModelKDL::createChain(const KDL::Tree& tree, const std::string &root_frame, const std::string &tip_frame){
@@ -135,7 +250,7 @@ void RobotModelKDL::createChain(const KDL::Tree& tree, const std::string &root_f
     const std::string chain_id = chainID(root_frame, tip_frame);
 
     KinematicChainKDLPtr kin_chain = std::make_shared<KinematicChainKDL>(chain, root_frame, tip_frame);
-    kin_chain->update(q,qd,qdd,joint_idx_map_kdl);
+    kin_chain->update(q,qd,qdd,tree_description->joint_idx_map_kdl);
     kdl_chain_map[chain_id] = kin_chain;
 
     LOG_INFO_S<<"Added chain "<<root_frame<<" --> "<<tip_frame<<std::endl;
@@ -158,28 +273,35 @@ void RobotModelKDL::update(const base::samples::Joints& joint_state_in,
         joint_state[n] = joint_state_in[n];
     joint_state.time = joint_state_in.time;
 
+    updateFromJointState(_floating_base_state);
+}
+
+void RobotModelKDL::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                           const Eigen::Ref<const base::VectorXd>& qd_in,
+                           const Eigen::Ref<const base::VectorXd>& qdd_in,
+                           const base::Time& time,
+                           const base::samples::RigidBodyStateSE3& _floating_base_state){
+    setJointStateRaw(q_in, qd_in, qdd_in, time);
+    updateFromJointState(_floating_base_state);
+}
+
+void RobotModelKDL::updateFromJointState(const base::samples::RigidBodyStateSE3& _floating_base_state){
+
+    // joint_state contains the floating base joints first, followed by the actuated joints
+    const uint n_fb = joint_names_floating_base.size();
+
     // Update floating base if available
     if(has_floating_base){
-        if(!_floating_base_state.hasValidPose() ||
-           !_floating_base_state.hasValidTwist() ||
-           !_floating_base_state.hasValidAcceleration()){
-           LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
-           throw std::runtime_error("Invalid floating base status");
-        }
         if(_floating_base_state.time.isNull()){
             LOG_ERROR("Floating base state does not have a valid timestamp. Or do we have 1970?");
             throw std::runtime_error("Invalid call to update()");
         }
+        RobotModelWorkspaceKDL::floatingBaseState(_floating_base_state, q, qd, qdd);
         floating_base_state = _floating_base_state;
-        base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
-        for(int i = 0; i < 3; i++){
-            q(i)   = joint_state[joint_names_floating_base[i]].position     = floating_base_state.pose.position(i);
-            qd(i)  = joint_state[joint_names_floating_base[i]].speed        = floating_base_state.twist.linear(i);
-            qdd(i) = joint_state[joint_names_floating_base[i]].acceleration = floating_base_state.acceleration.linear(i);
-
-            q(i+3)   = joint_state[joint_names_floating_base[i+3]].position     = euler(i);
-            qd(i+3)  = joint_state[joint_names_floating_base[i+3]].speed        = floating_base_state.twist.angular(i);
-            qdd(i+3) = joint_state[joint_names_floating_base[i+3]].acceleration = floating_base_state.acceleration.angular(i);
+        for(int i = 0; i < 6; i++){
+            joint_state.elements[i].position = q(i);
+            joint_state.elements[i].speed = qd(i);
+            joint_state.elements[i].acceleration = qdd(i);
         }
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
@@ -187,21 +309,16 @@ void RobotModelKDL::update(const base::samples::Joints& joint_state_in,
 
     // Update actuated joints
     for(size_t i = 0; i < noOfActuatedJoints(); i++){
-        const std::string &name = actuated_joint_names[i];
-        if(!hasJoint(name)){
-            LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the KDL Tree, but it is not in the joint state vector."
-                        << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-            throw std::runtime_error("Incomplete Joint State");
-        }
-        const base::JointState &state = joint_state_in[name];
-        uint idx = joint_idx_map_kdl[name];
+        const base::JointState &state = joint_state.elements[n_fb + i];
+        const uint idx = actuated_q_nr[i];
         q(idx) = state.position;
         qd(idx) = state.speed;
         qdd(idx) = state.acceleration;
     }
 
-    for(auto c : kdl_chain_map)
-        c.second->update(q,qd,qdd,joint_idx_map_kdl);
+    for(const auto& c : kdl_chain_map)
+        c.second->update(q,qd,qdd,tree_description->joint_idx_map_kdl);
+    update_counter++;
 }
 
 void RobotModelKDL::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
@@ -210,8 +327,7 @@ void RobotModelKDL::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::V
     _qdd.resize(noOfJoints());
 
     for(int i = 0; i < noOfJoints(); i++){
-        const std::string& name = jointNames()[i];
-        uint idx = joint_idx_map_kdl[name];
+        const uint idx = tree_description->joint_q_nr[i];
         _q[i] = q(idx);
         _qd[i] = qd(idx);
         _qdd[i] = qdd(idx);
@@ -237,8 +353,41 @@ const base::samples::RigidBodyStateSE3 &RobotModelKDL::rigidBodyState(const std:
     return rbs;
 }
 
+const base::samples::RigidBodyStateSE3 &RobotModelKDL::rigidBodyState(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->rigidBodyState(chain);
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        RobotModelWorkspaceKDL::computeRigidBodyState(*cd.kdl_chain, cd.rbs);
+        cd.rbs_stamp = update_counter;
+    }
+    return cd.rbs;
+}
+
 const base::MatrixXd& RobotModelKDL::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
-    return spaceJacobianFromTree(full_tree, root_frame, tip_frame);
+    return spaceJacobianFromTree(tree_description->tree, root_frame, tip_frame);
+}
+
+const base::MatrixXd& RobotModelKDL::spaceJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spaceJacobian(chain);
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        RobotModelWorkspaceKDL::computeSpaceJacobian(*cd.kdl_chain, cd.joint_idx, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
+    }
+    return cd.space_jac;
+}
+
+const base::MatrixXd& RobotModelKDL::bodyJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->bodyJacobian(chain);
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        RobotModelWorkspaceKDL::computeBodyJacobian(*cd.kdl_chain, cd.joint_idx, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
 }
 
 const base::MatrixXd& RobotModelKDL::spaceJacobianFromTree(const KDL::Tree& tree, const std::string &root_frame, const std::string &tip_frame){
@@ -296,46 +445,22 @@ const base::MatrixXd &RobotModelKDL::comJacobian(){
         LOG_ERROR("RobotModelKDL: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to rigidBodyState()");
     }
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->comJacobian();
 
-    com_jac = base::MatrixXd::Zero(3, noOfJoints());
-
-    // create a copy in which, for each segment with mass, COG frames are added
-    KDL::Tree tree_cog_frames = full_tree;
-
-    double totalMass = 0;
-    std::map<std::string, double> mass_map;
-
-    std::vector<std::string> COGSegmentNames;
-    for(auto& segment_it : full_tree.getSegments())
-    {
-        auto segment = segment_it.second.segment;
-        std::string segmentName = segment.getName();
-        // Skip root segment! To get consistent results with RBDL, Pinocchio, etc. we have to start with the first child of Root segment! Why?
-        if(segmentName == full_tree.getRootSegment()->second.segment.getName())
-            continue;
-        std::string segmentNameCOG = segmentName + "_COG";
-
-        KDL::Vector segmentCOG = segment.getInertia().getCOG();
-        double segmentMass = segment.getInertia().getMass();
-
-        if(segmentMass == 0.0)
-            continue;
-
-        KDL::Frame frameCOG(KDL::Rotation(), segmentCOG);
-        tree_cog_frames.addSegment(KDL::Segment(segmentNameCOG, KDL::Joint(KDL::Joint::Fixed), frameCOG), segmentName);
-
-        mass_map[segmentNameCOG] = segmentMass;
-        totalMass += segmentMass;
+    computeCoM();
+    return com_jac;
+}
 
-        COGSegmentNames.push_back(segmentNameCOG);
-    }
+void RobotModelKDL::computeCoM(){
 
-    // compute com jacobian as (mass) weighted average over COG frame jacobians
-    for(const auto& segment_name : COGSegmentNames)
-        com_jac += (mass_map[segment_name] / totalMass) *
-            spaceJacobianFromTree(tree_cog_frames, tree_cog_frames.getRootSegment()->second.segment.getName(), segment_name).topRows<3>();
+    if(com_stamp == update_counter)
+        return;
 
-    return com_jac;
+    RobotModelWorkspaceKDL::computeCoM(*tree_description, q, qd, tree_buffers, com_jac, com_rbs);
+    com_rbs.frame_id = world_frame;
+    com_rbs.time = joint_state.time;
+    com_stamp = update_counter;
 }
 
 const base::MatrixXd &RobotModelKDL::jacobianDot(const std::string &root_frame, const std::string &tip_frame){
@@ -366,12 +491,23 @@ const base::Acceleration &RobotModelKDL::spatialAccelerationBias(const std::stri
     qdot_tmp.resize(noOfJoints());
     tmp_acc.resize(6);
     for(int i = 0; i < joint_names.size(); i++)
-        qdot_tmp[i] = qd(joint_idx_map_kdl[joint_names[i]]);
+        qdot_tmp[i] = qd(tree_description->joint_q_nr[i]);
     tmp_acc = jacobianDot(root_frame, tip_frame)*qdot_tmp;
     spatial_acc_bias = base::Acceleration(tmp_acc.segment(0,3), tmp_acc.segment(3,3));
     return spatial_acc_bias;
 }
 
+const base::Acceleration &RobotModelKDL::spatialAccelerationBias(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spatialAccelerationBias(chain);
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp != update_counter){
+        RobotModelWorkspaceKDL::computeSpatialAccelerationBias(*cd.kdl_chain, cd.acc_bias);
+        cd.acc_bias_stamp = update_counter;
+    }
+    return cd.acc_bias;
+}
+
 const base::VectorXd &RobotModelKDL::biasForces(){
 
     if(joint_state.time.isNull()){
@@ -379,15 +515,8 @@ const base::VectorXd &RobotModelKDL::biasForces(){
         throw std::runtime_error(" Invalid call to jacobianDot()");
     }
 
-    // Use ID solver with zero joint accelerations and zero external wrenches to get bias forces/torques
-    KDL::TreeIdSolver_RNE solver(full_tree, KDL::Vector(gravity(0), gravity(1), gravity(2)));
-    solver.CartToJnt(q, qd, zero, std::map<std::string,KDL::Wrench>(), tau);
-
-    for(uint i = 0; i < joint_names.size(); i++){
-        const std::string &name = joint_names[i];
-        uint idx = joint_idx_map_kdl[name];
-        bias_forces[i] = tau(idx);
-    }
+    updateIdSolver();
+    RobotModelWorkspaceKDL::computeBiasForces(*tree_description, *id_solver, q, qd, zero, tau, bias_forces);
     return bias_forces;
 }
 
@@ -398,74 +527,11 @@ const base::MatrixXd& RobotModelKDL::jointSpaceInertiaMatrix(){
         throw std::runtime_error(" Invalid call to jacobianDot()");
     }
 
-    joint_space_inertia_mat.setZero();
-
-    // Use ID solver with zero bias and external wrenches to compute joint space inertia matrix column by column.
-    // TODO: Switch to more efficient method!
-    KDL::TreeIdSolver_RNE solver(full_tree, KDL::Vector::Zero());
-    for(uint i = 0; i < joint_names.size(); i++){
-        const std::string& name = joint_names[i];
-        qdd.data.setZero();
-        qdd(joint_idx_map_kdl[name]) = 1;
-        int ret = solver.CartToJnt(q, zero, qdd, std::map<std::string,KDL::Wrench>(), tau);
-        if(ret != 0)
-            throw(std::runtime_error("Unable to compute Tree Inverse Dynamics in joint space inertia matrix computation. Error Code is " + std::to_string(ret)));
-        for(int j = 0; j < joint_names.size(); j++){
-            const std::string& _name = joint_names[j];
-            joint_space_inertia_mat(j, i) = tau(joint_idx_map_kdl[_name]);
-        }
-    }
+    RobotModelWorkspaceKDL::computeJointSpaceInertiaMatrix(*tree_description, q, tree_buffers, joint_space_inertia_mat);
     return joint_space_inertia_mat;
 }
 
 
-void RobotModelKDL::recursiveCOM(const KDL::SegmentMap::const_iterator& currentSegment, const KDL::Frame& frame, double& mass, KDL::Vector& cog)
-{
-    double jointPosition = 0.0; // Joint position of the current joint
-#ifdef KDL_USE_NEW_TREE_INTERFACE
-    KDL::Segment segment = currentSegment->second->segment;
-#else
-    KDL::Segment segment = currentSegment->second.segment;
-#endif
-    // If the segment has a real joint, get the joint position
-    if( segment.getJoint().getType() != KDL::Joint::None ) {
-        const std::string name = segment.getJoint().getName();
-        if(joint_idx_map_kdl.count(name)==0){
-            LOG_ERROR_S  << "recursiveCOM: KDL tree contains joint " << name << " but this joint does not exist in joint idx map" << std::endl;
-            throw std::runtime_error("Problem with model configuration");
-        }
-        uint idx = joint_idx_map_kdl[name];
-        jointPosition = q(idx);
-    }
-
-    // Transform to the frame of the current segment
-    KDL::Frame currentFrame = frame * segment.pose( jointPosition );
-    // Get the COG of the current segemnt in the KDL tree
-    KDL::Vector currentCOG = segment.getInertia().getCOG();
-    // Gets the current mass
-    double currentMass = segment.getInertia().getMass();
-
-    // Computes the cog
-    cog += currentMass * ( currentFrame * currentCOG );
-    // Appends to the total mass
-    mass += currentMass;
-
-    // Iterates through all the child segments
-    std::vector< KDL::SegmentMap::const_iterator >::const_iterator childSegment;
-#ifdef KDL_USE_NEW_TREE_INTERFACE
-    for( childSegment = currentSegment->second->children.begin();
-            childSegment != currentSegment->second->children.end();
-#else
-    for( childSegment = currentSegment->second.children.begin();
-            childSegment != currentSegment->second.children.end();
-#endif
-            ++childSegment)
-    {
-        // Calls this functiion again with the child segment
-        recursiveCOM( *childSegment, currentFrame, mass, cog );
-    }
-}
-
 const base::samples::RigidBodyStateSE3& RobotModelKDL::centerOfMass(){
 
     if(joint_state.time.isNull()){
@@ -473,19 +539,7 @@ const base::samples::RigidBodyStateSE3& RobotModelKDL::centerOfMass(){
         throw std::runtime_error(" Invalid call to centerOfMass()");
     }
 
-    double mass = 0.0; // to get the total mass
-    KDL::Frame frame = KDL::Frame::Identity(); // Transformation of the last frame
-
-    // Computes the COG of the complete robot
-    KDL::Vector cog_pos;
-    // To get consistent results with RBDL, Pinocchio, etc. we have to start with the first child of Root link! Why?
-    recursiveCOM( full_tree.getRootSegment()->second.children[0], frame, mass, cog_pos );
-
-    // Returns the COG
-    com_rbs.frame_id = world_frame;
-    com_rbs.pose.position = base::Vector3d( cog_pos.x(), cog_pos.y(), cog_pos.z() ) / mass;
-    com_rbs.pose.orientation.setIdentity();
-    com_rbs.time = joint_state.time;
+    computeCoM();
     return com_rbs;
 }
 
@@ -495,7 +549,7 @@ void RobotModelKDL::computeInverseDynamics(base::commands::Joints &solver_output
         throw std::runtime_error(" Invalid call to jacobianDot()");
     }
 
-    KDL::TreeIdSolver_RNE solver(full_tree, KDL::Vector(gravity[0], gravity[1], gravity[2]));
+    updateIdSolver();
     KDL::WrenchMap w_map;
     for(auto n : contact_wrenches.names)
         w_map[n] = KDL::Wrench(KDL::Vector(contact_wrenches[n].force[0],
@@ -504,13 +558,11 @@ void RobotModelKDL::computeInverseDynamics(base::commands::Joints &solver_output
                                KDL::Vector(contact_wrenches[n].torque[0],
                                            contact_wrenches[n].torque[1],
                                            contact_wrenches[n].torque[2]));
-    int ret = solver.CartToJnt(q, qd, qdd, w_map, tau);
+    int ret = id_solver->CartToJnt(q, qd, qdd, w_map, tau);
     if(ret != 0)
         throw(std::runtime_error("Unable to compute Tree Inverse Dynamics. Error Code is " + std::to_string(ret)));
 
-    for(uint i = 0; i < noOfActuatedJoints(); i++){
-        const std::string& name = actuated_joint_names[i];
-        solver_output[name].effort = tau(joint_idx_map_kdl[name]);
-    }
+    for(uint i = 0; i < noOfActuatedJoints(); i++)
+        solver_output[actuated_joint_names[i]].effort = tau(actuated_q_nr[i]);
 }
 }
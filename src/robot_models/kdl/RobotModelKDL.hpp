@@ -2,10 +2,12 @@
 #define ROBOTMODELKDL_HPP
 
 #include "core/RobotModel.hpp"
+#include "RobotModelWorkspaceKDL.hpp"
 
 #include <kdl/tree.hpp>
 #include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
+#include <kdl/treeidsolver_recursive_newton_euler.hpp>
 #include <urdf_world/types.h>
 #include <map>
 
@@ -29,10 +31,47 @@ protected:
     base::VectorXd qdot_tmp;
     base::VectorXd tmp_acc;
 
-    KDL::Tree full_tree;                          /** Overall kinematic tree*/
-    std::map<std::string,int> joint_idx_map_kdl;
+    std::shared_ptr<const TreeDescriptionKDL> tree_description; /** Overall kinematic tree. Immutable after configure(), shared with all workspaces, see createWorkspace()*/
+    std::vector<int> actuated_q_nr;               /** Index of each actuated joint in q/qd/qdd*/
     KinematicChainKDLMap kdl_chain_map;           /** Map of KDL Chains*/
 
+    /** Per-chain data for the chain id based queries. The results are computed at most once per update()*/
+    struct ChainData{
+        KinematicChainKDLPtr kdl_chain;           /** Resolved on first use. Same as the corresponding entry in kdl_chain_map*/
+        std::vector<int> joint_idx;               /** Index of each chain joint in jointNames()*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;            /** Indexed by ChainId*/
+
+    std::shared_ptr<KDL::TreeIdSolver_RNE> id_solver; /** Inverse dynamics solver for bias forces and inverse dynamics. Only recreated if the gravity vector changes*/
+    KDL::Vector id_solver_gravity;                    /** Gravity vector that was used to create id_solver*/
+
+    TreeBuffersKDL tree_buffers;                       /** Intermediate results of the computations on the flat tree representation*/
+
+    uint64_t update_counter;                           /** Incremented in every call to update()*/
+    uint64_t com_stamp;                                /** Value of update_counter when CoM and CoM Jacobian were computed last*/
+
+    /**
+     * @brief Recursively add the given segment and all its children to the flat tree representation
+     * @param description Tree description to which the flat representation is added
+     * @param segment Current segment in the recursion
+     * @param parent_idx Index of the parent segment in the flat representation, -1 if the parent is the root segment
+     */
+    void flattenTree(TreeDescriptionKDL& description, const KDL::SegmentMap::const_iterator& segment, const int parent_idx);
+
+    /** Compute q, qd, qdd from joint_state and the given floating base state and update all kinematic chains*/
+    void updateFromJointState(const base::samples::RigidBodyStateSE3& floating_base_state);
+
+    /** Create the inverse dynamics solver if it does not exist yet or if the gravity vector has changed*/
+    void updateIdSolver();
+
+    /** Compute CoM position, CoM velocity and CoM Jacobian in a single pass over the flat tree. Does nothing if these
+     *  have already been computed since the last call to update()*/
+    void computeCoM();
+
     /**
      * @brief Create a KDL chain and add it to the KDL Chain map. Throws an exception if chain cannot be extracted from KDL Tree
      * @param root_frame Root frame of the chain
@@ -48,6 +87,15 @@ protected:
      */
     void createChain(const KDL::Tree& tree, const std::string &root_frame, const std::string &tip_frame);
 
+    /** Allocate the per-chain data for the given chain*/
+    virtual void addChain(const ChainId chain);
+
+    /** Return the data of the given chain. Creates the KDL chain on first use. Throws if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+
+    /** Return the data of the given chain and create the KDL chain if it does not exist yet. Throws if the chain cannot be extracted from the KDL tree*/
+    ChainData& resolveChain(const ChainId chain);
+
     /** Add a KDL Tree to the model. If the model is empty, the overall KDL::Tree will be replaced by the given tree. If there
      *  is already a KDL Tree, the new tree will be attached with the given pose to the hook frame of the overall tree. The relative poses
      *  of the trees can be updated online by calling update() with poses parameter appropriately set. This will also create the
@@ -56,16 +104,6 @@ protected:
     /** Free storage and clear data structures*/
     void clear();
 
-    /**
-     * Recursively loops through all the tree segments and compute the
-     * COG of the complete tree.
-     * @param currentSegement Current Segement in the recursive loop
-     * @param status Current joint state
-     */
-    void recursiveCOM( const KDL::SegmentMap::const_iterator& currentSegment,
-                       const KDL::Frame& frame,
-                       double& mass, KDL::Vector& cog);
-
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param tree kinematic tree from which the jacobian is computed.
@@ -101,6 +139,15 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
 
+    /**
+     * @brief Update the robot configuration from raw state vectors in the order given by setJointOrder(). Does not perform any name lookups. See RobotModel::update() for details
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
 
@@ -112,6 +159,9 @@ public:
      */
     virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as rigidBodyState(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -119,6 +169,9 @@ public:
       */
     virtual const base::MatrixXd &spaceJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spaceJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+
     /** @brief Returns the Body Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -126,6 +179,9 @@ public:
       */
     virtual const base::MatrixXd &bodyJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as bodyJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+
 
     /** @brief Returns the CoM Jacobian for the entire robot, which maps the robot joint velocities to linear spatial velocities in robot base coordinates.
       * Size of the Jacobian will be 3 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
@@ -150,6 +206,9 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spatialAccelerationBias(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+
     /** Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix();
 
@@ -157,7 +216,7 @@ public:
     virtual const base::VectorXd &biasForces();
 
     /** Return full tree (KDL model)*/
-    KDL::Tree getTree(){return full_tree;}
+    KDL::Tree getTree(){return tree_description->tree;}
 
     /** @brief Compute and return center of mass expressed in base frame*/
     virtual const base::samples::RigidBodyStateSE3& centerOfMass();
@@ -165,6 +224,12 @@ public:
     /** @brief Compute and return the inverse dynamics solution*/
     virtual void computeInverseDynamics(base::commands::Joints &solver_output);
 
+    /** Workspaces are supported, see createWorkspace()*/
+    virtual bool supportsWorkspaces() const {return true;}
+
+    /** Create a RobotModelWorkspaceKDL, which shares the KDL tree and owns its own copies of the kinematic chains and solvers, see RobotModel::createWorkspace()*/
+    virtual RobotModelWorkspacePtr createWorkspace();
+
 };
 
 }
@@ -0,0 +1,322 @@
+#include "RobotModelWorkspaceKDL.hpp"
+#include "KinematicChainKDL.hpp"
+#include <base-logging/Logging.hpp>
+#include <algorithm>
+
+namespace wbc {
+
+void TreeBuffersKDL::resize(const size_t n_segments){
+    X.resize(n_segments);
+    S.resize(n_segments);
+    Ic.resize(n_segments);
+    T.resize(n_segments);
+    subtree_mass.resize(n_segments);
+    subtree_mc.resize(n_segments);
+}
+
+RobotModelWorkspaceKDL::RobotModelWorkspaceKDL(TreeDescriptionKDLConstPtr description,
+                                               const bool has_floating_base,
+                                               const std::string& world_frame,
+                                               const base::Vector3d& gravity,
+                                               const std::vector<int>& q_nr,
+                                               const std::vector<const KinematicChainKDL*>& chains) :
+    description(description),
+    has_floating_base(has_floating_base),
+    q_nr(q_nr),
+    update_counter(0),
+    com_stamp(0),
+    inertia_mat_stamp(0),
+    bias_forces_stamp(0){
+
+    const uint nj = description->joint_names.size();
+    q.resize(nj);
+    qd.resize(nj);
+    qdd.resize(nj);
+    tau.resize(nj);
+    zero.resize(nj);
+    q.data.setZero();
+    qd.data.setZero();
+    qdd.data.setZero();
+    zero.data.setZero();
+    tree_buffers.resize(description->segments.size());
+    id_solver = std::make_shared<KDL::TreeIdSolver_RNE>(description->tree, KDL::Vector(gravity(0), gravity(1), gravity(2)));
+
+    chain_data.resize(chains.size());
+    for(size_t i = 0; i < chains.size(); i++){
+        if(!chains[i])
+            continue;
+        ChainData& cd = chain_data[i];
+        cd.kdl_chain = std::make_shared<KinematicChainKDL>(chains[i]->chain, chains[i]->root_frame, chains[i]->tip_frame);
+        cd.joint_idx.resize(cd.kdl_chain->joint_names.size());
+        for(size_t j = 0; j < cd.kdl_chain->joint_names.size(); j++){
+            const auto it = std::find(description->joint_names.begin(), description->joint_names.end(), cd.kdl_chain->joint_names[j]);
+            cd.joint_idx[j] = it - description->joint_names.begin();
+        }
+        // Columns of joints that are not part of the chain are always zero
+        cd.space_jac.setZero(6,nj);
+        cd.body_jac.setZero(6,nj);
+    }
+    com_jac.setZero(3,nj);
+    com_rbs.frame_id = world_frame;
+    joint_space_inertia_mat.setZero(nj,nj);
+    bias_forces.setZero(nj);
+}
+
+void RobotModelWorkspaceKDL::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                                    const Eigen::Ref<const base::VectorXd>& qd_in,
+                                    const Eigen::Ref<const base::VectorXd>& qdd_in,
+                                    const base::samples::RigidBodyStateSE3& floating_base_state){
+    const size_t n = q_nr.size();
+    if(q_in.size() != n || qd_in.size() != n || qdd_in.size() != n){
+        LOG_ERROR("Size of joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q_in.size(), qd_in.size(), qdd_in.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    if(has_floating_base)
+        floatingBaseState(floating_base_state, q, qd, qdd);
+    for(size_t i = 0; i < n; i++){
+        q(q_nr[i]) = q_in[i];
+        qd(q_nr[i]) = qd_in[i];
+        qdd(q_nr[i]) = qdd_in[i];
+    }
+
+    for(ChainData& cd : chain_data){
+        if(cd.kdl_chain)
+            cd.kdl_chain->update(q,qd,qdd,description->joint_idx_map_kdl);
+    }
+    update_counter++;
+}
+
+void RobotModelWorkspaceKDL::checkUpdated(const char* caller) const{
+    if(update_counter == 0){
+        LOG_ERROR("RobotModelWorkspaceKDL: You have to call update() at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+}
+
+RobotModelWorkspaceKDL::ChainData& RobotModelWorkspaceKDL::chainData(const ChainId chain, const char* caller){
+    if(chain < 0 || chain >= (int)chain_data.size()){
+        LOG_ERROR("Invalid chain id %i in %s(). The workspace knows %i chains. Chains have to be created before the workspace", chain, caller, chain_data.size());
+        throw std::invalid_argument("Invalid chain id");
+    }
+    ChainData& cd = chain_data[chain];
+    if(!cd.kdl_chain){
+        LOG_ERROR("Chain %i was requested in %s(), but either its root or its tip frame does not exist in robot model", chain, caller);
+        throw std::invalid_argument("Invalid chain id");
+    }
+    checkUpdated(caller);
+    return cd;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceKDL::rigidBodyState(const ChainId chain){
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        computeRigidBodyState(*cd.kdl_chain, cd.rbs);
+        cd.rbs_stamp = update_counter;
+    }
+    return cd.rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceKDL::spaceJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        computeSpaceJacobian(*cd.kdl_chain, cd.joint_idx, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
+    }
+    return cd.space_jac;
+}
+
+const base::MatrixXd &RobotModelWorkspaceKDL::bodyJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        computeBodyJacobian(*cd.kdl_chain, cd.joint_idx, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
+}
+
+const base::Acceleration &RobotModelWorkspaceKDL::spatialAccelerationBias(const ChainId chain){
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp != update_counter){
+        computeSpatialAccelerationBias(*cd.kdl_chain, cd.acc_bias);
+        cd.acc_bias_stamp = update_counter;
+    }
+    return cd.acc_bias;
+}
+
+const base::MatrixXd &RobotModelWorkspaceKDL::comJacobian(){
+    checkUpdated("comJacobian");
+    if(com_stamp != update_counter){
+        computeCoM(*description, q, qd, tree_buffers, com_jac, com_rbs);
+        com_stamp = update_counter;
+    }
+    return com_jac;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceKDL::centerOfMass(){
+    checkUpdated("centerOfMass");
+    if(com_stamp != update_counter){
+        computeCoM(*description, q, qd, tree_buffers, com_jac, com_rbs);
+        com_stamp = update_counter;
+    }
+    return com_rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceKDL::jointSpaceInertiaMatrix(){
+    checkUpdated("jointSpaceInertiaMatrix");
+    if(inertia_mat_stamp != update_counter){
+        computeJointSpaceInertiaMatrix(*description, q, tree_buffers, joint_space_inertia_mat);
+        inertia_mat_stamp = update_counter;
+    }
+    return joint_space_inertia_mat;
+}
+
+const base::VectorXd &RobotModelWorkspaceKDL::biasForces(){
+    checkUpdated("biasForces");
+    if(bias_forces_stamp != update_counter){
+        computeBiasForces(*description, *id_solver, q, qd, zero, tau, bias_forces);
+        bias_forces_stamp = update_counter;
+    }
+    return bias_forces;
+}
+
+void RobotModelWorkspaceKDL::floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state, KDL::JntArray& q, KDL::JntArray& qd, KDL::JntArray& qdd){
+    if(!floating_base_state.hasValidPose() ||
+       !floating_base_state.hasValidTwist() ||
+       !floating_base_state.hasValidAcceleration()){
+       LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
+       throw std::runtime_error("Invalid floating base status");
+    }
+
+    // The floating base joints are the first joints of the KDL tree
+    base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
+    for(int i = 0; i < 3; i++){
+        q(i)   = floating_base_state.pose.position(i);
+        qd(i)  = floating_base_state.twist.linear(i);
+        qdd(i) = floating_base_state.acceleration.linear(i);
+
+        q(i+3)   = euler(i);
+        qd(i+3)  = floating_base_state.twist.angular(i);
+        qdd(i+3) = floating_base_state.acceleration.angular(i);
+    }
+}
+
+void RobotModelWorkspaceKDL::computeRigidBodyState(KinematicChainKDL& kdl_chain, base::samples::RigidBodyStateSE3& rbs){
+    kdl_chain.calculateForwardKinematics();
+    rbs = kdl_chain.rigidBodyState();
+}
+
+void RobotModelWorkspaceKDL::computeSpaceJacobian(KinematicChainKDL& kdl_chain, const std::vector<int>& joint_idx, base::MatrixXd& space_jac){
+    kdl_chain.calculateSpaceJacobian();
+    for(uint j = 0; j < joint_idx.size(); j++)
+        space_jac.col(joint_idx[j]) = kdl_chain.space_jacobian.data.col(j);
+}
+
+void RobotModelWorkspaceKDL::computeBodyJacobian(KinematicChainKDL& kdl_chain, const std::vector<int>& joint_idx, base::MatrixXd& body_jac){
+    kdl_chain.calculateBodyJacobian();
+    for(uint j = 0; j < joint_idx.size(); j++)
+        body_jac.col(joint_idx[j]) = kdl_chain.body_jacobian.data.col(j);
+}
+
+void RobotModelWorkspaceKDL::computeSpatialAccelerationBias(KinematicChainKDL& kdl_chain, base::Acceleration& acc_bias){
+    kdl_chain.calculateJacobianDot();
+    // Only the columns of the chain joints are non-zero, so the product can be computed on chain level
+    const base::Vector6d acc = kdl_chain.jacobian_dot.data*kdl_chain.jnt_array_vel.qdot.data;
+    acc_bias.linear = acc.segment(0,3);
+    acc_bias.angular = acc.segment(3,3);
+}
+
+void RobotModelWorkspaceKDL::computeCoM(const TreeDescriptionKDL& description, const KDL::JntArray& q, const KDL::JntArray& qd, TreeBuffersKDL& buffers,
+                                        base::MatrixXd& com_jac, base::samples::RigidBodyStateSE3& com_rbs){
+
+    // Forward pass: Segment poses in root coordinates
+    const int n_segments = description.segments.size();
+    for(int i = 0; i < n_segments; i++){
+        const double q_i = description.q_nr[i] >= 0 ? q(description.q_nr[i]) : 0.0;
+        if(description.parent_idx[i] < 0)
+            buffers.T[i] = description.segments[i].pose(q_i);
+        else
+            buffers.T[i] = buffers.T[description.parent_idx[i]] * description.segments[i].pose(q_i);
+    }
+
+    // Backward pass: Mass and mass weighted COG of each subtree. Children are stored after their parents, so they have already been processed here.
+    // A joint moves the complete subtree behind it, so its CoM Jacobian column is the (mass weighted) velocity of the subtree COG induced by a unit joint velocity.
+    base::Vector3d com_vel = base::Vector3d::Zero();
+    KDL::Vector com_pos = KDL::Vector::Zero();
+    for(int i = n_segments-1; i >= 0; i--){
+        const KDL::RigidBodyInertia& inertia = description.segments[i].getInertia();
+        buffers.subtree_mass[i] = inertia.getMass();
+        buffers.subtree_mc[i] = inertia.getMass() * (buffers.T[i] * inertia.getCOG());
+        for(const int c : description.children_idx[i]){
+            buffers.subtree_mass[i] += buffers.subtree_mass[c];
+            buffers.subtree_mc[i] += buffers.subtree_mc[c];
+        }
+        if(description.parent_idx[i] < 0)
+            com_pos += buffers.subtree_mc[i];
+
+        const int col = description.joint_idx[i];
+        if(col < 0)
+            continue;
+
+        // Unit joint twist in root coordinates. Segment::twist() is expressed in parent coordinates with reference point at the segment origin
+        const KDL::Rotation& rot_parent = description.parent_idx[i] < 0 ? KDL::Rotation::Identity() : buffers.T[description.parent_idx[i]].M;
+        const KDL::Twist S = rot_parent * description.segments[i].twist(q(description.q_nr[i]), 1.0);
+        const KDL::Vector v = (buffers.subtree_mass[i] * S.vel + S.rot * (buffers.subtree_mc[i] - buffers.subtree_mass[i] * buffers.T[i].p)) / description.total_mass;
+        com_jac.col(col) = base::Vector3d(v.x(), v.y(), v.z());
+        com_vel += com_jac.col(col) * qd(description.q_nr[i]);
+    }
+    com_pos = com_pos / description.total_mass;
+
+    com_rbs.pose.position = base::Vector3d(com_pos.x(), com_pos.y(), com_pos.z());
+    com_rbs.pose.orientation.setIdentity();
+    com_rbs.twist.linear = com_vel;
+    com_rbs.twist.angular.setZero();
+}
+
+void RobotModelWorkspaceKDL::computeJointSpaceInertiaMatrix(const TreeDescriptionKDL& description, const KDL::JntArray& q, TreeBuffersKDL& buffers,
+                                                            base::MatrixXd& joint_space_inertia_mat){
+
+    // Composite rigid body algorithm on the flat tree representation, see Featherstone: "Rigid Body Dynamics Algorithms", Table 6.2.
+    // Forward pass: Segment poses and joint motion subspaces
+    const int n_segments = description.segments.size();
+    for(int i = 0; i < n_segments; i++){
+        const KDL::Segment& segment = description.segments[i];
+        const double q_i = description.q_nr[i] >= 0 ? q(description.q_nr[i]) : 0.0;
+        buffers.X[i] = segment.pose(q_i);
+        buffers.S[i] = buffers.X[i].M.Inverse(segment.twist(q_i, 1.0));
+    }
+
+    // Backward pass: Composite inertias. Children are stored after their parents, so they have already been processed here
+    joint_space_inertia_mat.setZero();
+    for(int i = n_segments-1; i >= 0; i--){
+        buffers.Ic[i] = description.segments[i].getInertia();
+        for(const int c : description.children_idx[i])
+            buffers.Ic[i] = buffers.Ic[i] + buffers.X[c]*buffers.Ic[c];
+
+        const int row = description.joint_idx[i];
+        if(row < 0)
+            continue;
+
+        // Propagate the force F = Ic*S towards the root and project it onto the motion subspaces of all supporting joints
+        KDL::Wrench F = buffers.Ic[i]*buffers.S[i];
+        joint_space_inertia_mat(row,row) = KDL::dot(buffers.S[i], F);
+        int j = i;
+        while(description.parent_idx[j] >= 0){
+            F = buffers.X[j]*F;
+            j = description.parent_idx[j];
+            const int col = description.joint_idx[j];
+            if(col >= 0)
+                joint_space_inertia_mat(row,col) = joint_space_inertia_mat(col,row) = KDL::dot(buffers.S[j], F);
+        }
+    }
+}
+
+void RobotModelWorkspaceKDL::computeBiasForces(const TreeDescriptionKDL& description, KDL::TreeIdSolver_RNE& id_solver, const KDL::JntArray& q, const KDL::JntArray& qd,
+                                               const KDL::JntArray& zero, KDL::JntArray& tau, base::VectorXd& bias_forces){
+    // Use ID solver with zero joint accelerations and zero external wrenches to get bias forces/torques
+    id_solver.CartToJnt(q, qd, zero, KDL::WrenchMap(), tau);
+    for(uint i = 0; i < description.joint_q_nr.size(); i++)
+        bias_forces[i] = tau(description.joint_q_nr[i]);
+}
+
+} // namespace wbc
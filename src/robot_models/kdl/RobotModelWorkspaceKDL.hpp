@@ -0,0 +1,147 @@
+#ifndef ROBOT_MODEL_WORKSPACE_KDL_HPP
+#define ROBOT_MODEL_WORKSPACE_KDL_HPP
+
+#include "core/RobotModelWorkspace.hpp"
+#include <kdl/tree.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/treeidsolver_recursive_newton_euler.hpp>
+#include <vector>
+#include <string>
+#include <map>
+
+namespace wbc {
+
+class KinematicChainKDL;
+
+/**
+ * @brief Description of the kinematic tree of RobotModelKDL. Created in RobotModelKDL::configure() and never modified afterwards, so that it can be shared by the robot model
+ *  and all of its workspaces. The KDL inverse dynamics solvers only keep a reference to the tree, which stays valid as long as the description exists.
+ *  The flat representation of the tree is required by the composite rigid body algorithm and the CoM computation. Parents are always stored before their children.
+ *  The root segment of the KDL tree is not part of the flat representation.
+ */
+struct TreeDescriptionKDL{
+    KDL::Tree tree;                                 /** Overall kinematic tree*/
+    std::vector<std::string> joint_names;           /** Same as RobotModel::jointNames()*/
+    std::map<std::string,int> joint_idx_map_kdl;    /** Index in the KDL joint arrays of each joint*/
+    std::vector<int> joint_q_nr;                    /** Index in the KDL joint arrays of each joint in joint_names*/
+    std::vector<KDL::Segment> segments;
+    std::vector<int> parent_idx;                    /** Index of the parent segment, -1 for the children of the root segment*/
+    std::vector< std::vector<int> > children_idx;   /** Indices of the child segments*/
+    std::vector<int> q_nr;                          /** Index of the segment joint in the KDL joint arrays, -1 for fixed joints*/
+    std::vector<int> joint_idx;                     /** Index of the segment joint in joint_names, -1 for fixed joints*/
+    double total_mass = 0;                          /** Total mass of the robot*/
+};
+typedef std::shared_ptr<const TreeDescriptionKDL> TreeDescriptionKDLConstPtr;
+
+/** State dependent intermediate results of the computations on the flat tree representation, see TreeDescriptionKDL*/
+struct TreeBuffersKDL{
+    std::vector<KDL::Frame> X;                    /** Pose of each segment in parent segment coordinates*/
+    std::vector<KDL::Twist> S;                    /** Motion subspace of each segment joint in segment coordinates*/
+    std::vector<KDL::RigidBodyInertia> Ic;        /** Composite rigid body inertia of each segment in segment coordinates*/
+    std::vector<KDL::Frame> T;                    /** Pose of each segment in root coordinates*/
+    std::vector<double> subtree_mass;             /** Total mass of the subtree starting at each segment*/
+    std::vector<KDL::Vector> subtree_mc;          /** Mass weighted sum of the COGs of the subtree starting at each segment, in root coordinates*/
+
+    void resize(const size_t n_segments);
+};
+
+/**
+ * @brief Workspace of RobotModelKDL, see RobotModelWorkspace. Shares the kinematic tree with the robot model (see TreeDescriptionKDL) and owns the joint arrays,
+ *  one copy of each kinematic chain including its KDL solvers and its own inverse dynamics solver. The static functions implement the kinematics and dynamics for both
+ *  RobotModelKDL and the workspaces, so that both give identical results.
+ */
+class RobotModelWorkspaceKDL : public RobotModelWorkspace{
+protected:
+    TreeDescriptionKDLConstPtr description;
+    bool has_floating_base;
+    std::vector<int> q_nr;                                /** Index in the KDL joint arrays of each joint in the joint order*/
+    KDL::JntArray q, qd, qdd, tau, zero;
+    TreeBuffersKDL tree_buffers;
+    std::shared_ptr<KDL::TreeIdSolver_RNE> id_solver;     /** Refers to the tree of the shared description*/
+
+    /** Per-chain results. A result is up to date if its stamp equals the current update counter*/
+    struct ChainData{
+        std::shared_ptr<KinematicChainKDL> kdl_chain;     /** Own copy of the chain and its solvers. Null if the chain is invalid*/
+        std::vector<int> joint_idx;                       /** Index of each chain joint in RobotModel::jointNames()*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;   /** Indexed by ChainId*/
+
+    base::samples::RigidBodyStateSE3 com_rbs;
+    base::MatrixXd com_jac, joint_space_inertia_mat;
+    base::VectorXd bias_forces;
+
+    uint64_t update_counter;
+    uint64_t com_stamp, inertia_mat_stamp, bias_forces_stamp;
+
+    /** Return the data of the given chain. Throws if the chain is unknown or invalid or if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+
+    /** Throw if update() has not been called yet*/
+    void checkUpdated(const char* caller) const;
+
+public:
+    /**
+     * @brief Create a workspace
+     * @param description Description of the kinematic tree, is shared
+     * @param has_floating_base True for floating base robots
+     * @param world_frame Frame id of the CoM state
+     * @param gravity Gravity vector for the bias forces
+     * @param q_nr Index in the KDL joint arrays of each joint in the joint order
+     * @param chains KDL chain of each chain, indexed by ChainId. The chains including their solvers are copied. Null for invalid chains
+     */
+    RobotModelWorkspaceKDL(TreeDescriptionKDLConstPtr description,
+                           const bool has_floating_base,
+                           const std::string& world_frame,
+                           const base::Vector3d& gravity,
+                           const std::vector<int>& q_nr,
+                           const std::vector<const KinematicChainKDL*>& chains);
+    virtual ~RobotModelWorkspaceKDL(){}
+
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+    virtual const base::MatrixXd &comJacobian();
+    virtual const base::samples::RigidBodyStateSE3 &centerOfMass();
+    virtual const base::MatrixXd &jointSpaceInertiaMatrix();
+    virtual const base::VectorXd &biasForces();
+    virtual uint noOfChains() const {return chain_data.size();}
+
+    /** Write the floating base state to the first six entries of the KDL joint arrays (position and XYZ euler angles). Throws if the floating base state is invalid*/
+    static void floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state, KDL::JntArray& q, KDL::JntArray& qd, KDL::JntArray& qdd);
+
+    /** Compute pose, twist and acceleration of the chain tip in chain root coordinates. The chain has to be up to date with the current joint state*/
+    static void computeRigidBodyState(KinematicChainKDL& kdl_chain, base::samples::RigidBodyStateSE3& rbs);
+
+    /** Compute the space Jacobian of the chain as full body Jacobian. The columns of joints that are not part of the chain are not modified*/
+    static void computeSpaceJacobian(KinematicChainKDL& kdl_chain, const std::vector<int>& joint_idx, base::MatrixXd& space_jac);
+
+    /** Compute the body Jacobian of the chain as full body Jacobian. The columns of joints that are not part of the chain are not modified*/
+    static void computeBodyJacobian(KinematicChainKDL& kdl_chain, const std::vector<int>& joint_idx, base::MatrixXd& body_jac);
+
+    /** Compute the spatial acceleration bias Jdot*qdot of the chain*/
+    static void computeSpatialAccelerationBias(KinematicChainKDL& kdl_chain, base::Acceleration& acc_bias);
+
+    /** Compute CoM position, CoM velocity and CoM Jacobian in a single pass over the flat tree. Does not set frame id and time stamp*/
+    static void computeCoM(const TreeDescriptionKDL& description, const KDL::JntArray& q, const KDL::JntArray& qd, TreeBuffersKDL& buffers,
+                           base::MatrixXd& com_jac, base::samples::RigidBodyStateSE3& com_rbs);
+
+    /** Compute the joint space inertia matrix with the composite rigid body algorithm on the flat tree. Size of the matrix has to be nj x nj*/
+    static void computeJointSpaceInertiaMatrix(const TreeDescriptionKDL& description, const KDL::JntArray& q, TreeBuffersKDL& buffers, base::MatrixXd& joint_space_inertia_mat);
+
+    /** Compute the bias forces in the order of RobotModel::jointNames(), using the inverse dynamics with zero joint accelerations and zero external wrenches*/
+    static void computeBiasForces(const TreeDescriptionKDL& description, KDL::TreeIdSolver_RNE& id_solver, const KDL::JntArray& q, const KDL::JntArray& qd,
+                                  const KDL::JntArray& zero, KDL::JntArray& tau, base::VectorXd& bias_forces);
+};
+
+} // namespace wbc
+
+#endif
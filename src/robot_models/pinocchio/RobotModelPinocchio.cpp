@@ -1,4 +1,5 @@
 #include "RobotModelPinocchio.hpp"
+#include "RobotModelWorkspacePinocchio.hpp"
 #include <base-logging/Logging.hpp>
 #include "../../tools/URDFTools.hpp"
 #include <pinocchio/algorithm/frames.hpp>
@@ -13,8 +14,13 @@ namespace wbc{
 
 RobotModelRegistry<RobotModelPinocchio> RobotModelPinocchio::reg("pinocchio");
 
-RobotModelPinocchio::RobotModelPinocchio(){
-
+RobotModelPinocchio::RobotModelPinocchio() :
+    update_counter(0),
+    acc_bias_pass_stamp(0),
+    inertia_mat_stamp(0),
+    bias_forces_stamp(0),
+    com_stamp(0),
+    com_jac_stamp(0){
 }
 
 RobotModelPinocchio::~RobotModelPinocchio(){
@@ -24,7 +30,13 @@ void RobotModelPinocchio::clear(){
 
     RobotModel::clear();
     data.reset();
-    model = pinocchio::Model();
+    data_acc_bias.reset();
+    data_dyn.reset();
+    model = std::make_shared<pinocchio::Model>();
+    frame_cache.clear();
+    chain_frame_cache.clear();
+    // Don't reset the update counter, so that results computed before clear() can never be mistaken for up to date
+    acc_bias_pass_stamp = inertia_mat_stamp = bias_forces_stamp = com_stamp = com_jac_stamp = 0;
 }
 
 bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
@@ -42,19 +54,24 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     base_frame =  robot_urdf->getRoot()->name;
     URDFTools::applyJointBlacklist(robot_urdf, cfg.joint_blacklist);
 
+    // The model is never modified after configuration, so that it can be shared with the workspaces, see createWorkspace()
+    std::shared_ptr<pinocchio::Model> new_model = std::make_shared<pinocchio::Model>();
     try{
         if(cfg.floating_base){
-            pinocchio::urdf::buildModel(robot_urdf,pinocchio::JointModelFreeFlyer(), model);
+            pinocchio::urdf::buildModel(robot_urdf,pinocchio::JointModelFreeFlyer(), *new_model);
         }
         else{
-            pinocchio::urdf::buildModel(robot_urdf, model);
+            pinocchio::urdf::buildModel(robot_urdf, *new_model);
         }
     }
     catch(std::invalid_argument e){
         LOG_ERROR_S << "RobotModelPinocchio: Failed to load urdf model"<<std::endl;
         return false;
     }
-    data = std::make_shared<pinocchio::Data>(model);
+    model = new_model;
+    data = std::make_shared<pinocchio::Data>(*model);
+    data_acc_bias = std::make_shared<pinocchio::Data>(*model);
+    data_dyn = std::make_shared<pinocchio::Data>(*model);
 
     // Add floating base
     has_floating_base = cfg.floating_base;
@@ -64,7 +81,7 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
         world_frame = robot_urdf->getRoot()->name;
     }
 
-    joint_names = model.names;
+    joint_names = model->names;
     joint_names.erase(joint_names.begin()); // Erase global joint 'universe' which is added by Pinocchio
     if(has_floating_base)
         joint_names.erase(joint_names.begin()); // Erase 'floating_base' root joint
@@ -94,13 +111,24 @@ bool RobotModelPinocchio::configure(const RobotModelConfig& cfg){
     // q:   joint_names_q,   Size: joint_names.size()
     // qd:  joint_names_dq,  Size: joint_names.size()
     // qdd: joint_names_ddq, Size: joint_names.size()
-    q.resize(model.nq);
-    qd.resize(model.nv);
-    qdd.resize(model.nv);
+    q.resize(model->nq);
+    qd.resize(model->nv);
+    qdd.resize(model->nv);
+    zero.setZero(model->nv);
 
     joint_state.resize(joint_names.size());
     joint_state.names = joint_names;
 
+    // Index of each actuated joint in q and qd/qdd
+    actuated_q_idx.resize(actuated_joint_names.size());
+    actuated_v_idx.resize(actuated_joint_names.size());
+    for(uint i = 0; i < actuated_joint_names.size(); i++){
+        const pinocchio::JointIndex id = model->getJointId(actuated_joint_names[i]);
+        actuated_q_idx[i] = model->idx_qs[id];
+        actuated_v_idx[i] = model->idx_vs[id];
+    }
+    setJointOrder(actuated_joint_names);
+
     URDFTools::jointLimitsFromURDF(robot_urdf, joint_limits);
 
     selection_matrix.resize(noOfActuatedJoints(),noOfJoints());
@@ -147,215 +175,238 @@ void RobotModelPinocchio::update(const base::samples::Joints& joint_state_in,
         joint_state[n] = joint_state_in[n];
     joint_state.time = joint_state_in.time;
 
+    updateFromJointState(floating_base_state_in);
+}
+
+void RobotModelPinocchio::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                                 const Eigen::Ref<const base::VectorXd>& qd_in,
+                                 const Eigen::Ref<const base::VectorXd>& qdd_in,
+                                 const base::Time& time,
+                                 const base::samples::RigidBodyStateSE3& floating_base_state_in){
+    setJointStateRaw(q_in, qd_in, qdd_in, time);
+    updateFromJointState(floating_base_state_in);
+}
+
+void RobotModelPinocchio::updateFromJointState(const base::samples::RigidBodyStateSE3& floating_base_state_in){
+
+    // joint_state contains the floating base joints first, followed by the actuated joints
+    const uint n_fb = joint_names_floating_base.size();
     if(has_floating_base){
-        if(!floating_base_state_in.hasValidPose() ||
-           !floating_base_state_in.hasValidTwist() ||
-           !floating_base_state_in.hasValidAcceleration()){
-           LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
-           throw std::runtime_error("Invalid floating base status");
-        }
         if(floating_base_state_in.time.isNull()){
             LOG_ERROR("Floating base state does not have a valid timestamp. Or do we have 1970?");
             throw std::runtime_error("Invalid call to update()");
         }
 
-        // Pinocchio expects the floating base twist/acceleration in local coordinates. However, we
-        // want to give the linear part in world coordinates and the angular part in local coordinates
         floating_base_state = floating_base_state_in;
-        base::Matrix3d fb_rot = floating_base_state.pose.orientation.toRotationMatrix();
-
-        base::Twist fb_twist = floating_base_state.twist;
-        fb_twist.linear = fb_rot.transpose() * floating_base_state.twist.linear;
-
-        base::Acceleration fb_acc = floating_base_state.acceleration;
-        fb_acc.linear = fb_rot.transpose() * floating_base_state.acceleration.linear;
+        RobotModelWorkspacePinocchio::floatingBaseState(floating_base_state, q, qd, qdd);
 
         base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
         for(int i = 0; i < 3; i++){
-            q[i]     = joint_state[joint_names_floating_base[i]].position       = floating_base_state.pose.position[i];
-            joint_state[joint_names_floating_base[i+3]].position = euler(i);
-            qd[i]    = joint_state[joint_names_floating_base[i]].speed          = fb_twist.linear[i];
-            qd[i+3]  = joint_state[joint_names_floating_base[i+3]].speed        = fb_twist.angular[i];
-            qdd[i]   = joint_state[joint_names_floating_base[i]].acceleration   = fb_acc.linear[i];
-            qdd[i+3] = joint_state[joint_names_floating_base[i+3]].acceleration = fb_acc.angular[i];
-        }
-        q[3] = floating_base_state.pose.orientation.x();
-        q[4] = floating_base_state.pose.orientation.y();
-        q[5] = floating_base_state.pose.orientation.z();
-        q[6] = floating_base_state.pose.orientation.w();
-
-        // Subtract 2 due to universe & root_joint
-        for(auto name : actuated_joint_names){
-            if(!hasJoint(name)){
-                LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                            << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-                throw std::runtime_error("Incomplete Joint State");
-            }
-            base::JointState state = joint_state[name];
-            q[model.getJointId(name)-2+7]   = state.position;     // first 7 elements in q are floating base pose
-            qd[model.getJointId(name)-2+6]  = state.speed;        // first 6 elements in q are floating base twist
-            qdd[model.getJointId(name)-2+6] = state.acceleration; // first 6 elements in q are floating base acceleration
+            joint_state.elements[i].position       = q[i];
+            joint_state.elements[i+3].position     = euler(i);
+            joint_state.elements[i].speed          = qd[i];
+            joint_state.elements[i+3].speed        = qd[i+3];
+            joint_state.elements[i].acceleration   = qdd[i];
+            joint_state.elements[i+3].acceleration = qdd[i+3];
         }
+
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
     }
-    else{
-        for(auto name : actuated_joint_names){
-            if(!hasJoint(name)){
-                LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                            << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-                throw std::runtime_error("Incomplete Joint State");
-            }
-            base::JointState state = joint_state[name];
-            q[model.getJointId(name)-1]   = state.position;
-            qd[model.getJointId(name)-1]  = state.speed;
-            qdd[model.getJointId(name)-1] = state.acceleration;
-        }
+
+    for(uint i = 0; i < actuated_joint_names.size(); i++){
+        const base::JointState& state = joint_state.elements[n_fb + i];
+        q[actuated_q_idx[i]]   = state.position;
+        qd[actuated_v_idx[i]]  = state.speed;
+        qdd[actuated_v_idx[i]] = state.acceleration;
     }
 
+    // Single forward pass per update: Joint placements, velocities, accelerations and joint Jacobians. All kinematic queries
+    // only extract frame quantities from this data. Dynamics and the acceleration bias are computed on demand, at most once per update.
+    pinocchio::forwardKinematics(*model, *data, q, qd, qdd);
+    pinocchio::computeJointJacobians(*model, *data);
+    update_counter++;
 }
 
-void RobotModelPinocchio::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
-    _q = q;
-    _qd = qd;
-    _qdd = qdd;
-}
-
-const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(const std::string &root_frame, const std::string &tip_frame){
+void RobotModelPinocchio::checkUpdated(const char* caller) const{
     if(joint_state.time.isNull()){
         LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
     }
+}
+
+RobotModelPinocchio::FrameCache& RobotModelPinocchio::frameCache(const std::string &root_frame, const std::string &tip_frame){
+
+    checkUpdated("frameCache");
+
     if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
+        LOG_ERROR_S<<"Requested kinematics for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
         throw std::runtime_error("Invalid root frame");
     }
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+    std::map<std::string, FrameCache>::iterator it = frame_cache.find(tip_frame);
+    if(it != frame_cache.end())
+        return it->second;
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
+    // First query for this frame: Look up the frame index once, this is a linear search over all frames in the model
+    const std::string use_tip_frame = (tip_frame == "world") ? "universe" : tip_frame;
+    uint idx = model->getFrameId(use_tip_frame);
+    if(idx == model->frames.size()){
+        LOG_ERROR_S<<"Requested kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
         throw std::runtime_error("Invalid tip frame");
     }
 
-    pinocchio::forwardKinematics(model,*data,q,qd,qdd);
-    pinocchio::updateFramePlacement(model,*data,idx);
+    FrameCache& fc = frame_cache[tip_frame];
+    fc.idx = idx;
+    // getFrameJacobian() only writes the columns of the joints supporting the frame, the remaining columns stay zero
+    fc.space_jac.setZero(6,model->nv);
+    fc.body_jac.setZero(6,model->nv);
+    return fc;
+}
+
+void RobotModelPinocchio::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
+    _q = q;
+    _qd = qd;
+    _qdd = qdd;
+}
 
-    rbs.time = joint_state.time;
-    rbs.frame_id = root_frame;
-    rbs.pose.position = data->oMf[idx].translation();
-    rbs.pose.orientation = base::Quaterniond(data->oMf[idx].rotation());
-    // The LOCAL_WORLD_ALIGNED frame convention corresponds to the frame centered on the moving part (Joint, Frame, etc.)
-    // but with axes aligned with the frame of the Universe. This a MIXED representation betwenn the LOCAL and the WORLD conventions.
-    rbs.twist.linear = pinocchio::getFrameVelocity(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    rbs.twist.angular = pinocchio::getFrameVelocity(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
-    rbs.acceleration.linear = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    rbs.acceleration.angular = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
+RobotModelPinocchio::FrameCache& RobotModelPinocchio::frameCache(const ChainId chain){
 
-    return rbs;
+    checkChainId(chain);
+    // Resolve the chain on first use. This also validates root and tip frame
+    FrameCache*& fc = chain_frame_cache[chain];
+    if(!fc)
+        fc = &frameCache(chainRoot(chain), chainTip(chain));
+    return *fc;
 }
 
-const base::MatrixXd &RobotModelPinocchio::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
+void RobotModelPinocchio::addChain(const ChainId chain){
+    chain_frame_cache.resize(chain+1, nullptr);
+}
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
+RobotModelWorkspacePtr RobotModelPinocchio::createWorkspace(){
+    if(!robot_urdf)
+        throw std::runtime_error("RobotModelPinocchio::createWorkspace: Robot model has not been configured");
+
+    // The joint state contains the floating base joints first, followed by the actuated joints
+    const uint n_fb = joint_names_floating_base.size();
+    std::vector<int> q_idx(joint_order_idx.size()), v_idx(joint_order_idx.size());
+    for(size_t i = 0; i < joint_order_idx.size(); i++){
+        q_idx[i] = actuated_q_idx[joint_order_idx[i] - n_fb];
+        v_idx[i] = actuated_v_idx[joint_order_idx[i] - n_fb];
     }
 
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
+    std::vector<int> chain_frame_idx(chains.size(), -1);
+    for(size_t i = 0; i < chains.size(); i++){
+        if(chainRoot(i) != world_frame)
+            continue;
+        const std::string use_tip_frame = (chainTip(i) == "world") ? "universe" : chainTip(i);
+        const uint idx = model->getFrameId(use_tip_frame);
+        if(idx < model->frames.size())
+            chain_frame_idx[i] = idx;
     }
+    return std::make_shared<RobotModelWorkspacePinocchio>(model, has_floating_base, world_frame, q_idx, v_idx, chain_frame_idx);
+}
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(const std::string &root_frame, const std::string &tip_frame){
+    return frameRigidBodyState(frameCache(root_frame, tip_frame));
+}
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
-    }
+const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::rigidBodyState(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->rigidBodyState(chain);
+    return frameRigidBodyState(frameCache(chain));
+}
 
-    std::string chain_id = chainID(root_frame, tip_frame);
-    space_jac_map[chain_id].resize(6,model.nv);
-    space_jac_map[chain_id].setZero();
-    pinocchio::computeFrameJacobian(model, *data, q, idx, pinocchio::LOCAL_WORLD_ALIGNED, space_jac_map[chain_id]);
+const base::MatrixXd &RobotModelPinocchio::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
+    return frameSpaceJacobian(frameCache(root_frame, tip_frame));
+}
 
-    return space_jac_map[chain_id];
+const base::MatrixXd &RobotModelPinocchio::spaceJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spaceJacobian(chain);
+    return frameSpaceJacobian(frameCache(chain));
 }
 
 const base::MatrixXd &RobotModelPinocchio::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
+    return frameBodyJacobian(frameCache(root_frame, tip_frame));
+}
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
-    }
+const base::MatrixXd &RobotModelPinocchio::bodyJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->bodyJacobian(chain);
+    return frameBodyJacobian(frameCache(chain));
+}
 
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
-    }
+const base::Acceleration &RobotModelPinocchio::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
+    return frameAccelerationBias(frameCache(root_frame, tip_frame));
+}
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+const base::Acceleration &RobotModelPinocchio::spatialAccelerationBias(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spatialAccelerationBias(chain);
+    return frameAccelerationBias(frameCache(chain));
+}
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
-    }
+const base::samples::RigidBodyStateSE3 &RobotModelPinocchio::frameRigidBodyState(FrameCache& fc){
+
+    if(fc.rbs_stamp == update_counter)
+        return fc.rbs;
 
-    std::string chain_id = chainID(root_frame, tip_frame);
-    body_jac_map[chain_id].resize(6,model.nv);
-    body_jac_map[chain_id].setZero();
-    pinocchio::computeFrameJacobian(model, *data, q, idx, pinocchio::LOCAL, body_jac_map[chain_id]);
+    RobotModelWorkspacePinocchio::computeFrameState(*model, *data, fc.idx, fc.rbs);
+    fc.rbs.time = joint_state.time;
+    fc.rbs.frame_id = world_frame;
+    fc.rbs_stamp = update_counter;
 
-    return body_jac_map[chain_id];
+    return fc.rbs;
 }
 
-const base::MatrixXd &RobotModelPinocchio::comJacobian(){
+const base::MatrixXd &RobotModelPinocchio::frameSpaceJacobian(FrameCache& fc){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error("Invalid call to comJacobian()");
+    if(fc.space_jac_stamp != update_counter){
+        pinocchio::getFrameJacobian(*model, *data, fc.idx, pinocchio::LOCAL_WORLD_ALIGNED, fc.space_jac);
+        fc.space_jac_stamp = update_counter;
     }
-
-    pinocchio::jacobianCenterOfMass(model, *data, q);
-    com_jac.resize(3,noOfJoints());
-    com_jac = data->Jcom;
-    return com_jac;
+    return fc.space_jac;
 }
 
-const base::Acceleration &RobotModelPinocchio::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
+const base::MatrixXd &RobotModelPinocchio::frameBodyJacobian(FrameCache& fc){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
+    if(fc.body_jac_stamp != update_counter){
+        pinocchio::getFrameJacobian(*model, *data, fc.idx, pinocchio::LOCAL, fc.body_jac);
+        fc.body_jac_stamp = update_counter;
     }
+    return fc.body_jac;
+}
 
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested space Jacobian computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but the pinocchio robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid root frame");
+const base::MatrixXd &RobotModelPinocchio::comJacobian(){
+
+    checkUpdated("comJacobian");
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->comJacobian();
+    if(com_jac_stamp != update_counter){
+        pinocchio::jacobianCenterOfMass(*model, *data_dyn, q);
+        com_jac = data_dyn->Jcom;
+        com_jac_stamp = update_counter;
     }
+    return com_jac;
+}
 
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "universe";
+const base::Acceleration &RobotModelPinocchio::frameAccelerationBias(FrameCache& fc){
 
-    uint idx = model.getFrameId(use_tip_frame);
-    if(idx == model.frames.size()){
-        LOG_ERROR_S<<"Requested Forward kinematics for tip frame "<<use_tip_frame<<" but this frame does not exist in Pinocchio"<<std::endl;
-        throw std::runtime_error("Invalid tip frame");
+    if(fc.acc_bias_stamp == update_counter)
+        return fc.acc_bias;
+
+    // One forward pass with zero joint accelerations per update, shared by all frames
+    if(acc_bias_pass_stamp != update_counter){
+        pinocchio::forwardKinematics(*model,*data_acc_bias,q,qd,zero);
+        acc_bias_pass_stamp = update_counter;
     }
-    pinocchio::forwardKinematics(model,*data,q,qd,base::VectorXd::Zero(model.nv));
-    spatial_acc_bias.linear = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).linear();
-    spatial_acc_bias.angular = pinocchio::getFrameClassicalAcceleration(model, *data, idx, pinocchio::LOCAL_WORLD_ALIGNED).angular();
-    return spatial_acc_bias;
+    const pinocchio::Motion acc = pinocchio::getFrameClassicalAcceleration(*model, *data_acc_bias, fc.idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    fc.acc_bias.linear = acc.linear();
+    fc.acc_bias.angular = acc.angular();
+    fc.acc_bias_stamp = update_counter;
+    return fc.acc_bias;
 }
 
 const base::MatrixXd &RobotModelPinocchio::jacobianDot(const std::string &root_frame, const std::string &tip_frame){
@@ -365,58 +416,54 @@ const base::MatrixXd &RobotModelPinocchio::jacobianDot(const std::string &root_f
 
 const base::MatrixXd &RobotModelPinocchio::jointSpaceInertiaMatrix(){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to jointSpaceInertiaMatrix()");
-    }
+    checkUpdated("jointSpaceInertiaMatrix");
+    if(inertia_mat_stamp == update_counter)
+        return joint_space_inertia_mat;
 
-    pinocchio::crba(model, *data, q);
-    joint_space_inertia_mat = data->M;
+    pinocchio::crba(*model, *data_dyn, q);
+    joint_space_inertia_mat = data_dyn->M;
     // copy upper right triangular part to lower left triangular part (they are symmetric), as pinocchio only computes the former
     joint_space_inertia_mat.triangularView<Eigen::StrictlyLower>() = joint_space_inertia_mat.transpose().triangularView<Eigen::StrictlyLower>();
+    inertia_mat_stamp = update_counter;
     return joint_space_inertia_mat;
 }
 
 const base::VectorXd &RobotModelPinocchio::biasForces(){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to biasForces()");
+    checkUpdated("biasForces");
+    if(bias_forces_stamp != update_counter){
+        pinocchio::nonLinearEffects(*model, *data_dyn, q, qd);
+        bias_forces = data_dyn->nle;
+        bias_forces_stamp = update_counter;
     }
-
-    pinocchio::nonLinearEffects(model, *data, q, qd);
-    bias_forces = data->nle;
     return bias_forces;
 }
 
 const base::samples::RigidBodyStateSE3& RobotModelPinocchio::centerOfMass(){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to centerOfMass()");
-    }
+    checkUpdated("centerOfMass");
+    if(com_stamp == update_counter)
+        return com_rbs;
 
-    pinocchio::centerOfMass(model, *data, q, qd, qdd);
-    com_rbs.pose.position       = data->com[0];
-    com_rbs.twist.linear        = data->vcom[0];
-    com_rbs.acceleration.linear = data->acom[0];
+    pinocchio::centerOfMass(*model, *data_dyn, q, qd, qdd);
+    com_rbs.pose.position       = data_dyn->com[0];
+    com_rbs.twist.linear        = data_dyn->vcom[0];
+    com_rbs.acceleration.linear = data_dyn->acom[0];
     com_rbs.pose.orientation.setIdentity();
     com_rbs.twist.angular.setZero();
     com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
     com_rbs.frame_id = world_frame;
+    com_stamp = update_counter;
     return com_rbs;
 }
 
 void RobotModelPinocchio::computeInverseDynamics(base::commands::Joints &solver_output){
 
-    if(joint_state.time.isNull()){
-        LOG_ERROR("RobotModelPinocchio: You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to centerOfMass()");
-    }
+    checkUpdated("computeInverseDynamics");
 
     // TODO: Add external wrenches here
-    pinocchio::rnea(model, *data, q, qd, qdd);
+    pinocchio::rnea(*model, *data_dyn, q, qd, qdd);
 
     uint start_idx = 0;
     if(has_floating_base)
@@ -424,7 +471,7 @@ void RobotModelPinocchio::computeInverseDynamics(base::commands::Joints &solver_
 
     for(uint i = 0; i < noOfJoints(); i++){
         const std::string &name = actuatedJointNames()[i];
-        solver_output[name].effort = data->tau[i+start_idx];
+        solver_output[name].effort = data_dyn->tau[i+start_idx];
     }
 }
 
@@ -11,10 +11,59 @@ class RobotModelPinocchio : public RobotModel{
 protected:
     static RobotModelRegistry<RobotModelPinocchio> reg;
 
-    Eigen::VectorXd q, qd, qdd;
-    pinocchio::Model model;
+    Eigen::VectorXd q, qd, qdd, zero;
+    std::shared_ptr<const pinocchio::Model> model;  /** Immutable after configure(), shared with all workspaces, see createWorkspace()*/
     typedef std::shared_ptr<pinocchio::Data> DataPtr;
-    DataPtr data;
+    DataPtr data;           /** Kinematics of the current robot state, computed once in every call to update()*/
+    DataPtr data_acc_bias;  /** Kinematics with zero joint accelerations, computed lazily for the spatial acceleration bias*/
+    DataPtr data_dyn;       /** Dynamics (inertia matrix, bias forces, CoM, inverse dynamics), computed lazily*/
+
+    /** Per-frame query results. A result is up to date if its stamp equals the current update counter*/
+    struct FrameCache{
+        FrameCache() : idx(0), rbs_stamp(0), space_jac_stamp(0), body_jac_stamp(0), acc_bias_stamp(0){}
+        uint idx;
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp, space_jac_stamp, body_jac_stamp, acc_bias_stamp;
+    };
+    std::map<std::string, FrameCache> frame_cache;
+    std::vector<FrameCache*> chain_frame_cache;  /** Cache entry of the tip frame of each chain, indexed by ChainId. Resolved on first use*/
+
+    /** Incremented in every call to update(). Memoized results are recomputed at most once per update*/
+    uint64_t update_counter;
+    uint64_t acc_bias_pass_stamp, inertia_mat_stamp, bias_forces_stamp, com_stamp, com_jac_stamp;
+
+    std::vector<int> actuated_q_idx;   /** Index of each actuated joint in q*/
+    std::vector<int> actuated_v_idx;   /** Index of each actuated joint in qd/qdd*/
+
+    /** Compute q, qd, qdd from joint_state and the given floating base state and run the kinematics pass*/
+    void updateFromJointState(const base::samples::RigidBodyStateSE3& floating_base_state_in);
+
+    /** Return the cache entry for the given frame. Creates the entry if called for the first time with the given tip frame.
+     *  Throws if update() has not been called yet, if the root frame is not the world frame or if the tip frame does not exist*/
+    FrameCache& frameCache(const std::string &root_frame, const std::string &tip_frame);
+
+    /** Return the cache entry for the tip frame of the given chain*/
+    FrameCache& frameCache(const ChainId chain);
+
+    /** Allocate the per-chain data for the given chain*/
+    virtual void addChain(const ChainId chain);
+
+    /** Return pose, twist and acceleration of the given frame. Only computed once per update()*/
+    const base::samples::RigidBodyStateSE3 &frameRigidBodyState(FrameCache& fc);
+
+    /** Return the space Jacobian of the given frame. Only computed once per update()*/
+    const base::MatrixXd &frameSpaceJacobian(FrameCache& fc);
+
+    /** Return the body Jacobian of the given frame. Only computed once per update()*/
+    const base::MatrixXd &frameBodyJacobian(FrameCache& fc);
+
+    /** Return the spatial acceleration bias of the given frame. Only computed once per update()*/
+    const base::Acceleration &frameAccelerationBias(FrameCache& fc);
+
+    /** Throw if update() has not been called yet*/
+    void checkUpdated(const char* caller) const;
 
     /** Free all data*/
     void clear();
@@ -37,12 +86,25 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
 
+    /**
+     * @brief Update the robot configuration from raw state vectors in the order given by setJointOrder(). Does not perform any name lookups. See RobotModel::update() for details
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
 
-    /** Returns the pose, twist and spatial acceleration between the two given frames. All quantities are defined in root_frame coordinates*/
+    /** Returns the pose, twist and spatial acceleration between the two given frames. All quantities are defined in root_frame coordinates.
+     *  Only extracts the frame quantities from the kinematics pass of update(), the result is memoized until the next update()*/
     virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as rigidBodyState(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -51,6 +113,9 @@ public:
       */
     virtual const base::MatrixXd &spaceJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spaceJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+
     /** @brief Returns the Body Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -59,6 +124,9 @@ public:
       */
     virtual const base::MatrixXd &bodyJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as bodyJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+
     /** @brief Returns the CoM Jacobian for the entire robot, which maps the robot joint velocities to linear spatial velocities in robot base coordinates.
       * Size of the Jacobian will be 3 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot.
@@ -73,6 +141,15 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spatialAccelerationBias(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+
+    /** Workspaces are supported, see createWorkspace()*/
+    virtual bool supportsWorkspaces() const {return true;}
+
+    /** Create a RobotModelWorkspacePinocchio, which shares the pinocchio model and owns its pinocchio data, see RobotModel::createWorkspace()*/
+    virtual RobotModelWorkspacePtr createWorkspace();
+
     /** @brief Returns the derivative of the Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. By convention reference frame & reference point
       *  of the Jacobian will be the root frame (corresponding to the body Jacobian). Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
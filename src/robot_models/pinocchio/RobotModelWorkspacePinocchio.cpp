@@ -0,0 +1,235 @@
+#include "RobotModelWorkspacePinocchio.hpp"
+#include <base-logging/Logging.hpp>
+#include <pinocchio/multibody/model.hpp>
+#include <pinocchio/multibody/data.hpp>
+#include <pinocchio/algorithm/frames.hpp>
+#include <pinocchio/algorithm/kinematics.hpp>
+#include <pinocchio/algorithm/jacobian.hpp>
+#include <pinocchio/algorithm/crba.hpp>
+#include <pinocchio/algorithm/rnea.hpp>
+#include <pinocchio/algorithm/center-of-mass.hpp>
+#include <pinocchio/algorithm/joint-configuration.hpp>
+
+namespace wbc{
+
+RobotModelWorkspacePinocchio::RobotModelWorkspacePinocchio(const ModelConstPtr& model,
+                                                           const bool has_floating_base,
+                                                           const std::string& world_frame,
+                                                           const std::vector<int>& q_idx,
+                                                           const std::vector<int>& v_idx,
+                                                           const std::vector<int>& chain_frame_idx) :
+    model(model),
+    has_floating_base(has_floating_base),
+    world_frame(world_frame),
+    q_idx(q_idx),
+    v_idx(v_idx),
+    update_counter(0),
+    acc_bias_pass_stamp(0),
+    com_stamp(0),
+    com_jac_stamp(0),
+    inertia_mat_stamp(0),
+    bias_forces_stamp(0){
+
+    data = std::make_shared<pinocchio::Data>(*model);
+    data_acc_bias = std::make_shared<pinocchio::Data>(*model);
+    data_dyn = std::make_shared<pinocchio::Data>(*model);
+
+    // Neutral configuration, in particular a valid quaternion of the floating base
+    q = pinocchio::neutral(*model);
+    qd.setZero(model->nv);
+    qdd.setZero(model->nv);
+    zero.setZero(model->nv);
+
+    chain_data.resize(chain_frame_idx.size());
+    for(size_t i = 0; i < chain_frame_idx.size(); i++){
+        ChainData& cd = chain_data[i];
+        cd.frame_idx = chain_frame_idx[i];
+        cd.rbs.frame_id = world_frame;
+        // getFrameJacobian() only writes the columns of the joints supporting the frame, the remaining columns stay zero
+        cd.space_jac.setZero(6,model->nv);
+        cd.body_jac.setZero(6,model->nv);
+    }
+    com_rbs.frame_id = world_frame;
+}
+
+void RobotModelWorkspacePinocchio::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                                          const Eigen::Ref<const base::VectorXd>& qd_in,
+                                          const Eigen::Ref<const base::VectorXd>& qdd_in,
+                                          const base::samples::RigidBodyStateSE3& floating_base_state){
+    const size_t n = q_idx.size();
+    if(q_in.size() != n || qd_in.size() != n || qdd_in.size() != n){
+        LOG_ERROR("Size of joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q_in.size(), qd_in.size(), qdd_in.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    if(has_floating_base)
+        floatingBaseState(floating_base_state, q, qd, qdd);
+    for(size_t i = 0; i < n; i++){
+        q[q_idx[i]] = q_in[i];
+        qd[v_idx[i]] = qd_in[i];
+        qdd[v_idx[i]] = qdd_in[i];
+    }
+
+    pinocchio::forwardKinematics(*model, *data, q, qd, qdd);
+    pinocchio::computeJointJacobians(*model, *data);
+    update_counter++;
+}
+
+void RobotModelWorkspacePinocchio::checkUpdated(const char* caller) const{
+    if(update_counter == 0){
+        LOG_ERROR("RobotModelWorkspacePinocchio: You have to call update() at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+}
+
+RobotModelWorkspacePinocchio::ChainData& RobotModelWorkspacePinocchio::chainData(const ChainId chain, const char* caller){
+    if(chain < 0 || chain >= (int)chain_data.size()){
+        LOG_ERROR("Invalid chain id %i in %s(). The workspace knows %i chains. Chains have to be created before the workspace", chain, caller, chain_data.size());
+        throw std::invalid_argument("Invalid chain id");
+    }
+    ChainData& cd = chain_data[chain];
+    if(cd.frame_idx < 0){
+        LOG_ERROR("Chain %i was requested in %s(), but either its root is not the world frame or its tip frame does not exist in Pinocchio", chain, caller);
+        throw std::invalid_argument("Invalid chain id");
+    }
+    checkUpdated(caller);
+    return cd;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspacePinocchio::rigidBodyState(const ChainId chain){
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        computeFrameState(*model, *data, cd.frame_idx, cd.rbs);
+        cd.rbs_stamp = update_counter;
+    }
+    return cd.rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspacePinocchio::spaceJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        pinocchio::getFrameJacobian(*model, *data, cd.frame_idx, pinocchio::LOCAL_WORLD_ALIGNED, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
+    }
+    return cd.space_jac;
+}
+
+const base::MatrixXd &RobotModelWorkspacePinocchio::bodyJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        pinocchio::getFrameJacobian(*model, *data, cd.frame_idx, pinocchio::LOCAL, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
+}
+
+const base::Acceleration &RobotModelWorkspacePinocchio::spatialAccelerationBias(const ChainId chain){
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp == update_counter)
+        return cd.acc_bias;
+
+    // One forward pass with zero joint accelerations per update, shared by all chains
+    if(acc_bias_pass_stamp != update_counter){
+        pinocchio::forwardKinematics(*model, *data_acc_bias, q, qd, zero);
+        acc_bias_pass_stamp = update_counter;
+    }
+    const pinocchio::Motion acc = pinocchio::getFrameClassicalAcceleration(*model, *data_acc_bias, cd.frame_idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    cd.acc_bias.linear = acc.linear();
+    cd.acc_bias.angular = acc.angular();
+    cd.acc_bias_stamp = update_counter;
+    return cd.acc_bias;
+}
+
+const base::MatrixXd &RobotModelWorkspacePinocchio::comJacobian(){
+    checkUpdated("comJacobian");
+    if(com_jac_stamp != update_counter){
+        pinocchio::jacobianCenterOfMass(*model, *data_dyn, q);
+        com_jac = data_dyn->Jcom;
+        com_jac_stamp = update_counter;
+    }
+    return com_jac;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspacePinocchio::centerOfMass(){
+    checkUpdated("centerOfMass");
+    if(com_stamp != update_counter){
+        pinocchio::centerOfMass(*model, *data_dyn, q, qd, qdd);
+        com_rbs.pose.position       = data_dyn->com[0];
+        com_rbs.twist.linear        = data_dyn->vcom[0];
+        com_rbs.acceleration.linear = data_dyn->acom[0];
+        com_rbs.pose.orientation.setIdentity();
+        com_rbs.twist.angular.setZero();
+        com_rbs.acceleration.angular.setZero();
+        com_stamp = update_counter;
+    }
+    return com_rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspacePinocchio::jointSpaceInertiaMatrix(){
+    checkUpdated("jointSpaceInertiaMatrix");
+    if(inertia_mat_stamp != update_counter){
+        pinocchio::crba(*model, *data_dyn, q);
+        joint_space_inertia_mat = data_dyn->M;
+        // copy upper right triangular part to lower left triangular part (they are symmetric), as pinocchio only computes the former
+        joint_space_inertia_mat.triangularView<Eigen::StrictlyLower>() = joint_space_inertia_mat.transpose().triangularView<Eigen::StrictlyLower>();
+        inertia_mat_stamp = update_counter;
+    }
+    return joint_space_inertia_mat;
+}
+
+const base::VectorXd &RobotModelWorkspacePinocchio::biasForces(){
+    checkUpdated("biasForces");
+    if(bias_forces_stamp != update_counter){
+        pinocchio::nonLinearEffects(*model, *data_dyn, q, qd);
+        bias_forces = data_dyn->nle;
+        bias_forces_stamp = update_counter;
+    }
+    return bias_forces;
+}
+
+void RobotModelWorkspacePinocchio::floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state,
+                                                     Eigen::VectorXd& q,
+                                                     Eigen::VectorXd& qd,
+                                                     Eigen::VectorXd& qdd){
+    if(!floating_base_state.hasValidPose() ||
+       !floating_base_state.hasValidTwist() ||
+       !floating_base_state.hasValidAcceleration()){
+       LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
+       throw std::runtime_error("Invalid floating base status");
+    }
+
+    // Pinocchio expects the floating base twist/acceleration in local coordinates. However, we
+    // want to give the linear part in world coordinates and the angular part in local coordinates
+    const base::Matrix3d fb_rot = floating_base_state.pose.orientation.toRotationMatrix();
+    const base::Vector3d fb_linear_vel = fb_rot.transpose() * floating_base_state.twist.linear;
+    const base::Vector3d fb_linear_acc = fb_rot.transpose() * floating_base_state.acceleration.linear;
+
+    for(int i = 0; i < 3; i++){
+        q[i]     = floating_base_state.pose.position[i];
+        qd[i]    = fb_linear_vel[i];
+        qd[i+3]  = floating_base_state.twist.angular[i];
+        qdd[i]   = fb_linear_acc[i];
+        qdd[i+3] = floating_base_state.acceleration.angular[i];
+    }
+    q[3] = floating_base_state.pose.orientation.x();
+    q[4] = floating_base_state.pose.orientation.y();
+    q[5] = floating_base_state.pose.orientation.z();
+    q[6] = floating_base_state.pose.orientation.w();
+}
+
+void RobotModelWorkspacePinocchio::computeFrameState(const pinocchio::Model& model, pinocchio::Data& data, const uint frame_idx, base::samples::RigidBodyStateSE3& rbs){
+    pinocchio::updateFramePlacement(model, data, frame_idx);
+
+    rbs.pose.position = data.oMf[frame_idx].translation();
+    rbs.pose.orientation = base::Quaterniond(data.oMf[frame_idx].rotation());
+    // The LOCAL_WORLD_ALIGNED frame convention corresponds to the frame centered on the moving part (Joint, Frame, etc.)
+    // but with axes aligned with the frame of the Universe. This a MIXED representation betwenn the LOCAL and the WORLD conventions.
+    const pinocchio::Motion twist = pinocchio::getFrameVelocity(model, data, frame_idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    rbs.twist.linear = twist.linear();
+    rbs.twist.angular = twist.angular();
+    const pinocchio::Motion acc = pinocchio::getFrameClassicalAcceleration(model, data, frame_idx, pinocchio::LOCAL_WORLD_ALIGNED);
+    rbs.acceleration.linear = acc.linear();
+    rbs.acceleration.angular = acc.angular();
+}
+
+}
@@ -0,0 +1,99 @@
+#ifndef ROBOT_MODEL_WORKSPACE_PINOCCHIO_HPP
+#define ROBOT_MODEL_WORKSPACE_PINOCCHIO_HPP
+
+#include "../../core/RobotModelWorkspace.hpp"
+#include <pinocchio/multibody/fwd.hpp>
+#include <vector>
+#include <string>
+
+namespace wbc {
+
+/**
+ * @brief Workspace of RobotModelPinocchio, see RobotModelWorkspace. All workspaces share the pinocchio::Model of the robot model, each workspace only owns its pinocchio::Data.
+ *  The static functions implement the state conversion and the frame kinematics for both RobotModelPinocchio and the workspaces, so that both give identical results.
+ */
+class RobotModelWorkspacePinocchio : public RobotModelWorkspace{
+protected:
+    typedef std::shared_ptr<const pinocchio::Model> ModelConstPtr;
+    typedef std::shared_ptr<pinocchio::Data> DataPtr;
+
+    ModelConstPtr model;
+    DataPtr data;           /** Kinematics of the current state, computed in every call to update()*/
+    DataPtr data_acc_bias;  /** Kinematics with zero joint accelerations, computed lazily for the spatial acceleration bias*/
+    DataPtr data_dyn;       /** Dynamics (inertia matrix, bias forces, CoM), computed lazily*/
+    bool has_floating_base;
+    std::string world_frame;
+    std::vector<int> q_idx;   /** Index in q of each joint in the joint order*/
+    std::vector<int> v_idx;   /** Index in qd/qdd of each joint in the joint order*/
+    Eigen::VectorXd q, qd, qdd, zero;
+
+    /** Per-chain results. A result is up to date if its stamp equals the current update counter*/
+    struct ChainData{
+        int frame_idx;    /** Pinocchio frame index of the tip frame. -1 if the chain is invalid*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;   /** Indexed by ChainId*/
+
+    base::samples::RigidBodyStateSE3 com_rbs;
+    base::MatrixXd com_jac, joint_space_inertia_mat;
+    base::VectorXd bias_forces;
+
+    uint64_t update_counter;
+    uint64_t acc_bias_pass_stamp, com_stamp, com_jac_stamp, inertia_mat_stamp, bias_forces_stamp;
+
+    /** Return the data of the given chain. Throws if the chain is unknown or invalid or if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+
+    /** Throw if update() has not been called yet*/
+    void checkUpdated(const char* caller) const;
+
+public:
+    /**
+     * @brief Create a workspace
+     * @param model The pinocchio model, shared with the robot model and all other workspaces
+     * @param has_floating_base True for floating base robots
+     * @param world_frame Frame id of all returned states
+     * @param q_idx Index in the pinocchio configuration vector of each joint in the joint order
+     * @param v_idx Index in the pinocchio velocity vector of each joint in the joint order
+     * @param chain_frame_idx Pinocchio frame index of the tip frame of each chain, indexed by ChainId. -1 for invalid chains
+     */
+    RobotModelWorkspacePinocchio(const ModelConstPtr& model,
+                                 const bool has_floating_base,
+                                 const std::string& world_frame,
+                                 const std::vector<int>& q_idx,
+                                 const std::vector<int>& v_idx,
+                                 const std::vector<int>& chain_frame_idx);
+    virtual ~RobotModelWorkspacePinocchio(){}
+
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+    virtual const base::MatrixXd &comJacobian();
+    virtual const base::samples::RigidBodyStateSE3 &centerOfMass();
+    virtual const base::MatrixXd &jointSpaceInertiaMatrix();
+    virtual const base::VectorXd &biasForces();
+    virtual uint noOfChains() const {return chain_data.size();}
+
+    /** Write the floating base state to the first entries of the pinocchio state vectors q, qd and qdd. Pinocchio expects twist and acceleration in local coordinates,
+     *  while the linear part of the given floating base twist and acceleration is in world coordinates. Throws if the floating base state is invalid*/
+    static void floatingBaseState(const base::samples::RigidBodyStateSE3& floating_base_state,
+                                  Eigen::VectorXd& q,
+                                  Eigen::VectorXd& qd,
+                                  Eigen::VectorXd& qdd);
+
+    /** Compute pose, twist and acceleration of the given frame in world coordinates. The forward kinematics in data have to be up to date. Updates the frame placement
+     *  in data. Does not set frame id and time stamp*/
+    static void computeFrameState(const pinocchio::Model& model, pinocchio::Data& data, const uint frame_idx, base::samples::RigidBodyStateSE3& rbs);
+};
+
+} // namespace wbc
+
+#endif
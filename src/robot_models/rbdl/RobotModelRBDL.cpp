@@ -1,4 +1,5 @@
 #include "RobotModelRBDL.hpp"
+#include "RobotModelWorkspaceRBDL.hpp"
 #include "tools/URDFTools.hpp"
 #include <rbdl/rbdl_utils.h>
 #include <rbdl/addons/urdfreader/urdfreader.h>
@@ -10,7 +11,11 @@ namespace wbc {
 
 RobotModelRegistry<RobotModelRBDL> RobotModelRBDL::reg("rbdl");
 
-RobotModelRBDL::RobotModelRBDL(){
+RobotModelRBDL::RobotModelRBDL() :
+    floating_body_id(0),
+    update_counter(0),
+    acc_bias_pass_stamp(0),
+    com_jac_stamp(0){
 
 }
 
@@ -19,8 +24,66 @@ RobotModelRBDL::~RobotModelRBDL(){
 }
 
 void RobotModelRBDL::clear(){
+    RobotModel::clear();
     rbdl_model.reset();
     rbdl_model = std::make_shared<Model>();
+    rbdl_model_acc_bias = std::make_shared<Model>();
+    chain_data.clear();
+    // Don't reset the update counter, so that results computed before clear() can never be mistaken for up to date
+}
+
+void RobotModelRBDL::addChain(const ChainId chain){
+    chain_data.resize(chain+1);
+}
+
+RobotModelWorkspacePtr RobotModelRBDL::createWorkspace(){
+    if(!robot_urdf)
+        throw std::runtime_error("RobotModelRBDL::createWorkspace: Robot model has not been configured");
+
+    // The joint state contains the floating base joints first, same as the RBDL state vectors
+    std::vector<uint> chain_body_ids(chains.size());
+    for(size_t i = 0; i < chains.size(); i++)
+        chain_body_ids[i] = chainRoot(i) == world_frame ? bodyId(chainTip(i)) : std::numeric_limits<unsigned int>::max();
+    return std::make_shared<RobotModelWorkspaceRBDL>(*rbdl_model, has_floating_base, floating_body_id, world_frame, joint_order_idx, chain_body_ids);
+}
+
+uint RobotModelRBDL::bodyIdChecked(const std::string &root_frame, const std::string &tip_frame, const char* caller){
+    if(joint_state.time.isNull()){
+        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+    if(root_frame != world_frame){
+        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but RBDL robot model always requires the root frame to be the root of the full model"<<std::endl;
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+    uint body_id = bodyId(tip_frame);
+    if(body_id == std::numeric_limits<unsigned int>::max()){
+        LOG_ERROR_S << "Request " << caller << " for " << root_frame << " -> " << tip_frame << " but link " << tip_frame << " does not exist in robot model" << std::endl;
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+    return body_id;
+}
+
+RobotModelRBDL::ChainData& RobotModelRBDL::chainData(const ChainId chain, const char* caller){
+    checkChainId(chain);
+    ChainData& cd = chain_data[chain];
+    // Resolve the body id once. Afterwards, only the time stamp of the joint state has to be checked
+    if(cd.body_id == std::numeric_limits<unsigned int>::max())
+        cd.body_id = bodyIdChecked(chainRoot(chain), chainTip(chain), caller);
+    else if(joint_state.time.isNull()){
+        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+    return cd;
+}
+
+uint RobotModelRBDL::bodyId(const std::string &frame){
+    static const std::string rbdl_root = "ROOT";
+    const std::string &name = (frame == "world") ? rbdl_root : frame;
+    auto it = rbdl_model->mBodyNameMap.find(name);
+    if(it == rbdl_model->mBodyNameMap.end())
+        return std::numeric_limits<unsigned int>::max();
+    return it->second;
 }
 
 void RobotModelRBDL::updateFloatingBase(const base::samples::RigidBodyStateSE3& floating_base_state_in){
@@ -57,6 +120,7 @@ bool RobotModelRBDL::configure(const RobotModelConfig& cfg){
         LOG_ERROR_S << "Unable to parse urdf from file " << robot_urdf_file << std::endl;
         return false;
     }
+    *rbdl_model_acc_bias = *rbdl_model;
 
     // Add floating base to robot_urdf. We will not load this URDF model in RBDL, since RBDL adds its own floating base.
     // However, we need the robot_urdf for some internal functionalities.
@@ -87,12 +151,17 @@ bool RobotModelRBDL::configure(const RobotModelConfig& cfg){
 
     joint_state.resize(joint_names.size());
     joint_state.names = joint_names;
+    setJointOrder(actuated_joint_names);
+    if(cfg.floating_base)
+        floating_body_id = rbdl_model->GetBodyId(base_frame.c_str());
 
     // Fixed base: If the robot has N dof, q_size = qd_size = N
     // Floating base: If the robot has N dof, q_size = N+7, qd_size = N+6
     q.resize(rbdl_model->q_size);
     qd.resize(rbdl_model->qdot_size);
     qdd.resize(rbdl_model->qdot_size);
+    zero.setZero(rbdl_model->qdot_size);
+    tau.resize(rbdl_model->qdot_size);
 
     selection_matrix.resize(noOfActuatedJoints(),noOfJoints());
     selection_matrix.setZero();
@@ -139,14 +208,23 @@ void RobotModelRBDL::update(const base::samples::Joints& joint_state_in,
         joint_state[n] = joint_state_in[n];
     joint_state.time = joint_state_in.time;
 
+    updateFromJointState(floating_base_state_in);
+}
+
+void RobotModelRBDL::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                            const Eigen::Ref<const base::VectorXd>& qd_in,
+                            const Eigen::Ref<const base::VectorXd>& qdd_in,
+                            const base::Time& time,
+                            const base::samples::RigidBodyStateSE3& floating_base_state_in){
+    setJointStateRaw(q_in, qd_in, qdd_in, time);
+    updateFromJointState(floating_base_state_in);
+}
+
+void RobotModelRBDL::updateFromJointState(const base::samples::RigidBodyStateSE3& floating_base_state_in){
+
+    // joint_state contains the floating base joints first, followed by the actuated joints
     uint start_idx = 0;
     if(has_floating_base){
-        if(!floating_base_state_in.hasValidPose() ||
-           !floating_base_state_in.hasValidTwist() ||
-           !floating_base_state_in.hasValidAcceleration()){
-           LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
-           throw std::runtime_error("Invalid floating base status");
-        }
         if(floating_base_state_in.time.isNull()){
             LOG_ERROR("Floating base state does not have a valid timestamp. Or do we have 1970?");
             throw std::runtime_error("Invalid call to update()");
@@ -154,56 +232,30 @@ void RobotModelRBDL::update(const base::samples::Joints& joint_state_in,
         floating_base_state = floating_base_state_in;
         start_idx = 6;
 
-        // Transformation from fb body linear acceleration to fb joint linear acceleration:
-        // since RBDL treats the floating base as XYZ translation followed by spherical
-        // aj is S*qdd(i)
-        // j is parent of i
-        // a(i) = Xa(j) + aj + cross(v(i), vj)
-        // For pinocchio we give directly a(fb), for RBDL we give aj instead (for the first two joints)
-        // so we have to remove the cross contribution cross(v(i), vj) from it
-        Eigen::Matrix3d fb_rot = floating_base_state.pose.orientation.toRotationMatrix();
-        base::Twist fb_twist = floating_base_state.twist;
-        base::Acceleration fb_acc = floating_base_state.acceleration;
-
-        Eigen::VectorXd spherical_j_vel(6);
-        spherical_j_vel << fb_twist.angular, Eigen::Vector3d::Zero();
-        Eigen::VectorXd spherical_b_vel(6);
-        spherical_b_vel << fb_twist.angular, fb_rot.transpose() * fb_twist.linear;
-
-        Eigen::VectorXd fb_spherical_cross = Math::crossm(spherical_b_vel, spherical_j_vel);
-        // remove cross contribution from linear acc s(in world coordinates as RBDL want)
-        fb_acc.linear = fb_acc.linear - fb_rot * fb_spherical_cross.tail<3>();
-
-        int floating_body_id = rbdl_model->GetBodyId(base_frame.c_str());
-        rbdl_model->SetQuaternion(floating_body_id, Math::Quaternion(floating_base_state_in.pose.orientation.coeffs()), q);
+        RobotModelWorkspaceRBDL::floatingBaseState(*rbdl_model, floating_body_id, floating_base_state, q, qd, qdd);
 
         base::Vector3d euler = floating_base_state.pose.orientation.toRotationMatrix().eulerAngles(0, 1, 2);
         for(int i = 0; i < 3; i++){
-            q[i] = joint_state[joint_names_floating_base[i]].position = floating_base_state.pose.position[i];
-            qd[i] = joint_state[joint_names_floating_base[i]].speed = fb_twist.linear[i];
-            qdd[i] = joint_state[joint_names_floating_base[i]].acceleration = fb_acc.linear[i];
-            joint_state[joint_names_floating_base[i+3]].position = euler(i);
-            qd[i+3] = joint_state[joint_names_floating_base[i+3]].speed = fb_twist.angular[i];
-            qdd[i+3] = joint_state[joint_names_floating_base[i+3]].acceleration = fb_acc.angular[i];
+            joint_state.elements[i].position = q[i];
+            joint_state.elements[i].speed = qd[i];
+            joint_state.elements[i].acceleration = qdd[i];
+            joint_state.elements[i+3].position = euler(i);
+            joint_state.elements[i+3].speed = qd[i+3];
+            joint_state.elements[i+3].acceleration = qdd[i+3];
         }
         if(floating_base_state.time > joint_state.time)
             joint_state.time = floating_base_state.time;
     }
 
     for(int i = 0; i < actuated_joint_names.size(); i++){
-        const std::string &name = actuated_joint_names[i];
-        if(!hasJoint(name)){
-            LOG_ERROR_S << "Joint " << name << " is a non-fixed joint in the robot model, but it is not in the joint state vector."
-                        << "You should either set the joint to 'fixed' in your URDF file or provide a valid joint state for it" << std::endl;
-            throw std::runtime_error("Incomplete Joint State");
-        }
-        const base::JointState& state = joint_state[name];
+        const base::JointState& state = joint_state.elements[start_idx + i];
         q[i+start_idx] = state.position;
         qd[i+start_idx] = state.speed;
         qdd[i+start_idx] = state.acceleration;
     }
 
     UpdateKinematics(*rbdl_model, q, qd, qdd); // update bodies kinematics once
+    update_counter++;
 }
 
 void RobotModelRBDL::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::VectorXd &_qdd){
@@ -213,108 +265,73 @@ void RobotModelRBDL::systemState(base::VectorXd &_q, base::VectorXd &_qd, base::
 }
 
 const base::samples::RigidBodyStateSE3 &RobotModelRBDL::rigidBodyState(const std::string &root_frame, const std::string &tip_frame){
-    if(joint_state.time.isNull()){
-        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to rigidBodyState()");
-    }
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but RBDL robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid call to rigidBodyState()");
-    }
-
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "ROOT";
-
-    uint body_id = rbdl_model->GetBodyId(use_tip_frame.c_str());
-    if(body_id == std::numeric_limits<unsigned int>::max()){
-        LOG_ERROR_S << "Request rigidBodyState for " << root_frame << " -> " << tip_frame << " but link " << tip_frame << " does not exist in robot model" << std::endl;
-        throw std::runtime_error("Invalid call to rigidBodyState()");
-    }
-
-
-    rbs.pose.position = CalcBodyToBaseCoordinates(*rbdl_model, q,body_id, base::Vector3d(0,0,0), false);
-    rbs.pose.orientation = base::Quaterniond(CalcBodyWorldOrientation(*rbdl_model, q, body_id, false).inverse());
-    Math::SpatialVector twist_rbdl = CalcPointVelocity6D(*rbdl_model, q, qd, body_id, base::Vector3d(0,0,0), false);
-    Math::SpatialVector acc_rbdl = CalcPointAcceleration6D(*rbdl_model, q, qd, qdd, body_id, base::Vector3d(0,0,0), false);
-    rbs.twist.linear = twist_rbdl.segment(3,3);
-    rbs.twist.angular = twist_rbdl.segment(0,3);
-    rbs.acceleration.linear = acc_rbdl.segment(3,3);
-    rbs.acceleration.angular = acc_rbdl.segment(0,3);
-    rbs.frame_id = root_frame;
-    rbs.time = joint_state.time;
-
+    computeRigidBodyState(bodyIdChecked(root_frame, tip_frame, "rigidBodyState"), rbs);
     return rbs;
 }
 
-const base::MatrixXd &RobotModelRBDL::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
-    if(joint_state.time.isNull()){
-        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to spaceJacobian()");
-    }
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but RBDL robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid call to spaceJacobian()");
-    }
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "ROOT";
-
-    uint body_id = rbdl_model->GetBodyId(use_tip_frame.c_str());
-    if(body_id == std::numeric_limits<unsigned int>::max()){
-        LOG_ERROR_S << "Request rigidBodyState for " << root_frame << " -> " << tip_frame << " but link " << tip_frame << " does not exist in robot model" << std::endl;
-        throw std::runtime_error("Invalid call to rigidBodyState()");
+const base::samples::RigidBodyStateSE3 &RobotModelRBDL::rigidBodyState(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->rigidBodyState(chain);
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        computeRigidBodyState(cd.body_id, cd.rbs);
+        cd.rbs_stamp = update_counter;
     }
+    return cd.rbs;
+}
 
-    std::string chain_id = chainID(root_frame,tip_frame);
-
-    uint nj = rbdl_model->dof_count;
-    space_jac_map[chain_id].resize(6,nj);
-    space_jac_map[chain_id].setZero();
-
-    base::Vector3d point_position;
-    point_position.setZero();
-    J.setZero(6, nj);
-    CalcPointJacobian6D(*rbdl_model, q, body_id, point_position, J, false);
+void RobotModelRBDL::computeRigidBodyState(const uint body_id, base::samples::RigidBodyStateSE3& rbs_out){
+    RobotModelWorkspaceRBDL::computeRigidBodyState(*rbdl_model, q, qd, qdd, body_id, rbs_out);
+    rbs_out.frame_id = world_frame;
+    rbs_out.time = joint_state.time;
+}
 
-    space_jac_map[chain_id].block(0,0,3,nj) = J.block(3,0,3,nj);
-    space_jac_map[chain_id].block(3,0,3,nj) = J.block(0,0,3,nj);
+const base::MatrixXd &RobotModelRBDL::spaceJacobian(const std::string &root_frame, const std::string &tip_frame){
+    uint body_id = bodyIdChecked(root_frame, tip_frame, "spaceJacobian");
 
-    return space_jac_map[chain_id];
+    // Root is always the world frame here, so the chain is fully defined by the tip frame. This avoids creating a chain ID string on each call
+    base::MatrixXd &space_jac = space_jac_map[tip_frame];
+    computeSpaceJacobian(body_id, space_jac);
+    return space_jac;
 }
 
-const base::MatrixXd &RobotModelRBDL::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
-    if(joint_state.time.isNull()){
-        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to bodyJacobian()");
-    }
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but RBDL robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid call to bodyJacobian()");
-    }
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "ROOT";
-
-    uint body_id = rbdl_model->GetBodyId(use_tip_frame.c_str());
-    if(body_id == std::numeric_limits<unsigned int>::max()){
-        LOG_ERROR_S << "Request rigidBodyState for " << root_frame << " -> " << tip_frame << " but link " << tip_frame << " does not exist in robot model" << std::endl;
-        throw std::runtime_error("Invalid call to rigidBodyState()");
+const base::MatrixXd &RobotModelRBDL::spaceJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spaceJacobian(chain);
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        computeSpaceJacobian(cd.body_id, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
     }
+    return cd.space_jac;
+}
 
-    std::string chain_id = chainID(root_frame,tip_frame);
+void RobotModelRBDL::computeSpaceJacobian(const uint body_id, base::MatrixXd& space_jac){
+    RobotModelWorkspaceRBDL::computeSpaceJacobian(*rbdl_model, q, body_id, space_jac);
+}
 
-    uint nj = rbdl_model->dof_count;
-    body_jac_map[chain_id].resize(6,nj);
-    body_jac_map[chain_id].setZero();
+const base::MatrixXd &RobotModelRBDL::bodyJacobian(const std::string &root_frame, const std::string &tip_frame){
+    uint body_id = bodyIdChecked(root_frame, tip_frame, "bodyJacobian");
 
-    J.setZero(6, nj);
-    CalcBodySpatialJacobian(*rbdl_model, q, body_id, J, false);
+    // Root is always the world frame here, so the chain is fully defined by the tip frame. This avoids creating a chain ID string on each call
+    base::MatrixXd &body_jac = body_jac_map[tip_frame];
+    computeBodyJacobian(body_id, body_jac);
+    return body_jac;
+}
 
-    body_jac_map[chain_id].block(0,0,3,nj) = J.block(3,0,3,nj);
-    body_jac_map[chain_id].block(3,0,3,nj) = J.block(0,0,3,nj);
+const base::MatrixXd &RobotModelRBDL::bodyJacobian(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->bodyJacobian(chain);
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        computeBodyJacobian(cd.body_id, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
+}
 
-    return body_jac_map[chain_id];
+void RobotModelRBDL::computeBodyJacobian(const uint body_id, base::MatrixXd& body_jac){
+    RobotModelWorkspaceRBDL::computeBodyJacobian(*rbdl_model, q, body_id, body_jac);
 }
 
 const base::MatrixXd &RobotModelRBDL::comJacobian(){
@@ -322,21 +339,13 @@ const base::MatrixXd &RobotModelRBDL::comJacobian(){
         LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
         throw std::runtime_error(" Invalid call to spatialAccelerationBias()");
     }
-    com_jac.setZero(3, rbdl_model->dof_count);
-    double total_mass = 0.0;
-
-    // iterate over the moving bodies except base link (numbered 0 in the graph)
-    for (unsigned int i = 1; i < rbdl_model->mBodies.size(); i++){
-        const Body& body = rbdl_model->mBodies.at(i);
-        Math::MatrixNd com_jac_body_i;
-        com_jac_body_i.setZero(3, rbdl_model->dof_count);
-        CalcPointJacobian(*rbdl_model, q, i, body.mCenterOfMass, com_jac_body_i, false);
-
-        com_jac = com_jac + body.mMass * com_jac_body_i;
-        total_mass = total_mass + body.mMass;
-    }
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->comJacobian();
+    if(com_jac_stamp == update_counter)
+        return com_jac;
 
-    com_jac = (1/total_mass) * com_jac;
+    RobotModelWorkspaceRBDL::computeCoMJacobian(*rbdl_model, q, com_jac);
+    com_jac_stamp = update_counter;
     return com_jac;
 }
 
@@ -345,30 +354,32 @@ const base::MatrixXd &RobotModelRBDL::jacobianDot(const std::string &root_frame,
 }
 
 const base::Acceleration &RobotModelRBDL::spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame){
-    if(joint_state.time.isNull()){
-        LOG_ERROR("You have to call update() with appropriately timestamped joint data at least once before requesting kinematic information!");
-        throw std::runtime_error(" Invalid call to spatialAccelerationBias()");
-    }
-    if(root_frame != world_frame){
-        LOG_ERROR_S<<"Requested Forward kinematics computation for kinematic chain "<<root_frame<<"->"<<tip_frame<<" but RBDL robot model always requires the root frame to be the root of the full model"<<std::endl;
-        throw std::runtime_error("Invalid call to spatialAccelerationBias()");
+    computeSpatialAccelerationBias(bodyIdChecked(root_frame, tip_frame, "spatialAccelerationBias"), spatial_acc_bias);
+    return spatial_acc_bias;
+}
+
+const base::Acceleration &RobotModelRBDL::spatialAccelerationBias(const ChainId chain){
+    if(RobotModelWorkspace* ws = concurrentWorkspace())
+        return ws->spatialAccelerationBias(chain);
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp != update_counter){
+        computeSpatialAccelerationBias(cd.body_id, cd.acc_bias);
+        cd.acc_bias_stamp = update_counter;
     }
-    std::string use_tip_frame = tip_frame;
-    if(use_tip_frame == "world")
-        use_tip_frame = "ROOT";
+    return cd.acc_bias;
+}
 
-    uint body_id = rbdl_model->GetBodyId(use_tip_frame.c_str());
-    if(body_id == std::numeric_limits<unsigned int>::max()){
-        LOG_ERROR_S << "Request rigidBodyState for " << root_frame << " -> " << tip_frame << " but link " << tip_frame << " does not exist in robot model" << std::endl;
-        throw std::runtime_error("Invalid call to spatialAccelerationBias()");
+void RobotModelRBDL::updateAccelerationBiasPass(){
+    if(acc_bias_pass_stamp != update_counter){
+        UpdateKinematics(*rbdl_model_acc_bias, q, qd, zero);
+        acc_bias_pass_stamp = update_counter;
     }
+}
 
-    base::Vector3d point_position;
-    point_position.setZero();
-    Math::SpatialVector spatial_acceleration = CalcPointAcceleration6D(*rbdl_model, q, qd, Math::VectorNd::Zero(rbdl_model->dof_count), body_id, point_position, true);
-    UpdateKinematics(*rbdl_model, q, qd, qdd);
-    spatial_acc_bias = base::Acceleration(spatial_acceleration.segment(3,3), spatial_acceleration.segment(0,3));
-    return spatial_acc_bias;
+void RobotModelRBDL::computeSpatialAccelerationBias(const uint body_id, base::Acceleration& acc_bias){
+    // The kinematics with zero joint accelerations are stored in a separate model, so that rbdl_model is never modified by a query
+    updateAccelerationBiasPass();
+    RobotModelWorkspaceRBDL::computeSpatialAccelerationBias(*rbdl_model_acc_bias, q, qd, zero, body_id, acc_bias);
 }
 
 const base::MatrixXd &RobotModelRBDL::jointSpaceInertiaMatrix(){
@@ -388,7 +399,7 @@ const base::VectorXd &RobotModelRBDL::biasForces(){
         throw std::runtime_error(" Invalid call to biasForces()");
     }
     tau.resize(rbdl_model->dof_count);
-    InverseDynamics(*rbdl_model, q, qd, Math::VectorNd::Zero(rbdl_model->dof_count), tau);
+    InverseDynamics(*rbdl_model, q, qd, zero, tau);
     bias_forces = tau;
     return bias_forces;
 }
@@ -399,17 +410,8 @@ const base::samples::RigidBodyStateSE3& RobotModelRBDL::centerOfMass(){
         throw std::runtime_error(" Invalid call to centerOfMass()");
     }
 
-    double mass;
-    Math::Vector3d com_pos, com_vel, com_acc;
-    Utils::CalcCenterOfMass(*rbdl_model, q, qd, &qdd, mass, com_pos, &com_vel, &com_acc, nullptr, nullptr, false);
-
+    RobotModelWorkspaceRBDL::computeCenterOfMass(*rbdl_model, q, qd, qdd, com_rbs);
     com_rbs.frame_id = world_frame;
-    com_rbs.pose.position = com_pos;
-    com_rbs.pose.orientation.setIdentity();
-    com_rbs.twist.linear = com_vel;
-    com_rbs.twist.angular.setZero();
-    com_rbs.acceleration.linear = com_acc; // TODO: double check CoM acceleration
-    com_rbs.acceleration.angular.setZero();
     com_rbs.time = joint_state.time;
     return com_rbs;
 }
@@ -11,10 +11,43 @@ protected:
     static RobotModelRegistry<RobotModelRBDL> reg;
 
     std::shared_ptr<RigidBodyDynamics::Model> rbdl_model;
-    Eigen::VectorXd q, qd, qdd, tau;
-    RigidBodyDynamics::Math::MatrixNd J, H_q;
+    std::shared_ptr<RigidBodyDynamics::Model> rbdl_model_acc_bias;  /** Copy of rbdl_model with the kinematics for zero joint accelerations, updated lazily for the spatial acceleration bias*/
+    Eigen::VectorXd q, qd, qdd, tau, zero;
+    RigidBodyDynamics::Math::MatrixNd H_q;
+    uint floating_body_id;   /** RBDL body id of the floating base body*/
+
+    /** Per-chain data for the chain id based queries. The results are computed at most once per update()*/
+    struct ChainData{
+        uint body_id = std::numeric_limits<unsigned int>::max(); /** RBDL body id of the tip frame. Resolved on first use*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;  /** Indexed by ChainId*/
+
+    /** Incremented in every call to update(). Memoized results are recomputed at most once per update*/
+    uint64_t update_counter;
+    uint64_t acc_bias_pass_stamp, com_jac_stamp;
 
     std::vector<std::string> jointNamesInRBDLOrder(const std::string &urdf_file);
+    /** Return the RBDL body id of the given frame or std::numeric_limits<unsigned int>::max() if the frame does not exist. Other than
+     *  RigidBodyDynamics::Model::GetBodyId() this will not construct any temporary strings*/
+    uint bodyId(const std::string &frame);
+    /** Check that update() has been called, that root_frame is the world frame and return the RBDL body id of the tip frame. Throw if any of these checks fails*/
+    uint bodyIdChecked(const std::string &root_frame, const std::string &tip_frame, const char* caller);
+    /** Return the data of the given chain. Resolves the RBDL body id on first use*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+    /** Allocate the per-chain data for the given chain*/
+    virtual void addChain(const ChainId chain);
+    void computeRigidBodyState(const uint body_id, base::samples::RigidBodyStateSE3& rbs_out);
+    void computeSpaceJacobian(const uint body_id, base::MatrixXd& space_jac);
+    void computeBodyJacobian(const uint body_id, base::MatrixXd& body_jac);
+    void computeSpatialAccelerationBias(const uint body_id, base::Acceleration& acc_bias);
+    /** Update the kinematics of rbdl_model_acc_bias with zero joint accelerations. Only executed once per update()*/
+    void updateAccelerationBiasPass();
+    /** Compute q, qd, qdd from joint_state and the given floating base state and update the kinematics*/
+    void updateFromJointState(const base::samples::RigidBodyStateSE3& floating_base_state_in);
     void updateFloatingBase(const base::samples::RigidBodyStateSE3& floating_base_state_in);
     void clear();
 
@@ -37,6 +70,15 @@ public:
     virtual void update(const base::samples::Joints& joint_state,
                         const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
 
+    /**
+     * @brief Update the robot configuration from raw state vectors in the order given by setJointOrder(). Does not perform any name lookups. See RobotModel::update() for details
+     */
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::Time& time,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+
     /** Return entire system state*/
     virtual void systemState(base::VectorXd &q, base::VectorXd &qd, base::VectorXd &qdd);
 
@@ -48,6 +90,9 @@ public:
      */
     virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as rigidBodyState(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+
     /** @brief Returns the Space Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -55,6 +100,9 @@ public:
       */
     virtual const base::MatrixXd &spaceJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spaceJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+
     /** @brief Returns the Body Jacobian for the kinematic chain between root and the tip frame as full body Jacobian. Size of the Jacobian will be 6 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the joint order of the robot. The columns that correspond to joints that are not part of the kinematic chain will have only zeros as entries.
       * @param root_frame Root frame of the chain. Has to be a valid link in the robot model.
@@ -62,6 +110,9 @@ public:
       */
     virtual const base::MatrixXd &bodyJacobian(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as bodyJacobian(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+
     /** @brief Returns the CoM Jacobian for the entire robot, which maps the robot joint velocities to linear spatial velocities in robot base coordinates.
       * Size of the Jacobian will be 3 x nJoints, where nJoints is the number of joints of the whole robot. The order of the
       * columns will be the same as the configured joint order of the robot.
@@ -85,6 +136,15 @@ public:
       */
     virtual const base::Acceleration &spatialAccelerationBias(const std::string &root_frame, const std::string &tip_frame);
 
+    /** Same as spatialAccelerationBias(root_frame, tip_frame), with the chain given by its id, see RobotModel::chainId()*/
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+
+    /** Workspaces are supported, see createWorkspace()*/
+    virtual bool supportsWorkspaces() const {return true;}
+
+    /** Create a RobotModelWorkspaceRBDL, which holds its own copy of the loaded RBDL model, see RobotModel::createWorkspace()*/
+    virtual RobotModelWorkspacePtr createWorkspace();
+
     /** Compute and return the joint space mass-inertia matrix, which is nj x nj, where nj is the number of joints of the system*/
     virtual const base::MatrixXd &jointSpaceInertiaMatrix();
 
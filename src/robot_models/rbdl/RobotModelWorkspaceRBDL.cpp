@@ -0,0 +1,297 @@
+#include "RobotModelWorkspaceRBDL.hpp"
+#include <rbdl/rbdl_utils.h>
+#include <base-logging/Logging.hpp>
+#include <limits>
+
+using namespace RigidBodyDynamics;
+
+namespace wbc {
+
+RobotModelWorkspaceRBDL::RobotModelWorkspaceRBDL(const Model& model,
+                                                 const bool has_floating_base,
+                                                 const uint floating_body_id,
+                                                 const std::string& world_frame,
+                                                 const std::vector<int>& q_idx,
+                                                 const std::vector<uint>& chain_body_ids) :
+    rbdl_model(model),
+    rbdl_model_acc_bias(model),
+    has_floating_base(has_floating_base),
+    floating_body_id(floating_body_id),
+    world_frame(world_frame),
+    q_idx(q_idx),
+    update_counter(0),
+    acc_bias_pass_stamp(0),
+    com_stamp(0),
+    com_jac_stamp(0),
+    inertia_mat_stamp(0),
+    bias_forces_stamp(0){
+
+    q.setZero(rbdl_model.q_size);
+    qd.setZero(rbdl_model.qdot_size);
+    qdd.setZero(rbdl_model.qdot_size);
+    zero.setZero(rbdl_model.qdot_size);
+    tau.setZero(rbdl_model.qdot_size);
+    H_q.setZero(rbdl_model.dof_count, rbdl_model.dof_count);
+
+    chain_data.resize(chain_body_ids.size());
+    for(size_t i = 0; i < chain_body_ids.size(); i++){
+        chain_data[i].body_id = chain_body_ids[i];
+        chain_data[i].rbs.frame_id = world_frame;
+    }
+    com_rbs.frame_id = world_frame;
+}
+
+void RobotModelWorkspaceRBDL::update(const Eigen::Ref<const base::VectorXd>& q_in,
+                                     const Eigen::Ref<const base::VectorXd>& qd_in,
+                                     const Eigen::Ref<const base::VectorXd>& qdd_in,
+                                     const base::samples::RigidBodyStateSE3& floating_base_state){
+    const size_t n = q_idx.size();
+    if(q_in.size() != n || qd_in.size() != n || qdd_in.size() != n){
+        LOG_ERROR("Size of joint state vectors is q: %i, qd: %i, qdd: %i, but joint order has %i entries", q_in.size(), qd_in.size(), qdd_in.size(), n);
+        throw std::runtime_error("Invalid joint state");
+    }
+
+    if(has_floating_base)
+        floatingBaseState(rbdl_model, floating_body_id, floating_base_state, q, qd, qdd);
+    for(size_t i = 0; i < n; i++){
+        q[q_idx[i]] = q_in[i];
+        qd[q_idx[i]] = qd_in[i];
+        qdd[q_idx[i]] = qdd_in[i];
+    }
+
+    UpdateKinematics(rbdl_model, q, qd, qdd);
+    update_counter++;
+}
+
+void RobotModelWorkspaceRBDL::checkUpdated(const char* caller) const{
+    if(update_counter == 0){
+        LOG_ERROR("RobotModelWorkspaceRBDL: You have to call update() at least once before requesting kinematic information!");
+        throw std::runtime_error(std::string("Invalid call to ") + caller + "()");
+    }
+}
+
+RobotModelWorkspaceRBDL::ChainData& RobotModelWorkspaceRBDL::chainData(const ChainId chain, const char* caller){
+    if(chain < 0 || chain >= (int)chain_data.size()){
+        LOG_ERROR("Invalid chain id %i in %s(). The workspace knows %i chains. Chains have to be created before the workspace", chain, caller, chain_data.size());
+        throw std::invalid_argument("Invalid chain id");
+    }
+    ChainData& cd = chain_data[chain];
+    if(cd.body_id == std::numeric_limits<unsigned int>::max()){
+        LOG_ERROR("Chain %i was requested in %s(), but either its root is not the world frame or its tip frame does not exist in robot model", chain, caller);
+        throw std::invalid_argument("Invalid chain id");
+    }
+    checkUpdated(caller);
+    return cd;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceRBDL::rigidBodyState(const ChainId chain){
+    ChainData& cd = chainData(chain, "rigidBodyState");
+    if(cd.rbs_stamp != update_counter){
+        computeRigidBodyState(rbdl_model, q, qd, qdd, cd.body_id, cd.rbs);
+        cd.rbs_stamp = update_counter;
+    }
+    return cd.rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceRBDL::spaceJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "spaceJacobian");
+    if(cd.space_jac_stamp != update_counter){
+        computeSpaceJacobian(rbdl_model, q, cd.body_id, cd.space_jac);
+        cd.space_jac_stamp = update_counter;
+    }
+    return cd.space_jac;
+}
+
+const base::MatrixXd &RobotModelWorkspaceRBDL::bodyJacobian(const ChainId chain){
+    ChainData& cd = chainData(chain, "bodyJacobian");
+    if(cd.body_jac_stamp != update_counter){
+        computeBodyJacobian(rbdl_model, q, cd.body_id, cd.body_jac);
+        cd.body_jac_stamp = update_counter;
+    }
+    return cd.body_jac;
+}
+
+const base::Acceleration &RobotModelWorkspaceRBDL::spatialAccelerationBias(const ChainId chain){
+    ChainData& cd = chainData(chain, "spatialAccelerationBias");
+    if(cd.acc_bias_stamp == update_counter)
+        return cd.acc_bias;
+
+    // One kinematics pass with zero joint accelerations per update, shared by all chains
+    if(acc_bias_pass_stamp != update_counter){
+        UpdateKinematics(rbdl_model_acc_bias, q, qd, zero);
+        acc_bias_pass_stamp = update_counter;
+    }
+    computeSpatialAccelerationBias(rbdl_model_acc_bias, q, qd, zero, cd.body_id, cd.acc_bias);
+    cd.acc_bias_stamp = update_counter;
+    return cd.acc_bias;
+}
+
+const base::MatrixXd &RobotModelWorkspaceRBDL::comJacobian(){
+    checkUpdated("comJacobian");
+    if(com_jac_stamp != update_counter){
+        computeCoMJacobian(rbdl_model, q, com_jac);
+        com_jac_stamp = update_counter;
+    }
+    return com_jac;
+}
+
+const base::samples::RigidBodyStateSE3 &RobotModelWorkspaceRBDL::centerOfMass(){
+    checkUpdated("centerOfMass");
+    if(com_stamp != update_counter){
+        computeCenterOfMass(rbdl_model, q, qd, qdd, com_rbs);
+        com_stamp = update_counter;
+    }
+    return com_rbs;
+}
+
+const base::MatrixXd &RobotModelWorkspaceRBDL::jointSpaceInertiaMatrix(){
+    checkUpdated("jointSpaceInertiaMatrix");
+    if(inertia_mat_stamp != update_counter){
+        H_q.setZero();
+        CompositeRigidBodyAlgorithm(rbdl_model, q, H_q, false);
+        joint_space_inertia_mat = H_q;
+        inertia_mat_stamp = update_counter;
+    }
+    return joint_space_inertia_mat;
+}
+
+const base::VectorXd &RobotModelWorkspaceRBDL::biasForces(){
+    checkUpdated("biasForces");
+    if(bias_forces_stamp != update_counter){
+        // InverseDynamics() overwrites the kinematics of the model it is called on (including the gravity acceleration of the root). Use the
+        // acceleration bias model for this, so that the kinematics of the current state stay intact, and recompute the acceleration bias pass afterwards
+        InverseDynamics(rbdl_model_acc_bias, q, qd, zero, tau);
+        acc_bias_pass_stamp = 0;
+        bias_forces = tau;
+        bias_forces_stamp = update_counter;
+    }
+    return bias_forces;
+}
+
+void RobotModelWorkspaceRBDL::floatingBaseState(const Model& rbdl_model,
+                                                const uint floating_body_id,
+                                                const base::samples::RigidBodyStateSE3& floating_base_state,
+                                                Eigen::VectorXd& q,
+                                                Eigen::VectorXd& qd,
+                                                Eigen::VectorXd& qdd){
+    if(!floating_base_state.hasValidPose() ||
+       !floating_base_state.hasValidTwist() ||
+       !floating_base_state.hasValidAcceleration()){
+       LOG_ERROR("Invalid status of floating base given! One (or all) of pose, twist or acceleration members is invalid (Either NaN or non-unit quaternion)");
+       throw std::runtime_error("Invalid floating base status");
+    }
+
+    // Transformation from fb body linear acceleration to fb joint linear acceleration:
+    // since RBDL treats the floating base as XYZ translation followed by spherical
+    // aj is S*qdd(i)
+    // j is parent of i
+    // a(i) = Xa(j) + aj + cross(v(i), vj)
+    // For pinocchio we give directly a(fb), for RBDL we give aj instead (for the first two joints)
+    // so we have to remove the cross contribution cross(v(i), vj) from it
+    Eigen::Matrix3d fb_rot = floating_base_state.pose.orientation.toRotationMatrix();
+    const base::Twist& fb_twist = floating_base_state.twist;
+    base::Acceleration fb_acc = floating_base_state.acceleration;
+
+    Eigen::VectorXd spherical_j_vel(6);
+    spherical_j_vel << fb_twist.angular, Eigen::Vector3d::Zero();
+    Eigen::VectorXd spherical_b_vel(6);
+    spherical_b_vel << fb_twist.angular, fb_rot.transpose() * fb_twist.linear;
+
+    Eigen::VectorXd fb_spherical_cross = Math::crossm(spherical_b_vel, spherical_j_vel);
+    // remove cross contribution from linear acc s(in world coordinates as RBDL want)
+    fb_acc.linear = fb_acc.linear - fb_rot * fb_spherical_cross.tail<3>();
+
+    rbdl_model.SetQuaternion(floating_body_id, Math::Quaternion(floating_base_state.pose.orientation.coeffs()), q);
+
+    for(int i = 0; i < 3; i++){
+        q[i] = floating_base_state.pose.position[i];
+        qd[i] = fb_twist.linear[i];
+        qdd[i] = fb_acc.linear[i];
+        qd[i+3] = fb_twist.angular[i];
+        qdd[i+3] = fb_acc.angular[i];
+    }
+}
+
+void RobotModelWorkspaceRBDL::computeRigidBodyState(Model& rbdl_model, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& qdd,
+                                                    const uint body_id, base::samples::RigidBodyStateSE3& rbs){
+    rbs.pose.position = CalcBodyToBaseCoordinates(rbdl_model, q, body_id, base::Vector3d(0,0,0), false);
+    rbs.pose.orientation = base::Quaterniond(CalcBodyWorldOrientation(rbdl_model, q, body_id, false).inverse());
+    Math::SpatialVector twist_rbdl = CalcPointVelocity6D(rbdl_model, q, qd, body_id, base::Vector3d(0,0,0), false);
+    Math::SpatialVector acc_rbdl = CalcPointAcceleration6D(rbdl_model, q, qd, qdd, body_id, base::Vector3d(0,0,0), false);
+    rbs.twist.linear = twist_rbdl.segment(3,3);
+    rbs.twist.angular = twist_rbdl.segment(0,3);
+    rbs.acceleration.linear = acc_rbdl.segment(3,3);
+    rbs.acceleration.angular = acc_rbdl.segment(0,3);
+}
+
+void RobotModelWorkspaceRBDL::computeSpaceJacobian(Model& rbdl_model, const Eigen::VectorXd& q, const uint body_id, base::MatrixXd& space_jac){
+    uint nj = rbdl_model.dof_count;
+    space_jac.resize(6,nj);
+
+    // Per-thread scratch, different chains may be computed concurrently
+    static thread_local Math::MatrixNd J;
+    base::Vector3d point_position;
+    point_position.setZero();
+    J.setZero(6, nj);
+    CalcPointJacobian6D(rbdl_model, q, body_id, point_position, J, false);
+
+    space_jac.block(0,0,3,nj) = J.block(3,0,3,nj);
+    space_jac.block(3,0,3,nj) = J.block(0,0,3,nj);
+}
+
+void RobotModelWorkspaceRBDL::computeBodyJacobian(Model& rbdl_model, const Eigen::VectorXd& q, const uint body_id, base::MatrixXd& body_jac){
+    uint nj = rbdl_model.dof_count;
+    body_jac.resize(6,nj);
+
+    // Per-thread scratch, different chains may be computed concurrently
+    static thread_local Math::MatrixNd J;
+    J.setZero(6, nj);
+    CalcBodySpatialJacobian(rbdl_model, q, body_id, J, false);
+
+    body_jac.block(0,0,3,nj) = J.block(3,0,3,nj);
+    body_jac.block(3,0,3,nj) = J.block(0,0,3,nj);
+}
+
+void RobotModelWorkspaceRBDL::computeSpatialAccelerationBias(Model& rbdl_model_acc_bias, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& zero,
+                                                             const uint body_id, base::Acceleration& acc_bias){
+    base::Vector3d point_position;
+    point_position.setZero();
+    Math::SpatialVector spatial_acceleration = CalcPointAcceleration6D(rbdl_model_acc_bias, q, qd, zero, body_id, point_position, false);
+    acc_bias = base::Acceleration(spatial_acceleration.segment(3,3), spatial_acceleration.segment(0,3));
+}
+
+void RobotModelWorkspaceRBDL::computeCoMJacobian(Model& rbdl_model, const Eigen::VectorXd& q, base::MatrixXd& com_jac){
+    com_jac.setZero(3, rbdl_model.dof_count);
+    double total_mass = 0.0;
+
+    // Per-thread scratch
+    static thread_local Math::MatrixNd com_jac_body;
+
+    // iterate over the moving bodies except base link (numbered 0 in the graph)
+    for (unsigned int i = 1; i < rbdl_model.mBodies.size(); i++){
+        const Body& body = rbdl_model.mBodies.at(i);
+        com_jac_body.setZero(3, rbdl_model.dof_count);
+        CalcPointJacobian(rbdl_model, q, i, body.mCenterOfMass, com_jac_body, false);
+
+        com_jac += body.mMass * com_jac_body;
+        total_mass = total_mass + body.mMass;
+    }
+
+    com_jac = (1/total_mass) * com_jac;
+}
+
+void RobotModelWorkspaceRBDL::computeCenterOfMass(Model& rbdl_model, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& qdd,
+                                                  base::samples::RigidBodyStateSE3& com_rbs){
+    double mass;
+    Math::Vector3d com_pos, com_vel, com_acc;
+    Utils::CalcCenterOfMass(rbdl_model, q, qd, &qdd, mass, com_pos, &com_vel, &com_acc, nullptr, nullptr, false);
+
+    com_rbs.pose.position = com_pos;
+    com_rbs.pose.orientation.setIdentity();
+    com_rbs.twist.linear = com_vel;
+    com_rbs.twist.angular.setZero();
+    com_rbs.acceleration.linear = com_acc; // TODO: double check CoM acceleration
+    com_rbs.acceleration.angular.setZero();
+}
+
+} // namespace wbc
@@ -0,0 +1,113 @@
+#ifndef ROBOT_MODEL_WORKSPACE_RBDL_HPP
+#define ROBOT_MODEL_WORKSPACE_RBDL_HPP
+
+#include "core/RobotModelWorkspace.hpp"
+#include <rbdl/rbdl.h>
+#include <vector>
+#include <string>
+
+namespace wbc {
+
+/**
+ * @brief Workspace of RobotModelRBDL, see RobotModelWorkspace. RBDL stores the kinematic state in RigidBodyDynamics::Model itself, so each workspace holds its own copies
+ *  of the already loaded RBDL model. The static functions implement the kinematics for both RobotModelRBDL and the workspaces, so that both give identical results.
+ */
+class RobotModelWorkspaceRBDL : public RobotModelWorkspace{
+protected:
+    RigidBodyDynamics::Model rbdl_model;            /** Kinematics of the current state, computed in every call to update()*/
+    RigidBodyDynamics::Model rbdl_model_acc_bias;   /** Kinematics with zero joint accelerations, computed lazily for the spatial acceleration bias*/
+    bool has_floating_base;
+    uint floating_body_id;
+    std::string world_frame;
+    std::vector<int> q_idx;                         /** Index in q/qd/qdd of each joint in the joint order*/
+    Eigen::VectorXd q, qd, qdd, zero, tau;
+    RigidBodyDynamics::Math::MatrixNd H_q;
+
+    /** Per-chain results. A result is up to date if its stamp equals the current update counter*/
+    struct ChainData{
+        uint body_id;      /** RBDL body id of the tip frame. std::numeric_limits<unsigned int>::max() if the chain is invalid*/
+        base::samples::RigidBodyStateSE3 rbs;
+        base::MatrixXd space_jac, body_jac;
+        base::Acceleration acc_bias;
+        uint64_t rbs_stamp = 0, space_jac_stamp = 0, body_jac_stamp = 0, acc_bias_stamp = 0;
+    };
+    std::vector<ChainData> chain_data;   /** Indexed by ChainId*/
+
+    base::samples::RigidBodyStateSE3 com_rbs;
+    base::MatrixXd com_jac, joint_space_inertia_mat;
+    base::VectorXd bias_forces;
+
+    uint64_t update_counter;
+    uint64_t acc_bias_pass_stamp, com_stamp, com_jac_stamp, inertia_mat_stamp, bias_forces_stamp;
+
+    /** Return the data of the given chain. Throws if the chain is unknown or invalid or if update() has not been called yet*/
+    ChainData& chainData(const ChainId chain, const char* caller);
+
+    /** Throw if update() has not been called yet*/
+    void checkUpdated(const char* caller) const;
+
+public:
+    /**
+     * @brief Create a workspace
+     * @param rbdl_model The loaded RBDL model, is copied
+     * @param has_floating_base True for floating base robots
+     * @param floating_body_id RBDL body id of the floating base body. Only used for floating base robots
+     * @param world_frame Frame id of all returned states
+     * @param q_idx Index in the RBDL state vectors of each joint in the joint order
+     * @param chain_body_ids RBDL body id of the tip frame of each chain, indexed by ChainId. std::numeric_limits<unsigned int>::max() for invalid chains
+     */
+    RobotModelWorkspaceRBDL(const RigidBodyDynamics::Model& rbdl_model,
+                            const bool has_floating_base,
+                            const uint floating_body_id,
+                            const std::string& world_frame,
+                            const std::vector<int>& q_idx,
+                            const std::vector<uint>& chain_body_ids);
+    virtual ~RobotModelWorkspaceRBDL(){}
+
+    virtual void update(const Eigen::Ref<const base::VectorXd>& q,
+                        const Eigen::Ref<const base::VectorXd>& qd,
+                        const Eigen::Ref<const base::VectorXd>& qdd,
+                        const base::samples::RigidBodyStateSE3& floating_base_state = base::samples::RigidBodyStateSE3());
+    virtual const base::samples::RigidBodyStateSE3 &rigidBodyState(const ChainId chain);
+    virtual const base::MatrixXd &spaceJacobian(const ChainId chain);
+    virtual const base::MatrixXd &bodyJacobian(const ChainId chain);
+    virtual const base::Acceleration &spatialAccelerationBias(const ChainId chain);
+    virtual const base::MatrixXd &comJacobian();
+    virtual const base::samples::RigidBodyStateSE3 &centerOfMass();
+    virtual const base::MatrixXd &jointSpaceInertiaMatrix();
+    virtual const base::VectorXd &biasForces();
+    virtual uint noOfChains() const {return chain_data.size();}
+
+    /** Write the floating base state to the first entries of the RBDL state vectors q, qd and qdd. Throws if the floating base state is invalid*/
+    static void floatingBaseState(const RigidBodyDynamics::Model& rbdl_model,
+                                  const uint floating_body_id,
+                                  const base::samples::RigidBodyStateSE3& floating_base_state,
+                                  Eigen::VectorXd& q,
+                                  Eigen::VectorXd& qd,
+                                  Eigen::VectorXd& qdd);
+
+    /** Compute pose, twist and acceleration of the given body in world coordinates. The kinematics of rbdl_model have to be up to date. Does not set frame id and time stamp*/
+    static void computeRigidBodyState(RigidBodyDynamics::Model& rbdl_model, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& qdd,
+                                      const uint body_id, base::samples::RigidBodyStateSE3& rbs);
+
+    /** Compute the space Jacobian of the given body. The kinematics of rbdl_model have to be up to date*/
+    static void computeSpaceJacobian(RigidBodyDynamics::Model& rbdl_model, const Eigen::VectorXd& q, const uint body_id, base::MatrixXd& space_jac);
+
+    /** Compute the body Jacobian of the given body. The kinematics of rbdl_model have to be up to date*/
+    static void computeBodyJacobian(RigidBodyDynamics::Model& rbdl_model, const Eigen::VectorXd& q, const uint body_id, base::MatrixXd& body_jac);
+
+    /** Compute the spatial acceleration bias of the given body. The kinematics of rbdl_model_acc_bias have to be up to date with zero joint accelerations*/
+    static void computeSpatialAccelerationBias(RigidBodyDynamics::Model& rbdl_model_acc_bias, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& zero,
+                                               const uint body_id, base::Acceleration& acc_bias);
+
+    /** Compute the CoM Jacobian. The kinematics of rbdl_model have to be up to date*/
+    static void computeCoMJacobian(RigidBodyDynamics::Model& rbdl_model, const Eigen::VectorXd& q, base::MatrixXd& com_jac);
+
+    /** Compute the center of mass in world coordinates. Does not set frame id and time stamp*/
+    static void computeCenterOfMass(RigidBodyDynamics::Model& rbdl_model, const Eigen::VectorXd& q, const Eigen::VectorXd& qd, const Eigen::VectorXd& qdd,
+                                    base::samples::RigidBodyStateSE3& com_rbs);
+};
+
+} // namespace wbc
+
+#endif
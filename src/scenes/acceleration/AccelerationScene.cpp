@@ -17,11 +17,11 @@ AccelerationScene::AccelerationScene(RobotModelPtr robot_model, QPSolverPtr solv
 TaskPtr AccelerationScene::createTask(const TaskConfig &config){
 
     if(config.type == cart)
-        return std::make_shared<CartesianAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CartesianAccelerationTask>(config, robot_model);
     else if(config.type == com)
-        return std::make_shared<CoMAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CoMAccelerationTask>(config, robot_model);
     else if(config.type == jnt)
-        return std::make_shared<JointAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<JointAccelerationTask>(config, robot_model);
     else{
         LOG_ERROR("Task with name %s has an invalid task type: %i", config.name.c_str(), config.type);
         throw std::invalid_argument("Invalid task config");
@@ -45,8 +45,8 @@ const HierarchicalQP& AccelerationScene::update(){
     ///////// Constraints
 
     // This scene does not implement constraints
-    hqp[prio].upper_x.setConstant(1e10);
-    hqp[prio].lower_x.setConstant(-1e10);
+    hqp[prio].upper_x.setConstant(QP_INFINITE_BOUND);
+    hqp[prio].lower_x.setConstant(-QP_INFINITE_BOUND);
 
     hqp[prio].A.setZero();
     hqp[prio].lower_y.setZero();
@@ -56,30 +56,15 @@ const HierarchicalQP& AccelerationScene::update(){
 
     ///////// Tasks
 
+    updateTasks();
     qp.H.setZero();
     qp.g.setZero();
     for(uint i = 0; i < tasks[prio].size(); i++){
 
         TaskPtr task = tasks[prio][i];
-
-        task->checkTimeout();
-        task->update(robot_model);
-
-        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-        // task phases and we don't want to store the "old" reference value, in case we switch on the task again
-        if(task->activation == 0){
-           task->y_ref.setZero();
-           task->y_ref_root.setZero();
-        }
-
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
-
-        qp.H += task->Aw.transpose()*task->Aw;
-        qp.g -= task->Aw.transpose()*task->y_ref_root;
+        addTaskToCost(task, qp);
     }
+    symmetrizeCost(qp);
 
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
     hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
@@ -92,17 +77,16 @@ const base::commands::Joints& AccelerationScene::solve(const HierarchicalQP& hqp
     solver_output.resize(hqp[0].nq);
     solver->solve(hqp, solver_output);
 
-    // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
+    // Convert Output. Joint names are set in configure()
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
         uint idx = robot_model->jointIndex(name);
         if(base::isNaN(solver_output[idx]))
             throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
-        solver_output_joints[name].acceleration = solver_output[idx];
+        solver_output_joints[i].acceleration = solver_output[idx];
     }
     solver_output_joints.time = base::Time::now();
+    publishSolverOutput();
     return solver_output_joints;
 }
 
@@ -126,14 +110,16 @@ const TasksStatus &AccelerationScene::updateTasksStatus(){
             tasks_status[name].weights    = task->weights;
             tasks_status[name].y_ref      = task->y_ref_root;
             if(task->config.type == cart){
-                const base::MatrixXd &jac = robot_model->spaceJacobian(task->config.root, task->config.tip);
-                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(task->config.root, task->config.tip);
+                const ChainId chain = static_cast<CartesianTask*>(task.get())->chain;
+                const base::MatrixXd &jac = robot_model->spaceJacobian(chain);
+                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(chain);
                 tasks_status[name].y_solution = jac * solver_output + bias_acc;
                 tasks_status[name].y          = jac * robot_acc + bias_acc;
             }
         }
     }
 
+    publishTasksStatus();
     return tasks_status;
 }
 
@@ -37,11 +37,11 @@ AccelerationSceneReducedTSID::AccelerationSceneReducedTSID(RobotModelPtr robot_m
 TaskPtr AccelerationSceneReducedTSID::createTask(const TaskConfig &config){
 
     if(config.type == cart)
-        return std::make_shared<CartesianAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CartesianAccelerationTask>(config, robot_model);
     else if(config.type == com)
-        return std::make_shared<CoMAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CoMAccelerationTask>(config, robot_model);
     else if(config.type == jnt)
-        return std::make_shared<JointAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<JointAccelerationTask>(config, robot_model);
     else{
         LOG_ERROR("Task with name %s has an invalid task type: %i", config.name.c_str(), config.type);
         throw std::invalid_argument("Invalid task config");
@@ -64,76 +64,26 @@ const HierarchicalQP& AccelerationSceneReducedTSID::update(){
 
     //////// Constraints
 
-    bool has_bounds = false;
-    size_t total_eqs = 0, total_ineqs = 0;
-    for(auto contraint : constraints[prio]) {
-        contraint->update(robot_model);
-        if(contraint->type() == Constraint::equality)
-            total_eqs += contraint->size();
-        if(contraint->type() == Constraint::inequality)
-            total_ineqs += contraint->size();
-        if(contraint->type() == Constraint::bounds)
-            has_bounds = true;
-    }
-
+    // Generate a sparse QP if the solver supports it. The constraint matrices are mostly zero in this formulation
     // QP Size: (nc x nj+nc*6)
     // Variable order: (qdd,f_ext)
+    updateConstraints(prio, nj+ncp*6, solver->sparseInput());
     QuadraticProgram& qp = hqp[prio];
-    qp.resize(nj+ncp*6, total_eqs, total_ineqs, has_bounds);
-    qp.A.setZero();
-    qp.lower_x.setConstant(-10000);   // bounds
-    qp.upper_x.setConstant(+10000);   // bounds
-    qp.lower_y.setZero(); // inequalities
-    qp.upper_y.setZero(); // inequalities
-
-    total_eqs = 0, total_ineqs = 0;
-    for(uint i = 0; i < constraints[prio].size(); i++) {
-        Constraint::Type type = constraints[prio][i]->type();
-        size_t c_size = constraints[prio][i]->size();
-
-        if(type == Constraint::bounds) {
-            qp.lower_x = constraints[prio][i]->lb(); // NOTE! Good only if a single bound task is admitted
-            qp.upper_x = constraints[prio][i]->ub();
-        }
-        else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
-            total_eqs += c_size;
-        }
-        else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
-            total_ineqs += c_size;
-        }
-    }
+    updateVariableBlocks(qp, false);
 
     ///////// Tasks
 
+    updateTasks();
     qp.H.setZero();
     qp.g.setZero();
     for(uint i = 0; i < tasks[prio].size(); i++){
         
         TaskPtr task = tasks[prio][i];
 
-        task->checkTimeout();
-        task->update(robot_model);
-
-        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-        // task phases and we don't want to store the "old" reference value, in case we switch on the task again
-        if(task->activation == 0){
-           task->y_ref.setZero();
-           task->y_ref_root.setZero();
-        }
-
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
-
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw; // NOTE! good only if tasks involve only acceleration
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
+        // NOTE! good only if tasks involve only acceleration
+        addTaskToCost(task, qp);
     }
+    symmetrizeCost(qp);
 
     qp.H.block(0,0, nj, nj).diagonal().array() += hessian_regularizer;
     qp.H.block(nj,nj, ncp*6, ncp*6).diagonal().array() += 1e-12;
@@ -150,6 +100,7 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
     solver->solve(hqp, solver_output);
 
     const auto& contacts = robot_model->getActiveContacts();
+    const std::vector<ChainId>& contact_chains = robot_model->contactChainIds();
 
     // Convert solver output: Acceleration and torque
     uint nj = robot_model->noOfJoints();
@@ -160,13 +111,13 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
     auto fext_out = Eigen::Map<Eigen::VectorXd>(solver_output.data()+nj, 6*nc);
 
     // computing torques from accelerations and forces (using last na equation from dynamic equations of motion)
-    Eigen::VectorXd tau_out = robot_model->jointSpaceInertiaMatrix().bottomRows(na) * qdd_out;
+    tau_out.resize(na);
+    tau_out.noalias() = robot_model->jointSpaceInertiaMatrix().bottomRows(na) * qdd_out;
     for(uint c = 0; c < nc; ++c)
-        tau_out += -robot_model->bodyJacobian(robot_model->worldFrame(), contacts.names[c]).transpose().bottomRows(na) * fext_out.segment<6>(c*6);
+        tau_out.noalias() -= robot_model->bodyJacobian(contact_chains[c]).transpose().bottomRows(na) * fext_out.segment<6>(c*6);
     tau_out += robot_model->biasForces().bottomRows(na);
 
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
+    // Joint names are set in configure()
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
         uint idx = robot_model->jointIndex(name);
@@ -179,8 +130,8 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
             hqp[0].print();
             throw std::runtime_error("Solver output (force/torque) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].acceleration = qdd_out[idx];
-        solver_output_joints[name].effort = tau_out[idx-start_idx]; // tau_out does not include fb dofs.
+        solver_output_joints[i].acceleration = qdd_out[idx];
+        solver_output_joints[i].effort = tau_out[idx-start_idx]; // tau_out does not include fb dofs.
     }
     solver_output_joints.time = base::Time::now();
 
@@ -189,14 +140,18 @@ const base::commands::Joints& AccelerationSceneReducedTSID::solve(const Hierarch
     // std::cerr << "F_ext: " << fext_out.transpose() << std::endl << std::endl;
 
     // Convert solver output: contact wrenches
-    contact_wrenches.resize(nc);
-    contact_wrenches.names = contacts.names;
+    // Contacts might have been changed from outside, only copy the names in that case
+    if(contact_wrenches.names != contacts.names){
+        contact_wrenches.resize(nc);
+        contact_wrenches.names = contacts.names;
+    }
     for(uint i = 0; i < nc; i++){
         contact_wrenches[i].force = fext_out.segment(i*6, 3);
         contact_wrenches[i].torque = fext_out.segment(i*6+3, 3);
     }
 
     contact_wrenches.time = base::Time::now();
+    publishSolverOutput();
     return solver_output_joints;
 }
 
@@ -221,14 +176,16 @@ const TasksStatus& AccelerationSceneReducedTSID::updateTasksStatus(){
             tasks_status[name].weights    = task->weights;
             tasks_status[name].y_ref      = task->y_ref_root;
             if(task->config.type == cart){
-                const base::MatrixXd &jac = robot_model->spaceJacobian(task->config.root, task->config.tip);
-                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(task->config.root, task->config.tip);
+                const ChainId chain = static_cast<CartesianTask*>(task.get())->chain;
+                const base::MatrixXd &jac = robot_model->spaceJacobian(chain);
+                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(chain);
                 tasks_status[name].y_solution = jac * solver_output_acc + bias_acc;
                 tasks_status[name].y          = jac * robot_acc + bias_acc;
             }
         }
     }
 
+    publishTasksStatus();
     return tasks_status;
 }
 
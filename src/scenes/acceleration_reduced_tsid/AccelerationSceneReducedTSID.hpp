@@ -42,6 +42,7 @@ protected:
 
     // Helper variables
     base::VectorXd robot_acc, solver_output_acc;
+    base::VectorXd tau_out;
     base::samples::Wrenches contact_wrenches;
     double hessian_regularizer;
 
@@ -34,11 +34,11 @@ AccelerationSceneTSID::AccelerationSceneTSID(RobotModelPtr robot_model, QPSolver
 TaskPtr AccelerationSceneTSID::createTask(const TaskConfig &config){
 
     if(config.type == cart)
-        return std::make_shared<CartesianAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CartesianAccelerationTask>(config, robot_model);
     else if(config.type == com)
-        return std::make_shared<CoMAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CoMAccelerationTask>(config, robot_model);
     else if(config.type == jnt)
-        return std::make_shared<JointAccelerationTask>(config, robot_model->noOfJoints());
+        return std::make_shared<JointAccelerationTask>(config, robot_model);
     else{
         LOG_ERROR("Task with name %s has an invalid task type: %i", config.name.c_str(), config.type);
         throw std::invalid_argument("Invalid task config");
@@ -50,82 +50,37 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
     if(!configured)
         throw std::runtime_error("AccelerationSceneTSID has not been configured!. PLease call configure() before calling update() for the first time!");
 
-    if(tasks.size() != 1){
-        LOG_ERROR("Number of priorities in AccelerationSceneTSID should be 1, but is %i", tasks.size());
-        throw std::runtime_error("Invalid task configuration");
-    }
-
-    int prio = 0; // Only one priority is implemented here!
     uint nj = robot_model->noOfJoints();
     uint na = robot_model->noOfActuatedJoints();
     uint ncp = robot_model->getActiveContacts().size();
+    uint nq = nj+na+ncp*6;
 
     ///////// Constraints
 
-    bool has_bounds = false;
-    size_t total_eqs = 0, total_ineqs = 0;
-    for(auto contraint : constraints[prio]) {
-        contraint->update(robot_model);
-        if(contraint->type() == Constraint::equality)
-            total_eqs += contraint->size();
-        if(contraint->type() == Constraint::inequality)
-            total_ineqs += contraint->size();
-        if(contraint->type() == Constraint::bounds)
-            has_bounds = true;;
-    }
-
-    QuadraticProgram& qp = hqp[prio];
-    qp.resize(nj+na+ncp*6, total_eqs, total_ineqs, has_bounds);
-    total_eqs = total_ineqs = 0;
-    for(uint i = 0; i < constraints[prio].size(); i++) {
-        Constraint::Type type = constraints[prio][i]->type();
-        size_t c_size = constraints[prio][i]->size();
-
-        if(type == Constraint::bounds) {
-            qp.lower_x = constraints[prio][i]->lb();
-            qp.upper_x = constraints[prio][i]->ub();
-        }
-        else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
-            total_eqs += c_size;
-        }
-        else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
-            total_ineqs += c_size;
-        }
-    }
+    // Generate a sparse QP if the solver supports it. The constraint matrices are mostly zero in this formulation.
+    // The physical constraints are part of the highest priority, lower priorities only contain tasks
+    updateConstraints(0, nq, solver->sparseInput());
+    updateVariableBlocks(hqp[0], true);
+    for(uint prio = 1; prio < tasks.size(); prio++)
+        hqp[prio].resize(nq, 0, 0, false, solver->sparseInput());
 
     ///////// Tasks
 
-    qp.H.setZero();
-    qp.g.setZero();
-    for(uint i = 0; i < tasks[prio].size(); i++){
-        
-        TaskPtr task = tasks[prio][i];
-
-        task->checkTimeout();
-        task->update(robot_model);
+    updateTasks();
+    for(uint prio = 0; prio < tasks.size(); prio++){
+        QuadraticProgram& qp = hqp[prio];
+        qp.H.setZero();
+        qp.g.setZero();
+        for(uint i = 0; i < tasks[prio].size(); i++){
 
-        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-        // task phases and we don't want to store the "old" reference value, in case we switch on the task again
-        if(task->activation == 0){
-           task->y_ref.setZero();
-           task->y_ref_root.setZero();
+            TaskPtr task = tasks[prio][i];
+            addTaskToCost(task, qp);
         }
-
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
-
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw;
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
+        symmetrizeCost(qp);
     }
 
-    qp.H.block(0,0, nj, nj).diagonal().array() += hessian_regularizer;
+    // Regularize only the lowest priority, otherwise the solution would be fully determined by the higher priorities
+    hqp[tasks.size()-1].H.block(0,0, nj, nj).diagonal().array() += hessian_regularizer;
 
     hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
@@ -138,11 +93,9 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
     solver_output.resize(hqp[0].nq);
     solver->solve(hqp, solver_output);
 
-    // Convert solver output: Acceleration and torque
+    // Convert solver output: Acceleration and torque. Joint names are set in configure()
     uint nj = robot_model->noOfJoints();
     uint na = robot_model->noOfActuatedJoints();
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
         uint idx = robot_model->jointIndex(name);
@@ -154,9 +107,9 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
             hqp[0].print();
             throw std::runtime_error("Solver output (force/torque) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].acceleration = solver_output.segment(0,nj)[idx];
+        solver_output_joints[i].acceleration = solver_output.segment(0,nj)[idx];
         uint start_idx = robot_model->hasFloatingBase() ? 6 : 0;
-        solver_output_joints[name].effort = solver_output.segment(nj,na)[idx-start_idx];
+        solver_output_joints[i].effort = solver_output.segment(nj,na)[idx-start_idx];
     }
     solver_output_joints.time = base::Time::now();
 
@@ -165,14 +118,18 @@ const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP&
     // std::cout<<"F_ext: "<<solver_output.segment(nj+na,12).transpose()<<std::endl<<std::endl;
 
     // Convert solver output: contact wrenches
-    contact_wrenches.resize(robot_model->getActiveContacts().size());
-    contact_wrenches.names = robot_model->getActiveContacts().names;
+    // Contacts might have been changed from outside, only copy the names in that case
+    if(contact_wrenches.names != robot_model->getActiveContacts().names){
+        contact_wrenches.resize(robot_model->getActiveContacts().size());
+        contact_wrenches.names = robot_model->getActiveContacts().names;
+    }
     for(uint i = 0; i < robot_model->getActiveContacts().size(); i++){
         contact_wrenches[i].force = solver_output.segment(nj+na+i*6,3);
         contact_wrenches[i].torque = solver_output.segment(nj+na+i*6+3,3);
     }
 
     contact_wrenches.time = base::Time::now();
+    publishSolverOutput();
     return solver_output_joints;
 }
 
@@ -197,14 +154,16 @@ const TasksStatus& AccelerationSceneTSID::updateTasksStatus(){
             tasks_status[name].weights    = task->weights;
             tasks_status[name].y_ref      = task->y_ref_root;
             if(task->config.type == cart){
-                const base::MatrixXd &jac = robot_model->spaceJacobian(task->config.root, task->config.tip);
-                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(task->config.root, task->config.tip);
+                const ChainId chain = static_cast<CartesianTask*>(task.get())->chain;
+                const base::MatrixXd &jac = robot_model->spaceJacobian(chain);
+                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(chain);
                 tasks_status[name].y_solution = jac * solver_output_acc + bias_acc;
                 tasks_status[name].y          = jac * robot_acc + bias_acc;
             }
         }
     }
 
+    publishTasksStatus();
     return tasks_status;
 }
 
@@ -33,8 +33,9 @@ namespace wbc{
  *
  * The implementation is close to the task-space-inverse dynamics (TSID) method: https://andreadelprete.github.io/teaching/tsid/1_tsid_theory.pdf.
  * It computes the required joint space accelerations \f$\ddot{\mathbf{q}}\f$, torques \f$\mathbf{\tau}\f$ and contact wrenches \f$\mathbf{f}\f$, required to achieve the given task space
- * accelerations \f$\mathbf{v}_{d}\f$ under consideration of the equations of motion (eom), rigid contacts and joint force/torque limits. Note that onyl a single hierarchy level is allowed here,
- * prioritization can be achieved by assigning suitable task weights \f$\mathbf{W}\f$.
+ * accelerations \f$\mathbf{v}_{d}\f$ under consideration of the equations of motion (eom), rigid contacts and joint force/torque limits. Prioritization can be achieved by assigning suitable task weights \f$\mathbf{W}\f$.
+ * Multiple priorities require a hierarchical QP solver like the CascadedQPSolver. In this case the constraints are part of the highest priority, each priority contains the tasks of that priority
+ * in its cost function and the Hessian regularization is only applied to the lowest priority.
  */
 class AccelerationSceneTSID : public Scene{
 protected:
@@ -18,11 +18,11 @@ VelocityScene::VelocityScene(RobotModelPtr robot_model, QPSolverPtr solver, cons
 TaskPtr VelocityScene::createTask(const TaskConfig &config){
 
     if(config.type == cart)
-        return std::make_shared<CartesianVelocityTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CartesianVelocityTask>(config, robot_model);
     else if(config.type == com)
-        return std::make_shared<CoMVelocityTask>(config, robot_model->noOfJoints());
+        return std::make_shared<CoMVelocityTask>(config, robot_model);
     else if(config.type == jnt)
-        return std::make_shared<JointVelocityTask>(config, robot_model->noOfJoints());
+        return std::make_shared<JointVelocityTask>(config, robot_model);
     else{
         LOG_ERROR("Task with name %s has an invalid task type: %i", config.name.c_str(), config.type);
         throw std::invalid_argument("Invalid task config");
@@ -38,6 +38,7 @@ const HierarchicalQP& VelocityScene::update(){
 
     // Note: This scene models all tasks as linear equality constraints in order to comply with the HLS solver
     uint nj = robot_model->noOfJoints();
+    updateTasks();
     for(uint prio = 0; prio < tasks.size(); prio++){
 
         uint nc = n_task_variables_per_prio[prio];
@@ -49,18 +50,8 @@ const HierarchicalQP& VelocityScene::update(){
 
             TaskPtr task = tasks[prio][i];
 
-            task->checkTimeout();
-            task->update(robot_model);
-            
             uint n_vars = task->config.nVariables();
 
-            // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-            // task phases and we don't want to store the "old" reference value, in case we switch on the task again
-            if(task->activation == 0){
-               task->y_ref.setZero();
-               task->y_ref_root.setZero();
-            }
-
             // Insert tasks into equation system of current priority at the correct position. Note: Weights will be zero if activations
             // for this task is zero or if the task is in timeout
             hqp[prio].Wy.segment(row_index, n_vars) = task->weights_root * task->activation * (!task->timeout);
@@ -89,9 +80,7 @@ const base::commands::Joints& VelocityScene::solve(const HierarchicalQP& hqp){
     solver_output.resize(hqp[0].nq);
     solver->solve(hqp, solver_output);
 
-    // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
+    // Convert Output. Joint names are set in configure()
     for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
         const std::string& name = robot_model->actuatedJointNames()[i];
         uint idx = robot_model->jointIndex(name);
@@ -99,10 +88,11 @@ const base::commands::Joints& VelocityScene::solve(const HierarchicalQP& hqp){
             hqp[0].print();
             throw std::runtime_error("Solver output (speed) for joint " + name + " is NaN");
         }
-        solver_output_joints[name].speed = solver_output[idx];
+        solver_output_joints[i].speed = solver_output[idx];
     }
 
     solver_output_joints.time = base::Time::now();
+    publishSolverOutput();
     return solver_output_joints;
 }
 
@@ -127,6 +117,7 @@ const TasksStatus& VelocityScene::updateTasksStatus(){
     }
 
     hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    publishTasksStatus();
     return tasks_status;
 }
 
@@ -30,92 +30,34 @@ const HierarchicalQP& VelocitySceneQP::update(){
     if(!configured)
         throw std::runtime_error("VelocitySceneQP has not been configured!. Please call configure() before calling update() for the first time!");
 
-    if(tasks.size() != 1){
-        LOG_ERROR("Number of priorities in VelocitySceneQP should be 1, but is %i", tasks.size());
-        throw std::runtime_error("Invalid task configuration");
-    }
-
     int nj = robot_model->noOfJoints();
-    uint prio = 0;
 
     ///////// Constraints
 
-    // check problem size
-    size_t total_eqs = 0, total_ineqs = 0;
-    bool has_bounds = false;
-    for(auto constraint : constraints[prio]) {
-        constraint->update(robot_model);
-        if(constraint->type() == Constraint::equality)
-            total_eqs += constraint->size();
-        else if(constraint->type() == Constraint::inequality)
-            total_ineqs += constraint->size();
-        else if(constraint->type() == Constraint::bounds)
-            has_bounds = true;
-    }
-
-    ///////// Tasks
-
     // QP Size: (ncp*6 x nj)
     // Variable order: (qd)
-    QuadraticProgram &qp = hqp[prio];
-    qp.resize(nj, total_eqs, total_ineqs, has_bounds);
-    qp.lower_y.setConstant(-99999);
-    qp.upper_y.setConstant(+99999);
-    qp.lower_x.setConstant(-99999);
-    qp.upper_x.setConstant(+99999);
-    qp.A.setZero();
-
-    total_eqs = total_ineqs = 0;
-    for(uint i = 0; i < constraints[prio].size(); i++) {
-        Constraint::Type type = constraints[prio][i]->type();
-        size_t c_size = constraints[prio][i]->size();
-
-        if(type == Constraint::bounds) {
-            qp.lower_x = constraints[prio][i]->lb();
-            qp.upper_x = constraints[prio][i]->ub();
-        }
-        else if (type == Constraint::equality) {
-            qp.A.middleRows(total_eqs, c_size) = constraints[prio][i]->A();
-            qp.b.segment(total_eqs, c_size) = constraints[prio][i]->b();
-            total_eqs += c_size;
-        }
-        else if (type == Constraint::inequality) {
-            qp.C.middleRows(total_ineqs, c_size) = constraints[prio][i]->A();
-            qp.lower_y.segment(total_ineqs, c_size) = constraints[prio][i]->lb();
-            qp.upper_y.segment(total_ineqs, c_size) = constraints[prio][i]->ub();
-            total_ineqs += c_size;
-        }
-    }
+    // The physical constraints are part of the highest priority, lower priorities only contain tasks
+    updateConstraints(0, nj);
+    for(uint prio = 1; prio < tasks.size(); prio++)
+        hqp[prio].resize(nj, 0, 0, false);
 
-    ///////// Tasks    
-    qp.H.setZero();
-    qp.g.setZero();
-    for(uint i = 0; i < tasks[prio].size(); i++){
-        
-        TaskPtr task = tasks[prio][i];
-
-        task->checkTimeout();
-        task->update(robot_model);
-
-        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-        // task phases and we don't want to store the "old" reference value, in case we switch on the task again
-        if(task->activation == 0){
-           task->y_ref.setZero();
-           task->y_ref_root.setZero();
-        }
-
-        for(int i = 0; i < task->A.rows(); i++)
-            task->Aw.row(i) = task->weights_root(i) * task->A.row(i) * task->activation * (!task->timeout);
-        for(int i = 0; i < task->A.cols(); i++)
-            task->Aw.col(i) = joint_weights[i] * task->Aw.col(i);
-
-        qp.H.block(0,0,nj,nj) += task->Aw.transpose()*task->Aw;
-        qp.g.segment(0,nj) -= task->Aw.transpose()*task->y_ref_root;
-
-    } // tasks on prio
+    ///////// Tasks
+    updateTasks();
+    for(uint prio = 0; prio < tasks.size(); prio++){
+        QuadraticProgram &qp = hqp[prio];
+        qp.H.setZero();
+        qp.g.setZero();
+        for(uint i = 0; i < tasks[prio].size(); i++){
+
+            TaskPtr task = tasks[prio][i];
+            addTaskToCost(task, qp);
+
+        } // tasks on prio
+        symmetrizeCost(qp);
+    }
 
-    // Add regularization term
-    qp.H.block(0,0,nj,nj).diagonal().array() += hessian_regularizer;
+    // Add regularization term. Only the lowest priority is regularized, otherwise the solution would be fully determined by the higher priorities
+    hqp[tasks.size()-1].H.block(0,0,nj,nj).diagonal().array() += hessian_regularizer;
 
     hqp.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
     hqp.time = base::Time::now(); //  TODO: Use latest time stamp from all tasks!?
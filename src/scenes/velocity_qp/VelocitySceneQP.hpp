@@ -19,6 +19,8 @@ namespace wbc{
  *
  * In contrast to the VelocityScene class, the tasks are formulated within the cost function instead of modeling them as tasks. The problem is
  * solved with respect to a number of rigid contacts \f$\mathbf{J}_{c,i}\dot{\mathbf{q}}=0, \, \forall i \f$ and under consideration of the joint velocity limits of the robot.
+ * Multiple priorities require a hierarchical QP solver like the CascadedQPSolver. In this case the constraints are part of the highest priority and the Hessian regularization
+ * is only applied to the lowest priority.
  *
  * \f$\dot{\mathbf{q}}\f$ - Vector of robot joint velocities<br>
  * \f$\mathbf{v}_{d}\f$ - Desired Spatial velocities of all tasks stacked in a vector<br>
@@ -0,0 +1,308 @@
+#include "ADMMSolver.hpp"
+#include <base/Time.hpp>
+#include <base-logging/Logging.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace wbc {
+
+QPSolverRegistry<ADMMSolver> ADMMSolver::reg("admm");
+
+/// Step size of the constraint rows without finite bounds, see OSQP
+static const double RHO_MIN = 1e-6;
+/// Factor between the step size of the equality and inequality constraints, see OSQP
+static const double RHO_EQ_FACTOR = 1e3;
+
+/// Infinity norm of a vector or vector expression. Expressions are evaluated coefficient-wise, without a temporary
+template<typename Derived> static double normInf(const Eigen::MatrixBase<Derived>& v){
+    return v.size() > 0 ? v.template lpNorm<Eigen::Infinity>() : 0;
+}
+
+ADMMSolver::ADMMSolver() :
+    max_iter(4000),
+    eps_abs(1e-6),
+    eps_rel(1e-6),
+    rho(0.1),
+    sigma(1e-6),
+    alpha(1.6),
+    check_interval(5),
+    refactorization_threshold(0.05),
+    n_iter(0),
+    n_factorizations(0),
+    prim_res(0),
+    dual_res(0),
+    best_prim_res(0),
+    best_dual_res(0),
+    best_feasible(false),
+    nq(0),
+    nc(0),
+    nb(0),
+    neq(0),
+    factorization_exact(false){
+}
+
+ADMMSolver::~ADMMSolver(){
+}
+
+void ADMMSolver::configure(const QuadraticProgram& qp){
+
+    // Structure changed at runtime, e.g. the contact points: Warm start from the previous solution. The multipliers of the bounds
+    // belong to the variables and can be mapped in the same way as the primal solution. The multipliers of the constraints cannot be matched, since
+    // the constraint rows do not carry any semantic information
+    base::VectorXd x_prev = x, y_bounds_prev = y.tail(nb), y_bounds;
+    const bool warm_start = stats.status != not_solved;
+    if(warm_start){
+        mapVariables(variable_blocks, x_prev, qp.variable_blocks, qp.nq, x);
+        mapVariables(variable_blocks, y_bounds_prev, qp.variable_blocks, qp.nq, y_bounds);
+    }
+    else
+        x.setZero(qp.nq);
+
+    nq = qp.nq;
+    neq = qp.neq;
+    nc = qp.neq + qp.nin;
+    nb = qp.lower_x.size();
+    variable_blocks = qp.variable_blocks;
+
+    y.setZero(nc + nb);
+    if(warm_start && nb > 0 && y_bounds_prev.size() > 0)
+        y.tail(nb) = y_bounds;
+    z.resize(nc + nb);
+
+    M.resize(nc, nq);
+    l.resize(nc + nb);
+    u.resize(nc + nb);
+    rho_vec.resize(nc + nb);
+    rho_vec_fact.resize(0);
+    H_fact.resize(nq, nq);
+    M_fact.resize(nc, nq);
+    K.resize(nq, nq);
+
+    x_tilde.resize(nq);
+    z_tilde.resize(nc + nb);
+    z_prev.resize(nc + nb);
+    rhs.resize(nq);
+    tmp_n.resize(nq);
+    tmp_m.resize(nc + nb);
+    res.resize(nq);
+    x_best.resize(nq);
+
+    configured = true;
+}
+
+void ADMMSolver::updateData(const QuadraticProgram& qp){
+
+    M.topRows(neq) = qp.A;
+    M.bottomRows(qp.nin) = qp.C;
+    l.head(neq) = qp.b;
+    u.head(neq) = qp.b;
+    l.segment(neq, qp.nin) = qp.lower_y;
+    u.segment(neq, qp.nin) = qp.upper_y;
+    l.tail(nb) = qp.lower_x;
+    u.tail(nb) = qp.upper_x;
+
+    // Rows without finite bounds can never become active and get a minimal step size, equality rows a larger one
+    for(int i = 0; i < nc + nb; i++){
+        if(l[i] <= -QP_INFINITE_BOUND && u[i] >= QP_INFINITE_BOUND)
+            rho_vec[i] = RHO_MIN;
+        else if(u[i] - l[i] < 1e-4)
+            rho_vec[i] = RHO_EQ_FACTOR * rho;
+        else
+            rho_vec[i] = rho;
+    }
+}
+
+bool ADMMSolver::matricesChanged(const QuadraticProgram& qp) const{
+    auto changed = [this](const base::MatrixXd& mat, const base::MatrixXd& mat_fact){
+        if(mat.size() == 0)
+            return false;
+        const double scale = std::max(1.0, mat_fact.cwiseAbs().maxCoeff());
+        return (mat - mat_fact).cwiseAbs().maxCoeff() > refactorization_threshold * scale;
+    };
+    return changed(qp.H, H_fact) || changed(M, M_fact);
+}
+
+void ADMMSolver::factorize(const QuadraticProgram& qp){
+
+    K = qp.H;
+    K.diagonal().array() += sigma;
+    K.noalias() += M.transpose() * rho_vec.head(nc).asDiagonal() * M;
+    if(nb > 0)
+        K.diagonal() += rho_vec.tail(nb);
+
+    llt.compute(K);
+    if(llt.info() != Eigen::Success){
+        LOG_ERROR("ADMMSolver: Factorization of the KKT matrix failed. Is the Hessian positive semi-definite?");
+        throw std::runtime_error("ADMMSolver: Factorization of the KKT matrix failed");
+    }
+
+    H_fact = qp.H;
+    M_fact = M;
+    rho_vec_fact = rho_vec;
+    factorization_exact = true;
+    n_factorizations++;
+}
+
+void ADMMSolver::multM(const base::VectorXd& v, base::VectorXd& out) const{
+    out.head(nc).noalias() = M * v;
+    if(nb > 0)
+        out.tail(nb) = v;
+}
+
+void ADMMSolver::multMt(const base::VectorXd& v, base::VectorXd& out) const{
+    out.noalias() = M.transpose() * v.head(nc);
+    if(nb > 0)
+        out += v.tail(nb);
+}
+
+void ADMMSolver::multKKT(const QuadraticProgram& qp, const base::VectorXd& v, base::VectorXd& out){
+    multM(v, tmp_m);
+    tmp_m.array() *= rho_vec.array();
+    multMt(tmp_m, out);
+    out.noalias() += qp.H * v;
+    out += sigma * v;
+}
+
+void ADMMSolver::solveKKT(const QuadraticProgram& qp, const base::VectorXd& b, base::VectorXd& v){
+
+    v = llt.solve(b);
+    if(factorization_exact)
+        return;
+
+    // The factorization belongs to slightly different matrices: Use it as preconditioner in an iterative refinement. Refactorize
+    // if the refinement does not converge fast enough
+    const double tol = 1e-10 * std::max(1.0, normInf(b));
+    double r_prev = std::numeric_limits<double>::infinity();
+    for(int k = 0; k < 10; k++){
+        multKKT(qp, v, res);
+        res = b - res;
+        const double r = normInf(res);
+        if(r <= tol)
+            return;
+        if(r > 0.5 * r_prev)
+            break;
+        r_prev = r;
+        tmp_n = llt.solve(res);
+        v += tmp_n;
+    }
+    factorize(qp);
+    v = llt.solve(b);
+}
+
+void ADMMSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output){
+
+    if(hierarchical_qp.size() != 1)
+        throw std::runtime_error("ADMMSolver::solve: Number of task hierarchies must be 1 for the current implementation");
+
+    const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    if(qp.sparse)
+        throw std::runtime_error("ADMMSolver::solve: Sparse quadratic programs are not supported");
+    qp.check();
+
+    const base::Time start = base::Time::now();
+
+    const bool structure_changed = !configured || qp.nq != nq || qp.neq != neq || qp.neq + qp.nin != nc || qp.lower_x.size() != nb;
+    stats.warm_start = stats.status != not_solved;
+    if(structure_changed)
+        configure(qp);
+    updateData(qp);
+
+    // Refactorize only if the step sizes changed or if the matrices changed significantly, otherwise the cached factorization is used with iterative refinement
+    if(rho_vec.size() != rho_vec_fact.size() || rho_vec != rho_vec_fact || matricesChanged(qp))
+        factorize(qp);
+    else
+        factorization_exact = qp.H == H_fact && M == M_fact;
+
+    // Constraint values consistent with the (warm started) primal solution
+    if(structure_changed){
+        multM(x, z);
+        z = z.cwiseMax(l).cwiseMin(u);
+    }
+
+    const base::Time setup_end = base::Time::now();
+    stats.setup_time = (setup_end - start).toMicroseconds();
+
+    stats.status = max_iter_reached;
+    best_prim_res = best_dual_res = std::numeric_limits<double>::infinity();
+    best_feasible = false;
+    uint i = 0;
+    while(i < max_iter){
+        i++;
+
+        // x_tilde = K^-1 * (sigma*x - g + M^T*(rho*z - y))
+        tmp_m = rho_vec.cwiseProduct(z) - y;
+        multMt(tmp_m, rhs);
+        rhs += sigma * x - qp.g;
+        solveKKT(qp, rhs, x_tilde);
+        multM(x_tilde, z_tilde);
+
+        // Relaxation, projection on the constraint set and dual update
+        x = alpha * x_tilde + (1 - alpha) * x;
+        z_prev = z;
+        z_tilde = alpha * z_tilde + (1 - alpha) * z_prev;
+        z = (z_tilde + y.cwiseQuotient(rho_vec)).cwiseMax(l).cwiseMin(u);
+        y += rho_vec.cwiseProduct(z_tilde - z);
+
+        if(i % check_interval != 0 && i != max_iter)
+            continue;
+
+        // Primal residual: Mx - z
+        multM(x, tmp_m);
+        prim_res = normInf(tmp_m - z);
+        const double eps_prim = eps_abs + eps_rel * std::max(normInf(tmp_m), normInf(z));
+
+        // Dual residual: Hx + g + M^T*y
+        multMt(y, tmp_n);
+        res.noalias() = qp.H * x;
+        const double eps_dual = eps_abs + eps_rel * std::max({normInf(res), normInf(tmp_n), normInf(qp.g)});
+        res += qp.g + tmp_n;
+        dual_res = normInf(res);
+
+        if(prim_res <= eps_prim && dual_res <= eps_dual){
+            stats.status = solved;
+            break;
+        }
+
+        // Keep the best iterate in case the solver stops before convergence: Among the primal feasible iterates the one with the smallest dual residual,
+        // as long as there is none, the one with the smallest primal residual
+        const bool feasible = prim_res <= eps_prim;
+        if(time_budget > 0 && (feasible ? !best_feasible || dual_res < best_dual_res : !best_feasible && prim_res < best_prim_res)){
+            x_best = x;
+            best_prim_res = prim_res;
+            best_dual_res = dual_res;
+            best_feasible = feasible;
+        }
+        if(time_budget > 0 && (base::Time::now() - start).toMicroseconds() > time_budget){
+            stats.status = time_budget_exceeded;
+            break;
+        }
+    }
+    n_iter = i;
+
+    // Active constraint sides are the ones at their bound with nonzero multiplier
+    stats.n_active = 0;
+    for(int j = 0; j < nc + nb; j++){
+        if(y[j] != 0 && (z[j] <= l[j] || z[j] >= u[j]) && rho_vec[j] != RHO_MIN)
+            stats.n_active++;
+    }
+    stats.n_iter = n_iter;
+    stats.solve_time = (base::Time::now() - setup_end).toMicroseconds();
+
+    // The iterates x, z and y are kept for warm starting the next call, even if a previous iterate is returned
+    solver_output.resize(nq);
+    if(stats.status != solved && best_prim_res < std::numeric_limits<double>::infinity()){
+        solver_output = x_best;
+        stats.primal_residual = best_prim_res;
+        stats.dual_residual = best_dual_res;
+    }
+    else{
+        solver_output = x;
+        stats.primal_residual = prim_res;
+        stats.dual_residual = dual_res;
+    }
+
+    if(stats.status == max_iter_reached && time_budget <= 0)
+        throw std::runtime_error("ADMMSolver: Maximum number of iterations reached.");
+}
+
+}
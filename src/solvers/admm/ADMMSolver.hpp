@@ -0,0 +1,130 @@
+#ifndef WBC_SOLVERS_ADMM_SOLVER_HPP
+#define WBC_SOLVERS_ADMM_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+
+#include <Eigen/Cholesky>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The ADMMSolver class is a dense, in-tree implementation of the operator splitting method of OSQP (Stellato et al., "OSQP: An Operator Splitting Solver for Quadratic Programs", 2020).
+ *  It solves problems of shape
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}\mathbf{x}+\mathbf{x}^T\mathbf{g}& \\
+ *             & & \\
+ *        s.t. & \mathbf{Ax} = \mathbf{b}& \\
+ *             & \mathbf{l} \leq \mathbf{Cx} \leq \mathbf{u}& \\
+ *             & \mathbf{lb} \leq \mathbf{x} \leq \mathbf{ub}& \\
+ *        \end{array}
+ *  \f]
+ * The reduced KKT matrix \f$\mathbf{H} + \sigma \mathbf{I} + \mathbf{M}^T diag(\rho) \mathbf{M}\f$, where \f$\mathbf{M}\f$ contains all constraint rows, is factorized once per
+ * problem structure. As long as H, A and C change by less than the refactorization threshold (see setRefactorizationThreshold()), the cached factorization is used as
+ * preconditioner in an iterative refinement of the linear system, which is exact up to numerical precision. Primal and dual variables are warm started from the previous call.
+ * Since whole body control problems change only slightly between two control cycles, this typically requires only few iterations. The time budget (see QPSolver::setTimeBudget())
+ * is checked together with the termination criteria. If the solver stops before convergence, it returns the best of all checked iterates instead of the last one: The primal
+ * feasible iterate with the smallest dual residual or, if no iterate was primal feasible, the one with the smallest primal residual. QPSolver::getStats() contains the residuals
+ * of the returned iterate. The iterates themselves are not reset, i.e., the next call is warm started from the last iterate.
+ */
+class ADMMSolver : public QPSolver{
+private:
+    static QPSolverRegistry<ADMMSolver> reg;
+
+public:
+    ADMMSolver();
+    virtual ~ADMMSolver();
+
+    /**
+     * @brief solve Solve the given quadratic program
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. Only one priority level is implemented.
+     * @param solver_output solution of the quadratic program. If the time budget is exceeded, this is the best iterate of the solver, see class description.
+     */
+    virtual void solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output);
+
+    /** Maximum number of ADMM iterations. If no time budget is set (see QPSolver::setTimeBudget()), an exception is thrown if the solver does not converge within
+     *  this number. Default is 4000*/
+    void setMaxIter(uint n){max_iter = n;}
+    uint getMaxIter() const {return max_iter;}
+
+    /** Absolute and relative tolerance of the primal and dual residuals. Default is 1e-6 for both*/
+    void setTolerance(double abs, double rel){eps_abs = abs; eps_rel = rel;}
+
+    /** ADMM step size for the inequality constraints. The step size of the equality constraints is 1e3 times larger. Triggers a refactorization. Default is 0.1*/
+    void setRho(double val){rho = val; configured = false;}
+
+    /** Regularization of the Hessian in the KKT matrix. Triggers a refactorization. Default is 1e-6*/
+    void setSigma(double val){sigma = val; configured = false;}
+
+    /** Relaxation parameter in (0,2). Default is 1.6*/
+    void setAlpha(double val){alpha = val;}
+
+    /** Check the termination criteria every n iterations. Default is 5*/
+    void setCheckInterval(uint n){check_interval = std::max(n, 1u);}
+
+    /** Maximum change of H, A and C relative to their largest absolute entry at the time of the last factorization, above which the KKT matrix is refactorized. Default is 0.05*/
+    void setRefactorizationThreshold(double val){refactorization_threshold = val;}
+
+    /** Number of ADMM iterations performed in the last call to solve()*/
+    uint getNIter() const {return n_iter;}
+
+    /** Total number of factorizations of the KKT matrix since construction*/
+    uint getNFactorizations() const {return n_factorizations;}
+
+    /** Infinity norm of the primal and dual residual of the last iterate in the last call to solve()*/
+    double getPrimalResidual() const {return prim_res;}
+    double getDualResidual() const {return dual_res;}
+
+protected:
+    /** (Re-)allocate all buffers and map the previous iterates to the new problem structure, see QPSolver::mapVariables()*/
+    void configure(const QuadraticProgram& qp);
+    /** Copy the constraint matrices and vectors and compute the step sizes of all constraint rows*/
+    void updateData(const QuadraticProgram& qp);
+    /** Return true if H or the constraint matrix changed by more than the refactorization threshold since the last factorization*/
+    bool matricesChanged(const QuadraticProgram& qp) const;
+    /** Factorize the reduced KKT matrix with the current data*/
+    void factorize(const QuadraticProgram& qp);
+    /** Solve the reduced KKT system for the given right hand side. Uses iterative refinement if the factorization is not up to date*/
+    void solveKKT(const QuadraticProgram& qp, const base::VectorXd& rhs, base::VectorXd& x);
+    /** out = K*x, with the reduced KKT matrix K of the current data*/
+    void multKKT(const QuadraticProgram& qp, const base::VectorXd& x, base::VectorXd& out);
+    /** out = M*x, where M contains the rows of A, C and the bounds*/
+    void multM(const base::VectorXd& x, base::VectorXd& out) const;
+    /** out = M^T*v*/
+    void multMt(const base::VectorXd& v, base::VectorXd& out) const;
+
+    uint max_iter;
+    double eps_abs, eps_rel;
+    double rho, sigma, alpha;
+    uint check_interval;
+    double refactorization_threshold;
+
+    uint n_iter;
+    uint n_factorizations;
+    double prim_res, dual_res;
+    double best_prim_res, best_dual_res; // Residuals of x_best, infinite if no iterate was checked
+    bool best_feasible;                  // True if x_best is primal feasible
+
+    int nq, nc, nb;                     // Number of variables, constraint rows (equalities + inequalities) and bounds
+    int neq;                            // Number of equalities
+    std::vector<VariableBlock> variable_blocks; // Variable blocks of the configured structure
+    bool factorization_exact;           // True if the factorization corresponds exactly to the current data
+
+    base::MatrixXd M;                   // Constraint matrix [A;C] (nc x nq)
+    base::VectorXd l, u;                // Lower and upper bounds of all constraint rows (nc+nb)
+    base::VectorXd rho_vec, rho_vec_fact; // Step size of each constraint row, current and at the time of the last factorization
+    base::MatrixXd H_fact, M_fact;      // Data of the last factorization
+    base::MatrixXd K;                   // Reduced KKT matrix
+    Eigen::LLT<base::MatrixXd> llt;     // Factorization of the reduced KKT matrix
+
+    base::VectorXd x, z, y;             // Iterates: primal variables, constraint values and multipliers
+    base::VectorXd x_best;              // Best iterate of the last call to solve(), only tracked if a time budget is set
+    base::VectorXd x_tilde, z_tilde, z_prev, rhs, tmp_n, tmp_m, res; // Work vectors
+};
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "CascadedQPSolver.hpp"
+#include <base/Time.hpp>
+#include <base-logging/Logging.hpp>
+
+namespace wbc {
+
+QPSolverRegistry<CascadedQPSolver> CascadedQPSolver::reg("cascaded_qp");
+
+CascadedQPSolver::CascadedQPSolver(const std::string& level_solver) :
+    level_solver(level_solver),
+    nullspace_threshold(1e-9),
+    n_solved_levels(0),
+    nq(0),
+    n_in(0){
+}
+
+CascadedQPSolver::~CascadedQPSolver(){
+}
+
+QPSolverPtr CascadedQPSolver::getLevelSolver(uint prio){
+    while(levels.size() <= prio){
+        levels.emplace_back();
+        levels.back().solver.reset(QPSolverFactory::createInstance(level_solver));
+        levels.back().hqp.resize(1);
+    }
+    return levels[prio].solver;
+}
+
+const SolverStats& CascadedQPSolver::getLevelStats(uint prio) const{
+    if(prio >= levels.size())
+        throw std::invalid_argument("CascadedQPSolver::getLevelStats: Invalid priority " + std::to_string(prio));
+    return levels[prio].stats;
+}
+
+void CascadedQPSolver::reduce(const QuadraticProgram& qp, uint prio){
+
+    QuadraticProgram& qp_red = levels[prio].hqp[0];
+
+    // Bounds are simple constraints on x: The ones of all levels can be intersected
+    if(qp.lower_x.size() > 0){
+        lower_x = lower_x.cwiseMax(qp.lower_x);
+        upper_x = upper_x.cwiseMin(qp.upper_x);
+    }
+
+    // Highest priority: No reduction required
+    if(prio == 0){
+        qp_red = qp;
+        return;
+    }
+
+    // Inequality constraints of this level are passed on to the next levels
+    C.middleRows(n_in, qp.nin) = qp.C;
+    lower_y.segment(n_in, qp.nin) = qp.lower_y;
+    upper_y.segment(n_in, qp.nin) = qp.upper_y;
+    n_in += qp.nin;
+
+    // Bounds of the previous levels are not bounds on the nullspace coordinates anymore, only their rows with finite sides are added as inequality constraints
+    bound_rows.clear();
+    for(uint i = 0; i < nq; i++){
+        if(lower_x[i] > -QP_INFINITE_BOUND || upper_x[i] < QP_INFINITE_BOUND)
+            bound_rows.push_back(i);
+    }
+
+    const uint nz = Z.cols();
+    qp_red.resize(nz, qp.neq, n_in + bound_rows.size(), false);
+
+    HZ.noalias() = qp.H * Z;
+    qp_red.H.noalias() = Z.transpose() * HZ;
+    qp_red.g.noalias() = HZ.transpose() * x;
+    qp_red.g.noalias() += Z.transpose() * qp.g;
+
+    qp_red.A.noalias() = qp.A * Z;
+    qp_red.b = qp.b;
+    qp_red.b.noalias() -= qp.A * x;
+
+    // Infinite sides have to stay infinite after the shift by the solution of the previous levels
+    qp_red.C.topRows(n_in).noalias() = C.topRows(n_in) * Z;
+    Cx.noalias() = C.topRows(n_in) * x;
+    qp_red.lower_y.head(n_in) = (lower_y.head(n_in).array() <= -QP_INFINITE_BOUND).select(-QP_INFINITE_BOUND, lower_y.head(n_in) - Cx);
+    qp_red.upper_y.head(n_in) = (upper_y.head(n_in).array() >= QP_INFINITE_BOUND).select(QP_INFINITE_BOUND, upper_y.head(n_in) - Cx);
+    for(size_t k = 0; k < bound_rows.size(); k++){
+        const int i = bound_rows[k];
+        qp_red.C.row(n_in + k) = Z.row(i);
+        qp_red.lower_y[n_in + k] = lower_x[i] <= -QP_INFINITE_BOUND ? -QP_INFINITE_BOUND : lower_x[i] - x[i];
+        qp_red.upper_y[n_in + k] = upper_x[i] >= QP_INFINITE_BOUND ? QP_INFINITE_BOUND : upper_x[i] - x[i];
+    }
+    qp_red.variable_blocks.clear();
+}
+
+void CascadedQPSolver::updateNullspace(uint prio){
+
+    Level& level = levels[prio];
+    const QuadraticProgram& qp_red = level.hqp[0];
+    const uint nz = qp_red.nq;
+
+    // All solutions of a convex QP have the same H*z and g^T*z. Together with the equality constraints, these rows define the directions in which the
+    // solution of this level can be changed by the next levels without increasing the cost of this level
+    level.M_t.resize(nz, nz + 1 + qp_red.neq);
+    level.M_t.leftCols(nz) = qp_red.H;
+    level.M_t.col(nz) = qp_red.g;
+    level.M_t.rightCols(qp_red.neq) = qp_red.A.transpose();
+
+    level.qr.setThreshold(nullspace_threshold);
+    level.qr.compute(level.M_t);
+    const uint rank = level.qr.rank();
+
+    // The last nz-rank columns of Q are an orthonormal basis of the nullspace. Compose it with the basis of the previous levels
+    N.setIdentity(nz, nz);
+    N.applyOnTheLeft(level.qr.householderQ());
+    Z_next.noalias() = Z * N.rightCols(nz - rank);
+    Z.swap(Z_next);
+}
+
+void CascadedQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output){
+
+    if(hierarchical_qp.size() == 0)
+        throw std::runtime_error("CascadedQPSolver::solve: Empty hierarchical quadratic program");
+
+    nq = hierarchical_qp[0].nq;
+    uint n_in_total = 0;
+    for(uint prio = 0; prio < hierarchical_qp.size(); prio++){
+        const QuadraticProgram& qp = hierarchical_qp[prio];
+        if(qp.sparse)
+            throw std::runtime_error("CascadedQPSolver::solve: Sparse quadratic programs are not supported");
+        if(qp.nq != nq){
+            LOG_ERROR("CascadedQPSolver: Number of variables of priority %i is %i, but priority 0 has %i variables", prio, qp.nq, nq);
+            throw std::runtime_error("CascadedQPSolver::solve: All priorities must have the same number of variables");
+        }
+        qp.check();
+        n_in_total += qp.nin;
+        getLevelSolver(prio);
+    }
+
+    const base::Time start = base::Time::now();
+
+    // After a reset, e.g. a reconfiguration of the scene, the level solvers have to be reconfigured as well
+    if(!configured){
+        for(Level& level : levels)
+            level.solver->reset();
+        configured = true;
+    }
+
+    x.setZero(nq);
+    Z.setIdentity(nq, nq);
+    if(C.rows() != n_in_total || C.cols() != nq){
+        C.resize(n_in_total, nq);
+        lower_y.resize(n_in_total);
+        upper_y.resize(n_in_total);
+    }
+    n_in = hierarchical_qp[0].nin;
+    if(n_in > 0){
+        C.topRows(n_in) = hierarchical_qp[0].C;
+        lower_y.head(n_in) = hierarchical_qp[0].lower_y;
+        upper_y.head(n_in) = hierarchical_qp[0].upper_y;
+    }
+    lower_x.setConstant(nq, -QP_INFINITE_BOUND);
+    upper_x.setConstant(nq, QP_INFINITE_BOUND);
+
+    stats = SolverStats();
+    stats.status = solved;
+    stats.warm_start = true;
+    n_solved_levels = 0;
+    for(Level& level : levels)
+        level.stats = SolverStats();
+    for(uint prio = 0; prio < hierarchical_qp.size(); prio++){
+
+        // The higher priorities already determine the solution completely
+        if(Z.cols() == 0)
+            break;
+
+        reduce(hierarchical_qp[prio], prio);
+
+        Level& level = levels[prio];
+        const double elapsed = (base::Time::now() - start).toMicroseconds();
+        level.solver->setTimeBudget(time_budget > 0 ? std::max(time_budget - elapsed, 1.0) : time_budget);
+        level.solver->solve(level.hqp, level.z);
+        x.noalias() += Z * level.z;
+        n_solved_levels++;
+
+        // The inequality constraints and bounds of the previous levels are passed on, so the active set of the last solved level contains all of them
+        level.stats = level.solver->getStats();
+        const SolverStats& level_stats = level.stats;
+        stats.n_iter += level_stats.n_iter;
+        stats.n_active = level_stats.n_active;
+        stats.dual_residual = std::fmax(stats.dual_residual, level_stats.dual_residual);
+        stats.solve_time += level_stats.solve_time;
+        stats.warm_start &= level_stats.warm_start;
+        if(level_stats.status != solved){
+            stats.status = level_stats.status;
+            break;
+        }
+
+        if(prio + 1 < hierarchical_qp.size())
+            updateNullspace(prio);
+    }
+    stats.setup_time = (base::Time::now() - start).toMicroseconds() - stats.solve_time;
+
+    // The residuals of the level solvers refer to the nullspace coordinates of each level
+    stats.primal_residual = 0;
+    for(uint prio = 0; prio < n_solved_levels; prio++)
+        stats.primal_residual = std::max(stats.primal_residual, constraintViolation(hierarchical_qp[prio], x));
+
+    solver_output.resize(nq);
+    solver_output = x;
+}
+
+}
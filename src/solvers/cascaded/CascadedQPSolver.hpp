@@ -0,0 +1,110 @@
+#ifndef WBC_SOLVERS_CASCADED_QP_SOLVER_HPP
+#define WBC_SOLVERS_CASCADED_QP_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+
+#include <Eigen/QR>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The CascadedQPSolver class solves hierarchical quadratic programs with equality and inequality constraints on all priority levels by a cascade of
+ *  single-level QPs (lexicographic optimization). Level i solves
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}_i\mathbf{x}+\mathbf{x}^T\mathbf{g}_i& \\
+ *             & & \\
+ *        s.t. & \mathbf{A}_i\mathbf{x} = \mathbf{b}_i& \\
+ *             & \mathbf{x} \in \mathcal{X}_{i-1}& \\
+ *        \end{array}
+ *  \f]
+ * where \f$\mathcal{X}_{i-1}\f$ is the set of optimal solutions of the previous level, including the inequality constraints and bounds of all previous levels. The optimal set
+ * of a convex QP is the intersection of its feasible set with \f$\mathbf{H}_i\mathbf{x} = \mathbf{H}_i\mathbf{x}^*_i\f$ and \f$\mathbf{g}_i^T\mathbf{x} = \mathbf{g}_i^T\mathbf{x}^*_i\f$.
+ * These equalities and the equality constraints of the level are eliminated by a nullspace parametrization \f$\mathbf{x} = \mathbf{x}^*_i + \mathbf{Z}_i\mathbf{z}\f$, so that each level
+ * is solved in the (smaller) nullspace basis of the previous level and only the inequality constraints are passed on. No weighting between the priorities is required. If the nullspace is empty,
+ * the remaining levels are skipped.
+ *
+ * Each level is solved by its own instance of a single-level QP solver plugin (see setLevelSolverType()), which keeps its internal state between two calls of solve(), i.e.,
+ * each level is warm started from the previous control cycle. Only dense quadratic programs are supported. The bounds of all levels are intersected.
+ *
+ * The statistics (see getStats()) combine all solved levels: Iterations and solve times are summed up. The primal residual is the constraint violation of the solution
+ * w.r.t. the constraints of all solved levels, in the original variables. The dual residual is the maximum of the levels, in the nullspace coordinates of each level. The
+ * active set size is the one of the last solved level, which contains the inequality constraints and bounds of all previous levels. The statistics of the individual levels
+ * are available with getLevelStats().
+ */
+class CascadedQPSolver : public QPSolver{
+private:
+    static QPSolverRegistry<CascadedQPSolver> reg;
+
+public:
+    /** Data of a single level of the cascade*/
+    struct Level{
+        QPSolverPtr solver;                           /** Solver for the reduced QP of this level*/
+        HierarchicalQP hqp;                           /** Reduced QP of this level, in the nullspace coordinates of the previous levels*/
+        base::VectorXd z;                             /** Solution of the reduced QP*/
+        base::MatrixXd M_t;                           /** Transposed rows whose nullspace is passed to the next level: reduced Hessian, gradient and equality constraints*/
+        Eigen::ColPivHouseholderQR<base::MatrixXd> qr;/** Rank revealing factorization of M_t*/
+        SolverStats stats;                            /** Statistics of the level solver in the last call to solve(). Status is not_solved if the level was skipped*/
+    };
+
+    /**
+     * @param level_solver Name of the QP solver plugin used for each level, see QPSolverFactory. The plugin has to be registered, i.e., its library has to be linked.
+     */
+    CascadedQPSolver(const std::string& level_solver = "qpoases");
+    virtual ~CascadedQPSolver();
+
+    /**
+     * @brief solve Solve the given hierarchical quadratic program
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. The first entry has the highest priority.
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output);
+
+    /** Set the QP solver plugin used for each level. Existing level solvers are discarded*/
+    void setLevelSolverType(const std::string& name){level_solver = name; levels.clear();}
+    const std::string& getLevelSolverType() const {return level_solver;}
+
+    /** Solver instance of the given priority level, e.g. for setting solver specific options. The instance is created if it does not exist yet*/
+    QPSolverPtr getLevelSolver(uint prio);
+
+    /** Relative threshold for the rank decision of the nullspace computation. Default is 1e-9*/
+    void setNullspaceThreshold(double val){nullspace_threshold = val;}
+    double getNullspaceThreshold() const {return nullspace_threshold;}
+
+    /** Number of levels that were solved in the last call to solve(). Levels are skipped if the higher priorities determine the solution completely*/
+    uint getNSolvedLevels() const {return n_solved_levels;}
+
+    /** Statistics of the given priority level in the last call to solve(), in the nullspace coordinates of the level. Status is not_solved if the level was skipped.
+     *  Throws if the level does not exist*/
+    const SolverStats& getLevelStats(uint prio) const;
+
+protected:
+    /** Write the QP of the given priority in the nullspace coordinates of the previous levels*/
+    void reduce(const QuadraticProgram& qp, uint prio);
+    /** Nullspace of the optimal set of the given level, which is the feasible set of the next level*/
+    void updateNullspace(uint prio);
+
+    std::string level_solver;
+    double nullspace_threshold;
+    uint n_solved_levels;
+    std::vector<Level> levels;
+
+    uint nq;
+    base::MatrixXd Z;          // Nullspace basis of the previous levels (nq x nz)
+    base::MatrixXd Z_next;
+    base::VectorXd x;          // Solution of the previous levels
+    base::MatrixXd C;          // Inequality constraints of the previous levels and the current level
+    base::VectorXd lower_y, upper_y;
+    uint n_in;                 // Number of used rows of C
+    base::VectorXd lower_x, upper_x; // Intersection of the bounds of the previous levels and the current level
+    std::vector<int> bound_rows;     // Bounds with at least one finite side
+    base::MatrixXd HZ, N;
+    base::VectorXd Cx;
+};
+
+}
+
+#endif
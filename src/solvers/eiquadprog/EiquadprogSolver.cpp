@@ -11,6 +11,7 @@ QPSolverRegistry<EiquadprogSolver> EiquadprogSolver::reg("eiquadprog");
 EiquadprogSolver::EiquadprogSolver()
 {
     _n_iter = 100;
+    _n_eq_init = 0;
 }
 
 EiquadprogSolver::~EiquadprogSolver()
@@ -25,70 +26,122 @@ void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::V
         throw std::runtime_error("EiquadprogSolver::solve: Constraints vector size must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    if(qp.sparse)
+        throw std::runtime_error("EiquadprogSolver::solve: Sparse quadratic programs are not supported");
     qp.check();
 
-    size_t n_in = (qp.bounded ? (2 * (qp.nin + qp.nq)) : (2*qp.nin));
-    size_t n_eq = qp.neq;
+    const base::Time start = base::Time::now();
+
+    // Only pass the constraint sides with finite bounds as inequalities and treat rows with equal lower and upper bound as equalities. Empty equality
+    // rows are dropped, eiquadprog would reject them as redundant
+    _rows_eq.updateEqualities(qp.A, qp.b);
+    _rows_in.update(qp.lower_y, qp.upper_y);
+    _rows_bounds.update(qp.lower_x, qp.upper_x);
+
+    size_t n_in = _rows_in.nInequalities() + _rows_bounds.nInequalities();
+    size_t n_eq = _rows_eq.equal.size() + _rows_in.equal.size() + _rows_bounds.equal.size();
     size_t n_var = qp.nq;
 
-    if(!configured) 
+    // Re-initialize if the structure changed at runtime, e.g. the contact points. Eiquadprog is a dual active set method that always
+    // starts from the unconstrained optimum, so there is no previous solution to warm start from
+    if(!configured || n_var != _CI_mtx.cols() || n_in != _CI_mtx.rows() || n_eq != _n_eq_init)
     {
         _solver.reset(n_var, n_eq, n_in);
-        _solver.setMaxIter(_n_iter);
 
         // hessian and gradient are ok (don#t need to be stacked)
-        // equality contraint is ok also
-        // configuring  inequalities constraints matrices
+        // configuring equality and inequalities constraints matrices
+        _CE_mtx.resize(n_eq, n_var);
+        _ce0_vec.resize(n_eq);
         _CI_mtx.resize(n_in, n_var);
         _ci0_vec.resize(n_in);
+        _x_vec.resize(n_var);
+        _n_eq_init = n_eq;
 
         configured = true;
     }
-    else 
-    {
-        if(n_var != _CI_mtx.cols())
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-        if(n_in != _CI_mtx.rows())
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-    }
 
-    _CI_mtx.setZero();
+    // create equality constraint matrix (equalities + inequalities and bounds with lb == ub)
+    int k = 0;
+    for(int i : _rows_eq.equal){
+        _CE_mtx.row(k) = qp.A.row(i);
+        _ce0_vec[k++] = -qp.b[i];
+    }
+    for(int i : _rows_in.equal){
+        _CE_mtx.row(k) = qp.C.row(i);
+        _ce0_vec[k++] = -qp.lower_y[i];
+    }
+    for(int i : _rows_bounds.equal){
+        _CE_mtx.row(k).setZero();
+        _CE_mtx(k,i) = 1.0;
+        _ce0_vec[k++] = -qp.lower_x[i];
+    }
 
-    // create inequalities constraint matric (inequalities + bounds)
-    _CI_mtx.middleRows(0, qp.nin) = qp.C;
-    _CI_mtx.middleRows(qp.nin, qp.nin) = -qp.C;
-    if(qp.bounded) {
-        _CI_mtx.middleRows(2*qp.nin, n_var).diagonal().setConstant(1.0);        // map bounds as inequalities
-        _CI_mtx.middleRows(2*qp.nin+n_var, n_var).diagonal().setConstant(-1.0);
+    // create inequalities constraint matrix (inequalities + bounds)
+    k = 0;
+    for(int i : _rows_in.lower){
+        _CI_mtx.row(k) = qp.C.row(i);
+        _ci0_vec[k++] = -qp.lower_y[i];
+    }
+    for(int i : _rows_in.upper){
+        _CI_mtx.row(k) = -qp.C.row(i);
+        _ci0_vec[k++] = qp.upper_y[i];
+    }
+    for(int i : _rows_bounds.lower){
+        _CI_mtx.row(k).setZero();
+        _CI_mtx(k,i) = 1.0;
+        _ci0_vec[k++] = -qp.lower_x[i];
+    }
+    for(int i : _rows_bounds.upper){
+        _CI_mtx.row(k).setZero();
+        _CI_mtx(k,i) = -1.0;
+        _ci0_vec[k++] = qp.upper_x[i];
     }
-    _ci0_vec << -qp.lower_y, qp.upper_y, -qp.lower_x, qp.upper_x;
 
     namespace eq = eiquadprog::solvers;
 
-    Eigen::VectorXd out(qp.nq);
-    eq::EiquadprogFast_status status = _solver.solve_quadprog(
-        qp.H, qp.g, qp.A, -qp.b, _CI_mtx, _ci0_vec, out);
-    
+    // Eiquadprog has no time limit, so the time budget is translated into a limit for the active set iterations
+    const uint max_iter = iterationBudget(_n_iter);
+    _solver.setMaxIter(max_iter);
+
+    const base::Time solve_start = base::Time::now();
+    eq::EiquadprogFast_status eq_status = _solver.solve_quadprog(
+        qp.H, qp.g, _CE_mtx, _ce0_vec, _CI_mtx, _ci0_vec, _x_vec);
+    const base::Time solve_end = base::Time::now();
+    _actual_n_iter = _solver.getIteratios();
+    updateTimePerIteration(solve_end - solve_start, _actual_n_iter);
+
+    // The active set of Eiquadprog contains the equality constraints as well
+    stats.setup_time = (solve_start - start).toMicroseconds();
+    stats.solve_time = (solve_end - solve_start).toMicroseconds();
+    stats.n_iter = _actual_n_iter;
+    stats.n_active = (int)_solver.getActiveSetSize() - (int)n_eq;
+    stats.warm_start = false;
+
     solver_output.resize(qp.nq);
-    solver_output = out;
+    solver_output = _x_vec;
+    stats.primal_residual = constraintViolation(qp, solver_output);
+    stats.status = solved;
 
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_UNBOUNDED){
+    if(eq_status == eq::EiquadprogFast_status::EIQUADPROG_FAST_UNBOUNDED){
         qp.print();
         throw std::runtime_error("Eiquadprog returned error status:unbounded.");
     }
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_MAX_ITER_REACHED){
-        qp.print();
-        throw std::runtime_error("Eiquadprog returned error status: max iterations reached.");
+    if(eq_status == eq::EiquadprogFast_status::EIQUADPROG_FAST_MAX_ITER_REACHED){
+        // With a time budget, the last iterate is returned. It satisfies the equalities, but in general not all inequalities, see stats.primal_residual
+        if(time_budget > 0)
+            stats.status = max_iter < (uint)_n_iter ? time_budget_exceeded : max_iter_reached;
+        else{
+            qp.print();
+            throw std::runtime_error("Eiquadprog returned error status: max iterations reached.");
+        }
     }
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_REDUNDANT_EQUALITIES){
+    if(eq_status == eq::EiquadprogFast_status::EIQUADPROG_FAST_REDUNDANT_EQUALITIES){
         qp.print();
         throw std::runtime_error("Eiquadprog returned error status: redundant equalities.");
     }
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_INFEASIBLE){
+    if(eq_status == eq::EiquadprogFast_status::EIQUADPROG_FAST_INFEASIBLE){
         qp.print();
         throw std::runtime_error("Eiquadprog returned error status: infeasible.");
     }
-
-    _actual_n_iter = _solver.getIteratios();
 }
 }
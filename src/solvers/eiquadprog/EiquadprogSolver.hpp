@@ -21,6 +21,9 @@ class HierarchicalQP;
  *             & \mathbf{CI}x + ci0 \geq 0& \\
  *        \end{array}
  *  \f]
+ * Eiquadprog is a dual active set method: Its iterates are optimal for the constraints in the active set, but violate the remaining inequality constraints until the
+ * method converges. Thus, if the time budget is exceeded (see QPSolver::setTimeBudget()), the returned iterate is primal infeasible in general. Its constraint violation
+ * is reported in QPSolver::getStats().primal_residual.
  */
 class EiquadprogSolver : public QPSolver{
 private:
@@ -52,9 +55,17 @@ protected:
     
     int _n_iter;
     int _actual_n_iter;
+    size_t _n_eq_init; // number of equalities in the configured solver instance
 
+    ConstraintRowSelection _rows_eq;     // Selection of the non-empty equality constraint rows
+    ConstraintRowSelection _rows_in;     // Selection of the inequality constraint rows
+    ConstraintRowSelection _rows_bounds; // Selection of the bounds
+
+    Eigen::MatrixXd _CE_mtx;
+    Eigen::VectorXd _ce0_vec;
     Eigen::MatrixXd _CI_mtx;
     Eigen::VectorXd _ci0_vec;
+    Eigen::VectorXd _x_vec;  // Solution buffer, allocated once in the configuration step
 };
 
 }
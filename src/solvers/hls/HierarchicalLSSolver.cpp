@@ -12,7 +12,8 @@ QPSolverRegistry<HierarchicalLSSolver> HierarchicalLSSolver::reg("hls");
 HierarchicalLSSolver::HierarchicalLSSolver() :
     no_of_joints(0),
     min_eigenvalue(1e-9),
-    max_solver_output_norm(10){
+    max_solver_output_norm(10),
+    warm_start_svd(true){
 }
 
 HierarchicalLSSolver::~HierarchicalLSSolver(){
@@ -40,14 +41,11 @@ bool HierarchicalLSSolver::configure(const std::vector<int>& n_constraints_per_p
     proj_mat.resize(no_of_joints, no_of_joints);
     proj_mat.setIdentity();
     s_vals.setZero(no_of_joints);
-    sing_vect_r.resize(no_of_joints, no_of_joints);
-    sing_vect_r.setIdentity();
-    s_vals_inv.setZero(no_of_joints, no_of_joints);
-    damped_s_vals_inv.setZero(no_of_joints, no_of_joints);
+    s_vals_inv.setZero(no_of_joints);
+    damped_s_vals_inv.setZero(no_of_joints);
     Wq_V.setZero(no_of_joints, no_of_joints);
     Wq_V_s_vals_inv.setZero(no_of_joints, no_of_joints);
     Wq_V_damped_s_vals_inv.setZero(no_of_joints, no_of_joints);
-    tmp.setZero(no_of_joints);
 
     configured = true;
     return true;
@@ -55,6 +53,7 @@ bool HierarchicalLSSolver::configure(const std::vector<int>& n_constraints_per_p
 
 void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    const base::Time start = base::Time::now();
     if(!configured){
         uint n_joints;
         std::vector<int> n_constraints_per_prio;
@@ -72,9 +71,11 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
                                     + ", Size of input vector: " + std::to_string(hierarchical_qp.size()));
 
     solver_output.setZero(no_of_joints);
+    const base::Time solve_start = base::Time::now();
 
     // Init projection matrix as identity, so that the highest priority can look for a solution in whole configuration space
     proj_mat.setIdentity();
+    uint n_sweeps = 0;
 
     //////// Loop through all priorities
 
@@ -97,25 +98,31 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
         if(hierarchical_qp.Wq.size() != 0)
             setJointWeights(hierarchical_qp.Wq, prio);
 
-        priorities[prio].y_comp.setZero();
-
         // Compensate y for part of the solution already met in higher priorities. For the first priority y_comp will be equal to  y
-        priorities[prio].y_comp = hierarchical_qp[prio].b - hierarchical_qp[prio].A*solver_output;
+        priorities[prio].y_comp = hierarchical_qp[prio].b;
+        priorities[prio].y_comp.noalias() -= hierarchical_qp[prio].A*solver_output;
 
         // projection of A on the null space of previous priorities: A_proj = A * P = A * ( P(p-1) - (A_wdls)^# * A )
         // For the first priority P == Identity
-        priorities[prio].A_proj = hierarchical_qp[prio].A * proj_mat;
+        priorities[prio].A_proj.noalias() = hierarchical_qp[prio].A * proj_mat;
 
         // Compute weighted, projected mat: A_proj_w = Wy * A_proj * Wq^-1
-        // Since the weight matrices are diagonal, there is no need for full matrix multiplication
-
-        for(uint i = 0; i < priorities[prio].n_constraint_variables; i++)
-            priorities[prio].A_proj_w.row(i) = priorities[prio].constraint_weight_mat(i,i) * priorities[prio].A_proj.row(i);
-
-        for(uint i = 0; i < no_of_joints; i++)
-            priorities[prio].A_proj_w.col(i) = priorities[prio].joint_weight_mat(i,i) * priorities[prio].A_proj_w.col(i);
-
-        svd_eigen_decomposition(priorities[prio].A_proj_w, priorities[prio].U, s_vals, sing_vect_r, tmp);
+        // Since the weight matrices are diagonal, they are stored as vectors and applied as diagonal products
+        PriorityData& p = priorities[prio];
+        p.A_proj_w.noalias() = p.constraint_weights.asDiagonal() * p.A_proj * p.joint_weights.asDiagonal();
+
+        // One-sided Jacobi SVD, initialized with the right singular vectors of the previous cycle
+        if(!warm_start_svd)
+            p.V.setIdentity();
+        int ret = svd_jacobi_decomposition(p.A_proj_w, p.U, s_vals, p.V);
+        if(ret < 0){
+            // Not converged, e.g. due to a bad initial guess after a large change of the task matrix: Restart from identity
+            p.V.setIdentity();
+            ret = svd_jacobi_decomposition(p.A_proj_w, p.U, s_vals, p.V);
+            if(ret < 0)
+                throw std::runtime_error("HierarchicalLSSolver: SVD on priority " + to_string(prio) + " did not converge");
+        }
+        n_sweeps += ret;
 
         // Compute damping factor based on
         // A.A. Maciejewski, C.A. Klein, “Numerical Filtering for the Operation of
@@ -132,39 +139,32 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
         // Damped Inverse of Eigenvalue matrix for computation of a singularity robust solution for the current priority
         damped_s_vals_inv.setZero();
         for (uint i = 0; i < min(no_of_joints, priorities[prio].n_constraint_variables); i++)
-            damped_s_vals_inv(i,i) = (s_vals(i) / (s_vals(i) * s_vals(i) + priorities[prio].damping * priorities[prio].damping));
+            damped_s_vals_inv(i) = (s_vals(i) / (s_vals(i) * s_vals(i) + priorities[prio].damping * priorities[prio].damping));
 
         // Additionally compute normal Inverse of Eigenvalue matrix for correct computation of nullspace projection
         for(uint i = 0; i < s_vals.rows(); i++){
             if(s_vals(i) < min_eigenvalue)
-                s_vals_inv(i,i) = 0;
+                s_vals_inv(i) = 0;
             else
-                s_vals_inv(i,i) = 1 / s_vals(i);
+                s_vals_inv(i) = 1 / s_vals(i);
         }
 
         // A^# = Wq^-1 * V * S^# * U^T * Wy
-        // Since the weight matrices are diagonal, there is no need for full matrix multiplication (saves a lot of computation!)
-        priorities[prio].u_t_weight_mat = priorities[prio].U.transpose();
-        for(uint i = 0; i < priorities[prio].n_constraint_variables; i++)
-            priorities[prio].u_t_weight_mat.col(i) = priorities[prio].u_t_weight_mat.col(i) * priorities[prio].constraint_weight_mat(i,i);
+        // Since the weight and singular value matrices are diagonal, they are applied as diagonal products without temporaries
+        p.U_w.noalias() = p.constraint_weights.asDiagonal() * p.U;
+        Wq_V.noalias() = p.joint_weights.asDiagonal() * p.V;
+        Wq_V_s_vals_inv.noalias() = Wq_V * s_vals_inv.asDiagonal();
+        Wq_V_damped_s_vals_inv.noalias() = Wq_V * damped_s_vals_inv.asDiagonal();
 
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V.row(i) = priorities[prio].joint_weight_mat(i,i) * sing_vect_r.row(i);
-
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V_s_vals_inv.col(i) = Wq_V.col(i) * s_vals_inv(i,i);
-        for(uint i = 0; i < no_of_joints; i++)
-            Wq_V_damped_s_vals_inv.col(i) = Wq_V.col(i) * damped_s_vals_inv(i,i);
-
-        priorities[prio].A_proj_inv_wls = Wq_V_s_vals_inv * priorities[prio].u_t_weight_mat; //Normal Inverse with weighting
-        priorities[prio].A_proj_inv_wdls = Wq_V_damped_s_vals_inv * priorities[prio].u_t_weight_mat; //Damped inverse with weighting
+        p.A_proj_inv_wls.noalias() = Wq_V_s_vals_inv * p.U_w.transpose(); //Normal Inverse with weighting
+        p.A_proj_inv_wdls.noalias() = Wq_V_damped_s_vals_inv * p.U_w.transpose(); //Damped inverse with weighting
 
         // x = x + A^# * y
-        priorities[prio].solution_prio = priorities[prio].A_proj_inv_wdls * priorities[prio].y_comp;
+        priorities[prio].solution_prio.noalias() = priorities[prio].A_proj_inv_wdls * priorities[prio].y_comp;
         solver_output += priorities[prio].solution_prio;
 
         // Compute projection matrix for the next priority. Use here the undamped inverse to have a correct solution
-        proj_mat -= priorities[prio].A_proj_inv_wls * priorities[prio].A_proj;
+        proj_mat.noalias() -= priorities[prio].A_proj_inv_wls * priorities[prio].A_proj;
 
         //store eigenvalues for this priority
         priorities[prio].sing_vals.setZero();
@@ -174,6 +174,13 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
     } //priority loop
 
     ///////////////
+
+    // The number of iterations is the total number of SVD sweeps
+    stats.setup_time = (solve_start - start).toMicroseconds();
+    stats.solve_time = (base::Time::now() - solve_start).toMicroseconds();
+    stats.n_iter = n_sweeps;
+    stats.warm_start = warm_start_svd;
+    stats.status = solved;
 }
 
 void HierarchicalLSSolver::setJointWeights(const base::VectorXd& weights){
@@ -191,11 +198,10 @@ void HierarchicalLSSolver::setJointWeights(const base::VectorXd& weights, const
                                     ". Number of priority levels is " + to_string(priorities.size()));
 
     if(weights.size() == no_of_joints){
-        priorities[prio].joint_weight_mat.setZero();
         for(uint i = 0; i < no_of_joints; i++)
         {
             if(weights(i) >= 0)
-                priorities[prio].joint_weight_mat(i,i) = sqrt(weights(i));
+                priorities[prio].joint_weights(i) = sqrt(weights(i));
             else
                 throw std::invalid_argument("Entries of joint weight vector have to be >= 0, but element " + to_string(i) + " is " + to_string(weights(i)));
         }
@@ -216,10 +222,9 @@ void HierarchicalLSSolver::setTaskWeights(const base::VectorXd& weights, const u
     if(priorities[prio].n_constraint_variables != weights.size())
         throw std::invalid_argument("Cannot set joint weights. Size of joint weight vector is " + to_string(weights.size())
                                     + " but should be " + to_string(priorities[prio].n_constraint_variables));
-    priorities[prio].constraint_weight_mat.setZero();
     for(uint i = 0; i < priorities[prio].n_constraint_variables; i++){
         if(weights(i) >= 0)
-           priorities[prio].constraint_weight_mat(i,i) = sqrt(weights(i));
+           priorities[prio].constraint_weights(i) = sqrt(weights(i));
         else
             throw std::invalid_argument("Entries of constraint weight vector have to be >= 0, but element " + to_string(i) + " is " + to_string(weights(i)));
 
@@ -48,26 +48,26 @@ public:
             A_proj.setZero(_n_constraint_variables, n_joints);
             A_proj_w.setZero(_n_constraint_variables,n_joints);
             U.setZero(_n_constraint_variables, n_joints);
-            A_proj_inv_wls.setZero(_n_constraint_variables, n_joints);
-            A_proj_inv_wdls.setZero(_n_constraint_variables, n_joints);
+            U_w.setZero(_n_constraint_variables, n_joints);
+            V.setIdentity(n_joints, n_joints);
+            A_proj_inv_wls.setZero(n_joints, _n_constraint_variables);
+            A_proj_inv_wdls.setZero(n_joints, _n_constraint_variables);
             y_comp.setZero(_n_constraint_variables);
-            constraint_weight_mat.resize(_n_constraint_variables, _n_constraint_variables);
-            constraint_weight_mat.setIdentity();
-            joint_weight_mat.resize(n_joints, n_joints);
-            joint_weight_mat.setIdentity();
-            u_t_weight_mat.setZero(n_joints, _n_constraint_variables);
+            constraint_weights.setOnes(_n_constraint_variables);
+            joint_weights.setOnes(n_joints);
             sing_vals.resize(n_joints);
         }
         base::VectorXd solution_prio;         /** Solution for the current priority*/
         base::MatrixXd A_proj;                /** Constraint Matrix projected into nullspace of the higher priority */
         base::MatrixXd A_proj_w;              /** Constraint Matrix projected into nullspace of the higher priority with weighting*/
         base::MatrixXd U;                     /** Matrix of left singular vector of A_proj_w */
+        base::MatrixXd U_w;                   /** Constraint weights times U*/
+        base::MatrixXd V;                     /** Matrix of right singular vectors of A_proj_w. Initial guess for the SVD in the next cycle*/
         base::MatrixXd A_proj_inv_wls;        /** Least square inverse of A_proj_w*/
         base::MatrixXd A_proj_inv_wdls;       /** Damped Least square inverse of A_proj_w*/
         base::VectorXd y_comp;                /** Input variables which are compensated for the part of solution already met in higher priorities */
-        base::MatrixXd constraint_weight_mat; /** Constraint weight matrix of this priority*/
-        base::MatrixXd joint_weight_mat;      /** Joint weight matrix of this priority*/
-        base::MatrixXd u_t_weight_mat;        /** Matrix U_transposed * constraint_weight_mat*/
+        base::VectorXd constraint_weights;    /** Square root of the constraint weights of this priority, i.e., the diagonal of the constraint weight matrix*/
+        base::VectorXd joint_weights;         /** Square root of the joint weights of this priority, i.e., the diagonal of the joint weight matrix*/
         base::VectorXd sing_vals;             /** Singular values of this priority */
         double damping;                        /** Damping term for matrix inversion on this priority*/
         unsigned int n_constraint_variables;   /** Number of constraint variables of this priority*/
@@ -134,6 +134,13 @@ public:
     /** Return the maximum norm term.*/
     double getMaxSolverOutputNorm(){return max_solver_output_norm;}
 
+    /**
+     * @brief Use the right singular vectors of the previous call as initial guess for the SVD of each priority. Since the projected task matrices
+     *        change only slightly between two control cycles, the Jacobi SVD converges in few sweeps in this case. Default is true.
+     */
+    void setWarmStartSVD(bool enable){warm_start_svd = enable;}
+    bool getWarmStartSVD() const {return warm_start_svd;}
+
     /**
      * @brief Has configure() been  called already?
      */
@@ -143,9 +150,8 @@ protected:
     std::vector<PriorityData> priorities;     /** Contains priority specific matrices etc. */
     base::MatrixXd proj_mat;                 /** Projection Matrix that performs the nullspace projection onto the next lower priority*/
     base::VectorXd s_vals;                   /** Singular value vector*/
-    base::MatrixXd s_vals_inv;               /** Diagonal matrix containing the reciprocal singular values*/
-    base::MatrixXd sing_vect_r;              /** Matrix of right singular vectors*/
-    base::MatrixXd damped_s_vals_inv;        /** Diagonal matrix containing the reciprocal singular values with damping*/
+    base::VectorXd s_vals_inv;               /** Reciprocal singular values*/
+    base::VectorXd damped_s_vals_inv;        /** Reciprocal singular values with damping*/
     base::MatrixXd Wq_V;                     /** Column weight matrix times Matrix of Vectors of right singular vectors*/
     base::MatrixXd Wq_V_s_vals_inv;          /** Wq_V * s_vals_inv */
     base::MatrixXd Wq_V_damped_s_vals_inv;   /** Wq_V * damped_s_vals_inv */
@@ -155,9 +161,7 @@ protected:
     //Properties
     double min_eigenvalue;    /** Precision for eigenvalue inversion. Inverse of an Eigenvalue smaller than this will be set to zero*/
     double max_solver_output_norm;   /** Maximum norm of (J#) * y */
-
-    //Helpers
-    base::VectorXd tmp;
+    bool warm_start_svd;             /** Use the right singular vectors of the previous call as initial guess for the SVD*/
 };
 }
 #endif
@@ -0,0 +1,269 @@
+#include "KKTSolver.hpp"
+#include <base/Time.hpp>
+#include <base-logging/Logging.hpp>
+
+namespace wbc {
+
+QPSolverRegistry<KKTSolver> KKTSolver::reg("kkt");
+
+static double normInf(const base::VectorXd& v){
+    return v.size() > 0 ? v.lpNorm<Eigen::Infinity>() : 0;
+}
+
+KKTSolver::KKTSolver() :
+    regularization(1e-9),
+    max_refinement_steps(5),
+    tolerance(1e-9),
+    used_fallback(false),
+    nq(0),
+    neq(0),
+    nin(0),
+    nb(0),
+    sparse(false),
+    n_eq(0){
+}
+
+KKTSolver::~KKTSolver(){
+}
+
+void KKTSolver::configure(const QuadraticProgram& qp){
+
+    nq = qp.nq;
+    neq = qp.neq;
+    nin = qp.nin;
+    nb = qp.lower_x.size();
+    sparse = qp.sparse;
+    n_eq = neq + rows_in.equal.size() + rows_bounds.equal.size();
+
+    in_to_eq.assign(nin, -1);
+    int k = neq;
+    for(int i : rows_in.equal)
+        in_to_eq[i] = k++;
+
+    M.resize(sparse ? 0 : n_eq, nq);
+    b.resize(n_eq);
+    Y.resize(sparse ? 0 : nq, n_eq);
+    S.resize(sparse ? 0 : n_eq, n_eq);
+    kkt_pattern.clear();
+
+    x.resize(nq);
+    dx.resize(nq);
+    r_x.resize(nq);
+    y.resize(n_eq);
+    dy.resize(n_eq);
+    r_y.resize(n_eq);
+    rhs.resize(nq + n_eq);
+    Cx.resize(nin);
+
+    configured = true;
+}
+
+void KKTSolver::updateEqualities(const QuadraticProgram& qp){
+
+    b.head(neq) = qp.b;
+    int k = neq;
+    for(int i : rows_in.equal)
+        b[k++] = qp.lower_y[i];
+    for(int i : rows_bounds.equal)
+        b[k++] = qp.lower_x[i];
+
+    if(!sparse){
+        M.topRows(neq) = qp.A;
+        k = neq;
+        for(int i : rows_in.equal)
+            M.row(k++) = qp.C.row(i);
+        for(int i : rows_bounds.equal){
+            M.row(k).setZero();
+            M(k++,i) = 1.0;
+        }
+        return;
+    }
+
+    triplets.clear();
+    for(int j = 0; j < qp.A_sparse.outerSize(); j++)
+        for(SparseMatrixXd::InnerIterator it(qp.A_sparse, j); it; ++it)
+            triplets.emplace_back(it.row(), j, it.value());
+    for(int j = 0; j < qp.C_sparse.outerSize(); j++){
+        for(SparseMatrixXd::InnerIterator it(qp.C_sparse, j); it; ++it){
+            if(in_to_eq[it.row()] >= 0)
+                triplets.emplace_back(in_to_eq[it.row()], j, it.value());
+        }
+    }
+    k = neq + rows_in.equal.size();
+    for(int i : rows_bounds.equal)
+        triplets.emplace_back(k++, i, 1.0);
+    M_sparse.resize(n_eq, nq);
+    M_sparse.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+void KKTSolver::factorize(const QuadraticProgram& qp){
+
+    if(!sparse){
+        llt_H.compute(qp.H + regularization * base::MatrixXd::Identity(nq, nq));
+        if(llt_H.info() != Eigen::Success){
+            LOG_ERROR("KKTSolver: Factorization of the Hessian failed. Is it positive semi-definite and the regularization positive?");
+            throw std::runtime_error("KKTSolver: Factorization of the Hessian failed");
+        }
+        if(n_eq == 0)
+            return;
+        Y = M.transpose();
+        llt_H.solveInPlace(Y);
+        S.noalias() = M * Y;
+        S.diagonal().array() += regularization;
+        llt_S.compute(S);
+        if(llt_S.info() != Eigen::Success){
+            LOG_ERROR("KKTSolver: Factorization of the Schur complement failed. Are the equality constraints linearly dependent and the regularization zero?");
+            throw std::runtime_error("KKTSolver: Factorization of the Schur complement failed");
+        }
+        return;
+    }
+
+    // Upper triangle of the regularized KKT matrix
+    triplets.clear();
+    for(int j = 0; j < nq; j++){
+        for(int i = 0; i < j; i++){
+            if(qp.H(i,j) != 0)
+                triplets.emplace_back(i, j, qp.H(i,j));
+        }
+        triplets.emplace_back(j, j, qp.H(j,j) + regularization);
+    }
+    for(int j = 0; j < M_sparse.outerSize(); j++)
+        for(SparseMatrixXd::InnerIterator it(M_sparse, j); it; ++it)
+            triplets.emplace_back(j, nq + it.row(), it.value());
+    for(int i = 0; i < n_eq; i++)
+        triplets.emplace_back(nq + i, nq + i, -regularization);
+    K.resize(nq + n_eq, nq + n_eq);
+    K.setFromTriplets(triplets.begin(), triplets.end());
+
+    // The symbolic factorization (fill-reducing ordering and elimination tree) only depends on the sparsity pattern and is reused as long as it does not change
+    const int n_outer = K.outerSize() + 1, nnz = K.nonZeros();
+    if((int)kkt_pattern.size() != n_outer + nnz ||
+       !std::equal(K.outerIndexPtr(), K.outerIndexPtr() + n_outer, kkt_pattern.begin()) ||
+       !std::equal(K.innerIndexPtr(), K.innerIndexPtr() + nnz, kkt_pattern.begin() + n_outer)){
+        kkt_pattern.assign(K.outerIndexPtr(), K.outerIndexPtr() + n_outer);
+        kkt_pattern.insert(kkt_pattern.end(), K.innerIndexPtr(), K.innerIndexPtr() + nnz);
+        ldlt.analyzePattern(K);
+    }
+    ldlt.factorize(K);
+    if(ldlt.info() != Eigen::Success){
+        LOG_ERROR("KKTSolver: Factorization of the KKT matrix failed. Is the Hessian positive semi-definite and the regularization positive?");
+        throw std::runtime_error("KKTSolver: Factorization of the KKT matrix failed");
+    }
+}
+
+void KKTSolver::solveKKT(const base::VectorXd& res_x, const base::VectorXd& res_y, base::VectorXd& step_x, base::VectorXd& step_y){
+
+    if(sparse){
+        rhs.head(nq) = res_x;
+        rhs.tail(n_eq) = res_y;
+        sol = ldlt.solve(rhs);
+        step_x = sol.head(nq);
+        step_y = sol.tail(n_eq);
+        return;
+    }
+
+    // Block elimination: x0 = (H + delta*I)^-1*res_x, S*y = M*x0 - res_y, x = x0 - Y*y
+    step_x = res_x;
+    llt_H.solveInPlace(step_x);
+    if(n_eq == 0)
+        return;
+    step_y.noalias() = M * step_x;
+    step_y -= res_y;
+    llt_S.solveInPlace(step_y);
+    step_x.noalias() -= Y * step_y;
+}
+
+bool KKTSolver::isFeasible(const QuadraticProgram& qp, const base::VectorXd& x_sol){
+
+    auto violated = [this](double val, double bound, bool lower){
+        const double tol = tolerance * std::max(1.0, std::abs(bound));
+        return lower ? val < bound - tol : val > bound + tol;
+    };
+
+    if(sparse)
+        Cx.noalias() = qp.C_sparse * x_sol;
+    else
+        Cx.noalias() = qp.C * x_sol;
+    for(int i : rows_in.lower)
+        if(violated(Cx[i], qp.lower_y[i], true)) return false;
+    for(int i : rows_in.upper)
+        if(violated(Cx[i], qp.upper_y[i], false)) return false;
+    for(int i : rows_bounds.lower)
+        if(violated(x_sol[i], qp.lower_x[i], true)) return false;
+    for(int i : rows_bounds.upper)
+        if(violated(x_sol[i], qp.upper_x[i], false)) return false;
+    return true;
+}
+
+void KKTSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output){
+
+    if(hierarchical_qp.size() != 1)
+        throw std::runtime_error("KKTSolver::solve: Number of task hierarchies must be 1 for the current implementation");
+
+    const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    qp.check();
+
+    const base::Time start = base::Time::now();
+
+    // Buffers are only re-allocated if the problem structure changes, e.g. if the contact points change at runtime
+    bool rows_changed = rows_in.update(qp.lower_y, qp.upper_y);
+    rows_changed |= rows_bounds.update(qp.lower_x, qp.upper_x);
+    if(!configured || rows_changed || qp.nq != nq || qp.neq != neq || qp.nin != nin || (int)qp.lower_x.size() != nb || qp.sparse != sparse)
+        configure(qp);
+
+    updateEqualities(qp);
+    factorize(qp);
+    const base::Time solve_start = base::Time::now();
+
+    // Solve the regularized KKT system and remove the regularization error by iterative refinement on the exact KKT system
+    x.setZero();
+    y.setZero();
+    uint n_iter = 0;
+    while(true){
+        r_x = -qp.g;
+        r_x.noalias() -= qp.H * x;
+        r_y = b;
+        if(sparse){
+            r_x.noalias() -= M_sparse.transpose() * y;
+            r_y.noalias() -= M_sparse * x;
+        }
+        else{
+            r_x.noalias() -= M.transpose() * y;
+            r_y.noalias() -= M * x;
+        }
+        if(n_iter > max_refinement_steps || (n_iter > 0 && std::max(normInf(r_x), normInf(r_y)) <= tolerance * std::max(1.0, normInf(qp.g))))
+            break;
+        solveKKT(r_x, r_y, dx, dy);
+        x += dx;
+        y += dy;
+        n_iter++;
+    }
+    const base::Time end = base::Time::now();
+
+    stats.status = solved;
+    stats.n_iter = n_iter;
+    stats.n_active = 0;
+    stats.primal_residual = normInf(r_y);
+    stats.dual_residual = normInf(r_x);
+    stats.setup_time = (solve_start - start).toMicroseconds();
+    stats.solve_time = (end - solve_start).toMicroseconds();
+    stats.warm_start = false;
+
+    used_fallback = !isFeasible(qp, x);
+    if(!used_fallback){
+        solver_output.resize(nq);
+        solver_output = x;
+        return;
+    }
+
+    // At least one inequality constraint is active at the optimum: Solve the complete problem
+    if(!fallback_solver)
+        throw std::runtime_error("KKTSolver: Solution violates the inequality constraints or bounds. Set a fallback solver for problems with active inequality constraints");
+    const double kkt_time = (base::Time::now() - start).toMicroseconds();
+    fallback_solver->setTimeBudget(time_budget > 0 ? std::max(time_budget - kkt_time, 1.0) : time_budget);
+    fallback_solver->solve(hierarchical_qp, solver_output);
+    stats = fallback_solver->getStats();
+    stats.setup_time += kkt_time;
+}
+
+}
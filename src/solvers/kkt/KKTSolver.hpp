@@ -0,0 +1,113 @@
+#ifndef WBC_SOLVERS_KKT_SOLVER_HPP
+#define WBC_SOLVERS_KKT_SOLVER_HPP
+
+#include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+
+#include <Eigen/Cholesky>
+#include <Eigen/SparseCholesky>
+
+namespace wbc {
+
+class HierarchicalQP;
+
+/**
+ * @brief The KKTSolver class is a direct solver for quadratic programs without active inequality constraints, e.g., the ones of the AccelerationScene. It solves
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}\mathbf{x}+\mathbf{x}^T\mathbf{g}& \\
+ *             & & \\
+ *        s.t. & \mathbf{Mx} = \mathbf{b}& \\
+ *        \end{array}
+ *  \f]
+ * where \f$\mathbf{M}\f$ contains the equality constraints, the inequality constraints with equal lower and upper bound and the bounds with equal lower and upper bound,
+ * by a single solution of the KKT system. The regularized, quasi-definite KKT matrix
+ *  \f[
+ *        \left(\begin{array}{cc}
+ *        \mathbf{H} + \delta \mathbf{I} & \mathbf{M}^T \\
+ *        \mathbf{M} & -\delta \mathbf{I} \\
+ *        \end{array}\right)
+ *  \f]
+ * is LDLT factorized, for dense problems in block form (Cholesky factorization of the Hessian and the Schur complement), for sparse problems with a sparse LDLT,
+ * whose symbolic factorization is reused as long as the sparsity pattern does not change. The error of the regularization is removed by iterative refinement.
+ *
+ * Inequality constraints and bounds are not added to the KKT system. If one of their finite sides (see QP_INFINITE_BOUND) is violated by the solution, the problem is
+ * passed to the fallback solver (see setFallbackSolver()) or, if no fallback solver is set, an exception is thrown. Otherwise the solution is optimal for the complete problem.
+ */
+class KKTSolver : public QPSolver{
+private:
+    static QPSolverRegistry<KKTSolver> reg;
+
+public:
+    KKTSolver();
+    virtual ~KKTSolver();
+
+    /**
+     * @brief solve Solve the given quadratic program
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. Only one priority level is implemented.
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output);
+
+    /** Solver for problems with violated inequality constraints. The time budget is forwarded to the fallback solver. Default is none, i.e., an exception is thrown in this case*/
+    void setFallbackSolver(QPSolverPtr solver){fallback_solver = solver;}
+    QPSolverPtr getFallbackSolver(){return fallback_solver;}
+
+    /** Regularization of the KKT matrix. Has to be positive if the Hessian is only positive semi-definite or the constraints are linearly dependent. Default is 1e-9*/
+    void setRegularization(double val){regularization = val;}
+    double getRegularization() const {return regularization;}
+
+    /** Maximum number of iterative refinement steps. Default is 5*/
+    void setMaxRefinementSteps(uint n){max_refinement_steps = n;}
+
+    /** Tolerance for the KKT residuals in the iterative refinement and for the violation of the inequality constraints. Default is 1e-9*/
+    void setTolerance(double val){tolerance = val;}
+
+    /** True if the last call of solve() was passed to the fallback solver*/
+    bool usedFallbackSolver() const {return used_fallback;}
+
+protected:
+    /** Classify the constraint rows and (re-)allocate the buffers if the problem structure changed*/
+    void configure(const QuadraticProgram& qp);
+    /** Write the equality rows and the right hand side of the KKT system*/
+    void updateEqualities(const QuadraticProgram& qp);
+    /** Factorize the regularized KKT matrix*/
+    void factorize(const QuadraticProgram& qp);
+    /** Solve the regularized KKT system for the right hand side (res_x, res_y), using the current factorization*/
+    void solveKKT(const base::VectorXd& res_x, const base::VectorXd& res_y, base::VectorXd& step_x, base::VectorXd& step_y);
+    /** Return true if the solution x satisfies all finite sides of the inequality constraints and bounds*/
+    bool isFeasible(const QuadraticProgram& qp, const base::VectorXd& x_sol);
+
+    QPSolverPtr fallback_solver;
+    double regularization;
+    uint max_refinement_steps;
+    double tolerance;
+    bool used_fallback;
+
+    int nq, neq, nin, nb;               // Structure of the configured problem
+    bool sparse;
+    ConstraintRowSelection rows_in;     // Inequality constraints with finite sides and equal bounds
+    ConstraintRowSelection rows_bounds; // Bounds with finite sides and equal bounds
+    int n_eq;                           // Number of rows of the KKT equality block
+    std::vector<int> in_to_eq;          // Row of the KKT equality block of each inequality constraint, -1 if the constraint is not an equality
+
+    base::MatrixXd M;                   // Equality rows of the KKT system (dense problems)
+    SparseMatrixXd M_sparse;            // Equality rows of the KKT system (sparse problems)
+    base::VectorXd b;                   // Right hand side of the equality rows
+
+    Eigen::LLT<base::MatrixXd> llt_H;   // Factorization of H + delta*I (dense problems)
+    Eigen::LLT<base::MatrixXd> llt_S;   // Factorization of the Schur complement M*(H + delta*I)^-1*M^T + delta*I (dense problems)
+    base::MatrixXd Y;                   // (H + delta*I)^-1*M^T (dense problems)
+    base::MatrixXd S;                   // Schur complement (dense problems)
+
+    Eigen::SimplicialLDLT<SparseMatrixXd, Eigen::Upper> ldlt; // Factorization of the KKT matrix (sparse problems)
+    SparseMatrixXd K;                   // Upper triangle of the regularized KKT matrix (sparse problems)
+    std::vector<Eigen::Triplet<double,int>> triplets;
+    std::vector<int> kkt_pattern;       // Sparsity pattern of the last symbolic factorization
+
+    base::VectorXd x, y, dx, dy, r_x, r_y, rhs, sol, Cx; // Solution, multipliers and work vectors
+};
+
+}
+
+#endif
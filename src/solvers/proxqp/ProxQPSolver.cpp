@@ -3,8 +3,11 @@
 #include <base/Eigen.hpp>
 #include <Eigen/Core>
 #include <iostream>
+#include <algorithm>
+#include <limits>
 
 #include <proxsuite/proxqp/dense/dense.hpp>
+#include <proxsuite/proxqp/sparse/sparse.hpp>
 #include <proxsuite/proxqp/status.hpp>
 
 namespace wbc {
@@ -14,7 +17,135 @@ QPSolverRegistry<ProxQPSolver> ProxQPSolver::reg("proxqp");
 ProxQPSolver::ProxQPSolver()
 {
     _n_iter = 10000;
+    _max_iter_budget = _n_iter;
     _eps_abs = 1e-9;
+    _sparse = false;
+}
+
+/// Copy the non-zeros of a dense matrix into a compressed sparse matrix. Memory is only allocated if the number of non-zeros increases
+static void toSparse(const base::MatrixXd& dense, SparseMatrixXd& sparse)
+{
+    if(sparse.rows() != dense.rows() || sparse.cols() != dense.cols())
+        sparse.resize(dense.rows(), dense.cols());
+    sparse.resizeNonZeros((dense.array() != 0).count());
+    int k = 0;
+    for(int j = 0; j < dense.cols(); j++){
+        sparse.outerIndexPtr()[j] = k;
+        for(int i = 0; i < dense.rows(); i++){
+            if(dense(i,j) != 0){
+                sparse.innerIndexPtr()[k] = i;
+                sparse.valuePtr()[k] = dense(i,j);
+                k++;
+            }
+        }
+    }
+    sparse.outerIndexPtr()[dense.cols()] = k;
+}
+
+/// Stack the inequality constraint matrix and the bounds (identity matrix with n_bounds rows) vertically
+static void stackBounds(const SparseMatrixXd& C, int n_bounds, SparseMatrixXd& C_out)
+{
+    if(C_out.rows() != C.rows() + n_bounds || C_out.cols() != C.cols())
+        C_out.resize(C.rows() + n_bounds, C.cols());
+    C_out.resizeNonZeros(C.nonZeros() + n_bounds);
+    int k = 0;
+    for(int j = 0; j < C.cols(); j++){
+        C_out.outerIndexPtr()[j] = k;
+        for(SparseMatrixXd::InnerIterator it(C, j); it; ++it){
+            C_out.innerIndexPtr()[k] = it.row();
+            C_out.valuePtr()[k] = it.value();
+            k++;
+        }
+        if(n_bounds > 0){
+            C_out.innerIndexPtr()[k] = C.rows() + j;
+            C_out.valuePtr()[k] = 1.0;
+            k++;
+        }
+    }
+    C_out.outerIndexPtr()[C.cols()] = k;
+}
+
+/// Stack the constraint and variable bounds and pass the infinite sides (see QP_INFINITE_BOUND) as +-infinity, which prox-qp never treats as active. Large, finite values like
+/// QP_INFINITE_BOUND would enter the scaling and the residuals of the solver instead
+static void stackBoundVectors(const wbc::QuadraticProgram &qp, base::VectorXd& l, base::VectorXd& u)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    l.resize(qp.nin + qp.lower_x.size());
+    u.resize(qp.nin + qp.lower_x.size());
+    l << qp.lower_y, qp.lower_x;
+    u << qp.upper_y, qp.upper_x;
+    for(int i = 0; i < l.size(); i++){
+        if(l[i] <= -QP_INFINITE_BOUND)
+            l[i] = -inf;
+        if(u[i] >= QP_INFINITE_BOUND)
+            u[i] = inf;
+    }
+}
+
+/// Compare the sparsity pattern of the given matrix with the stored one and store the new pattern. Return true if the pattern changed
+static bool patternChanged(const SparseMatrixXd& mat, std::vector<int>& pattern)
+{
+    const int n_outer = mat.outerSize() + 1, nnz = mat.nonZeros();
+    if((int)pattern.size() == n_outer + nnz &&
+       std::equal(mat.outerIndexPtr(), mat.outerIndexPtr() + n_outer, pattern.begin()) &&
+       std::equal(mat.innerIndexPtr(), mat.innerIndexPtr() + nnz, pattern.begin() + n_outer))
+        return false;
+    pattern.assign(mat.outerIndexPtr(), mat.outerIndexPtr() + n_outer);
+    pattern.insert(pattern.end(), mat.innerIndexPtr(), mat.innerIndexPtr() + nnz);
+    return true;
+}
+
+const proxsuite::proxqp::Results<double>& ProxQPSolver::solveSparse(const wbc::QuadraticProgram &qp)
+{
+    namespace pqp = proxsuite::proxqp;
+
+    size_t n_var = qp.nq;
+    size_t n_eq = qp.neq;
+    size_t n_in = qp.nin + qp.lower_x.size();
+
+    // merge inequalities and bounds together
+    toSparse(qp.H, _H_sparse);
+    stackBounds(qp.C_sparse, qp.lower_x.size(), _C_sparse);
+    stackBoundVectors(qp, _l_vec, _u_vec);
+
+    // The sparse backend performs a symbolic factorization for the given sparsity pattern, so we have to re-initialize if the pattern changes
+    bool pattern_changed = patternChanged(_H_sparse, _H_pattern);
+    pattern_changed |= patternChanged(qp.A_sparse, _A_pattern);
+    pattern_changed |= patternChanged(_C_sparse, _C_pattern);
+
+    bool warm_start = false;
+    if(!configured || !_sparse_solver_ptr || pattern_changed || n_var != _n_var_init || n_eq != _n_eq_init || n_in != _n_in_init)
+    {
+        // Structure changed at runtime, e.g. the contact points: Warm start from the previous solution
+        warm_start = configured && _sparse_solver_ptr;
+        if(warm_start)
+            mapResults(_sparse_solver_ptr->results, qp);
+        storeStructure(qp);
+
+        _sparse_solver_ptr = std::make_shared<pqp::sparse::QP<double,int>>(n_var, n_eq, n_in);
+        _sparse_solver_ptr->settings.eps_abs = _eps_abs;
+        _sparse_solver_ptr->settings.max_iter = _n_iter;
+        _sparse_solver_ptr->init(_H_sparse, qp.g, qp.A_sparse, qp.b, _C_sparse, _l_vec, _u_vec);
+
+        stats.warm_start = warm_start;
+        configured = true;
+    }
+    else
+    {
+        _sparse_solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
+        _sparse_solver_ptr->update(_H_sparse, qp.g, qp.A_sparse, qp.b, _C_sparse, _l_vec, _u_vec);
+        stats.warm_start = true;
+    }
+
+    _sparse_solver_ptr->settings.max_iter = _max_iter_budget;
+    _solve_start = base::Time::now();
+    if(warm_start){
+        _sparse_solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START;
+        _sparse_solver_ptr->solve(_x_guess, _y_guess, _z_guess);
+    }
+    else
+        _sparse_solver_ptr->solve();
+    return _sparse_solver_ptr->results;
 }
 
 /// solve problem:
@@ -31,26 +162,39 @@ void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::Vecto
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
     qp.check();
 
-    
+    // prox-qp has no time limit, so the time budget is translated into an iteration limit
+    const base::Time start = base::Time::now();
+    _max_iter_budget = iterationBudget(_n_iter);
+
+    if(qp.sparse){
+        const pqp::Results<double>& results = solveSparse(qp);
+        solver_output = results.x;
+        const base::Time end = base::Time::now();
+        stats.setup_time = (_solve_start - start).toMicroseconds();
+        stats.solve_time = (end - _solve_start).toMicroseconds();
+        updateTimePerIteration(end - start, results.info.iter);
+        checkStatus(results);
+        return;
+    }
+
     size_t n_var = qp.A.cols();
     size_t n_eq = qp.neq;
     size_t n_in = qp.nin + qp.lower_x.size();
 
     // merge ineuqalities and bounds together
     _C_mtx.resize(n_in, n_var);
-    _l_vec.resize(n_in);
-    _u_vec.resize(n_in);
-
     _C_mtx.topRows(qp.nin) = qp.C;
     _C_mtx.bottomRows(qp.lower_x.size()).setIdentity();
-    _l_vec << qp.lower_y, qp.lower_x;
-    _u_vec << qp.upper_y, qp.upper_x;
+    stackBoundVectors(qp, _l_vec, _u_vec);
 
-    if(!configured) 
+    bool warm_start = false;
+    if(!configured || !_solver_ptr || n_var != _n_var_init || n_eq != _n_eq_init || n_in != _n_in_init)
     {
-        _n_var_init = n_var;
-        _n_eq_init = n_eq;
-        _n_in_init = n_in;
+        // Structure changed at runtime, e.g. the contact points: Warm start from the previous solution
+        warm_start = configured && _solver_ptr;
+        if(warm_start)
+            mapResults(_solver_ptr->results, qp);
+        storeStructure(qp);
 
         _solver_ptr = std::make_shared<pqp::dense::QP<double>>(n_var, n_eq, n_in);
         _solver_ptr->settings.eps_abs = _eps_abs;
@@ -61,17 +205,14 @@ void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::Vecto
 
         _solver_ptr->init(qp.H, qp.g, qp.A, qp.b, _C_mtx, _l_vec, _u_vec);
 
+        stats.warm_start = warm_start;
         configured = true;
     }
     else 
     {
-        if(n_var != _n_var_init)
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-        if(n_in != _n_in_init)
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-
         _solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START_WITH_PREVIOUS_RESULT;
         _solver_ptr->update(qp.H, qp.g, qp.A, qp.b, _C_mtx, _l_vec, _u_vec);
+        stats.warm_start = true;
     }
 
 //     std::cerr << "qp.nq = " << qp.nq <<std::endl;
@@ -86,28 +227,80 @@ void ProxQPSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::Vecto
 //     std::cerr << "eps_abs: " << _solver_ptr->settings.eps_abs << std::endl;
 //     std::cerr << "max_iter: " << _solver_ptr->settings.max_iter << std::endl;
 
-    _solver_ptr->solve();
+    _solver_ptr->settings.max_iter = _max_iter_budget;
+    _solve_start = base::Time::now();
+    if(warm_start){
+        _solver_ptr->settings.initial_guess = pqp::InitialGuessStatus::WARM_START;
+        _solver_ptr->solve(_x_guess, _y_guess, _z_guess);
+    }
+    else
+        _solver_ptr->solve();
     
     solver_output.resize(qp.nq);
     solver_output = _solver_ptr->results.x;
 
-    auto status = _solver_ptr->results.info.status;
+    const base::Time end = base::Time::now();
+    stats.setup_time = (_solve_start - start).toMicroseconds();
+    stats.solve_time = (end - _solve_start).toMicroseconds();
+    updateTimePerIteration(end - start, _solver_ptr->results.info.iter);
+    checkStatus(_solver_ptr->results);
+}
+
+void ProxQPSolver::storeStructure(const wbc::QuadraticProgram &qp)
+{
+    _n_var_init = qp.nq;
+    _n_eq_init = qp.neq;
+    _n_in_init = qp.nin + qp.lower_x.size();
+    _n_bounds_init = qp.lower_x.size();
+    _variable_blocks_init = qp.variable_blocks;
+}
+
+void ProxQPSolver::mapResults(const proxsuite::proxqp::Results<double>& results, const wbc::QuadraticProgram &qp)
+{
+    // The multipliers of the bounds (last entries of z) belong to the variables and can be mapped in the same way as the primal solution. The multipliers
+    // of the constraints cannot be matched, since the constraint rows do not carry any semantic information
+    mapVariables(_variable_blocks_init, results.x, qp.variable_blocks, qp.nq, _x_guess);
+    _y_guess.setZero(qp.neq);
+    _z_guess.setZero(qp.nin + qp.lower_x.size());
+    if(_n_bounds_init > 0 && qp.lower_x.size() > 0){
+        base::VectorXd z_bounds;
+        mapVariables(_variable_blocks_init, results.z.tail(_n_bounds_init), qp.variable_blocks, qp.nq, z_bounds);
+        _z_guess.tail(qp.nq) = z_bounds;
+    }
+}
+
+void ProxQPSolver::checkStatus(const proxsuite::proxqp::Results<double>& results)
+{
+    namespace pqp = proxsuite::proxqp;
+
+    auto pqp_status = results.info.status;
 
-    // if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED)
+    // if(pqp_status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED)
     //     std::cerr << "ProxQP returned error status: max iterations reached." << std::endl;
-    // if(status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
+    // if(pqp_status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
     //     std::cerr << "ProxQP returned error status: problem is primal infeasible." << std::endl;
-    // if(status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
+    // if(pqp_status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
     //     std::cerr << "ProxQP returned error status: problem is dual infeasible." << std::endl;
 
-    if(status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED)
-        throw std::runtime_error("ProxQP returned error status: max iterations reached.");
-    if(status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
+    _actual_n_iter = results.info.iter;
+    stats.n_iter = _actual_n_iter;
+    stats.primal_residual = results.info.pri_res;
+    stats.dual_residual = results.info.dua_res;
+    stats.n_active = 0;
+    for(int i = 0; i < results.z.size(); i++)
+        stats.n_active += results.z[i] != 0;
+    stats.status = solved;
+
+    // With a time budget, the last iterate is returned if the iteration limit is reached
+    if(pqp_status == pqp::QPSolverOutput::PROXQP_MAX_ITER_REACHED){
+        if(time_budget <= 0)
+            throw std::runtime_error("ProxQP returned error status: max iterations reached.");
+        stats.status = _max_iter_budget < (uint)_n_iter ? time_budget_exceeded : max_iter_reached;
+    }
+    if(pqp_status == pqp::QPSolverOutput::PROXQP_PRIMAL_INFEASIBLE)
         throw std::runtime_error("ProxQP returned error status: problem is primal infeasible.");
-    if(status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
+    if(pqp_status == pqp::QPSolverOutput::PROXQP_DUAL_INFEASIBLE)
         throw std::runtime_error("ProxQP returned error status: problem is dual infeasible.");
-
-    _actual_n_iter = _solver_ptr->results.info.iter;
 }
 
 } // namespace wbc
@@ -2,12 +2,14 @@
 #define WBC_SOLVERS_PROXQP_SOLVER_HPP
 
 #include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
 
 #include <memory>
 
 #include <base/Time.hpp>
 
 #include <proxsuite/proxqp/dense/wrapper.hpp>
+#include <proxsuite/proxqp/sparse/wrapper.hpp>
 
 namespace wbc {
 
@@ -23,6 +25,9 @@ class HierarchicalQP;
  *             & \mathbf{l} \leq \mathbf{Cx} \leq \mathbf{u}& \\
  *        \end{array}
  *  \f]
+ * Sparse quadratic programs (see QuadraticProgram::sparse) are solved with the sparse backend of prox-qp, dense ones with the dense backend.
+ * Use setSparse() to make scenes generate sparse quadratic programs. The bounds of the solution vector are appended to the inequality constraints. Infinite
+ * constraint sides (see QP_INFINITE_BOUND) are passed as +-infinity, so that they never become active and do not affect the scaling of the problem.
  */
 class ProxQPSolver : public QPSolver{
 private:
@@ -49,21 +54,51 @@ public:
     /** Get number of working set recalculations actually performed*/
     int getNter(){ return _actual_n_iter; }
 
+    /** If true, scenes will generate sparse quadratic programs for this solver, which are then solved with the sparse backend of prox-qp. Default is false*/
+    void setSparse(bool sparse){ _sparse = sparse; configured = false; }
+
+    /** Return true if scenes shall generate sparse quadratic programs for this solver, see setSparse()*/
+    virtual bool sparseInput() const { return _sparse; }
+
 protected:
 
+    /** Throw if the solver returned an error status and store the number of iterations and the solver statistics*/
+    void checkStatus(const proxsuite::proxqp::Results<double>& results);
+
+    /** Store the dimensions and variable blocks of the given QP, which is used to (re-)initialize the solver*/
+    void storeStructure(const wbc::QuadraticProgram &qp);
+
+    /** Map the results of the previous solver instance to the variables of the given QP after a structure change, see QPSolver::mapVariables()*/
+    void mapResults(const proxsuite::proxqp::Results<double>& results, const wbc::QuadraticProgram &qp);
+
+    /** Solve the given sparse QP with the sparse backend*/
+    const proxsuite::proxqp::Results<double>& solveSparse(const wbc::QuadraticProgram &qp);
+
     std::shared_ptr<proxsuite::proxqp::dense::QP<double>> _solver_ptr;
+    std::shared_ptr<proxsuite::proxqp::sparse::QP<double,int>> _sparse_solver_ptr;
+    bool _sparse;
 
     double _eps_abs = 1e-9;
     int _n_iter;
     int _actual_n_iter;
+    uint _max_iter_budget; // iteration limit of the current call, see QPSolver::iterationBudget()
+    base::Time _solve_start; // start of the actual solver call in the current call of solve(), for the solver statistics
 
     size_t _n_var_init; // number of variables in the configured solver instance
     size_t _n_eq_init;  // number of equalities in the configured solver instance
     size_t _n_in_init;  // number of inequalities in the configured solver instance (inclusing bounds)
+    size_t _n_bounds_init; // number of bounds in the configured solver instance
+    std::vector<VariableBlock> _variable_blocks_init; // variable blocks of the QP the solver instance was configured with
+
+    Eigen::VectorXd _x_guess, _y_guess, _z_guess; // warm start after a structure change
 
     Eigen::MatrixXd _C_mtx; // inequalities matrix (including bounds)
-    Eigen::VectorXd _l_vec; // inequalities lower bounds
-    Eigen::VectorXd _u_vec; // inequalities upper bounds
+    Eigen::VectorXd _l_vec; // inequalities lower bounds, infinite bounds are passed as -infinity
+    Eigen::VectorXd _u_vec; // inequalities upper bounds, infinite bounds are passed as +infinity
+
+    SparseMatrixXd _H_sparse;  // Hessian matrix in sparse format
+    SparseMatrixXd _C_sparse;  // sparse inequalities matrix (including bounds)
+    std::vector<int> _H_pattern, _A_pattern, _C_pattern; // sparsity patterns of the configured sparse solver instance
 };
 
 }
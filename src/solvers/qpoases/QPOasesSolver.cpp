@@ -10,7 +10,8 @@ namespace wbc{
 
 QPSolverRegistry<QPOASESSolver> QPOASESSolver::reg("qpoases");
 
-QPOASESSolver::QPOASESSolver(){
+QPOASESSolver::QPOASESSolver() :
+    matrices_changed(true){
     n_wsr = 1000;
     options.setToFast();
     options.printLevel = PL_NONE;
@@ -26,38 +27,74 @@ void QPOASESSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
         throw std::runtime_error("QPOASESSolver::solve: Number of task hierarchies must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    if(qp.sparse)
+        throw std::runtime_error("QPOASESSolver::solve: Sparse quadratic programs are not supported");
     qp.check();
 
-    size_t nc = qp.C.rows() + qp.A.rows();
+    const base::Time start = base::Time::now();
+    const int nc = qp.neq + qp.nin;
+
+    // The solver buffers are only (re-)allocated if the problem dimensions change. Note that qpOASES keeps pointers to H and A
+    // internally, so they must not be touched unless they are passed again in a matrix update
+    bool warm_start = false;
+    if(!configured || H.rows() != qp.nq || A.rows() != nc){
+
+        // Structure changed at runtime, e.g. the contact points: Warm start from the previous solution. qpOASES stores the multipliers of
+        // the bounds first, followed by the ones of the constraints. The latter cannot be matched, since the constraint rows do not carry any semantic information
+        warm_start = configured && sq_problem.isInitialised();
+        if(warm_start){
+            base::VectorXd x_prev(H.rows()), y_prev(H.rows() + A.rows()), y_bounds;
+            sq_problem.getPrimalSolution(x_prev.data());
+            sq_problem.getDualSolution(y_prev.data());
+            mapVariables(variable_blocks, x_prev, qp.variable_blocks, qp.nq, x_guess);
+            mapVariables(variable_blocks, y_prev.head(H.rows()), qp.variable_blocks, qp.nq, y_bounds);
+            y_guess.setZero(qp.nq + nc);
+            y_guess.head(qp.nq) = y_bounds;
+        }
+        variable_blocks = qp.variable_blocks;
 
-    if(!configured){
-        sq_problem = SQProblem(qp.A.cols(), nc);
+        sq_problem = SQProblem(qp.nq, nc);
         sq_problem.setOptions(options);
+        H.resize(qp.nq, qp.nq);
+        A.resize(nc, qp.nq);
+        lower_a.resize(nc);
+        upper_a.resize(nc);
+        lower_x.resize(qp.lower_x.size());
+        upper_x.resize(qp.upper_x.size());
         configured = true;
     }
 
-    // Have to convert to row-major order matrices. Eigen uses column major by default and
-    // qpoases expects the data to be arranged in row-major
-    H = qp.H;
-
-    // same for A mtx but equalities and inequalities constraints have to be merged in a single matrix
-    A.resize(nc, qp.A.cols());
-    A.topRows(qp.A.rows()) = qp.A;
-    A.bottomRows(qp.C.rows()) = qp.C;
+    // Have to convert to row-major order matrices. Eigen uses column major by default and qpoases expects the data to be arranged in row-major.
+    // Equalities and inequalities constraints have to be merged in a single matrix. Only copy the matrices if they changed since the last call,
+    // otherwise a hotstart with the new vectors is sufficient, which saves the matrix update of qpOASES
+    matrices_changed = !sq_problem.isInitialised() ||
+                       H != qp.H ||
+                       A.topRows(qp.neq) != qp.A ||
+                       A.bottomRows(qp.nin) != qp.C;
+    if(matrices_changed){
+        H = qp.H;
+        A.topRows(qp.neq) = qp.A;
+        A.bottomRows(qp.nin) = qp.C;
+    }
 
-    // create constraints vectors (merging equalities and inequalities vecs)
-    Eigen::VectorXd lower_a(nc);
-    Eigen::VectorXd upper_a(nc);
-    lower_a << qp.b, qp.lower_y;
-    upper_a << qp.b, qp.upper_y;
+    // create constraints vectors (merging equalities and inequalities vecs). Infinite bounds (see QP_INFINITE_BOUND) are mapped to the
+    // infinity of qpOASES, so that the corresponding constraint sides are never added to the active set
+    lower_a.head(qp.neq) = qp.b;
+    upper_a.head(qp.neq) = qp.b;
+    lower_a.tail(qp.nin) = (qp.lower_y.array() <= -QP_INFINITE_BOUND).select(-INFTY, qp.lower_y);
+    upper_a.tail(qp.nin) = (qp.upper_y.array() >= QP_INFINITE_BOUND).select(INFTY, qp.upper_y);
 
     // Joint space upper and lower bounds
     real_t* lb_ptr = 0;
     real_t* ub_ptr = 0;
-    if(qp.lower_x.size() > 0)
-        lb_ptr = (real_t*)qp.lower_x.data();
-    if(qp.upper_x.size() > 0)
-        ub_ptr = (real_t*)qp.upper_x.data();
+    if(qp.lower_x.size() > 0){
+        lower_x = (qp.lower_x.array() <= -QP_INFINITE_BOUND).select(-INFTY, qp.lower_x);
+        lb_ptr = (real_t*)lower_x.data();
+    }
+    if(qp.upper_x.size() > 0){
+        upper_x = (qp.upper_x.array() >= QP_INFINITE_BOUND).select(INFTY, qp.upper_x);
+        ub_ptr = (real_t*)upper_x.data();
+    }
 
     // Constraint space upper and lower bounds
     real_t* lbA_ptr = 0;
@@ -78,26 +115,43 @@ void QPOASESSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
     if(qp.g.size() > 0)
         g_ptr = (real_t*)qp.g.data();
 
+    // qpOASES supports a cpu time limit natively (in seconds). Its value is replaced by the actually used time
     actual_n_wsr = n_wsr;
+    real_t cputime = time_budget * 1e-6;
+    real_t* cputime_ptr = time_budget > 0 ? &cputime : 0;
+    std::string stage = "hotstart";
+    stats.warm_start = warm_start || sq_problem.isInitialised();
+    const base::Time solve_start = base::Time::now();
     if(!sq_problem.isInitialised()){
-        ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
-            options.print();
-            qp.print();
-            throw std::runtime_error("SQ Problem initialization failed with error " + std::to_string(ret_val));
-        }
+        stage = "initialization";
+        if(warm_start)
+            ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr, x_guess.data(), y_guess.data());
+        else
+            ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
     }
+    else if(matrices_changed)
+        ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
     else{
-        ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
-            options.print();
-            qp.print();
-            throw std::runtime_error("SQ Problem hotstart failed with error " + std::to_string(ret_val));
-        }
+        // Same matrices as in the last call: Vector-only hotstart, which reuses the matrix factorizations
+        ret_val = sq_problem.QProblem::hotstart(g_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+    }
+
+    // With a time budget, running out of time or working set recalculations is not an error. The solution of the last (intermediate) QP in the homotopy is returned in that case
+    stats.solve_time = (base::Time::now() - solve_start).toMicroseconds();
+    stats.setup_time = (solve_start - start).toMicroseconds();
+    stats.n_iter = actual_n_wsr;
+    stats.n_active = sq_problem.getNAC() + sq_problem.getNFX();
+    stats.status = solved;
+    if(ret_val == RET_MAX_NWSR_REACHED && time_budget > 0)
+        stats.status = actual_n_wsr < n_wsr ? time_budget_exceeded : max_iter_reached;
+    else if(ret_val != SUCCESSFUL_RETURN){
+        options.print();
+        qp.print();
+        throw std::runtime_error("SQ Problem " + stage + " failed with error " + std::to_string(ret_val));
     }
 
     solver_output.resize(qp.nq);
-    if(sq_problem.getPrimalSolution( solver_output.data() ) == RET_QP_NOT_SOLVED)
+    if(sq_problem.getPrimalSolution( solver_output.data() ) == RET_QP_NOT_SOLVED && stats.status == solved)
         throw std::runtime_error("SQ Problem getPrimalSolution() returned " + std::to_string(RET_QP_NOT_SOLVED));
 }
 
@@ -2,6 +2,7 @@
 #define WBC_SOLVERS_QP_OASES_SOLVER_HPP
 
 #include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
 #include <qpOASES.hpp>
 #include <base/Time.hpp>
 
@@ -53,6 +54,9 @@ public:
     void setOptions(const qpOASES::Options& opt);
     /** Set new solver options using one of the following presets: qp_default, qp_reliable, qp_fast, qp_unset*/
     void setOptionsPreset(const qpOASES::optionPresets& opt);
+    /** Return true if H or the constraint matrices changed in the last call to solve(). If false, the solver performed a hotstart with the new vectors only,
+     *  which reuses the matrix factorizations of the previous call*/
+    bool matricesChanged(){return matrices_changed;}
     /** Get Quadratic program*/
     const qpOASES::SQProblem& getSQProblem(){return sq_problem;}
 
@@ -63,6 +67,11 @@ protected:
     qpOASES::returnValue ret_val;
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> H;
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> A;
+    Eigen::VectorXd lower_a, upper_a;
+    Eigen::VectorXd lower_x, upper_x;
+    bool matrices_changed;
+    std::vector<VariableBlock> variable_blocks; // Variable blocks of the QP the solver was initialized with
+    Eigen::VectorXd x_guess, y_guess;           // Warm start after a structure change
     base::Time stamp;
 };
 
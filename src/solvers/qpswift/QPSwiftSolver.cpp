@@ -1,13 +1,31 @@
 #include "QPSwiftSolver.hpp"
 #include <core/QuadraticProgram.hpp>
 #include <base-logging/Logging.hpp>
+#include <Eigen/Sparse>
+#include <Eigen/OrderingMethods>
 
 #include <iostream>
+#include <cmath>
 
 namespace wbc {
 
 QPSolverRegistry<QPSwiftSolver> QPSwiftSolver::reg("qpswift");
 
+/** Offset of the tags, see QPSwiftSolver::setupQpSwift(). Chosen such that the tags cannot be confused with the constant entries of the KKT matrix*/
+static const double TAG_OFFSET = 1e6;
+
+/** Assign a unique tag to each non-zero of the given matrix and store its non-zero pattern*/
+static void tagMatrix(const base::MatrixXd& mat, base::MatrixXd& tags, base::MatrixXd& pattern, std::vector<const double*>& tag_sources){
+    tags.setZero(mat.rows(), mat.cols());
+    pattern = (mat.array() != 0).cast<double>();
+    for(int k = 0; k < mat.size(); k++){
+        if(mat.data()[k] != 0){
+            tags.data()[k] = TAG_OFFSET + tag_sources.size();
+            tag_sources.push_back(mat.data() + k);
+        }
+    }
+}
+
 QPSwiftSolver::QPSwiftSolver(){
     my_qp = 0;
     max_iter = 1000;
@@ -15,6 +33,9 @@ QPSwiftSolver::QPSwiftSolver(){
     abs_tol = 1e-6;
     sigma = 100;
     verbose_level = 0;
+    reuse_kkt_ordering = true;
+    in_place_update = true;
+    setup_required = true;
 }
 
 QPSwiftSolver::~QPSwiftSolver(){
@@ -22,41 +43,115 @@ QPSwiftSolver::~QPSwiftSolver(){
         QP_CLEANUP_dense(my_qp);
 }
 
+void QPSwiftSolver::configure(const wbc::QuadraticProgram &qp){
+
+    // Count equality / inequality constraints. Only the constraint sides with finite bounds are mapped to inequalities, rows with equal
+    // lower and upper bound are mapped to equalities. Empty equality rows are dropped, they would make the KKT matrix singular
+    n_dec = qp.nq;
+    n_eq = rows_eq.equal.size() + rows_in.equal.size() + rows_bounds.equal.size();
+    n_bounds = rows_bounds.nInequalities();
+    n_ineq = rows_in.nInequalities() + n_bounds;
+
+    A.setZero(n_eq, n_dec);
+    b.resize(n_eq);
+    G.setZero(n_ineq, n_dec);
+    h.resize(n_ineq);
+    P.resize(n_dec, n_dec);
+    c.resize(n_dec);
+
+    // The bounds are mapped to equalities/inequalities, the corresponding rows of A and G are constant
+    int k = rows_eq.equal.size() + rows_in.equal.size();
+    for(int i : rows_bounds.equal)
+        A(k++, i) = 1.0;
+    k = rows_in.nInequalities();
+    for(int i : rows_bounds.upper)
+        G(k++, i) = 1.0;
+    for(int i : rows_bounds.lower)
+        G(k++, i) = -1.0;
+    kkt_ordering.clear();
+    setup_required = true;
+
+    LOG_DEBUG_S << "n_dec:    " << n_dec    << std::endl;
+    LOG_DEBUG_S << "n_eq:     " << n_eq     << std::endl;
+    LOG_DEBUG_S << "n_ineq:   " << n_ineq   << std::endl;
+    configured = true;
+}
+
+void QPSwiftSolver::computeKKTOrdering(){
+
+    const int n_kkt = n_dec + n_eq + n_ineq;
+    std::vector<Eigen::Triplet<double,int>> triplets;
+    triplets.reserve(n_kkt + P.size() + 2*(A.size() + G.size()));
+    for(int j = 0; j < n_dec; j++){
+        for(int i = 0; i < n_dec; i++){
+            if(P(i,j) != 0 || i == j)
+                triplets.emplace_back(i, j, 1.0);
+        }
+        for(int i = 0; i < n_eq; i++){
+            if(A(i,j) != 0){
+                triplets.emplace_back(n_dec + i, j, 1.0);
+                triplets.emplace_back(j, n_dec + i, 1.0);
+            }
+        }
+        for(int i = 0; i < n_ineq; i++){
+            if(G(i,j) != 0){
+                triplets.emplace_back(n_dec + n_eq + i, j, 1.0);
+                triplets.emplace_back(j, n_dec + n_eq + i, 1.0);
+            }
+        }
+    }
+    for(int i = n_dec + n_eq; i < n_kkt; i++)
+        triplets.emplace_back(i, i, 1.0);
+
+    Eigen::SparseMatrix<double,Eigen::ColMajor,int> kkt(n_kkt, n_kkt);
+    kkt.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::AMDOrdering<int>::PermutationType perm;
+    Eigen::AMDOrdering<int>()(kkt, perm);
+
+    // Same convention as in AMD: Entry k is the index of the row/column of the original matrix that becomes row/column k
+    kkt_ordering.assign(perm.indices().data(), perm.indices().data() + n_kkt);
+}
+
 void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
-    
-    G.setZero();    
 
     P = qp.H;
     c = qp.g;
-    A = qp.A;
-    b = qp.b;
-    
-    // create inequalities matrix (inequalities constraints + bounds)
-    G.middleRows(0, qp.nin) = qp.C;
-    G.middleRows(qp.nin, qp.nin) = -qp.C;
-    h.segment(0, qp.nin) = qp.upper_y;
-    h.segment(qp.nin, qp.nin) = -qp.lower_y;
-
-    if(qp.bounded){
-        G.middleRows(2*qp.nin, n_dec).diagonal().setConstant(1.0);        // map bounds as inequalities
-        G.middleRows(2*qp.nin+n_dec, n_dec).diagonal().setConstant(-1.0);
-        h.segment(2*qp.nin, n_dec) = qp.upper_x;        // map bounds as inequalities
-        h.segment(2*qp.nin+n_dec, n_dec) = -qp.lower_x;
+
+    // create equalities matrix (equalities + inequalities and bounds with lb == ub). The bound rows have been written in configure()
+    int k = 0;
+    for(int i : rows_eq.equal){
+        A.row(k) = qp.A.row(i);
+        b[k++] = qp.b[i];
+    }
+    for(int i : rows_in.equal){
+        A.row(k) = qp.C.row(i);
+        b[k++] = qp.lower_y[i];
     }
+    for(int i : rows_bounds.equal)
+        b[k++] = qp.lower_x[i];
 
-    my_qp = QP_SETUP_dense(n_dec,                   // Number decision variables
-                           n_ineq,                  // Number inequality constraints
-                           n_eq,                    // Number equality constraints
-                           (double*)P.data(),       // Hessian matrix
-                           (double*)A.data(),       // Equality constraint matrix
-                           (double*)G.data(),       // Inequality constraint matrix
-                           (double*)c.data(),       // Cost function gradient vector
-                           (double*)h.data(),       // Inequality constraint vector
-                           (double*)b.data(),       // Equality constraint vector
-                           NULL,
-                           COLUMN_MAJOR_ORDERING);
+    // create inequalities matrix (inequalities constraints + bounds). The bound rows have been written in configure()
+    k = 0;
+    for(int i : rows_in.upper){
+        G.row(k) = qp.C.row(i);
+        h[k++] = qp.upper_y[i];
+    }
+    for(int i : rows_in.lower){
+        G.row(k) = -qp.C.row(i);
+        h[k++] = -qp.lower_y[i];
+    }
+    for(int i : rows_bounds.upper)
+        h[k++] = qp.upper_x[i];
+    for(int i : rows_bounds.lower)
+        h[k++] = -qp.lower_x[i];
+
+    // The setup (allocations, ordering and symbolic factorization of the KKT matrix) is only required if the structure changed
+    if(in_place_update && !setup_required && !patternChanged())
+        updateQpSwift();
+    else
+        setupQpSwift();
 
-    my_qp->options->maxit = max_iter;
+    my_qp->options->maxit = iterationBudget(max_iter); // qpSWIFT has no time limit, so the time budget is translated into an iteration limit
     my_qp->options->reltol = rel_tol;
     my_qp->options->abstol = abs_tol;
     my_qp->options->sigma = sigma;
@@ -64,36 +159,145 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
     LOG_DEBUG_S << "Setup Time     : " << my_qp->stats->tsetup * 1000.0 << " ms" << std::endl;
 }
 
+void QPSwiftSolver::setupQpSwift(){
+
+    // The ordering of the KKT matrix is passed, which saves the AMD ordering in QP_SETUP_dense. Free the previous setup first.
+    if(reuse_kkt_ordering && kkt_ordering.empty())
+        computeKKTOrdering();
+    if(my_qp)
+        QP_CLEANUP_dense(my_qp);
+    my_qp = 0;
+    setup_required = true;
+
+    if(in_place_update){
+        // Set up with unique tags instead of the matrix entries. qpSWIFT copies the matrices to its internal sparse matrices and KKT matrix,
+        // so the tags show where each matrix entry ends up. The tagged matrices have the same non-zero pattern as the actual ones.
+        tag_sources.clear();
+        tagMatrix(P, P_tags, P_pattern, tag_sources);
+        tagMatrix(A, A_tags, A_pattern, tag_sources);
+        tagMatrix(G, G_tags, G_pattern, tag_sources);
+        my_qp = QP_SETUP_dense(n_dec, n_ineq, n_eq, P_tags.data(), A_tags.data(), G_tags.data(), c.data(), h.data(), b.data(),
+                               reuse_kkt_ordering ? kkt_ordering.data() : NULL, COLUMN_MAJOR_ORDERING);
+        if(findValueSlots()){
+            updateQpSwift();
+            setup_required = false;
+            return;
+        }
+        LOG_WARN("QPSwiftSolver: Failed to locate the problem data in the qpSWIFT instance. Falling back to a setup in each cycle");
+        in_place_update = false;
+        QP_CLEANUP_dense(my_qp);
+    }
+
+    my_qp = QP_SETUP_dense(n_dec,                   // Number decision variables
+                           n_ineq,                  // Number inequality constraints
+                           n_eq,                    // Number equality constraints
+                           P.data(),                // Hessian matrix
+                           A.data(),                // Equality constraint matrix
+                           G.data(),                // Inequality constraint matrix
+                           c.data(),                // Cost function gradient vector
+                           h.data(),                // Inequality constraint vector
+                           b.data(),                // Equality constraint vector
+                           reuse_kkt_ordering ? kkt_ordering.data() : NULL, // Permutation vector of the KKT matrix
+                           COLUMN_MAJOR_ORDERING);
+}
+
+bool QPSwiftSolver::findValueSlots(){
+
+    value_slots.clear();
+    internal_arrays.clear();
+    std::vector<bool> in_kkt(tag_sources.size(), false);
+
+    smat* matrices[] = {my_qp->P, my_qp->A, my_qp->G, my_qp->kkt->kktmatrix, my_qp->kkt->PKPt};
+    for(smat* mat : matrices){
+        if(!mat)
+            continue;
+        InternalArray arr;
+        arr.data = mat->pr;
+        arr.constants.assign(mat->pr, mat->pr + mat->jc[mat->n]);
+        for(size_t i = 0; i < arr.constants.size(); i++){
+            const double tag = std::abs(arr.constants[i]) - TAG_OFFSET;
+            if(tag < 0 || tag >= tag_sources.size() || tag != std::floor(tag))
+                continue;
+            value_slots.push_back({mat->pr + i, tag_sources[(size_t)tag], arr.constants[i] > 0 ? 1.0 : -1.0});
+            arr.constants[i] = 0;
+            if(mat == my_qp->kkt->PKPt)
+                in_kkt[(size_t)tag] = true;
+        }
+        internal_arrays.push_back(arr);
+    }
+
+    // All entries of A and G and one of each pair of symmetric entries of P have to be part of the KKT matrix
+    const size_t n_p_tags = P_pattern.sum();
+    for(size_t k = n_p_tags; k < in_kkt.size(); k++){
+        if(!in_kkt[k])
+            return false;
+    }
+    for(int j = 0; j < n_dec; j++){
+        for(int i = 0; i <= j; i++){
+            if(P_tags(i,j) == 0 && P_tags(j,i) == 0)
+                continue;
+            const bool found_ij = P_tags(i,j) != 0 && in_kkt[(size_t)(P_tags(i,j) - TAG_OFFSET)];
+            const bool found_ji = P_tags(j,i) != 0 && in_kkt[(size_t)(P_tags(j,i) - TAG_OFFSET)];
+            if(!found_ij && !found_ji)
+                return false;
+        }
+    }
+    return true;
+}
+
+void QPSwiftSolver::updateQpSwift(){
+
+    for(InternalArray& arr : internal_arrays)
+        std::copy(arr.constants.begin(), arr.constants.end(), arr.data);
+    for(const ValueSlot& slot : value_slots)
+        *slot.dst = slot.sign * (*slot.src);
+
+    // qpSWIFT keeps pointers to the vectors given in the setup, so they only have to be copied if it made own copies
+    if(my_qp->c != c.data())
+        std::copy(c.data(), c.data() + n_dec, my_qp->c);
+    if(my_qp->h != h.data())
+        std::copy(h.data(), h.data() + n_ineq, my_qp->h);
+    if(my_qp->b != b.data())
+        std::copy(b.data(), b.data() + n_eq, my_qp->b);
+}
+
+bool QPSwiftSolver::patternChanged() const{
+    return ((P.array() != 0) && (P_pattern.array() == 0)).any() ||
+           ((A.array() != 0) && (A_pattern.array() == 0)).any() ||
+           ((G.array() != 0) && (G_pattern.array() == 0)).any();
+}
+
 void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("QPSwiftSolver::solve: Number of task hierarchies must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+    if(qp.sparse)
+        throw std::runtime_error("QPSwiftSolver::solve: Sparse quadratic programs are not supported");
 
-    if(!configured){        
-        // Count equality / inequality constraints
-        n_dec = qp.nq;
-        n_eq = qp.neq;
-        n_ineq = 2 * (qp.nin + qp.upper_x.size()); 
-
-        A.resize(n_eq, n_dec);
-        b.resize(n_eq);
-        G.resize(n_ineq, n_dec);
-        h.resize(n_ineq);
-        P.resize(n_dec, n_dec);
-        c.resize(n_dec);
-        solver_output.resize(n_dec);
-
-        LOG_DEBUG_S << "n_dec:    " << n_dec    << std::endl;
-        LOG_DEBUG_S << "n_eq:     " << n_eq     << std::endl;
-        LOG_DEBUG_S << "n_ineq:   " << n_ineq   << std::endl;
-        configured = true;
-    }
+    // Buffers and KKT ordering are only re-created if the problem structure changes, e.g. if the contact points change at runtime
+    bool rows_changed = rows_eq.updateEqualities(qp.A, qp.b);
+    rows_changed |= rows_in.update(qp.lower_y, qp.upper_y);
+    rows_changed |= rows_bounds.update(qp.lower_x, qp.upper_x);
+    if(!configured || rows_changed || n_dec != (int)qp.nq)
+        configure(qp);
 
+    const base::Time start = base::Time::now();
     toQpSwift(qp);
 
+    const base::Time solve_start = base::Time::now();
     qp_int exit_code = QP_SOLVE(my_qp);
+    const base::Time end = base::Time::now();
+    updateTimePerIteration(end - start, my_qp->stats->IterationCount);
+
+    // qpSWIFT is an interior point method without warm start, so there is no active set either
+    stats.setup_time = (solve_start - start).toMicroseconds();
+    stats.solve_time = (end - solve_start).toMicroseconds();
+    stats.n_iter = my_qp->stats->IterationCount;
+    stats.n_active = -1;
+    stats.warm_start = false;
+    stats.status = solved;
 
     switch(exit_code){
     case QP_OPTIMAL:{
@@ -111,7 +315,11 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
         LOG_DEBUG_S << "LDL Time       : " << my_qp->stats->ldl_numeric * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Diff	       : " << (my_qp->stats->kkt_time - my_qp->stats->ldl_numeric) * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Iterations     : " << my_qp->stats->IterationCount << std::endl;
-        throw std::runtime_error("QPSwiftSolver failed: Maximum Iterations reached");
+        // With a time budget, the last iterate is returned. It is primal infeasible in general, see stats.primal_residual
+        if(time_budget <= 0)
+            throw std::runtime_error("QPSwiftSolver failed: Maximum Iterations reached");
+        stats.status = (uint)my_qp->options->maxit < max_iter ? time_budget_exceeded : max_iter_reached;
+        break;
     }
     case QP_FATAL:{
         throw std::runtime_error("QPSwiftSolver failed: Unknown error");
@@ -121,8 +329,10 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
     }
     }
 
+    solver_output.resize(n_dec);
     for(int i = 0; i < n_dec; i++)
         solver_output[i] = my_qp->x[i];
+    stats.primal_residual = constraintViolation(qp, solver_output);
 }
 
 }
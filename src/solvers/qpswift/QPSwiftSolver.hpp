@@ -3,10 +3,18 @@
 
 #include "../../core/QPSolver.hpp"
 #include <qpSWIFT/qpSWIFT.h>
+#include <vector>
 
 namespace wbc {
 class QuadraticProgram;
 
+/**
+ * @brief The QPSwiftSolver class is a wrapper for the interior point solver qpSWIFT (see https://github.com/qpSWIFT/qpSWIFT). Since the method starts from an infeasible
+ *  point, the iterates satisfy neither the equality nor the inequality constraints before convergence. Thus, if the time budget is exceeded (see QPSolver::setTimeBudget()),
+ *  the returned iterate is primal infeasible in general. Its constraint violation is reported in QPSolver::getStats().primal_residual.
+ *  qpSWIFT has no interface to update the problem data of a solver instance. Thus, the instance is only set up if the problem structure changes, and the problem data is
+ *  overwritten in its internal arrays in all other cycles, see setInPlaceUpdate().
+ */
 class QPSwiftSolver : public QPSolver{
 private:
     static QPSolverRegistry<QPSwiftSolver> reg;
@@ -21,15 +29,50 @@ protected:
     int n_dec;          /** Number decision variables*/
     int n_ineq;         /** Number inequality constraints*/
     int n_eq;           /** Number equality constraints*/
-    int n_bounds;       /** Number of lower/upper bounds on the decision variables*/
+    int n_bounds;       /** Number of lower/upper bounds on the decision variables, which are mapped to inequalities*/
+    ConstraintRowSelection rows_eq;     /** Selection of the non-empty equality constraint rows*/
+    ConstraintRowSelection rows_in;     /** Selection of the inequality constraint rows*/
+    ConstraintRowSelection rows_bounds; /** Selection of the bounds*/
     QP *my_qp;
+    bool in_place_update;             /** If true, the problem data of my_qp is overwritten in place as long as the problem structure does not change*/
+    bool setup_required;              /** If true, my_qp has to be set up in the next cycle*/
+    base::MatrixXd P_pattern, A_pattern, G_pattern;   /** Non-zero pattern (1 for non-zeros) of P, A and G at the last setup. qpSWIFT only stores these entries*/
+    base::MatrixXd P_tags, A_tags, G_tags;            /** Unique tag of each non-zero of P, A and G, used to locate the entries in the internal arrays of qpSWIFT*/
+    std::vector<const double*> tag_sources;           /** Entry of P, A or G for each tag*/
+    struct ValueSlot{
+        double* dst;                  /** Entry in an internal array of my_qp*/
+        const double* src;            /** Corresponding entry of P, A or G*/
+        double sign;                  /** qpSWIFT may store the negative value*/
+    };
+    std::vector<ValueSlot> value_slots;               /** All entries of the internal arrays of my_qp that hold values of P, A or G*/
+    struct InternalArray{
+        double* data;
+        std::vector<double> constants;  /** Entries that do not depend on the problem data (e.g. the identity blocks of the KKT matrix), zero otherwise*/
+    };
+    std::vector<InternalArray> internal_arrays;      /** Internal value arrays of the matrices and the KKT matrix of my_qp*/
+    std::vector<qp_int> kkt_ordering; /** Fill-reducing ordering of the KKT matrix, computed once per problem structure*/
+    bool reuse_kkt_ordering;          /** If false, qpSWIFT computes the ordering of the KKT matrix in each cycle*/
     uint max_iter;      /** Maximum number of Iterations of QP */
     double rel_tol;     /** Relative Tolerance */
     double abs_tol;     /** Absolute Tolerance */
     double sigma;       /** sigma desired */
     uint verbose_level; /** Verbose Levels, 0 - Print,  >0 - Print Everything */
 
+    /** Allocate the buffers for the given problem dimensions and write the constant bound rows of the equality and inequality constraint matrices*/
+    void configure(const QuadraticProgram &qp);
+    /** Compute the AMD ordering of the KKT matrix [P A' G'; A 0 0; G 0 -I] from the current sparsity pattern. qpSWIFT would otherwise compute
+     *  the same ordering in each call of QP_SETUP_dense*/
+    void computeKKTOrdering();
     void toQpSwift(const QuadraticProgram &qp);
+    /** Set up my_qp from the current problem data. With in-place update, the setup is done with unique tags instead of the problem data, so that the
+     *  position of each matrix entry in the internal arrays of qpSWIFT can be found, see findValueSlots()*/
+    void setupQpSwift();
+    /** Locate the tags in the internal arrays of my_qp. Return false if not all entries of P, A and G were found in the KKT matrix*/
+    bool findValueSlots();
+    /** Overwrite the problem data of my_qp in place*/
+    void updateQpSwift();
+    /** Return true if P, A or G have non-zeros that were zero at the last setup*/
+    bool patternChanged() const;
 public:
     QPSwiftSolver();
     ~QPSwiftSolver();
@@ -46,6 +89,12 @@ public:
     void setAbsTol(double val){abs_tol=val;}
     void setSigma(double val){sigma=val;}
     void setVerboseLevel(uint val){verbose_level=val;}
+    /** Reuse the ordering of the KKT matrix as long as the problem structure does not change. Default is true*/
+    void setReuseKKTOrdering(bool val){reuse_kkt_ordering=val;}
+    /** Set up the solver instance only if the problem structure or the non-zero pattern of the matrices changes, and overwrite the problem data in place
+     *  in all other cycles. This saves the allocations and the symbolic factorization of the KKT matrix in each cycle. If the problem data cannot be located in
+     *  the solver instance, the solver falls back to a setup in each cycle with a warning. Default is true*/
+    void setInPlaceUpdate(bool val){in_place_update=val; setup_required=true;}
 };
 }
 
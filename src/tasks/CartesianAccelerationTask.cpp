@@ -16,28 +16,28 @@ base::Vector6d operator-(base::Vector6d a, base::Acceleration b){
     return a;
 }
 
-CartesianAccelerationTask::CartesianAccelerationTask(TaskConfig config, uint n_robot_joints)
-    : CartesianTask(config, n_robot_joints){
+CartesianAccelerationTask::CartesianAccelerationTask(TaskConfig config, RobotModelPtr robot_model)
+    : CartesianTask(config, robot_model){
 }
 
 void CartesianAccelerationTask::update(RobotModelPtr robot_model){
     // Task Jacobian
-    A = robot_model->spaceJacobian(config.root, config.tip);
+    A = robot_model->spaceJacobian(chain);
 
     // Desired task space acceleration: y_r = y_d - Jdot*qdot
-    y_ref = y_ref - robot_model->spatialAccelerationBias(config.root, config.tip);
+    y_ref = y_ref - robot_model->spatialAccelerationBias(chain);
 
     // Convert input acceleration from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
     // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
     // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
-    base::samples::RigidBodyStateSE3 ref_frame = robot_model->rigidBodyState(config.root, config.ref_frame);
-    y_ref_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * y_ref.segment(0,3);
-    y_ref_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * y_ref.segment(3,3);
+    const base::Matrix3d rot_mat = robot_model->rigidBodyState(ref_chain).pose.orientation.toRotationMatrix();
+    y_ref_root.segment(0,3) = rot_mat * y_ref.segment(0,3);
+    y_ref_root.segment(3,3) = rot_mat * y_ref.segment(3,3);
 
     // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
     // assume positive values
-    weights_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * weights.segment(0,3);
-    weights_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * weights.segment(3,3);
+    weights_root.segment(0,3) = rot_mat * weights.segment(0,3);
+    weights_root.segment(3,3) = rot_mat * weights.segment(3,3);
     weights_root = weights_root.cwiseAbs();
 }
 
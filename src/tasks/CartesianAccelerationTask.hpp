@@ -14,7 +14,7 @@ base::Vector6d operator-(base::Vector6d a, base::Acceleration b);
  */
 class CartesianAccelerationTask : public CartesianTask{
 public:
-    CartesianAccelerationTask(TaskConfig config, uint n_robot_joints);
+    CartesianAccelerationTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~CartesianAccelerationTask() = default;
 
     /**
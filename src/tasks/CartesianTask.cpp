@@ -3,9 +3,18 @@
 
 namespace wbc {
 
-CartesianTask::CartesianTask(const TaskConfig &_config, uint n_robot_joints) :
-    Task(_config, n_robot_joints){
+CartesianTask::CartesianTask(const TaskConfig &_config, RobotModelPtr robot_model) :
+    Task(_config, robot_model->noOfJoints()),
+    chain(-1),
+    ref_chain(-1){
 
+    if(config.type == cart){
+        chain = robot_model->chainId(config.root, config.tip);
+        ref_chain = robot_model->chainId(config.root, config.ref_frame);
+        // Invalid frames are reported by Scene::configure(), keep all columns active in that case
+        if(robot_model->hasLink(config.root) && robot_model->hasLink(config.tip))
+            setActiveColumns(robot_model->chainJointIndices(config.root, config.tip));
+    }
 }
 
 CartesianTask::~CartesianTask(){
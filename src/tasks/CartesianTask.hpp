@@ -12,9 +12,17 @@ namespace wbc {
  */
 class CartesianTask : public Task{
 public:
-    CartesianTask(const TaskConfig& _config, uint n_robot_joints);
+    /**
+     * @brief Create the task and resolve the ids of the kinematic chains required by the task
+     * @param _config Task configuration
+     * @param robot_model Robot model which will be passed to update(). Chain ids are only valid until the robot model is reconfigured
+     */
+    CartesianTask(const TaskConfig& _config, RobotModelPtr robot_model);
     virtual ~CartesianTask();
 
+    ChainId chain;      /** Chain root -> tip, only valid for Cartesian tasks (config.type == cart)*/
+    ChainId ref_chain;  /** Chain root -> ref_frame, only valid for Cartesian tasks (config.type == cart)*/
+
     /**
      * @brief Update the Cartesian reference input for this task.
      */
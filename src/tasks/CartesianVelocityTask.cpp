@@ -4,17 +4,17 @@
 
 namespace wbc{
 
-CartesianVelocityTask::CartesianVelocityTask(TaskConfig config, uint n_robot_joints)
-    : CartesianTask(config, n_robot_joints){
+CartesianVelocityTask::CartesianVelocityTask(TaskConfig config, RobotModelPtr robot_model)
+    : CartesianTask(config, robot_model){
 }
 
 void CartesianVelocityTask::update(RobotModelPtr robot_model){
     
     // Task Jacobian
-    A = robot_model->spaceJacobian(config.root, config.tip);
+    A = robot_model->spaceJacobian(chain);
 
     // Convert task twist to robot root
-    base::MatrixXd rot_mat = robot_model->rigidBodyState(config.root, config.ref_frame).pose.orientation.toRotationMatrix();
+    const base::Matrix3d rot_mat = robot_model->rigidBodyState(ref_chain).pose.orientation.toRotationMatrix();
     y_ref_root.segment(0,3) = rot_mat * y_ref.segment(0,3);
     y_ref_root.segment(3,3) = rot_mat * y_ref.segment(3,3);
 
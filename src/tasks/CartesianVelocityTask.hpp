@@ -10,7 +10,7 @@ namespace wbc{
  */
 class CartesianVelocityTask : public CartesianTask{
 public:
-    CartesianVelocityTask(TaskConfig config, uint n_robot_joints);
+    CartesianVelocityTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~CartesianVelocityTask() = default;
 
     /**
@@ -4,14 +4,15 @@
 
 namespace wbc {
 
-CoMAccelerationTask::CoMAccelerationTask(TaskConfig config, uint n_robot_joints)
-    : CartesianTask(config, n_robot_joints){
+CoMAccelerationTask::CoMAccelerationTask(TaskConfig config, RobotModelPtr robot_model)
+    : CartesianTask(config, robot_model){
+    base_chain = robot_model->chainId(robot_model->worldFrame(), robot_model->baseFrame());
 }
 
 void CoMAccelerationTask::update(RobotModelPtr robot_model){
     A = robot_model->comJacobian();
     // Desired task space acceleration: y_r = y_d - Jdot*qdot
-    y_ref = y_ref - robot_model->spatialAccelerationBias(robot_model->worldFrame(), robot_model->baseFrame()).linear;
+    y_ref = y_ref - robot_model->spatialAccelerationBias(base_chain).linear;
     // CoM tasks are always in world/base frame, no need to transform.
     y_ref_root = y_ref;
     weights_root = weights;
@@ -9,8 +9,10 @@ namespace wbc{
  * @brief Implementation of a CoM velocity task.
  */
 class CoMAccelerationTask : public CartesianTask{
+protected:
+    ChainId base_chain;  /** Chain world frame -> base frame*/
 public:
-    CoMAccelerationTask(TaskConfig config, uint n_robot_joints);
+    CoMAccelerationTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~CoMAccelerationTask() = default;
 
     virtual void update(RobotModelPtr robot_model) override;
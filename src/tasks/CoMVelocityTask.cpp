@@ -4,8 +4,8 @@
 
 namespace wbc {
 
-CoMVelocityTask::CoMVelocityTask(TaskConfig config, uint n_robot_joints)
-    : CartesianTask(config, n_robot_joints){
+CoMVelocityTask::CoMVelocityTask(TaskConfig config, RobotModelPtr robot_model)
+    : CartesianTask(config, robot_model){
 }
 
 void CoMVelocityTask::update(RobotModelPtr robot_model){
@@ -10,7 +10,7 @@ namespace wbc{
  */
 class CoMVelocityTask : public CartesianTask{
 public:
-    CoMVelocityTask(TaskConfig config, uint n_robot_joints);
+    CoMVelocityTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~CoMVelocityTask() = default;
 
     virtual void update(RobotModelPtr robot_model) override;
@@ -10,6 +10,7 @@ namespace wbc{
 class JointAccelerationTask : public JointTask{
 public:
     JointAccelerationTask(TaskConfig config, uint n_robot_joints);
+    JointAccelerationTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~JointAccelerationTask() = default;
 
     /**
@@ -7,6 +7,19 @@ JointTask::JointTask(const TaskConfig& _config, uint n_robot_joints) :
 
 }
 
+JointTask::JointTask(const TaskConfig& _config, RobotModelPtr robot_model) :
+    Task(_config, robot_model->noOfJoints()){
+
+    // Invalid joint names are reported in update(), keep all columns active in that case
+    std::vector<int> cols;
+    for(const auto& name : config.joint_names){
+        if(!robot_model->hasJoint(name))
+            return;
+        cols.push_back(robot_model->jointIndex(name));
+    }
+    setActiveColumns(cols);
+}
+
 JointTask::~JointTask(){
 
 }
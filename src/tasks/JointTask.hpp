@@ -11,6 +11,11 @@ namespace wbc {
 class JointTask : public Task{
 public:
     JointTask(const TaskConfig& _config, uint n_robot_joints);
+
+    /**
+     * @brief Constructor. Restricts the active columns of the task (see Task::setActiveColumns()) to the configured joints
+     */
+    JointTask(const TaskConfig& _config, RobotModelPtr robot_model);
     virtual ~JointTask();
 
     /**
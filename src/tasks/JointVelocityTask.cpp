@@ -8,6 +8,11 @@ JointVelocityTask::JointVelocityTask(TaskConfig config, uint n_robot_joints)
 
 }
 
+JointVelocityTask::JointVelocityTask(TaskConfig config, RobotModelPtr robot_model)
+    : JointTask(config, robot_model){
+
+}
+
 void JointVelocityTask::update(RobotModelPtr robot_model){
 
     // Joint space tasks: task matrix has only ones and Zeros. The joint order in the tasks might be different than in the robot model.
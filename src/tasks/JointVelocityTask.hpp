@@ -10,6 +10,7 @@ namespace wbc{
 class JointVelocityTask : public JointTask{
 public:
     JointVelocityTask(TaskConfig config, uint n_robot_joints);
+    JointVelocityTask(TaskConfig config, RobotModelPtr robot_model);
     virtual ~JointVelocityTask() = default;
 
     /**
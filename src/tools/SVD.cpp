@@ -250,4 +250,81 @@ int svd_eigen_decomposition(const base::MatrixXd& A,
             return (0);
 }
 
+int svd_jacobi_decomposition(const base::MatrixXd& A,
+                             base::MatrixXd& U,
+                             base::VectorXd& S,
+                             base::MatrixXd& V,
+                             int max_sweeps,
+                             double epsilon){
+
+    const int rows = A.rows();
+    const int cols = A.cols();
+    if(V.rows() != cols || V.cols() != cols)
+        V.setIdentity(cols, cols);
+
+    // B = A*V, stored in U
+    U.noalias() = A * V;
+    S.resize(cols);
+
+    // Columns with a norm at the level of the rounding errors are numerically zero and are not rotated anymore
+    const double tiny = 1e-30 * std::max(A.squaredNorm(), 1e-300);
+
+    int sweeps = 0;
+    bool rotated = true;
+    while(rotated){
+        if(sweeps == max_sweeps)
+            return -2;
+        rotated = false;
+        for(int i = 0; i < cols-1; i++){
+            for(int j = i+1; j < cols; j++){
+                const double alpha = U.col(i).squaredNorm();
+                const double beta = U.col(j).squaredNorm();
+                const double gamma = U.col(i).dot(U.col(j));
+                if(alpha <= tiny || beta <= tiny || fabs(gamma) <= epsilon * sqrt(alpha * beta))
+                    continue;
+
+                // Rotation that makes the columns i and j orthogonal
+                const double zeta = (beta - alpha) / (2.0 * gamma);
+                const double t = SIGN(1.0, zeta) / (fabs(zeta) + sqrt(1.0 + zeta * zeta));
+                const double c = 1.0 / sqrt(1.0 + t * t);
+                const double s = c * t;
+                for(int k = 0; k < rows; k++){
+                    const double ui = U(k,i), uj = U(k,j);
+                    U(k,i) = c * ui - s * uj;
+                    U(k,j) = s * ui + c * uj;
+                }
+                for(int k = 0; k < cols; k++){
+                    const double vi = V(k,i), vj = V(k,j);
+                    V(k,i) = c * vi - s * vj;
+                    V(k,j) = s * vi + c * vj;
+                }
+                rotated = true;
+            }
+        }
+        sweeps++;
+    }
+
+    // Singular values are the norms of the orthogonal columns
+    for(int i = 0; i < cols; i++){
+        S(i) = U.col(i).norm();
+        if(S(i) > 0)
+            U.col(i) /= S(i);
+    }
+
+    // Sort singular values in descending order
+    for(int i = 0; i < cols; i++){
+        int i_max = i;
+        for(int j = i+1; j < cols; j++){
+            if(S(j) > S(i_max))
+                i_max = j;
+        }
+        if(i_max != i){
+            std::swap(S(i), S(i_max));
+            U.col(i).swap(U.col(i_max));
+            V.col(i).swap(V.col(i_max));
+        }
+    }
+    return sweeps;
+}
+
 } // namespace wbc
@@ -58,6 +58,26 @@ int svd_eigen_decomposition(const base::MatrixXd& A,
                             int maxiter=150,
                             double epsilon=1e-300);
 
+/**
+ * @brief One-sided Jacobi SVD (Hestenes, see also Maciejewski, Klein, "SVD computation using a sequence of plane rotations" and KDL's svd_eigen_Macie) of a m x n matrix A = U*diag(S)*V^T.
+ *  The columns of B = A*V are orthogonalized by plane rotations, which are accumulated in V. V is used as initial guess: If A changes only slightly
+ *  between two calls, e.g., in a control loop, passing the V of the previous call reduces the number of sweeps to one or two. Singular values are sorted in descending order.
+ *  No memory is allocated if U, S and V have the correct size.
+ * @param A Input matrix (m x n)
+ * @param U Left singular vectors (m x n). Columns belonging to zero singular values are zero
+ * @param S Singular values (n)
+ * @param V Right singular vectors (n x n). Initial guess on input, has to be orthogonal, e.g. identity or the result of a previous call
+ * @param max_sweeps Maximum number of sweeps over all column pairs
+ * @param epsilon Two columns are considered orthogonal if the cosine of the angle between them is below epsilon
+ * @return Number of sweeps or -2 if the algorithm did not converge within max_sweeps
+ */
+int svd_jacobi_decomposition(const base::MatrixXd& A,
+                             base::MatrixXd& U,
+                             base::VectorXd& S,
+                             base::MatrixXd& V,
+                             int max_sweeps=30,
+                             double epsilon=1e-12);
+
 }
 
 #endif // SVD_DECOMPOSITION_HPP
@@ -0,0 +1,59 @@
+#ifndef WBC_TRIPLE_BUFFER_HPP
+#define WBC_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+namespace wbc {
+
+/**
+ * @brief Lock-free single-producer/single-consumer mailbox for exchanging the most recent value of type T between two threads. The producer writes to its private
+ *  slot (see write()) and publishes it (see publish()), the consumer takes over the most recently published slot (see fetch()) and reads it (see read()). Both sides
+ *  only exchange a slot index atomically, so neither of them ever blocks or waits for the other one, and the consumer always sees a completely written value.
+ *  Values that are published faster than they are fetched are overwritten, i.e., the consumer only gets the latest one. All three slots are initialized with the
+ *  given value, so that no memory is allocated on publish() and fetch() if T keeps its size.
+ *  Only one thread may act as producer and only one as consumer at the same time.
+ */
+template<typename T> class TripleBuffer{
+public:
+    explicit TripleBuffer(const T& init = T()) :
+        slots{init, init, init},
+        write_idx(0),
+        read_idx(1),
+        middle(2){
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /** @brief Producer: Return the private slot of the producer. Its content is undefined, i.e., it may contain any previously published value*/
+    T& write(){return slots[write_idx];}
+
+    /** @brief Producer: Publish the value written to write(). Afterwards write() refers to a different slot*/
+    void publish(){
+        write_idx = middle.exchange(write_idx | new_data, std::memory_order_acq_rel) & index_mask;
+    }
+
+    /** @brief Consumer: Take over the most recently published value, if there is a new one. Return true in this case, otherwise read() is unchanged*/
+    bool fetch(){
+        if(!(middle.load(std::memory_order_relaxed) & new_data))
+            return false;
+        read_idx = middle.exchange(read_idx, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    /** @brief Consumer: Return the value taken over in the last successful call of fetch(), or the initial value*/
+    const T& read() const {return slots[read_idx];}
+
+protected:
+    static const unsigned int index_mask = 3;
+    static const unsigned int new_data = 4;    /** Set in middle if the middle slot has been published, but not fetched yet*/
+
+    T slots[3];
+    unsigned int write_idx;                    /** Slot owned by the producer*/
+    unsigned int read_idx;                     /** Slot owned by the consumer*/
+    std::atomic<unsigned int> middle;          /** Index of the slot in between, plus the new_data flag*/
+};
+
+} // namespace wbc
+
+#endif
@@ -0,0 +1,144 @@
+#include "WorkerPool.hpp"
+#include <base-logging/Logging.hpp>
+#include <stdexcept>
+#include <string.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace wbc {
+
+/** Hint to the CPU that we are in a busy-wait loop*/
+static inline void cpuRelax(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+WorkerPool::WorkerPool(unsigned int n_threads, const std::vector<int>& cores) :
+    function(nullptr),
+    context(nullptr),
+    n_items(0),
+    next_item(0),
+    n_busy(0),
+    epoch(0),
+    n_parked(0),
+    stop(false),
+    spin_iterations(20000){
+
+    if(n_threads == 0)
+        throw std::invalid_argument("WorkerPool: Number of threads has to be > 0");
+
+    workers.reserve(n_threads-1);
+    for(unsigned int i = 1; i < n_threads; i++){
+        const int core = i-1 < cores.size() ? cores[i-1] : -1;
+        workers.emplace_back(&WorkerPool::workerLoop, this, i, core);
+    }
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        epoch++;
+    }
+    cv.notify_all();
+    for(std::thread& t : workers)
+        t.join();
+}
+
+void WorkerPool::run(unsigned int n, Function f, void* ctx){
+
+    if(workers.empty() || n <= 1){
+        for(unsigned int i = 0; i < n; i++)
+            f(ctx, i, 0);
+        return;
+    }
+
+    function = f;
+    context = ctx;
+    n_items = n;
+    next_item.store(0, std::memory_order_relaxed);
+    n_busy.store(workers.size(), std::memory_order_relaxed);
+
+    // Publish the job. Parked workers have to be woken up, the others will see the new epoch while spinning. Since both the epoch and n_parked are
+    // sequentially consistent, a worker that is about to park either sees the new epoch or is counted in n_parked here
+    epoch.fetch_add(1);
+    if(n_parked.load() > 0){
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_all();
+    }
+
+    work(0);
+
+    // The items are short, so busy waiting for the remaining workers is cheaper than parking the calling thread
+    while(n_busy.load(std::memory_order_acquire) > 0)
+        cpuRelax();
+
+    if(exception){
+        std::exception_ptr e = exception;
+        exception = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void WorkerPool::work(unsigned int thread){
+    for(unsigned int i = next_item.fetch_add(1, std::memory_order_relaxed); i < n_items; i = next_item.fetch_add(1, std::memory_order_relaxed)){
+        try{
+            function(context, i, thread);
+        }
+        catch(...){
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if(!exception)
+                exception = std::current_exception();
+        }
+    }
+}
+
+void WorkerPool::workerLoop(unsigned int thread, int core){
+
+#ifdef __linux__
+    if(core >= 0){
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core, &cpu_set);
+        const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+        if(err != 0)
+            LOG_WARN("WorkerPool: Unable to pin worker thread %i to core %i: %s", thread, core, strerror(err));
+    }
+#else
+    if(core >= 0)
+        LOG_WARN("WorkerPool: Pinning threads to cores is not supported on this platform");
+#endif
+
+    unsigned long seen_epoch = 0;
+    while(true){
+
+        // Spin for a while, then park
+        const unsigned int n_spin = spin_iterations.load(std::memory_order_relaxed);
+        unsigned long current_epoch = epoch.load(std::memory_order_acquire);
+        for(unsigned int k = 0; current_epoch == seen_epoch && k < n_spin; k++){
+            cpuRelax();
+            current_epoch = epoch.load(std::memory_order_acquire);
+        }
+        if(current_epoch == seen_epoch){
+            std::unique_lock<std::mutex> lock(mutex);
+            n_parked++;
+            cv.wait(lock, [&]{return epoch.load() != seen_epoch;});
+            n_parked--;
+            current_epoch = epoch.load();
+        }
+        seen_epoch = current_epoch;
+
+        if(stop)
+            return;
+
+        work(thread);
+        n_busy.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+} // namespace wbc
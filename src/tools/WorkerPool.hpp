@@ -0,0 +1,88 @@
+#ifndef WBC_WORKER_POOL_HPP
+#define WBC_WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wbc {
+
+/**
+ * @brief Persistent pool of worker threads for fork-join parallelism inside the control loop. All threads are created in the constructor, so that no threads
+ *  are created or destroyed in the control cycle. On each call of parallelFor(), the workers spin for a short time before they park on a condition variable,
+ *  which keeps the handoff latency low if the pool is used in every cycle, without burning CPU time if it is idle. The calling thread participates in the work.
+ *  parallelFor() does not allocate memory and must not be called from several threads at the same time.
+ */
+class WorkerPool{
+public:
+    /**
+     * @brief Create the worker threads
+     * @param n_threads Total number of threads including the calling thread of parallelFor(), i.e., n_threads-1 worker threads are created. Has to be > 0.
+     * @param cores Optional: CPU cores to pin the worker threads to, one entry per worker thread. Workers without an entry or with a negative entry are not pinned.
+     *  The calling thread is never pinned.
+     */
+    WorkerPool(unsigned int n_threads, const std::vector<int>& cores = std::vector<int>());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Call f(i, thread) for all i in [0,n) and return once all calls have finished. The items are distributed dynamically among all threads, thread is
+     *  the index of the executing thread in [0,nThreads()), 0 being the calling thread. It can be used to index per-thread buffers. If any call throws, the
+     *  first exception is rethrown here after all other items have been processed.
+     */
+    template<typename F> void parallelFor(unsigned int n, F& f){
+        run(n, &invoke<F>, &f);
+    }
+
+    /** @brief Return the total number of threads, including the calling thread*/
+    unsigned int nThreads() const {return workers.size() + 1;}
+
+    /** @brief Set the number of iterations the workers busy-wait for new work before they park on the condition variable. Default is 20000, which is in the order of some tens of microseconds*/
+    void setSpinIterations(unsigned int n){spin_iterations.store(n, std::memory_order_relaxed);}
+
+    /** @brief Return the number of iterations the workers busy-wait for new work, see setSpinIterations()*/
+    unsigned int getSpinIterations() const {return spin_iterations.load(std::memory_order_relaxed);}
+
+protected:
+    typedef void (*Function)(void* context, unsigned int i, unsigned int thread);
+
+    template<typename F> static void invoke(void* context, unsigned int i, unsigned int thread){
+        (*static_cast<F*>(context))(i, thread);
+    }
+
+    /** Publish the job, process items on the calling thread and wait for the workers*/
+    void run(unsigned int n, Function function, void* context);
+    /** Main loop of the worker threads*/
+    void workerLoop(unsigned int thread, int core);
+    /** Process items of the current job until there are no items left*/
+    void work(unsigned int thread);
+
+    std::vector<std::thread> workers;
+
+    // Current job. Written by the calling thread before the epoch is incremented, read-only for the workers afterwards
+    Function function;
+    void* context;
+    unsigned int n_items;
+
+    std::atomic<unsigned int> next_item;     /** Next item of the current job that has not been claimed yet*/
+    std::atomic<unsigned int> n_busy;        /** Number of workers that have not finished the current job*/
+    std::atomic<unsigned long> epoch;        /** Incremented for every new job. Workers compare it with the last epoch they processed*/
+    std::atomic<int> n_parked;               /** Number of workers waiting on the condition variable*/
+    std::atomic<bool> stop;
+    std::atomic<unsigned int> spin_iterations;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    std::mutex exception_mutex;
+    std::exception_ptr exception;            /** First exception thrown by any item of the current job*/
+};
+
+} // namespace wbc
+
+#endif
@@ -4,6 +4,8 @@
 #include <core/RobotModel.hpp>
 #include <core/QPSolver.hpp>
 #include <core/Scene.hpp>
+#include <tools/WorkerPool.hpp>
+#include <tools/TripleBuffer.hpp>
 
 using namespace std;
 using namespace wbc;
@@ -90,8 +92,9 @@ BOOST_AUTO_TEST_CASE(robot_model_factory){
 BOOST_AUTO_TEST_CASE(qp_solver_factory){
     BOOST_CHECK_NO_THROW(PluginLoader::loadPlugin("libwbc-solvers-qpoases.so"));
     QPSolverFactory::QPSolverMap *qp_solver_map = QPSolverFactory::getQPSolverMap();
-    BOOST_CHECK(qp_solver_map->size() == 1);
+    BOOST_CHECK(qp_solver_map->size() == 2);
     BOOST_CHECK(qp_solver_map->count("qpoases") == 1);
+    BOOST_CHECK(qp_solver_map->count("scaled_qp") == 1); // Scaling wrapper, part of wbc-core
     BOOST_CHECK(qp_solver_map->at("qpoases") != 0);
     QPSolver* model;
     BOOST_CHECK_NO_THROW(model = QPSolverFactory::createInstance("qpoases"));
@@ -111,3 +114,93 @@ BOOST_AUTO_TEST_CASE(scene_factory){
     BOOST_CHECK(scene != 0);
 }
 
+
+BOOST_AUTO_TEST_CASE(worker_pool){
+
+    /**
+     * Check that every item is processed exactly once, the thread index is valid and exceptions are propagated to the caller
+     */
+
+    BOOST_CHECK_THROW(WorkerPool(0), std::invalid_argument);
+
+    WorkerPool pool(4);
+    BOOST_CHECK(pool.nThreads() == 4);
+
+    const unsigned int n = 1000;
+    vector<atomic<int>> count(n);
+    vector<atomic<int>> items_per_thread(pool.nThreads());
+    atomic<bool> thread_valid(true);
+    auto f = [&](unsigned int i, unsigned int thread){
+        count[i]++;
+        if(thread >= pool.nThreads())
+            thread_valid = false;
+        else
+            items_per_thread[thread]++;
+    };
+
+    // Repeated calls, with and without parking the workers in between
+    for(int k = 0; k < 100; k++){
+        for(auto &c : count) c = 0;
+        BOOST_CHECK_NO_THROW(pool.parallelFor(n, f));
+        for(uint i = 0; i < n; i++)
+            BOOST_CHECK(count[i] == 1);
+        if(k == 50)
+            pool.setSpinIterations(0);
+    }
+    BOOST_CHECK(thread_valid);
+    int total = 0;
+    for(auto &c : items_per_thread) total += c;
+    BOOST_CHECK(total == 100*n);
+
+    auto g = [&](unsigned int i, unsigned int thread){
+        if(i == 7)
+            throw std::runtime_error("Item failed");
+        count[i] = 2;
+    };
+    BOOST_CHECK_THROW(pool.parallelFor(n, g), std::runtime_error);
+    for(uint i = 0; i < n; i++){
+        if(i != 7)
+            BOOST_CHECK(count[i] == 2);
+    }
+
+    // The pool has to remain usable after an exception
+    for(auto &c : count) c = 0;
+    BOOST_CHECK_NO_THROW(pool.parallelFor(n, f));
+    for(uint i = 0; i < n; i++)
+        BOOST_CHECK(count[i] == 1);
+}
+
+BOOST_AUTO_TEST_CASE(triple_buffer){
+
+    /**
+     * The consumer must only see completely written values, in the order they have been published, and finally the last published value
+     */
+
+    TripleBuffer<base::VectorXd> buffer(base::VectorXd::Zero(100));
+    BOOST_CHECK(!buffer.fetch());
+    BOOST_CHECK(buffer.read() == base::VectorXd::Zero(100));
+
+    const int n = 100000;
+    thread producer([&](){
+        for(int k = 1; k <= n; k++){
+            buffer.write().setConstant(k);
+            buffer.publish();
+        }
+    });
+
+    bool consistent = true, ordered = true;
+    double last = 0;
+    while(last < n){
+        if(!buffer.fetch())
+            continue;
+        const base::VectorXd& v = buffer.read();
+        consistent &= (v.array() == v[0]).all();
+        ordered &= v[0] > last;
+        last = v[0];
+    }
+    producer.join();
+    BOOST_CHECK(consistent);
+    BOOST_CHECK(ordered);
+    BOOST_CHECK(!buffer.fetch());
+    BOOST_CHECK(buffer.read()[0] == n);
+}
@@ -0,0 +1,237 @@
+#include <boost/test/unit_test.hpp>
+#include "core/QPScaling.hpp"
+#include "core/ScaledQPSolver.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+#include "solvers/qpoases/QPOasesSolver.hpp"
+
+using namespace wbc;
+using namespace std;
+
+base::Matrix6d taskJacobian(){
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    return A;
+}
+
+base::Vector6d taskReference(){
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    return y;
+}
+
+/** Badly scaled QP with one equality, inequality constraints with one-sided, two-sided and infinite bounds and bounds*/
+QuadraticProgram badlyScaledQP(bool sparse){
+    base::Matrix6d J = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    base::MatrixXd A(1,6), C(3,6);
+    A << 1e3, 0, 0, 0, 0, -1e3;
+    C << 0, 1e-2, 0, 0, 0, 0,
+         0, 0, 0, 1e2, 1e2, 0,
+         1, 0, 1, 0, 0, 0;
+
+    QuadraticProgram qp;
+    qp.resize(6, 1, 3, true, sparse);
+    qp.H = J.transpose()*J;
+    qp.H.row(2) *= 1e2;
+    qp.H.col(2) *= 1e2;
+    qp.g = -(J.transpose()*y);
+    qp.b << 1e2;
+    qp.lower_y << -QP_INFINITE_BOUND, -30, -QP_INFINITE_BOUND;
+    qp.upper_y << 3e-3, 30, QP_INFINITE_BOUND;
+    qp.lower_x.setConstant(-0.8);
+    qp.upper_x.setConstant(0.8);
+    qp.upper_x[5] = QP_INFINITE_BOUND;
+    if(sparse){
+        qp.A_sparse = A.sparseView();
+        qp.C_sparse = C.sparseView();
+    }
+    else{
+        qp.A = A;
+        qp.C = C;
+    }
+    qp.check();
+    return qp;
+}
+
+QPSolverPtr makeQPOasesSolver(){
+    std::shared_ptr<QPOASESSolver> solver = std::make_shared<QPOASESSolver>();
+    qpOASES::Options options = solver->getOptions();
+    options.printLevel = qpOASES::PL_NONE;
+    solver->setOptions(options);
+    solver->setMaxNoWSR(1000);
+    return solver;
+}
+
+BOOST_AUTO_TEST_CASE(qp_scaling_sparse){
+    /**
+     * Dense and sparse problems have to give the same scaling factors and the same scaled problem
+     */
+
+    QuadraticProgram qp_dense = badlyScaledQP(false);
+    QuadraticProgram qp_sparse = badlyScaledQP(true);
+
+    for(QPScaling::Method method : {QPScaling::jacobi, QPScaling::ruiz}){
+        QPScaling scaling_dense, scaling_sparse;
+        scaling_dense.setMethod(method);
+        scaling_sparse.setMethod(method);
+        QuadraticProgram qp_dense_scaled, qp_sparse_scaled;
+        scaling_dense.scale(qp_dense, qp_dense_scaled);
+        scaling_sparse.scale(qp_sparse, qp_sparse_scaled);
+
+        BOOST_CHECK(qp_sparse_scaled.sparse);
+        BOOST_CHECK(scaling_dense.variableScaling().isApprox(scaling_sparse.variableScaling()));
+        BOOST_CHECK(scaling_dense.constraintScaling().isApprox(scaling_sparse.constraintScaling()));
+        BOOST_CHECK(fabs(scaling_dense.costScaling() - scaling_sparse.costScaling()) < 1e-12);
+        BOOST_CHECK(qp_dense_scaled.H.isApprox(qp_sparse_scaled.H));
+        BOOST_CHECK(qp_dense_scaled.A.isApprox(base::MatrixXd(qp_sparse_scaled.A_sparse)));
+        BOOST_CHECK(qp_dense_scaled.C.isApprox(base::MatrixXd(qp_sparse_scaled.C_sparse)));
+        BOOST_CHECK(qp_dense_scaled.lower_y == qp_sparse_scaled.lower_y);
+        BOOST_CHECK(qp_dense_scaled.upper_y == qp_sparse_scaled.upper_y);
+        BOOST_CHECK(qp_dense_scaled.lower_x == qp_sparse_scaled.lower_x);
+        BOOST_CHECK(qp_dense_scaled.upper_x == qp_sparse_scaled.upper_x);
+
+        // Scaled problem: E*[A;C]*D
+        const base::VectorXd& D = scaling_dense.variableScaling();
+        const base::VectorXd& E = scaling_dense.constraintScaling();
+        BOOST_CHECK(qp_dense_scaled.C.isApprox(E.tail(3).asDiagonal() * qp_dense.C * D.asDiagonal()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(qp_scaling_bounds){
+    /**
+     * Infinite bounds have to remain infinite and finite bounds finite, even if they exceed QP_INFINITE_BOUND after scaling
+     */
+
+    QuadraticProgram qp = badlyScaledQP(false);
+    qp.upper_y[1] = 0.5 * QP_INFINITE_BOUND;  // Large, finite bound on a row with small entries, i.e., with large row scaling
+    qp.C.row(1) *= 1e-4;
+    qp.check();
+
+    QPScaling scaling;
+    QuadraticProgram qp_scaled;
+    scaling.scale(qp, qp_scaled);
+    const base::VectorXd& D = scaling.variableScaling();
+    const base::VectorXd E_C = scaling.constraintScaling().tail(3);
+    BOOST_CHECK(E_C[1] > 2);
+
+    for(int i = 0; i < 3; i++){
+        for(auto bounds : {make_pair(qp.lower_y[i], qp_scaled.lower_y[i]), make_pair(qp.upper_y[i], qp_scaled.upper_y[i])}){
+            if(fabs(bounds.first) >= QP_INFINITE_BOUND)
+                BOOST_CHECK(bounds.second == bounds.first);
+            else{
+                BOOST_CHECK(fabs(bounds.second) < QP_INFINITE_BOUND);
+                if(fabs(E_C[i] * bounds.first) < QP_INFINITE_BOUND)
+                    BOOST_CHECK(fabs(bounds.second - E_C[i] * bounds.first) < 1e-9 * std::max(1.0, fabs(bounds.second)));
+            }
+        }
+    }
+    BOOST_CHECK(qp_scaled.upper_y[1] > 0.99 * QP_INFINITE_BOUND);
+    BOOST_CHECK(qp_scaled.upper_x[5] == QP_INFINITE_BOUND);
+    for(int j = 0; j < 5; j++)
+        BOOST_CHECK(fabs(qp_scaled.upper_x[j] - qp.upper_x[j] / D[j]) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(scaled_qp_solver_admm)
+{
+    /**
+     * Solve a badly scaled problem, which is obtained from a well scaled one by substituting x = S*x', with and without scaling stage. Both solutions
+     * have to match the one of the well scaled problem and the scaled problem must not require more iterations
+     */
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+    base::Vector6d s;
+    s << 1e2, 1, 1e-1, 1e2, 1, 1e-1;
+    base::Matrix6d S_inv = s.cwiseInverse().asDiagonal();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 1, 0, true);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+    qp.A = 1e3*A.row(0);
+    qp.b.setConstant(1e3*y[0]);
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(+0.4);
+    qp.upper_x[5] = QP_INFINITE_BOUND;
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+    ADMMSolver solver_ref;
+    base::VectorXd x_ref;
+    BOOST_CHECK_NO_THROW(solver_ref.solve(hqp, x_ref));
+
+    hqp[0].H = S_inv*qp.H*S_inv;
+    hqp[0].g = S_inv*qp.g;
+    hqp[0].A = qp.A*S_inv;
+    hqp[0].lower_x = s.cwiseProduct(qp.lower_x);
+    hqp[0].upper_x = s.cwiseProduct(qp.upper_x);
+    hqp[0].upper_x[5] = QP_INFINITE_BOUND;
+
+    for(QPScaling::Method method : {QPScaling::jacobi, QPScaling::ruiz}){
+        std::shared_ptr<ADMMSolver> admm = std::make_shared<ADMMSolver>();
+        ADMMSolver admm_unscaled;
+        admm->setMaxIter(20000);
+        admm_unscaled.setMaxIter(20000);
+        ScaledQPSolver solver(admm, method);
+        base::VectorXd solver_output, solver_output_unscaled;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        BOOST_CHECK_NO_THROW(admm_unscaled.solve(hqp, solver_output_unscaled));
+        BOOST_CHECK(solver.getStats().n_iter <= admm_unscaled.getStats().n_iter);
+        BOOST_CHECK(solver.getScaling().variableScaling().size() == 6);
+
+        // The primal residual refers to the original problem
+        BOOST_CHECK(solver.getStats().primal_residual >= std::abs(hqp[0].A.row(0).dot(solver_output) - hqp[0].b[0]));
+        BOOST_CHECK(solver.getStats().primal_residual < 1e-3);
+
+        for(uint j = 0; j < 6; ++j){
+            BOOST_CHECK(fabs(solver_output(j)/s[j] - x_ref(j)) < 1e-3);
+            BOOST_CHECK(fabs(solver_output_unscaled(j)/s[j] - x_ref(j)) < 1e-3);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scaled_qp_solver_qpoases)
+{
+    /**
+     * The unscaled solution of the scaled problem has to match the solution of the original problem, also with an active set solver and if the wrapper
+     * is created as plugin
+     */
+
+    QuadraticProgram qp = badlyScaledQP(false);
+    HierarchicalQP hqp;
+    hqp << qp;
+
+    QPSolverPtr solver_ref = makeQPOasesSolver();
+    base::VectorXd x_ref;
+    BOOST_CHECK_NO_THROW(solver_ref->solve(hqp, x_ref));
+
+    std::shared_ptr<ScaledQPSolver> solver_plugin;
+    BOOST_CHECK_NO_THROW(solver_plugin.reset(QPSolverFactory::createInstance<ScaledQPSolver>("scaled_qp")));
+    BOOST_CHECK(solver_plugin != nullptr);
+    BOOST_CHECK(solver_plugin->getSolverType() == "qpoases");
+    BOOST_CHECK(solver_plugin->getSolver() != nullptr);
+    BOOST_CHECK(!solver_plugin->sparseInput());
+
+    for(QPScaling::Method method : {QPScaling::jacobi, QPScaling::ruiz}){
+        ScaledQPSolver solver(makeQPOasesSolver(), method);
+        base::VectorXd solver_output;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        BOOST_CHECK(solver_output.size() == 6);
+        for(uint j = 0; j < 6; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - x_ref(j)) < 1e-6);
+
+        solver_plugin->getScaling().setMethod(method);
+        solver_plugin->reset();
+        BOOST_CHECK_NO_THROW(solver_plugin->solve(hqp, solver_output));
+        for(uint j = 0; j < 6; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - x_ref(j)) < 1e-6);
+    }
+}
@@ -145,6 +145,32 @@ BOOST_AUTO_TEST_CASE(body_jacobian){
     testBodyJacobian(robot_model, tip_frame, false);
 }
 
+BOOST_AUTO_TEST_CASE(chain_ids){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelHyrodyn>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.submechanism_file = "../../../../models/kuka/hyrodyn/kuka_iiwa_floating_base.yml";
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testChainIds(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(raw_update){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelHyrodyn>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.submechanism_file = "../../../../models/kuka/hyrodyn/kuka_iiwa_floating_base.yml";
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testRawUpdate(robot_model, tip_frame);
+}
+
 BOOST_AUTO_TEST_CASE(com_jacobian){
     string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
     string tip_frame = "kuka_lbr_l_tcp";
@@ -231,3 +257,29 @@ BOOST_AUTO_TEST_CASE(compare_serial_vs_hybrid_model){
     for(int i = 0; i < robot_model_hybrid.noOfActuatedJoints(); i++)
         BOOST_CHECK(fabs(robot_model_hybrid.hyrodynHandle()->yd[i] - yd[i]) < 1e-6);
 }
+
+BOOST_AUTO_TEST_CASE(workspaces){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelHyrodyn>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.submechanism_file = "../../../../models/kuka/hyrodyn/kuka_iiwa_floating_base.yml";
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testWorkspaces(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(batch){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelHyrodyn>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.submechanism_file = "../../../../models/kuka/hyrodyn/kuka_iiwa_floating_base.yml";
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testBatch(robot_model, tip_frame);
+}
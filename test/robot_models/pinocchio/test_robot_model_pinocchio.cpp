@@ -120,6 +120,30 @@ BOOST_AUTO_TEST_CASE(body_jacobian){
     testBodyJacobian(robot_model, tip_frame, false);
 }
 
+BOOST_AUTO_TEST_CASE(chain_ids){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testChainIds(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(raw_update){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testRawUpdate(robot_model, tip_frame);
+}
+
 BOOST_AUTO_TEST_CASE(com_jacobian){
     string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
     string tip_frame = "kuka_lbr_l_tcp";
@@ -144,3 +168,27 @@ BOOST_AUTO_TEST_CASE(dynamics){
     testDynamics(robot_model, false);
 
 }
+
+BOOST_AUTO_TEST_CASE(workspaces){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testWorkspaces(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(batch){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelPinocchio>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testBatch(robot_model, tip_frame);
+}
@@ -114,6 +114,30 @@ BOOST_AUTO_TEST_CASE(body_jacobian){
     testBodyJacobian(robot_model, tip_frame, false);
 }
 
+BOOST_AUTO_TEST_CASE(chain_ids){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testChainIds(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(raw_update){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testRawUpdate(robot_model, tip_frame);
+}
+
 BOOST_AUTO_TEST_CASE(com_jacobian){
     string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
     string tip_frame = "kuka_lbr_l_tcp";
@@ -138,3 +162,45 @@ BOOST_AUTO_TEST_CASE(dynamics){
     testDynamics(robot_model, false);
 
 }
+
+BOOST_AUTO_TEST_CASE(workspaces){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testWorkspaces(robot_model, tip_frame);
+}
+
+BOOST_AUTO_TEST_CASE(batch){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testBatch(robot_model, tip_frame);
+}
+
+/** RBDL robot model without workspaces, to test the sequential evaluation of batches on the robot model itself*/
+class RobotModelRBDLNoWorkspaces : public RobotModelRBDL{
+public:
+    virtual bool supportsWorkspaces() const {return false;}
+};
+
+BOOST_AUTO_TEST_CASE(batch_without_workspaces){
+    string urdf_file = "../../../../models/kuka/urdf/kuka_iiwa.urdf";
+    string tip_frame = "kuka_lbr_l_tcp";
+
+    RobotModelPtr robot_model = make_shared<RobotModelRBDLNoWorkspaces>();
+    RobotModelConfig cfg(urdf_file);
+    cfg.floating_base = true;
+    BOOST_CHECK(robot_model->configure(cfg));
+
+    testBatch(robot_model, tip_frame);
+}
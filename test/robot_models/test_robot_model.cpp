@@ -1,5 +1,7 @@
 #include "test_robot_model.hpp"
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <thread>
 
 using namespace std;
 
@@ -259,4 +261,263 @@ void testDynamics(RobotModelPtr robot_model, bool verbose){
     }
 }
 
+void testChainIds(RobotModelPtr robot_model, const string &tip_frame){
+
+    const ChainId chain = robot_model->chainId(robot_model->worldFrame(), tip_frame);
+    BOOST_CHECK_EQUAL(robot_model->chainId(robot_model->worldFrame(), tip_frame), chain);
+    BOOST_CHECK(robot_model->chainRoot(chain) == robot_model->worldFrame());
+    BOOST_CHECK(robot_model->chainTip(chain) == tip_frame);
+    BOOST_CHECK_THROW(robot_model->rigidBodyState(chain+1), std::invalid_argument);
+
+    // Id based queries have to give the same results as the frame name based queries, also after several updates
+    for(int n = 0; n < 3; n++){
+        base::samples::Joints joint_state_in = makeRandomJointState(robot_model->actuatedJointNames());
+        base::samples::RigidBodyStateSE3 floating_base_state_in = makeRandomFloatingBaseState();
+        BOOST_CHECK_NO_THROW(robot_model->update(joint_state_in, floating_base_state_in));
+
+        base::samples::RigidBodyStateSE3 rbs = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+        base::samples::RigidBodyStateSE3 rbs_id = robot_model->rigidBodyState(chain);
+        BOOST_CHECK(rbs.pose.position.isApprox(rbs_id.pose.position));
+        BOOST_CHECK(rbs.pose.orientation.coeffs().isApprox(rbs_id.pose.orientation.coeffs()));
+        BOOST_CHECK(rbs.twist.linear.isApprox(rbs_id.twist.linear));
+        BOOST_CHECK(rbs.twist.angular.isApprox(rbs_id.twist.angular));
+
+        base::MatrixXd Js = robot_model->spaceJacobian(robot_model->worldFrame(), tip_frame);
+        BOOST_CHECK(Js.isApprox(robot_model->spaceJacobian(chain)));
+        base::MatrixXd Jb = robot_model->bodyJacobian(robot_model->worldFrame(), tip_frame);
+        BOOST_CHECK(Jb.isApprox(robot_model->bodyJacobian(chain)));
+
+        base::Acceleration acc_bias = robot_model->spatialAccelerationBias(robot_model->worldFrame(), tip_frame);
+        base::Acceleration acc_bias_id = robot_model->spatialAccelerationBias(chain);
+        BOOST_CHECK((acc_bias.linear - acc_bias_id.linear).norm() < 1e-9);
+        BOOST_CHECK((acc_bias.angular - acc_bias_id.angular).norm() < 1e-9);
+    }
+}
+
+void testRawUpdate(RobotModelPtr robot_model, const string &tip_frame){
+
+    // Use a permuted joint order to check the index mapping
+    vector<string> order = robot_model->jointOrder();
+    reverse(order.begin(), order.end());
+    BOOST_CHECK_NO_THROW(robot_model->setJointOrder(order));
+    BOOST_CHECK(robot_model->jointOrder() == order);
+
+    vector<string> invalid_order(order.begin(), order.end()-1);
+    BOOST_CHECK_THROW(robot_model->setJointOrder(invalid_order), std::invalid_argument);
+    invalid_order = order;
+    invalid_order[0] = invalid_order[1];
+    BOOST_CHECK_THROW(robot_model->setJointOrder(invalid_order), std::invalid_argument);
+    BOOST_CHECK(robot_model->jointOrder() == order);
+
+    const uint n = order.size();
+    BOOST_CHECK_THROW(robot_model->update(base::VectorXd::Zero(n+1), base::VectorXd::Zero(n), base::VectorXd::Zero(n), base::Time::now()), std::runtime_error);
+
+    // The raw update has to give exactly the same results as the named update
+    for(int k = 0; k < 3; k++){
+        base::samples::Joints joint_state_in = makeRandomJointState(order);
+        base::samples::RigidBodyStateSE3 floating_base_state_in = makeRandomFloatingBaseState();
+        base::VectorXd q(n), qd(n), qdd(n);
+        for(uint i = 0; i < n; i++){
+            q[i] = joint_state_in.elements[i].position;
+            qd[i] = joint_state_in.elements[i].speed;
+            qdd[i] = joint_state_in.elements[i].acceleration;
+        }
+
+        robot_model->update(joint_state_in, floating_base_state_in);
+        base::VectorXd q_named, qd_named, qdd_named;
+        robot_model->systemState(q_named, qd_named, qdd_named);
+        base::samples::RigidBodyStateSE3 rbs_named = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+        base::MatrixXd Js_named = robot_model->spaceJacobian(robot_model->worldFrame(), tip_frame);
+        base::MatrixXd Jb_named = robot_model->bodyJacobian(robot_model->worldFrame(), tip_frame);
+        base::Acceleration acc_bias_named = robot_model->spatialAccelerationBias(robot_model->worldFrame(), tip_frame);
+        base::MatrixXd H_named = robot_model->jointSpaceInertiaMatrix();
+        base::VectorXd h_named = robot_model->biasForces();
+
+        robot_model->update(q, qd, qdd, joint_state_in.time, floating_base_state_in);
+        base::VectorXd q_raw, qd_raw, qdd_raw;
+        robot_model->systemState(q_raw, qd_raw, qdd_raw);
+        BOOST_CHECK(q_raw == q_named);
+        BOOST_CHECK(qd_raw == qd_named);
+        BOOST_CHECK(qdd_raw == qdd_named);
+
+        const base::samples::RigidBodyStateSE3 &rbs_raw = robot_model->rigidBodyState(robot_model->worldFrame(), tip_frame);
+        BOOST_CHECK(rbs_raw.pose.position == rbs_named.pose.position);
+        BOOST_CHECK(rbs_raw.pose.orientation.coeffs() == rbs_named.pose.orientation.coeffs());
+        BOOST_CHECK(rbs_raw.twist.linear == rbs_named.twist.linear);
+        BOOST_CHECK(rbs_raw.twist.angular == rbs_named.twist.angular);
+        BOOST_CHECK(robot_model->spaceJacobian(robot_model->worldFrame(), tip_frame) == Js_named);
+        BOOST_CHECK(robot_model->bodyJacobian(robot_model->worldFrame(), tip_frame) == Jb_named);
+        const base::Acceleration &acc_bias_raw = robot_model->spatialAccelerationBias(robot_model->worldFrame(), tip_frame);
+        BOOST_CHECK(acc_bias_raw.linear == acc_bias_named.linear);
+        BOOST_CHECK(acc_bias_raw.angular == acc_bias_named.angular);
+        BOOST_CHECK(robot_model->jointSpaceInertiaMatrix() == H_named);
+        BOOST_CHECK(robot_model->biasForces() == h_named);
+    }
+}
+
+void testWorkspaces(RobotModelPtr robot_model, const string &tip_frame){
+
+    BOOST_CHECK(robot_model->supportsWorkspaces());
+
+    // Permuted joint order, to check that the workspaces use the joint order of the robot model
+    vector<string> order = robot_model->jointOrder();
+    reverse(order.begin(), order.end());
+    robot_model->setJointOrder(order);
+    const uint n = order.size();
+
+    const ChainId chain = robot_model->chainId(robot_model->worldFrame(), tip_frame);
+    const uint n_threads = 4;
+    vector<RobotModelWorkspacePtr> workspaces;
+    for(uint i = 0; i < n_threads; i++)
+        workspaces.push_back(robot_model->createWorkspace());
+    BOOST_CHECK(workspaces[0]->noOfChains() == uint(chain+1));
+    BOOST_CHECK_THROW(workspaces[0]->rigidBodyState(chain), std::runtime_error);
+
+    // Chains that are created after the workspace are unknown to it
+    const ChainId base_chain = robot_model->chainId(robot_model->worldFrame(), robot_model->baseFrame());
+    BOOST_CHECK_THROW(workspaces[0]->rigidBodyState(base_chain), std::invalid_argument);
+
+    // Reference results of the robot model
+    const uint n_states = 20;
+    vector<base::VectorXd> q(n_states), qd(n_states), qdd(n_states);
+    vector<base::samples::RigidBodyStateSE3> fb(n_states), rbs(n_states), com(n_states);
+    vector<base::MatrixXd> Js(n_states), Jb(n_states), Jcom(n_states), H(n_states);
+    vector<base::VectorXd> h(n_states);
+    vector<base::Acceleration> acc_bias(n_states);
+    for(uint k = 0; k < n_states; k++){
+        base::samples::Joints joint_state = makeRandomJointState(order);
+        q[k].resize(n); qd[k].resize(n); qdd[k].resize(n);
+        for(uint i = 0; i < n; i++){
+            q[k][i] = joint_state.elements[i].position;
+            qd[k][i] = joint_state.elements[i].speed;
+            qdd[k][i] = joint_state.elements[i].acceleration;
+        }
+        fb[k] = makeRandomFloatingBaseState();
+        robot_model->update(q[k], qd[k], qdd[k], joint_state.time, fb[k]);
+        rbs[k] = robot_model->rigidBodyState(chain);
+        Js[k] = robot_model->spaceJacobian(chain);
+        Jb[k] = robot_model->bodyJacobian(chain);
+        acc_bias[k] = robot_model->spatialAccelerationBias(chain);
+        Jcom[k] = robot_model->comJacobian();
+        com[k] = robot_model->centerOfMass();
+        H[k] = robot_model->jointSpaceInertiaMatrix();
+        h[k] = robot_model->biasForces();
+    }
+
+    // Evaluate all states in parallel, each thread uses its own workspace. Boost test macros are not thread safe, so only store the results here
+    vector<int> ok(n_states, 0);
+    vector<thread> threads;
+    for(uint t = 0; t < n_threads; t++){
+        threads.emplace_back([&, t](){
+            RobotModelWorkspace& ws = *workspaces[t];
+            for(uint k = t; k < n_states; k += n_threads){
+                ws.update(q[k], qd[k], qdd[k], fb[k]);
+                const double eps = 1e-9;
+                const base::samples::RigidBodyStateSE3& ws_rbs = ws.rigidBodyState(chain);
+                const base::Acceleration& ws_acc_bias = ws.spatialAccelerationBias(chain);
+                ok[k] = (ws_rbs.pose.position - rbs[k].pose.position).norm() < eps &&
+                        (ws_rbs.pose.orientation.coeffs() - rbs[k].pose.orientation.coeffs()).norm() < eps &&
+                        (ws_rbs.twist.linear - rbs[k].twist.linear).norm() < eps &&
+                        (ws_rbs.twist.angular - rbs[k].twist.angular).norm() < eps &&
+                        (ws_rbs.acceleration.linear - rbs[k].acceleration.linear).norm() < eps &&
+                        (ws_rbs.acceleration.angular - rbs[k].acceleration.angular).norm() < eps &&
+                        (ws.spaceJacobian(chain) - Js[k]).norm() < eps &&
+                        (ws.bodyJacobian(chain) - Jb[k]).norm() < eps &&
+                        (ws_acc_bias.linear - acc_bias[k].linear).norm() < eps &&
+                        (ws_acc_bias.angular - acc_bias[k].angular).norm() < eps &&
+                        (ws.comJacobian() - Jcom[k]).norm() < eps &&
+                        (ws.centerOfMass().pose.position - com[k].pose.position).norm() < eps &&
+                        (ws.jointSpaceInertiaMatrix() - H[k]).norm() < eps &&
+                        (ws.biasForces() - h[k]).norm() < eps;
+            }
+        });
+    }
+    for(thread& t : threads)
+        t.join();
+    for(uint k = 0; k < n_states; k++)
+        BOOST_CHECK(ok[k] == 1);
+
+    BOOST_CHECK_THROW(workspaces[0]->update(base::VectorXd::Zero(n+1), base::VectorXd::Zero(n), base::VectorXd::Zero(n), fb[0]), std::runtime_error);
+}
+
+void testBatch(RobotModelPtr robot_model, const string &tip_frame){
+
+    const vector<string> order = robot_model->jointOrder();
+    const uint n = order.size();
+    const uint nj = robot_model->noOfJoints();
+    const ChainId chain = robot_model->chainId(robot_model->worldFrame(), tip_frame);
+
+    BatchRequest request;
+    request.quantities = batch_pose | batch_space_jacobian | batch_body_jacobian | batch_com | batch_com_jacobian | batch_inertia | batch_bias_forces;
+    request.chains = {chain};
+    request.floating_base_state = makeRandomFloatingBaseState();
+
+    const uint n_configs = 50;
+    base::MatrixXd Q(n, n_configs);
+    for(uint k = 0; k < n_configs; k++){
+        base::samples::Joints joint_state = makeRandomJointState(order);
+        for(uint i = 0; i < n; i++)
+            Q(i,k) = joint_state.elements[i].position;
+    }
+
+    // Sequential and parallel evaluation have to give the same results as the robot model itself
+    for(uint n_threads : {1, 3}){
+        robot_model->setBatchThreads(n_threads);
+
+        // The batch must not change the state of the robot model
+        base::samples::Joints joint_state = makeRandomJointState(robot_model->actuatedJointNames());
+        base::samples::RigidBodyStateSE3 fb_state = makeRandomFloatingBaseState();
+        robot_model->update(joint_state, fb_state);
+        const base::samples::Joints joint_state_before = robot_model->jointState(robot_model->jointNames());
+        const base::samples::RigidBodyStateSE3 fb_state_before = robot_model->floatingBaseState();
+
+        BatchResult result;
+        robot_model->evaluateBatch(Q, request, result);
+
+        const base::samples::Joints& joint_state_after = robot_model->jointState(robot_model->jointNames());
+        for(uint i = 0; i < nj; i++){
+            BOOST_CHECK(joint_state_after.elements[i].position == joint_state_before.elements[i].position);
+            BOOST_CHECK(joint_state_after.elements[i].speed == joint_state_before.elements[i].speed);
+            BOOST_CHECK(joint_state_after.elements[i].acceleration == joint_state_before.elements[i].acceleration);
+        }
+        BOOST_CHECK(robot_model->floatingBaseState().pose.position == fb_state_before.pose.position);
+        BOOST_CHECK(robot_model->floatingBaseState().pose.orientation.coeffs() == fb_state_before.pose.orientation.coeffs());
+
+        BOOST_CHECK(result.positions.size() == 1 && result.positions[0].cols() == n_configs);
+        BOOST_CHECK(result.space_jacobians[0].rows() == 6 && result.space_jacobians[0].cols() == nj*n_configs);
+        BOOST_CHECK(result.inertia_matrices.rows() == nj && result.inertia_matrices.cols() == nj*n_configs);
+
+        base::samples::RigidBodyStateSE3 fb = request.floating_base_state;
+        fb.twist.linear.setZero();
+        fb.twist.angular.setZero();
+        fb.acceleration.linear.setZero();
+        fb.acceleration.angular.setZero();
+        fb.time = base::Time::now();
+        const base::VectorXd zero = base::VectorXd::Zero(n);
+        const double eps = 1e-9;
+        for(uint k = 0; k < n_configs; k++){
+            robot_model->update(Q.col(k), zero, zero, fb.time, fb);
+            const base::samples::RigidBodyStateSE3& rbs = robot_model->rigidBodyState(chain);
+            BOOST_CHECK((result.positions[0].col(k) - rbs.pose.position).norm() < eps);
+            BOOST_CHECK((result.orientations[0].col(k) - rbs.pose.orientation.coeffs()).norm() < eps);
+            BOOST_CHECK((result.space_jacobians[0].middleCols(k*nj,nj) - robot_model->spaceJacobian(chain)).norm() < eps);
+            BOOST_CHECK((result.body_jacobians[0].middleCols(k*nj,nj) - robot_model->bodyJacobian(chain)).norm() < eps);
+            BOOST_CHECK((result.com.col(k) - robot_model->centerOfMass().pose.position).norm() < eps);
+            BOOST_CHECK((result.com_jacobians.middleCols(k*nj,nj) - robot_model->comJacobian()).norm() < eps);
+            BOOST_CHECK((result.inertia_matrices.middleCols(k*nj,nj) - robot_model->jointSpaceInertiaMatrix()).norm() < eps);
+            BOOST_CHECK((result.bias_forces.col(k) - robot_model->biasForces()).norm() < eps);
+        }
+    }
+
+    // Only the requested quantities are allocated
+    request.quantities = batch_com;
+    BatchResult result;
+    robot_model->evaluateBatch(Q, request, result);
+    BOOST_CHECK(result.com.cols() == n_configs);
+    BOOST_CHECK(result.positions.empty() && result.inertia_matrices.size() == 0);
+
+    BOOST_CHECK_THROW(robot_model->evaluateBatch(base::MatrixXd::Zero(n+1, 2), request, result), std::invalid_argument);
+    BOOST_CHECK_THROW(robot_model->setBatchThreads(0), std::invalid_argument);
+}
+
 }
@@ -14,5 +14,9 @@ void testSpaceJacobian(RobotModelPtr robot_model, const std::string &tip_frame,
 void testBodyJacobian(RobotModelPtr robot_model, const std::string &tip_frame, bool verbose=false);
 void testCoMJacobian(RobotModelPtr robot_model, bool verbose=false);
 void testDynamics(RobotModelPtr robot_model, bool verbose);
+void testChainIds(RobotModelPtr robot_model, const std::string &tip_frame);
+void testRawUpdate(RobotModelPtr robot_model, const std::string &tip_frame);
+void testWorkspaces(RobotModelPtr robot_model, const std::string &tip_frame);
+void testBatch(RobotModelPtr robot_model, const std::string &tip_frame);
 }
 #endif
@@ -0,0 +1,124 @@
+#include <boost/test/unit_test.hpp>
+#include "allocation_audit.hpp"
+
+/**
+ * Allocation audit: Replace malloc & friends by counting wrappers around the glibc implementation. Since the test executable exports these symbols, they
+ * also replace the allocation functions of all shared libraries (wbc, Eigen in wbc, libstdc++'s operator new, ...). This catches every heap allocation, unlike
+ * EIGEN_RUNTIME_NO_MALLOC, which only works for code that was compiled with that flag.
+ */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool count_allocations = false;
+static size_t n_allocations = 0;
+
+extern "C" void* malloc(size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size){
+    if(count_allocations)
+        n_allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+namespace wbc {
+
+void startAllocationCount(){
+    n_allocations = 0;
+    count_allocations = true;
+}
+
+size_t stopAllocationCount(){
+    count_allocations = false;
+    return n_allocations;
+}
+
+static const int n_warmup_cycles = 3;
+static const int n_test_cycles = 100;
+
+std::shared_ptr<RobotModelRBDL> makeKUKAIiwa(){
+    std::shared_ptr<RobotModelRBDL> robot_model = std::make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    BOOST_CHECK(robot_model->configure(config));
+    return robot_model;
+}
+
+std::shared_ptr<RobotModelRBDL> makeRH5Legs(){
+    std::shared_ptr<RobotModelRBDL> robot_model = std::make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    wbc::ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    config.contact_points.elements = {contact, contact};
+    BOOST_CHECK(robot_model->configure(config));
+    return robot_model;
+}
+
+void updateRobotModel(RobotModelPtr robot_model, double q){
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = q;
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+    robot_model->update(joint_state, rbs);
+}
+
+void checkAllocations(Scene& scene, const TaskConfig& cfg, SolveAllocations check_solve){
+    BOOST_CHECK(scene.configure({cfg}));
+    TaskHandle handle = scene.getTaskHandle(cfg.name);
+    base::VectorXd ref(cfg.nVariables());
+    ref.setConstant(0.01);
+
+    size_t n_solve_first = 0;
+    for(int i = 0; i < n_warmup_cycles + n_test_cycles; i++){
+        updateRobotModel(scene.getRobotModel(), 0.1 + i*1e-3);
+        scene.setReference(handle, ref);
+
+        if(i >= n_warmup_cycles)
+            startAllocationCount();
+        const HierarchicalQP& hqp = scene.update();
+        size_t n_update = stopAllocationCount();
+
+        if(i >= n_warmup_cycles && check_solve != solve_not_checked)
+            startAllocationCount();
+        scene.solve(hqp);
+        size_t n_solve = stopAllocationCount();
+
+        if(i < n_warmup_cycles)
+            continue;
+        BOOST_CHECK_EQUAL(n_update, 0);
+        if(i == n_warmup_cycles)
+            n_solve_first = n_solve;
+        if(check_solve == solve_no_allocations)
+            BOOST_CHECK_EQUAL(n_solve, 0);
+        else if(check_solve == solve_constant_allocations)
+            BOOST_CHECK_EQUAL(n_solve, n_solve_first);
+    }
+}
+
+}
@@ -0,0 +1,27 @@
+#ifndef ALLOCATION_AUDIT_HPP
+#define ALLOCATION_AUDIT_HPP
+
+#include "robot_models/rbdl/RobotModelRBDL.hpp"
+#include "core/Scene.hpp"
+
+namespace wbc {
+
+/** What to check for the heap allocations of Scene::solve(), see checkAllocations()*/
+enum SolveAllocations{solve_not_checked,            /** Only check Scene::update()*/
+                      solve_no_allocations,         /** Scene::solve() must not allocate*/
+                      solve_constant_allocations};  /** Scene::solve() must allocate the same number of times in each cycle. For solver backends that allocate internally*/
+
+/** Start counting all heap allocations of the test executable*/
+void startAllocationCount();
+/** Stop counting and return the number of heap allocations since startAllocationCount()*/
+size_t stopAllocationCount();
+
+std::shared_ptr<RobotModelRBDL> makeKUKAIiwa();
+std::shared_ptr<RobotModelRBDL> makeRH5Legs();
+void updateRobotModel(RobotModelPtr robot_model, double q);
+
+/** Run a couple of warm-up cycles, then count the allocations of Scene::update() and Scene::solve() in steady state. Scene::update() must never allocate*/
+void checkAllocations(Scene& scene, const TaskConfig& cfg, SolveAllocations check_solve);
+
+}
+#endif
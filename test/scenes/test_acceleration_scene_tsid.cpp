@@ -2,6 +2,7 @@
 #include "robot_models/rbdl/RobotModelRBDL.hpp"
 #include "scenes/acceleration_tsid/AccelerationSceneTSID.hpp"
 #include "solvers/qpoases/QPOasesSolver.hpp"
+#include "test_contact_switching.hpp"
 
 using namespace std;
 using namespace wbc;
@@ -90,3 +91,256 @@ BOOST_AUTO_TEST_CASE(simple_test){
         BOOST_CHECK(fabs(status[0].y_ref[i+3] - status[0].y_solution[i+3]) < 1e3);
     }
 }
+
+/** Solver stub that requests sparse quadratic programs. Only used to check the QP generation of the scene*/
+class SparseInputSolver : public QPSolver{
+public:
+    virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output){}
+    virtual bool sparseInput() const {return true;}
+};
+
+BOOST_AUTO_TEST_CASE(sparse_qp){
+
+    /**
+     * Check if the sparse QP generated by the WBC scene is the same as the dense one
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    wbc::ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    config.contact_points.elements = {contact, contact};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = 0.1;
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+    TaskConfig cart_task("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+
+    AccelerationSceneTSID scene_dense(robot_model, std::make_shared<QPOASESSolver>(), 1e-3);
+    AccelerationSceneTSID scene_sparse(robot_model, std::make_shared<SparseInputSolver>(), 1e-3);
+    BOOST_CHECK_EQUAL(scene_dense.configure({cart_task}), true);
+    BOOST_CHECK_EQUAL(scene_sparse.configure({cart_task}), true);
+
+    // Run two cycles to check that the sparse matrices are correctly refilled
+    for(int n = 0; n < 2; n++){
+        const QuadraticProgram& qp_dense = scene_dense.update()[0];
+        const QuadraticProgram& qp_sparse = scene_sparse.update()[0];
+
+        BOOST_CHECK(!qp_dense.sparse);
+        BOOST_CHECK(qp_sparse.sparse);
+        BOOST_CHECK(qp_sparse.hasSize(qp_dense.nq, qp_dense.neq, qp_dense.nin, qp_dense.bounded, true));
+        BOOST_CHECK(base::MatrixXd(qp_sparse.A_sparse) == qp_dense.A);
+        BOOST_CHECK(base::MatrixXd(qp_sparse.C_sparse) == qp_dense.C);
+        BOOST_CHECK(qp_sparse.b == qp_dense.b);
+        BOOST_CHECK(qp_sparse.lower_y == qp_dense.lower_y);
+        BOOST_CHECK(qp_sparse.upper_y == qp_dense.upper_y);
+        BOOST_CHECK(qp_sparse.lower_x == qp_dense.lower_x);
+        BOOST_CHECK(qp_sparse.upper_x == qp_dense.upper_x);
+        BOOST_CHECK(qp_sparse.H == qp_dense.H);
+
+        // Friction cones: one 16x6 block per contact
+        BOOST_CHECK_EQUAL(qp_sparse.C_sparse.nonZeros(), 2*16*6);
+    }
+}
+
+void checkConstraintsEqual(const QuadraticProgram& qp, const QuadraticProgram& qp_ref){
+    BOOST_CHECK(qp.hasSize(qp_ref.nq, qp_ref.neq, qp_ref.nin, qp_ref.bounded, qp_ref.sparse));
+    if(qp_ref.sparse){
+        BOOST_CHECK(base::MatrixXd(qp.A_sparse) == base::MatrixXd(qp_ref.A_sparse));
+        BOOST_CHECK(base::MatrixXd(qp.C_sparse) == base::MatrixXd(qp_ref.C_sparse));
+    }
+    else{
+        BOOST_CHECK(qp.A == qp_ref.A);
+        BOOST_CHECK(qp.C == qp_ref.C);
+    }
+    BOOST_CHECK(qp.b == qp_ref.b);
+    BOOST_CHECK(qp.lower_y == qp_ref.lower_y);
+    BOOST_CHECK(qp.upper_y == qp_ref.upper_y);
+    BOOST_CHECK(qp.lower_x == qp_ref.lower_x);
+    BOOST_CHECK(qp.upper_x == qp_ref.upper_x);
+}
+
+BOOST_AUTO_TEST_CASE(constraint_structure_update){
+
+    /**
+     * The constraints only write their state dependent entries to the QP in every cycle, the constant entries are only written if the structure changes.
+     * Check if the incrementally updated QP is the same as the one generated by a newly configured scene, after changing the robot state, the contact
+     * parameters and the number of contacts
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    wbc::ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    config.contact_points.elements = {contact, contact};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    joint_state.elements.resize(robot_model->noOfActuatedJoints());
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+
+    auto updateRobotModel = [&](double q){
+        for(base::JointState& js : joint_state.elements){
+            js.position = q;
+            js.speed = js.acceleration = 0;
+        }
+        joint_state.time = rbs.time = base::Time::now();
+        robot_model->update(joint_state,rbs);
+    };
+
+    TaskConfig cart_task("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+
+    for(bool sparse : {false, true}){
+        QPSolverPtr solver = sparse ? QPSolverPtr(std::make_shared<SparseInputSolver>()) : QPSolverPtr(std::make_shared<QPOASESSolver>());
+        BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+        updateRobotModel(0.1);
+
+        AccelerationSceneTSID scene(robot_model, solver, 1e-3);
+        BOOST_CHECK_EQUAL(scene.configure({cart_task}), true);
+        scene.update();
+
+        // Change of the robot state: Only the numeric phase is executed
+        uint structure_counter = robot_model->structureCounter();
+        updateRobotModel(0.2);
+        const QuadraticProgram& qp = scene.update()[0];
+        AccelerationSceneTSID scene_ref(robot_model, solver, 1e-3);
+        BOOST_CHECK_EQUAL(scene_ref.configure({cart_task}), true);
+        checkConstraintsEqual(qp, scene_ref.update()[0]);
+
+        // Switching a contact on or off does not change the structure
+        ActiveContacts contacts = robot_model->getActiveContacts();
+        contacts[1].active = 0;
+        robot_model->setActiveContacts(contacts);
+        BOOST_CHECK_EQUAL(robot_model->structureCounter(), structure_counter);
+
+        // Changing the friction coefficient changes the constant friction cones
+        contacts[1].mu = 0.8;
+        robot_model->setActiveContacts(contacts);
+        BOOST_CHECK(robot_model->structureCounter() != structure_counter);
+        updateRobotModel(0.3);
+        const QuadraticProgram& qp_mu = scene.update()[0];
+        AccelerationSceneTSID scene_ref_mu(robot_model, solver, 1e-3);
+        BOOST_CHECK_EQUAL(scene_ref_mu.configure({cart_task}), true);
+        checkConstraintsEqual(qp_mu, scene_ref_mu.update()[0]);
+
+        // Changing the number of contacts changes the size of the QP
+        contacts.names.pop_back();
+        contacts.elements.pop_back();
+        robot_model->setActiveContacts(contacts);
+        updateRobotModel(0.4);
+        const QuadraticProgram& qp_nc = scene.update()[0];
+        AccelerationSceneTSID scene_ref_nc(robot_model, solver, 1e-3);
+        BOOST_CHECK_EQUAL(scene_ref_nc.configure({cart_task}), true);
+        const QuadraticProgram& qp_nc_ref = scene_ref_nc.update()[0];
+        BOOST_CHECK_EQUAL(qp_nc.nq, robot_model->noOfJoints() + robot_model->noOfActuatedJoints() + 6);
+        checkConstraintsEqual(qp_nc, qp_nc_ref);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cost_function_active_columns){
+
+    /**
+     * The scenes assemble the cost function only on the active columns of each task. Check if all non-zero task matrix columns are active and if
+     * the resulting cost function is the same as the one computed with the complete task matrices
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    config.contact_points.elements = {wbc::ActiveContact(1,0.6), wbc::ActiveContact(1,0.6)};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(auto n : robot_model->actuatedJointNames()){
+        base::JointState js;
+        js.position = 0.1;
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    joint_state.time = rbs.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+    std::vector<TaskConfig> task_config = {TaskConfig("body", 0, "world", "RH5_Root_Link", "world", 1),
+                                           TaskConfig("left_foot", 0, "world", "FL_SupportCenter", "RH5_Root_Link", 1, {1,2,3,4,5,6}),
+                                           TaskConfig("right_knee", 0, {"LRKnee", "LRHip3"}, {0.5, 2}, 0.5)};
+
+    QPSolverPtr solver = std::make_shared<QPOASESSolver>();
+    AccelerationSceneTSID scene(robot_model, solver, 1e-3);
+    BOOST_CHECK_EQUAL(scene.configure(task_config), true);
+
+    JointWeights joint_weights = scene.getJointWeights();
+    for(uint i = 0; i < joint_weights.size(); i++)
+        joint_weights.elements[i] = 1.0 / (i+1);
+    scene.setJointWeights(joint_weights);
+
+    for(const auto& cfg : task_config){
+        base::VectorXd ref = base::VectorXd::Random(cfg.nVariables());
+        scene.setReference(scene.getTaskHandle(cfg.name), ref);
+    }
+    const QuadraticProgram& qp = scene.update()[0];
+
+    uint nj = robot_model->noOfJoints();
+    base::MatrixXd H = base::MatrixXd::Zero(nj,nj);
+    base::VectorXd g = base::VectorXd::Zero(nj);
+    for(const auto& cfg : task_config){
+        TaskPtr task = scene.getTask(cfg.name);
+        BOOST_CHECK(task->active_cols.size() < nj);
+        for(uint j = 0; j < nj; j++){
+            if(std::find(task->active_cols.begin(), task->active_cols.end(), j) == task->active_cols.end())
+                BOOST_CHECK(task->A.col(j).isZero());
+        }
+
+        base::MatrixXd Aw = task->activation * task->weights_root.asDiagonal() * task->A *
+                            base::VectorXd::Map(joint_weights.elements.data(), nj).asDiagonal();
+        H += Aw.transpose()*Aw;
+        g -= Aw.transpose()*task->y_ref_root;
+    }
+    H.diagonal().array() += scene.getHessianRegularizer();
+
+    BOOST_CHECK(qp.H.topLeftCorner(nj,nj).isApprox(H, 1e-12));
+    BOOST_CHECK(qp.g.head(nj).isApprox(g, 1e-12));
+    BOOST_CHECK(qp.H.isApprox(qp.H.transpose()));
+}
+
+BOOST_AUTO_TEST_CASE(contact_switching){
+    QPSolverPtr solver = std::make_shared<QPOASESSolver>();
+    dynamic_pointer_cast<QPOASESSolver>(solver)->setMaxNoWSR(1000);
+    testContactSwitching(solver);
+}
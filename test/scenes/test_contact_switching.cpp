@@ -0,0 +1,88 @@
+#include <boost/test/unit_test.hpp>
+#include "test_contact_switching.hpp"
+#include "robot_models/rbdl/RobotModelRBDL.hpp"
+#include "scenes/acceleration_tsid/AccelerationSceneTSID.hpp"
+
+using namespace std;
+
+namespace wbc {
+
+void testContactSwitching(QPSolverPtr solver){
+
+    /**
+     * Switch the contacts at runtime. Without fixed contact set, the size of the QP changes and the solver has to re-initialize. With fixed contact set,
+     * the size of the QP and the structure of the robot model do not change and the wrench of the removed contact is pinned to zero
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    wbc::ActiveContact contact(1,0.6);
+    contact.wx = 0.2;
+    contact.wy = 0.08;
+    config.contact_points.elements = {contact, contact};
+
+    vector<double> q_in = {0,0,-0.35,0.64,0,-0.27,
+                           0,0,-0.35,0.64,0,-0.27};
+    base::samples::Joints joint_state;
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+
+    ActiveContacts single_contact;
+    single_contact.names = {"FL_SupportCenter"};
+    single_contact.elements = {contact};
+
+    TaskConfig cart_task("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+
+    for(bool fixed : {false, true}){
+        BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+        joint_state.names = robot_model->actuatedJointNames();
+        joint_state.elements.resize(robot_model->noOfActuatedJoints());
+        for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+            joint_state[i].position = q_in[i];
+            joint_state[i].speed = joint_state[i].acceleration = 0;
+        }
+        joint_state.time = rbs.time = base::Time::now();
+        BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+        AccelerationSceneTSID scene(robot_model, solver, 1e-3);
+        scene.setFixedContactSet(fixed);
+        BOOST_CHECK_EQUAL(scene.configure({cart_task}), true);
+        BOOST_CHECK_NO_THROW(scene.solve(scene.update()));
+        const int nq = scene.update()[0].nq;
+        const uint structure_counter = robot_model->structureCounter();
+
+        // Remove one contact
+        robot_model->setActiveContacts(single_contact);
+        const HierarchicalQP& hqp = scene.update();
+        BOOST_CHECK_EQUAL(hqp[0].nq == nq, fixed);
+        BOOST_CHECK_NO_THROW(scene.solve(hqp));
+        BOOST_CHECK_EQUAL(robot_model->structureCounter() == structure_counter, fixed);
+        if(fixed){
+            BOOST_CHECK_EQUAL(robot_model->getActiveContacts().size(), 2);
+            BOOST_CHECK_EQUAL(robot_model->getActiveContacts()["FR_SupportCenter"].active, 0);
+            BOOST_CHECK(scene.getContactWrenches()["FR_SupportCenter"].force.norm() < 1e-6);
+            BOOST_CHECK(scene.getContactWrenches()["FR_SupportCenter"].torque.norm() < 1e-6);
+        }
+        else{
+            BOOST_CHECK_EQUAL(scene.getContactWrenches().size(), 1);
+            BOOST_CHECK_EQUAL(hqp[0].variable_blocks.size(), 3);
+            BOOST_CHECK_EQUAL(hqp[0].variable_blocks.back().name, "wrench_FL_SupportCenter");
+        }
+
+        // Add the contact again
+        robot_model->setActiveContacts(config.contact_points);
+        BOOST_CHECK_NO_THROW(scene.solve(scene.update()));
+        BOOST_CHECK_EQUAL(scene.update()[0].nq, nq);
+        BOOST_CHECK_EQUAL(scene.getContactWrenches().size(), 2);
+        if(fixed)
+            BOOST_CHECK_EQUAL(robot_model->structureCounter(), structure_counter);
+    }
+}
+
+}
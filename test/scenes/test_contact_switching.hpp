@@ -0,0 +1,9 @@
+#ifndef TEST_CONTACT_SWITCHING_HPP
+#define TEST_CONTACT_SWITCHING_HPP
+
+#include "core/QPSolver.hpp"
+
+namespace wbc {
+void testContactSwitching(QPSolverPtr solver);
+}
+#endif
@@ -0,0 +1,10 @@
+#include <boost/test/unit_test.hpp>
+#include "solvers/proxqp/ProxQPSolver.hpp"
+#include "test_contact_switching.hpp"
+
+using namespace std;
+using namespace wbc;
+
+BOOST_AUTO_TEST_CASE(contact_switching){
+    testContactSwitching(make_shared<ProxQPSolver>());
+}
@@ -0,0 +1,105 @@
+#include <boost/test/unit_test.hpp>
+#include "test_parallel_update.hpp"
+#include "scenes/velocity_qp/VelocitySceneQP.hpp"
+#include "solvers/qpoases/QPOasesSolver.hpp"
+
+using namespace std;
+
+namespace wbc {
+
+/** True if both have the same size and all entries are equal up to the given tolerance. Equal infinite bounds are considered equal*/
+template<typename T> static bool approxEqual(const T& a, const T& b, const double tol = 1e-9){
+    if(a.rows() != b.rows() || a.cols() != b.cols())
+        return false;
+    return (a.array() == b.array() || (a - b).array().abs() < tol).all();
+}
+
+void testParallelUpdate(RobotModelPtr robot_model, uint expected_threads){
+
+    /**
+     * Updating tasks and constraints in parallel has to give the same QP as the sequential update, also if the robot state changes between the updates
+     */
+
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    config.contact_points.elements = {ActiveContact(1,0.6),ActiveContact(1,0.6)};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    vector<double> q_in = {0,0,-0.35,0.64,0,-0.27,
+                           0,0,-0.35,0.64,0,-0.27};
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = q_in[i];
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+    // Several tasks on the same and on different chains
+    vector<TaskConfig> task_config = {TaskConfig("body", 0, "world", "RH5_Root_Link", "world", 1),
+                                      TaskConfig("body_local", 0, "world", "RH5_Root_Link", "RH5_Root_Link", 1),
+                                      TaskConfig("left_foot", 0, "world", "FL_SupportCenter", "RH5_Root_Link", 1),
+                                      TaskConfig("right_foot", 0, "world", "FR_SupportCenter", "RH5_Root_Link", 1),
+                                      TaskConfig("com", 0, {1,1,1}, 1),
+                                      TaskConfig("joints", 0, robot_model->actuatedJointNames(), vector<double>(robot_model->noOfActuatedJoints(),1), 1)};
+
+    // Both scenes share the same robot model
+    VelocitySceneQP scene_seq(robot_model, std::make_shared<QPOASESSolver>(), 1e-3);
+    VelocitySceneQP scene_par(robot_model, std::make_shared<QPOASESSolver>(), 1e-3);
+    BOOST_CHECK_EQUAL(scene_seq.configure(task_config), true);
+    BOOST_CHECK_EQUAL(scene_par.configure(task_config), true);
+    BOOST_CHECK(scene_par.getParallelUpdate() == 1);
+    BOOST_CHECK_THROW(scene_par.setParallelUpdate(0), std::invalid_argument);
+    BOOST_CHECK_NO_THROW(scene_par.setParallelUpdate(3));
+    BOOST_CHECK(scene_par.getParallelUpdate() == expected_threads);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1, 0, 0.05);
+    ref.twist.angular = base::Vector3d(0, 0.05, 0);
+    for(const TaskConfig& cfg : task_config){
+        if(cfg.type == cart){
+            BOOST_CHECK_NO_THROW(scene_seq.setReference(cfg.name, ref));
+            BOOST_CHECK_NO_THROW(scene_par.setReference(cfg.name, ref));
+        }
+    }
+
+    HierarchicalQP hqp_seq, hqp_par;
+    for(int k = 0; k < 10; k++){
+        for(uint i = 0; i < joint_state.size(); i++){
+            joint_state[i].position = q_in[i] + 0.01*k;
+            joint_state[i].speed = 0.1*k;
+        }
+        joint_state.time = rbs.time = base::Time::now();
+        rbs.pose.position[2] = 0.876 - 0.001*k;
+        BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+        // Update the parallel scene first, so that the worker threads compute all quantities themselves
+        BOOST_CHECK_NO_THROW(hqp_par = scene_par.update());
+        BOOST_CHECK_NO_THROW(hqp_seq = scene_seq.update());
+        BOOST_CHECK(approxEqual(hqp_par[0].H, hqp_seq[0].H));
+        BOOST_CHECK(approxEqual(hqp_par[0].g, hqp_seq[0].g));
+        BOOST_CHECK(approxEqual(hqp_par[0].A, hqp_seq[0].A));
+        BOOST_CHECK(approxEqual(hqp_par[0].b, hqp_seq[0].b));
+        BOOST_CHECK(approxEqual(hqp_par[0].lower_x, hqp_seq[0].lower_x));
+        BOOST_CHECK(approxEqual(hqp_par[0].upper_x, hqp_seq[0].upper_x));
+    }
+
+    BOOST_CHECK_NO_THROW(scene_par.setParallelUpdate(1));
+    BOOST_CHECK(scene_par.getParallelUpdate() == 1);
+}
+
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_PARALLEL_UPDATE_HPP
+#define TEST_PARALLEL_UPDATE_HPP
+
+#include "core/RobotModel.hpp"
+
+namespace wbc {
+void testParallelUpdate(RobotModelPtr robot_model, uint expected_threads);
+}
+#endif
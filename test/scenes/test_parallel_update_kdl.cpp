@@ -0,0 +1,10 @@
+#include <boost/test/unit_test.hpp>
+#include "robot_models/kdl/RobotModelKDL.hpp"
+#include "test_parallel_update.hpp"
+
+using namespace std;
+using namespace wbc;
+
+BOOST_AUTO_TEST_CASE(parallel_update){
+    testParallelUpdate(make_shared<RobotModelKDL>(), 3);
+}
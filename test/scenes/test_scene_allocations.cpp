@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+#include "allocation_audit.hpp"
+#include "scenes/velocity/VelocityScene.hpp"
+#include "scenes/velocity_qp/VelocitySceneQP.hpp"
+#include "scenes/acceleration/AccelerationScene.hpp"
+#include "scenes/acceleration_tsid/AccelerationSceneTSID.hpp"
+#include "scenes/acceleration_reduced_tsid/AccelerationSceneReducedTSID.hpp"
+#include "solvers/hls/HierarchicalLSSolver.hpp"
+#include "solvers/qpoases/QPOasesSolver.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+#include "solvers/kkt/KKTSolver.hpp"
+
+using namespace std;
+using namespace wbc;
+
+/** qpOASES allocates its working arrays in each hotstart, so only check that the number of allocations does not grow*/
+QPSolverPtr makeQPOasesSolver(){
+    QPSolverPtr solver = std::make_shared<QPOASESSolver>();
+    qpOASES::Options options = dynamic_pointer_cast<QPOASESSolver>(solver)->getOptions();
+    options.printLevel = qpOASES::PL_NONE;
+    dynamic_pointer_cast<QPOASESSolver>(solver)->setOptions(options);
+    return solver;
+}
+
+BOOST_AUTO_TEST_CASE(velocity_scene){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    VelocityScene scene(robot_model, solver, 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_no_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(velocity_scene_qp){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    VelocitySceneQP scene(robot_model, makeQPOasesSolver(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    AccelerationScene scene(robot_model, makeQPOasesSolver(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_tsid){
+    RobotModelPtr robot_model = makeRH5Legs();
+    AccelerationSceneTSID scene(robot_model, makeQPOasesSolver(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_reduced_tsid){
+    RobotModelPtr robot_model = makeRH5Legs();
+    AccelerationSceneReducedTSID scene(robot_model, makeQPOasesSolver(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(velocity_scene_qp_admm){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    VelocitySceneQP scene(robot_model, std::make_shared<ADMMSolver>(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_no_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_tsid_admm){
+    RobotModelPtr robot_model = makeRH5Legs();
+    AccelerationSceneTSID scene(robot_model, std::make_shared<ADMMSolver>(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+    checkAllocations(scene, cfg, solve_no_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_kkt){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    AccelerationScene scene(robot_model, std::make_shared<KKTSolver>(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_no_allocations);
+}
@@ -0,0 +1,23 @@
+#include <boost/test/unit_test.hpp>
+#include "allocation_audit.hpp"
+#include "scenes/velocity_qp/VelocitySceneQP.hpp"
+#include "scenes/acceleration_tsid/AccelerationSceneTSID.hpp"
+#include "solvers/proxqp/ProxQPSolver.hpp"
+
+using namespace std;
+using namespace wbc;
+
+// Allocations inside the prox-qp backend are not under our control, so only check that their number does not grow
+BOOST_AUTO_TEST_CASE(velocity_scene_qp){
+    RobotModelPtr robot_model = makeKUKAIiwa();
+    VelocitySceneQP scene(robot_model, std::make_shared<ProxQPSolver>(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
+
+BOOST_AUTO_TEST_CASE(acceleration_scene_tsid){
+    RobotModelPtr robot_model = makeRH5Legs();
+    AccelerationSceneTSID scene(robot_model, std::make_shared<ProxQPSolver>(), 1e-3);
+    TaskConfig cfg("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+    checkAllocations(scene, cfg, solve_constant_allocations);
+}
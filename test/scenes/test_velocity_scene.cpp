@@ -99,3 +99,82 @@ BOOST_AUTO_TEST_CASE(simple_test){
 
 
 
+
+BOOST_AUTO_TEST_CASE(task_handles){
+
+    /**
+     * Check if task handles address the correct tasks and if setting references via handle gives the same result as setting them by name
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    BOOST_CHECK(robot_model->configure(config));
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    VelocityScene wbc_scene(robot_model, solver, 1e-3);
+    TaskConfig cart_task("cart_pos_ctrl_left", 1, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    TaskConfig jnt_task("jnt_pos_ctrl", 0, robot_model->jointNames(), vector<double>(robot_model->noOfJoints(),1), 1);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, jnt_task}), true);
+
+    // Handles are given by the order in the task config
+    BOOST_CHECK_EQUAL(wbc_scene.getTaskHandle(cart_task.name), 0);
+    BOOST_CHECK_EQUAL(wbc_scene.getTaskHandle(jnt_task.name), 1);
+    BOOST_CHECK_THROW(wbc_scene.getTaskHandle("invalid"), std::invalid_argument);
+
+    TaskHandle cart_handle = wbc_scene.getTaskHandle(cart_task.name);
+    TaskHandle jnt_handle = wbc_scene.getTaskHandle(jnt_task.name);
+
+    // Invalid handles and wrong reference types
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1,0.2,0.3);
+    ref.twist.angular = base::Vector3d(0.01,0.02,0.03);
+    BOOST_CHECK_THROW(wbc_scene.setReference(2, ref), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.setReference(-1, ref), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.setReference(jnt_handle, ref), std::runtime_error);
+    BOOST_CHECK_THROW(wbc_scene.setReference(cart_handle, base::VectorXd(5)), std::invalid_argument);
+
+    // Raw reference has to be the same as the reference set by base types
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_handle, ref));
+    base::VectorXd y_ref = wbc_scene.getTask(cart_task.name)->y_ref;
+    base::VectorXd y_raw(6);
+    y_raw << 0.1,0.2,0.3,0.01,0.02,0.03;
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_handle, y_raw));
+    for(int i = 0; i < 6; i++)
+        BOOST_CHECK_EQUAL(wbc_scene.getTask(cart_task.name)->y_ref[i], y_ref[i]);
+
+    base::VectorXd jnt_ref(robot_model->noOfJoints());
+    jnt_ref.setConstant(0.1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(jnt_handle, jnt_ref));
+    BOOST_CHECK(wbc_scene.getTask(jnt_task.name)->y_ref == jnt_ref);
+
+    // Weights and activation
+    base::VectorXd weights(6);
+    weights << 1,1,1,0,0,0;
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskWeights(cart_handle, weights));
+    BOOST_CHECK(wbc_scene.getTask(cart_task.name)->weights == weights);
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskActivation(jnt_handle, 0.5));
+    BOOST_CHECK_EQUAL(wbc_scene.getTask(jnt_task.name)->activation, 0.5);
+    BOOST_CHECK_THROW(wbc_scene.setTaskActivation(jnt_handle, 1.5), std::invalid_argument);
+
+    // Task names have to be unique, independent of the priority and type of the tasks
+    TaskConfig cart_task_2("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_link_4", "kuka_lbr_l_link_0", 1);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, cart_task_2}), false);
+    BOOST_CHECK_THROW(wbc_scene.getTaskHandle(cart_task.name), std::invalid_argument);
+    jnt_task.name = cart_task.name;
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, jnt_task}), false);
+    BOOST_CHECK_THROW(wbc_scene.getTaskHandle(cart_task.name), std::invalid_argument);
+    cart_task_2.name = "cart_pos_ctrl_left_2";
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, cart_task_2}), true);
+    BOOST_CHECK_EQUAL(wbc_scene.getTaskHandle(cart_task_2.name), 1);
+}
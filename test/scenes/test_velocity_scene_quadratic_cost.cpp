@@ -2,6 +2,10 @@
 #include "robot_models/rbdl/RobotModelRBDL.hpp"
 #include "scenes/velocity_qp/VelocitySceneQP.hpp"
 #include "solvers/qpoases/QPOasesSolver.hpp"
+#include "solvers/cascaded/CascadedQPSolver.hpp"
+#include "core/ScaledQPSolver.hpp"
+#include "test_parallel_update.hpp"
+#include <thread>
 
 using namespace std;
 using namespace wbc;
@@ -88,3 +92,240 @@ BOOST_AUTO_TEST_CASE(simple_test){
         BOOST_CHECK(fabs(status[0].y_ref[i+3] - status[0].y_solution[i+3]) < 1e-3);
     }
 }
+
+BOOST_AUTO_TEST_CASE(multiple_priorities){
+
+    /**
+     * With a hierarchical QP solver, the task of the highest priority has to be achieved exactly, a conflicting joint space task on the lower priority must not disturb it
+     */
+
+    // Configure Robot model
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    config.contact_points.elements = {ActiveContact(1,0.6),ActiveContact(1,0.6)};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    vector<double> q_in = {0,0,-0.35,0.64,0,-0.27,
+                           0,0,-0.35,0.64,0,-0.27};
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = q_in[i];
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+    // Configure scene with two priorities
+    TaskConfig cart_task;
+    cart_task.type = cart;
+    cart_task.name = "cart_pos_ctrl";
+    cart_task.root = "world";
+    cart_task.tip = "RH5_Root_Link";
+    cart_task.ref_frame = "world";
+    cart_task.weights = {1,1,1,1,1,1};
+    cart_task.priority = 0;
+    cart_task.activation = 1;
+    TaskConfig jnt_task("jnt_pos_ctrl", 1, robot_model->actuatedJointNames(), vector<double>(robot_model->noOfActuatedJoints(),1), 1);
+
+    QPSolverPtr solver = std::make_shared<CascadedQPSolver>();
+    VelocitySceneQP wbc_scene(robot_model, solver, 1e-3);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task, jnt_task}), true);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1, 0, 0.05);
+    ref.twist.angular = base::Vector3d(0, 0.05, 0);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_task.name, ref));
+    base::VectorXd jnt_ref(robot_model->noOfActuatedJoints());
+    jnt_ref.setConstant(0.1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(wbc_scene.getTaskHandle(jnt_task.name), jnt_ref));
+
+    // Solve
+    HierarchicalQP hqp;
+    BOOST_CHECK_NO_THROW(hqp = wbc_scene.update());
+    BOOST_CHECK(hqp.size() == 2);
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(hqp));
+    BOOST_CHECK(solver->getStatus() == QPSolver::solved);
+
+    // Check
+    wbc_scene.updateTasksStatus();
+    TasksStatus status = wbc_scene.getTasksStatus();
+    for(int i = 0; i < 6; i++)
+        BOOST_CHECK(fabs(status[0].y_ref[i] - status[0].y_solution[i]) < 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(qp_scaling){
+
+    /**
+     * Enabling the scaling of the quadratic program must not change the scene output
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/rh5/urdf/rh5_legs.urdf";
+    config.floating_base = true;
+    config.contact_points.names = {"FL_SupportCenter", "FR_SupportCenter"};
+    config.contact_points.elements = {ActiveContact(1,0.6),ActiveContact(1,0.6)};
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    vector<double> q_in = {0,0,-0.35,0.64,0,-0.27,
+                           0,0,-0.35,0.64,0,-0.27};
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = q_in[i];
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    base::samples::RigidBodyStateSE3 rbs;
+    rbs.pose.position = base::Vector3d(-0.175,0,0.876);
+    rbs.pose.orientation.setIdentity();
+    rbs.twist.setZero();
+    rbs.acceleration.setZero();
+    rbs.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state,rbs));
+
+    std::shared_ptr<QPOASESSolver> solver = std::make_shared<QPOASESSolver>();
+    solver->setMaxNoWSR(1000);
+    qpOASES::Options options = solver->getOptions();
+    options.printLevel = qpOASES::PL_NONE;
+    solver->setOptions(options);
+
+    TaskConfig cart_task("cart_pos_ctrl", 0, "world", "RH5_Root_Link", "world", 1);
+    VelocitySceneQP wbc_scene(robot_model, solver, 1e-3);
+    BOOST_CHECK(wbc_scene.getQPScaling() == QPScaling::none);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_task}), true);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1, 0, 0.05);
+    ref.twist.angular = base::Vector3d(0, 0.05, 0);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_task.name, ref));
+
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(wbc_scene.update()));
+    base::VectorXd solver_output = wbc_scene.getSolverOutputRaw();
+
+    for(QPScaling::Method method : {QPScaling::jacobi, QPScaling::ruiz}){
+        wbc_scene.setQPScaling(method);
+        BOOST_CHECK(wbc_scene.getQPScaling() == method);
+        std::shared_ptr<ScaledQPSolver> scaled = dynamic_pointer_cast<ScaledQPSolver>(wbc_scene.getSolver());
+        BOOST_CHECK(scaled != nullptr);
+        BOOST_CHECK(scaled->getSolver() == solver);
+
+        BOOST_CHECK_NO_THROW(wbc_scene.solve(wbc_scene.update()));
+        BOOST_CHECK(wbc_scene.getSolverStats().status == QPSolver::solved);
+        for(int i = 0; i < solver_output.size(); i++)
+            BOOST_CHECK(fabs(wbc_scene.getSolverOutputRaw()[i] - solver_output[i]) < 1e-6);
+    }
+
+    // Disabling the scaling restores the original solver
+    wbc_scene.setQPScaling(QPScaling::none);
+    BOOST_CHECK(wbc_scene.getQPScaling() == QPScaling::none);
+    BOOST_CHECK(wbc_scene.getSolver() == solver);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_update){
+    testParallelUpdate(make_shared<RobotModelRBDL>(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(mailboxes){
+
+    /**
+     * Task inputs posted from another thread have to be applied in the next update, solver output and tasks status have to be readable from another thread
+     */
+
+    shared_ptr<RobotModelRBDL> robot_model = make_shared<RobotModelRBDL>();
+    RobotModelConfig config;
+    config.file_or_string = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->actuatedJointNames();
+    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
+        base::JointState js;
+        js.position = 0.1;
+        js.speed = js.acceleration = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    vector<TaskConfig> task_config = {TaskConfig("cart_pos_ctrl", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1)};
+    QPSolverPtr solver = std::make_shared<QPOASESSolver>();
+    VelocitySceneQP wbc_scene(robot_model, solver, 1e-3);
+    BOOST_CHECK_EQUAL(wbc_scene.configure(task_config), true);
+    const TaskHandle handle = wbc_scene.getTaskHandle("cart_pos_ctrl");
+
+    base::commands::Joints solver_output;
+    TasksStatus tasks_status;
+    BOOST_CHECK(!wbc_scene.readSolverOutput(solver_output));
+    BOOST_CHECK(!wbc_scene.readTasksStatus(tasks_status));
+
+    BOOST_CHECK_THROW(wbc_scene.postReference(handle, base::VectorXd::Zero(5)), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.postTaskWeights(handle, -base::VectorXd::Ones(6)), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.postTaskActivation(handle, 1.5), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.postTaskActivation(handle+1, 0.5), std::invalid_argument);
+
+    // Only the last posted inputs are applied
+    base::VectorXd ref(6), weights(6);
+    ref << 0.1, 0, 0.05, 0, 0.05, 0;
+    weights << 1, 1, 1, 0, 0, 0;
+    base::Time time = base::Time::now();
+    thread producer([&](){
+        wbc_scene.postReference(handle, base::VectorXd::Zero(6));
+        wbc_scene.postReference(handle, ref, time);
+        wbc_scene.postTaskWeights(handle, weights);
+        wbc_scene.postTaskActivation(handle, 0.5);
+    });
+    producer.join();
+
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    TaskPtr task = wbc_scene.getTask("cart_pos_ctrl");
+    BOOST_CHECK(task->y_ref == ref);
+    BOOST_CHECK(task->time.toMicroseconds() == time.toMicroseconds());
+    BOOST_CHECK(task->weights == weights);
+    BOOST_CHECK(task->activation == 0.5);
+
+    // Inputs set in the control thread are not overwritten as long as nothing new is posted
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskActivation(handle, 1.0));
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    BOOST_CHECK(task->activation == 1.0);
+
+    HierarchicalQP hqp;
+    wbc_scene.getHierarchicalQP(hqp);
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(hqp));
+    BOOST_CHECK_NO_THROW(wbc_scene.updateTasksStatus());
+
+    bool has_output = false, has_status = false;
+    thread consumer([&](){
+        has_output = wbc_scene.readSolverOutput(solver_output);
+        has_status = wbc_scene.readTasksStatus(tasks_status);
+    });
+    consumer.join();
+    BOOST_CHECK(has_output);
+    BOOST_CHECK(has_status);
+    BOOST_CHECK(solver_output.names == robot_model->actuatedJointNames());
+    for(uint i = 0; i < solver_output.size(); i++)
+        BOOST_CHECK(solver_output[i].speed == wbc_scene.getSolverOutput()[i].speed);
+    BOOST_CHECK(tasks_status["cart_pos_ctrl"].y_ref == wbc_scene.getTasksStatus()["cart_pos_ctrl"].y_ref);
+    BOOST_CHECK(tasks_status["cart_pos_ctrl"].weights == weights);
+
+    // Nothing new has been published since
+    BOOST_CHECK(!wbc_scene.readSolverOutput(solver_output));
+    BOOST_CHECK(!wbc_scene.readTasksStatus(tasks_status));
+}
@@ -0,0 +1,218 @@
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+
+using namespace wbc;
+using namespace std;
+
+base::Matrix6d taskJacobian(){
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    return A;
+}
+
+base::Vector6d taskReference(){
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    return y;
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_without_constraints)
+{
+    // Solve the problem min(||Ax-b||) without constraints --> encode the task as part of the cost function
+    // Standard form of QP is x^T*H*x + x^T*g --> Choose H = A^T*A and g = -(A^T*y)^T
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 0, 0, false);
+    qp.lower_x.resize(0);
+    qp.upper_x.resize(0);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+    qp.check();
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+
+    base::VectorXd test = A*solver_output;
+    for(uint j = 0; j < 6; j++)
+        BOOST_CHECK(fabs(test(j) - y(j)) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_with_equality_constraints)
+{
+    // Solve the problem min(||x||), subject Ax=b --> encode the task as constraint
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 6, 0, false);
+    qp.lower_x.resize(0);
+    qp.upper_x.resize(0);
+    qp.g.setZero();
+    qp.H.setIdentity();
+    qp.A = A;
+    qp.b = y;
+    qp.check();
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+
+    base::VectorXd test = A*solver_output;
+    for(uint j = 0; j < 6; j++)
+        BOOST_CHECK(fabs(test(j) - y(j)) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_bounded)
+{
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 0, 2, true);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+    qp.C.setZero();
+    qp.C(0,0) = qp.C(0,1) = 1;
+    qp.C(1,2) = qp.C(1,3) = 1;
+    qp.lower_y << -0.2, -QP_INFINITE_BOUND;
+    qp.upper_y << 0.2, 0.1;
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(+0.4);
+    qp.check();
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+
+    for(uint j = 0; j < 6; ++j)
+        BOOST_CHECK((qp.lower_x(j)-1e-4) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-4));
+    base::VectorXd Cx = qp.C*solver_output;
+    for(uint j = 0; j < 2; ++j)
+        BOOST_CHECK((qp.lower_y(j)-1e-4) <= Cx(j) && Cx(j) <= (qp.upper_y(j)+1e-4));
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_warm_start)
+{
+    /**
+     * Solve a sequence of slightly changing problems: The KKT matrix must only be factorized once and the warm started solver has to
+     * converge in less iterations than the cold started one
+     */
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 0, 0, true);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(+0.4);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    uint n_iter_cold = solver.getNIter();
+    BOOST_CHECK(solver.getNFactorizations() == 1);
+    BOOST_CHECK(!solver.getStats().warm_start);
+
+    for(int i = 0; i < 10; i++){
+        hqp[0].H = (1.0 + 1e-3*(i+1)) * qp.H;
+        hqp[0].g = (1.0 + 1e-3*(i+1)) * qp.g;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        BOOST_CHECK(solver.getNIter() < n_iter_cold);
+
+        const SolverStats& stats = solver.getStats();
+        BOOST_CHECK(stats.status == QPSolver::solved);
+        BOOST_CHECK(stats.warm_start);
+        BOOST_CHECK(stats.n_iter == solver.getNIter());
+        BOOST_CHECK(stats.primal_residual == solver.getPrimalResidual());
+        BOOST_CHECK(stats.dual_residual == solver.getDualResidual());
+        BOOST_CHECK(stats.n_active >= 0);
+    }
+    BOOST_CHECK(solver.getNFactorizations() == 1);
+
+    // Compare with a cold started solver
+    ADMMSolver solver_cold;
+    base::VectorXd solver_output_cold;
+    BOOST_CHECK_NO_THROW(solver_cold.solve(hqp, solver_output_cold));
+    for(uint j = 0; j < 6; ++j)
+        BOOST_CHECK(fabs(solver_output(j) - solver_output_cold(j)) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_time_budget)
+{
+    /**
+     * With a time budget, the solver must not throw if it stops early, but return the last iterate together with the status
+     */
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 0, 0, true);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(+0.4);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    solver.setMaxIter(5);
+    base::VectorXd solver_output;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::runtime_error);
+
+    solver.setTimeBudget(1e6);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::max_iter_reached);
+    BOOST_CHECK(solver_output.size() == 6);
+    BOOST_CHECK(!solver_output.hasNaN());
+
+    // After a large change of the problem, the primal residual of the first iterates oscillates. If the solver stops early, it must return the best
+    // iterate, not the last one
+    for(uint n_iter = 1; n_iter <= 20; n_iter++){
+        ADMMSolver solver_budget;
+        solver_budget.setTimeBudget(1e6);
+        solver_budget.setCheckInterval(1);
+        hqp[0].g = qp.g;
+        BOOST_CHECK_NO_THROW(solver_budget.solve(hqp, solver_output));
+        BOOST_CHECK(solver_budget.getStatus() == QPSolver::solved);
+
+        hqp[0].g = -3*qp.g;
+        solver_budget.setMaxIter(n_iter);
+        BOOST_CHECK_NO_THROW(solver_budget.solve(hqp, solver_output));
+        BOOST_CHECK(solver_budget.getStatus() == QPSolver::max_iter_reached);
+        BOOST_CHECK(solver_budget.getStats().primal_residual <= solver_budget.getPrimalResidual());
+        if(n_iter == 3)
+            BOOST_CHECK(solver_budget.getStats().primal_residual < solver_budget.getPrimalResidual());
+    }
+}
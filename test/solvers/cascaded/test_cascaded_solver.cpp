@@ -0,0 +1,141 @@
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/cascaded/CascadedQPSolver.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+#include <Eigen/QR>
+
+using namespace wbc;
+using namespace std;
+
+base::Matrix6d taskJacobian(){
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    return A;
+}
+
+base::Vector6d taskReference(){
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    return y;
+}
+
+/** Least squares task ||J*x - y||^2 as cost function, optionally with bounds*/
+wbc::QuadraticProgram taskQP(const base::MatrixXd& J, const base::VectorXd& y, bool bounds){
+    wbc::QuadraticProgram qp;
+    qp.resize(J.cols(), 0, 0, bounds);
+    qp.H = J.transpose()*J;
+    qp.g = -(J.transpose()*y);
+    if(bounds){
+        qp.lower_x.setConstant(-QP_INFINITE_BOUND);
+        qp.upper_x.setConstant(QP_INFINITE_BOUND);
+    }
+    return qp;
+}
+
+double taskCost(const wbc::QuadraticProgram& qp, const base::VectorXd& x){
+    return 0.5*x.dot(qp.H*x) + qp.g.dot(x);
+}
+
+BOOST_AUTO_TEST_CASE(solver_cascaded_equality_tasks)
+{
+    /**
+     * Two least squares tasks with 3 rows each: The first task has to be solved exactly, the second one in the nullspace of the first one
+     */
+
+    base::MatrixXd J1 = taskJacobian().topRows(3), J2 = taskJacobian().bottomRows(3);
+    base::VectorXd y1 = taskReference().head(3), y2 = taskReference().tail(3);
+
+    wbc::QuadraticProgram qp1 = taskQP(J1, y1, false), qp2 = taskQP(J2, y2, false);
+    wbc::HierarchicalQP hqp;
+    hqp << qp1;
+    hqp << qp2;
+
+    // Nullspace projection based reference solution
+    Eigen::CompleteOrthogonalDecomposition<base::MatrixXd> J1_inv(J1);
+    base::MatrixXd N1 = base::MatrixXd::Identity(6,6) - J1_inv.pseudoInverse()*J1;
+    base::VectorXd x1 = J1_inv.solve(y1);
+    base::MatrixXd J2_N1 = J2*N1;
+    base::VectorXd x_ref = x1 + N1*J2_N1.completeOrthogonalDecomposition().solve(y2 - J2*x1);
+
+    CascadedQPSolver solver("admm");
+    base::VectorXd solver_output;
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        BOOST_CHECK(solver.getNSolvedLevels() == 2);
+        for(uint j = 0; j < 6; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - x_ref(j)) < 1e-3);
+    }
+    BOOST_CHECK(solver.getStats().warm_start);
+
+    base::VectorXd test = J1*solver_output;
+    for(uint j = 0; j < 3; ++j)
+        BOOST_CHECK(fabs(test(j) - y1(j)) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_cascaded_inequality_constraints)
+{
+    /**
+     * An active bound on the highest priority has to be respected by all levels, and the lower priority must not increase the cost of the higher priority
+     */
+
+    base::MatrixXd J1 = taskJacobian().topRows(3), J2 = taskJacobian().bottomRows(3);
+    base::VectorXd y1 = taskReference().head(3), y2 = taskReference().tail(3);
+
+    wbc::QuadraticProgram qp1 = taskQP(J1, y1, true);
+    qp1.upper_x.setConstant(0.3);
+    wbc::QuadraticProgram qp2 = taskQP(J2, y2, false);
+    wbc::HierarchicalQP hqp_single, hqp;
+    hqp_single << qp1;
+    hqp << qp1;
+    hqp << qp2;
+
+    ADMMSolver single_solver;
+    base::VectorXd x_single;
+    single_solver.solve(hqp_single, x_single);
+
+    CascadedQPSolver solver("admm");
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+    for(uint j = 0; j < 6; ++j)
+        BOOST_CHECK(solver_output(j) <= 0.3 + 1e-4);
+    BOOST_CHECK(fabs(taskCost(qp1, solver_output) - taskCost(qp1, x_single)) < 1e-4);
+    BOOST_CHECK(taskCost(qp2, solver_output) <= taskCost(qp2, x_single) + 1e-4);
+
+    // The statistics combine both levels
+    BOOST_CHECK(solver.getLevelStats(0).status == QPSolver::solved);
+    BOOST_CHECK(solver.getLevelStats(1).status == QPSolver::solved);
+    BOOST_CHECK(solver.getStats().n_iter == solver.getLevelStats(0).n_iter + solver.getLevelStats(1).n_iter);
+    BOOST_CHECK(solver.getStats().n_active == solver.getLevelStats(1).n_active);
+    BOOST_CHECK(solver.getStats().primal_residual < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_cascaded_determined_solution)
+{
+    /**
+     * If the highest priority determines the solution completely, the lower priorities are skipped
+     */
+
+    wbc::QuadraticProgram qp1 = taskQP(taskJacobian(), taskReference(), false);
+    wbc::QuadraticProgram qp2 = taskQP(base::MatrixXd::Identity(6,6), base::VectorXd::Zero(6), false);
+    wbc::HierarchicalQP hqp;
+    hqp << qp1;
+    hqp << qp2;
+
+    CascadedQPSolver solver("admm");
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNSolvedLevels() == 1);
+    BOOST_CHECK(solver.getLevelStats(1).status == QPSolver::not_solved);
+
+    base::VectorXd test = taskJacobian()*solver_output;
+    for(uint j = 0; j < 6; ++j)
+        BOOST_CHECK(fabs(test(j) - taskReference()(j)) < 1e-3);
+}
@@ -205,5 +205,68 @@ BOOST_AUTO_TEST_CASE(solver_eiquadprog_bounded)
 
     for(uint j = 0; j < NO_JOINTS; ++j)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
+    BOOST_CHECK(solver.getStats().primal_residual < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(solver_eiquadprog_infinite_bounds)
+{
+    /**
+     * Check that constraint sides with infinite bounds are dropped and rows with equal lower and upper bound are treated as equalities,
+     * i.e., the solution has to be the same as for large, but finite bounds
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 0;
+    const int NO_IN_CONSTRAINTS = 6;
+    const bool WITH_BOUNDS = true;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y).transpose();
+
+    // One-sided inequalities on the sum of two variables, one equality
+    qp.C.setZero();
+    for(int i = 0; i < NO_IN_CONSTRAINTS-1; i++)
+        qp.C(i,i) = qp.C(i,i+1) = 1;
+    qp.C(5,5) = 1;
+    qp.lower_y << -QP_INFINITE_BOUND, -0.3, -QP_INFINITE_BOUND, -0.2, -QP_INFINITE_BOUND, 0.1;
+    qp.upper_y << 0.3, QP_INFINITE_BOUND, 0.4, QP_INFINITE_BOUND, QP_INFINITE_BOUND, 0.1;
+    qp.lower_x << -QP_INFINITE_BOUND, -0.5, -0.5, -QP_INFINITE_BOUND, 0.2, -QP_INFINITE_BOUND;
+    qp.upper_x << 0.5, QP_INFINITE_BOUND, 0.5, QP_INFINITE_BOUND, 0.2, QP_INFINITE_BOUND;
+    qp.check();
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    // Same problem with large, finite bounds
+    wbc::HierarchicalQP hqp_finite = hqp;
+    for(base::VectorXd* v : {&hqp_finite[0].lower_y, &hqp_finite[0].lower_x})
+        *v = v->cwiseMax(-1e5);
+    for(base::VectorXd* v : {&hqp_finite[0].upper_y, &hqp_finite[0].upper_x})
+        *v = v->cwiseMin(1e5);
+
+    EiquadprogSolver solver, solver_finite;
+    base::VectorXd solver_output, solver_output_finite;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK_NO_THROW(solver_finite.solve(hqp_finite, solver_output_finite));
+
+    for(uint j = 0; j < NO_JOINTS; ++j)
+        BOOST_CHECK(fabs(solver_output(j) - solver_output_finite(j)) < 1e-6);
+    BOOST_CHECK(fabs(solver_output(4) - 0.2) < 1e-9);
+    BOOST_CHECK(fabs(solver_output(5) - 0.1) < 1e-9);
 
+    // Infinite bounds must not count as violated in the reported constraint violation
+    BOOST_CHECK(solver.getStats().primal_residual < 1e-9);
 }
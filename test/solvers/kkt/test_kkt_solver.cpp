@@ -0,0 +1,155 @@
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/kkt/KKTSolver.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+#include <Eigen/LU>
+
+using namespace wbc;
+using namespace std;
+
+base::Matrix6d taskJacobian(){
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    return A;
+}
+
+base::Vector6d taskReference(){
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    return y;
+}
+
+/** Quadratic program with two equality constraints, one inequality constraint with equal bounds, one inactive inequality constraint and inactive bounds*/
+wbc::QuadraticProgram equalityQP(){
+    base::Matrix6d J = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 2, 2, true);
+    qp.H = J.transpose()*J;
+    qp.H.diagonal().array() += 1e-3;
+    qp.g = -(J.transpose()*y);
+    qp.A = J.topRows(2);
+    qp.b << 0.1, -0.2;
+    qp.C = J.bottomRows(2);
+    qp.lower_y << 0.3, -QP_INFINITE_BOUND;
+    qp.upper_y << 0.3, 100;
+    qp.lower_x.setConstant(-QP_INFINITE_BOUND);
+    qp.upper_x.setConstant(QP_INFINITE_BOUND);
+    return qp;
+}
+
+/** Solution of the equality constrained problem with a dense LU decomposition of the KKT matrix*/
+base::VectorXd referenceSolution(const wbc::QuadraticProgram& qp){
+    base::MatrixXd K = base::MatrixXd::Zero(9, 9);
+    K.topLeftCorner(6,6) = qp.H;
+    K.block(6,0,2,6) = qp.A;
+    K.block(0,6,6,2) = qp.A.transpose();
+    K.block(8,0,1,6) = qp.C.row(0);
+    K.block(0,8,6,1) = qp.C.row(0).transpose();
+    base::VectorXd rhs(9);
+    rhs << -qp.g, qp.b, qp.lower_y[0];
+    return K.partialPivLu().solve(rhs).head(6);
+}
+
+BOOST_AUTO_TEST_CASE(solver_kkt_without_constraints)
+{
+    /**
+     * Check if the solver computes the solution of an unconstrained least squares problem
+     */
+
+    base::Matrix6d A = taskJacobian();
+    base::Vector6d y = taskReference();
+
+    wbc::QuadraticProgram qp;
+    qp.resize(6, 0, 0, false);
+    qp.H = A.transpose()*A;
+    qp.g = -(A.transpose()*y);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    KKTSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+    BOOST_CHECK(!solver.usedFallbackSolver());
+
+    base::VectorXd test = A*solver_output;
+    for(uint j = 0; j < 6; ++j)
+        BOOST_CHECK(fabs(test(j) - y(j)) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(solver_kkt_with_equality_constraints)
+{
+    /**
+     * Equality constraints and inequality constraints with equal bounds have to be satisfied, inactive inequality constraints and bounds are ignored. Dense and sparse
+     * problems have to give the same solution
+     */
+
+    wbc::QuadraticProgram qp = equalityQP();
+    base::VectorXd x_ref = referenceSolution(qp);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    KKTSolver solver;
+    base::VectorXd solver_output;
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        BOOST_CHECK(solver.getStats().primal_residual < 1e-9);
+        for(uint j = 0; j < 6; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - x_ref(j)) < 1e-6);
+    }
+
+    wbc::QuadraticProgram qp_sparse;
+    qp_sparse.resize(6, 2, 2, true, true);
+    qp_sparse.H = qp.H;
+    qp_sparse.g = qp.g;
+    qp_sparse.A_sparse = qp.A.sparseView();
+    qp_sparse.b = qp.b;
+    qp_sparse.C_sparse = qp.C.sparseView();
+    qp_sparse.lower_y = qp.lower_y;
+    qp_sparse.upper_y = qp.upper_y;
+    qp_sparse.lower_x = qp.lower_x;
+    qp_sparse.upper_x = qp.upper_x;
+    hqp[0] = qp_sparse;
+
+    for(int i = 0; i < 2; i++){
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+        for(uint j = 0; j < 6; ++j)
+            BOOST_CHECK(fabs(solver_output(j) - x_ref(j)) < 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(solver_kkt_active_inequalities)
+{
+    /**
+     * If the solution of the equality constrained problem violates a bound, the solver has to throw or use the fallback solver
+     */
+
+    wbc::QuadraticProgram qp = equalityQP();
+    base::VectorXd x_ref = referenceSolution(qp);
+    qp.upper_x[0] = x_ref[0] - 0.1;
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    KKTSolver solver;
+    base::VectorXd solver_output;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::runtime_error);
+
+    solver.setFallbackSolver(std::make_shared<ADMMSolver>());
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.usedFallbackSolver());
+    BOOST_CHECK(solver.getStatus() == QPSolver::solved);
+    BOOST_CHECK(solver_output[0] <= qp.upper_x[0] + 1e-4);
+}
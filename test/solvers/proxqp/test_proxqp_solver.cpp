@@ -233,3 +233,152 @@ BOOST_AUTO_TEST_CASE(solver_proxqp_bounded)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
 
 }
+
+BOOST_AUTO_TEST_CASE(solver_proxqp_sparse)
+{
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 2;
+    const int NO_IN_CONSTRAINTS = 3;
+    const bool WITH_BOUNDS = true;
+
+    // Solve the same problem in dense and in sparse format. Both backends have to give the same solution
+
+    // Task Jacobian
+    base::Matrix6d J;
+    J << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    // Desired task space reference
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+
+    base::MatrixXd A(NO_EQ_CONSTRAINTS, NO_JOINTS), C(NO_IN_CONSTRAINTS, NO_JOINTS);
+    A << 1, 0, 0, 0, 0, -1,
+         0, 0, 1, 0, 0,  0;
+    C << 0, 1, 0, 0, 0, 0,
+         0, 0, 0, 1, 1, 0,
+         1, 0, 0, 0, 0, 0;
+
+    wbc::QuadraticProgram qp_dense, qp_sparse;
+    qp_dense.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+    qp_sparse.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS, true);
+    BOOST_CHECK(qp_sparse.sparse);
+    BOOST_CHECK(qp_sparse.A.rows() == 0 && qp_sparse.C.rows() == 0);
+
+    for(wbc::QuadraticProgram* qp : {&qp_dense, &qp_sparse}){
+        qp->H = J.transpose()*J;
+        qp->g = -(J.transpose()*y);
+        qp->b << 0.1, -0.2;
+        qp->lower_y << -0.5, -0.3, -1;
+        qp->upper_y << 0.5, 0.3, 1;
+        qp->lower_x.setConstant(-0.8);
+        qp->upper_x.setConstant(0.8);
+    }
+    qp_dense.A = A;
+    qp_dense.C = C;
+    qp_sparse.A_sparse = A.sparseView();
+    qp_sparse.C_sparse = C.sparseView();
+
+    qp_dense.check();
+    qp_sparse.check();
+    wbc::HierarchicalQP hqp_dense, hqp_sparse;
+    hqp_dense << qp_dense;
+    hqp_sparse << qp_sparse;
+
+    ProxQPSolver solver_dense, solver_sparse;
+    solver_sparse.setSparse(true);
+    BOOST_CHECK(!solver_dense.sparseInput());
+    BOOST_CHECK(solver_sparse.sparseInput());
+
+    base::VectorXd solver_output_dense, solver_output_sparse;
+    BOOST_CHECK_NO_THROW(solver_dense.solve(hqp_dense, solver_output_dense));
+    BOOST_CHECK_NO_THROW(solver_sparse.solve(hqp_sparse, solver_output_sparse));
+
+    BOOST_CHECK(solver_output_dense.size() == NO_JOINTS);
+    BOOST_CHECK(solver_output_sparse.size() == NO_JOINTS);
+    BOOST_CHECK((A*solver_output_sparse - qp_sparse.b).norm() < 1e-6);
+    for(uint j = 0; j < NO_JOINTS; j++){
+        BOOST_CHECK(fabs(solver_output_dense(j) - solver_output_sparse(j)) < 1e-6);
+        BOOST_CHECK(solver_output_sparse(j) <= 0.8 + 1e-6 && solver_output_sparse(j) >= -0.8 - 1e-6);
+    }
+
+    // Second call uses the warm start with the same sparsity pattern
+    BOOST_CHECK_NO_THROW(solver_sparse.solve(hqp_sparse, solver_output_sparse));
+    for(uint j = 0; j < NO_JOINTS; j++)
+        BOOST_CHECK(fabs(solver_output_dense(j) - solver_output_sparse(j)) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(solver_proxqp_infinite_bounds)
+{
+    /**
+     * Check that constraint sides with infinite bounds are handled correctly by the dense and the sparse backend, i.e., the solution has to be the same as for
+     * large, but finite bounds
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 0;
+    const int NO_IN_CONSTRAINTS = 6;
+    const bool WITH_BOUNDS = true;
+
+    base::Matrix6d J;
+    J << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+
+    // One-sided inequalities on the sum of two variables, one equality
+    base::MatrixXd C = base::MatrixXd::Zero(NO_IN_CONSTRAINTS, NO_JOINTS);
+    for(int i = 0; i < NO_IN_CONSTRAINTS-1; i++)
+        C(i,i) = C(i,i+1) = 1;
+    C(5,5) = 1;
+
+    wbc::QuadraticProgram qp_dense, qp_sparse;
+    qp_dense.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS);
+    qp_sparse.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, WITH_BOUNDS, true);
+    for(wbc::QuadraticProgram* qp : {&qp_dense, &qp_sparse}){
+        qp->H = J.transpose()*J;
+        qp->g = -(J.transpose()*y);
+        qp->lower_y << -QP_INFINITE_BOUND, -0.3, -QP_INFINITE_BOUND, -0.2, -QP_INFINITE_BOUND, 0.1;
+        qp->upper_y << 0.3, QP_INFINITE_BOUND, 0.4, QP_INFINITE_BOUND, QP_INFINITE_BOUND, 0.1;
+        qp->lower_x << -QP_INFINITE_BOUND, -0.5, -0.5, -QP_INFINITE_BOUND, 0.2, -QP_INFINITE_BOUND;
+        qp->upper_x << 0.5, QP_INFINITE_BOUND, 0.5, QP_INFINITE_BOUND, 0.2, QP_INFINITE_BOUND;
+    }
+    qp_dense.C = C;
+    qp_sparse.C_sparse = C.sparseView();
+    qp_dense.check();
+    qp_sparse.check();
+
+    wbc::HierarchicalQP hqp_dense, hqp_sparse;
+    hqp_dense << qp_dense;
+    hqp_sparse << qp_sparse;
+
+    // Same problem with large, finite bounds
+    wbc::HierarchicalQP hqp_finite = hqp_dense;
+    for(base::VectorXd* v : {&hqp_finite[0].lower_y, &hqp_finite[0].lower_x})
+        *v = v->cwiseMax(-1e5);
+    for(base::VectorXd* v : {&hqp_finite[0].upper_y, &hqp_finite[0].upper_x})
+        *v = v->cwiseMin(1e5);
+
+    ProxQPSolver solver_dense, solver_sparse, solver_finite;
+    solver_sparse.setSparse(true);
+    base::VectorXd solver_output_dense, solver_output_sparse, solver_output_finite;
+    BOOST_CHECK_NO_THROW(solver_dense.solve(hqp_dense, solver_output_dense));
+    BOOST_CHECK_NO_THROW(solver_sparse.solve(hqp_sparse, solver_output_sparse));
+    BOOST_CHECK_NO_THROW(solver_finite.solve(hqp_finite, solver_output_finite));
+
+    for(uint j = 0; j < NO_JOINTS; ++j){
+        BOOST_CHECK(fabs(solver_output_dense(j) - solver_output_finite(j)) < 1e-6);
+        BOOST_CHECK(fabs(solver_output_sparse(j) - solver_output_finite(j)) < 1e-6);
+    }
+    BOOST_CHECK(fabs(solver_output_dense(4) - 0.2) < 1e-6);
+    BOOST_CHECK(fabs(solver_output_dense(5) - 0.1) < 1e-6);
+    BOOST_CHECK(solver_dense.getStats().primal_residual < 1e-6);
+    BOOST_CHECK(solver_sparse.getStats().primal_residual < 1e-6);
+}
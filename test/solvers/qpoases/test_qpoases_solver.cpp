@@ -280,4 +280,56 @@ BOOST_AUTO_TEST_CASE(solver_qpoases_bounded)
     for(uint j = 0; j < NO_JOINTS; ++j)
         BOOST_CHECK((qp.lower_x(j)-1e-9) <= solver_output(j) && solver_output(j) <= (qp.upper_x(j)+1e-9));
 
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(solver_qpoases_vector_hotstart)
+{
+    // If only the vectors of the QP change between two calls, the solver performs a hotstart without matrix update.
+    // Check if the solution is the same as the one of a newly initialized solver
+
+    const int NO_JOINTS = 6;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, 1, 0, true);
+
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+
+    qp.H = A.transpose()*A;
+    qp.g = -A.transpose()*y;
+    qp.A.setOnes();
+    qp.b.setConstant(0.1);
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(+0.4);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    QPOASESSolver solver;
+    base::VectorXd solver_output, solver_output_ref;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.matricesChanged());
+
+    // New gradient, bounds and constraint vector, same matrices
+    hqp[0].g = -A.transpose()*(y*0.5);
+    hqp[0].b.setConstant(-0.2);
+    hqp[0].upper_x.setConstant(0.3);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(!solver.matricesChanged());
+
+    QPOASESSolver solver_ref;
+    BOOST_CHECK_NO_THROW(solver_ref.solve(hqp, solver_output_ref));
+    for(uint j = 0; j < NO_JOINTS; ++j)
+        BOOST_CHECK(fabs(solver_output(j) - solver_output_ref(j)) < 1e-6);
+
+    // Changed Hessian: Full matrix update
+    hqp[0].H.diagonal().array() += 1e-3;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.matricesChanged());
+}
@@ -147,3 +147,41 @@ BOOST_AUTO_TEST_CASE(solver_qp_swift_with_equality_constraints)
 
     //cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_qp_swift_in_place_update)
+{
+    /**
+     * Solve a sequence of quadratic programs with constant structure. Overwriting the problem data in place has to give the same results as a setup in each cycle
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_EQ_CONSTRAINTS = 2;
+    const int NO_IN_CONSTRAINTS = 2;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_JOINTS, NO_EQ_CONSTRAINTS, NO_IN_CONSTRAINTS, true);
+
+    QPSwiftSolver solver, solver_setup;
+    solver_setup.setInPlaceUpdate(false);
+    base::VectorXd solver_output, solver_output_setup;
+
+    for(int i = 0; i < 10; i++){
+        base::MatrixXd M = base::MatrixXd::Random(NO_JOINTS, NO_JOINTS);
+        qp.H = M*M.transpose() + base::MatrixXd::Identity(NO_JOINTS, NO_JOINTS);
+        qp.g.setRandom();
+        qp.A.setRandom();
+        qp.b.setRandom();
+        qp.C.setRandom();
+        qp.lower_y.setConstant(-1);
+        qp.upper_y.setConstant(1);
+        qp.lower_x.setConstant(-1000);
+        qp.upper_x.setConstant(1000);
+
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK_NO_THROW(solver_setup.solve(hqp, solver_output_setup));
+        BOOST_CHECK((solver_output - solver_output_setup).norm() < 1e-6);
+        BOOST_CHECK((qp.A*solver_output - qp.b).norm() < 1e-6);
+    }
+}